@@ -224,6 +224,9 @@ namespace graphene { namespace app {
             case operation::tag<contract_invoke_operation>::value:
                 op.get<contract_invoke_operation>().fee.amount = ir.acctual_fee;
                 break;
+            case operation::tag<contract_batch_invoke_operation>::value:
+                op.get<contract_batch_invoke_operation>().fee.amount = ir.acctual_fee;
+                break;
             case operation::tag<contract_register_operation>::value:
                 op.get<contract_register_operation>().fee.amount = ir.acctual_fee;
                 break;
@@ -361,6 +364,11 @@ namespace graphene { namespace app {
        return _app.p2p_node()->set_advanced_node_parameters(params);
     }
 
+    fc::variant_object network_node_api::get_p2p_metrics() const
+    {
+       return _app.p2p_node()->get_p2p_metrics();
+    }
+
     fc::api<network_broadcast_api> login_api::network_broadcast()const
     {
        FC_ASSERT(_network_broadcast_api);
@@ -677,6 +685,31 @@ namespace graphene { namespace app {
        return hist->tracked_buckets();
     }
 
+    // through its interface, graphene_app doesn't link the plugin
+    static const exchange_order_book_source& get_exchange_order_book_source( const application& app )
+    {
+       auto plugin = app.get_plugin( "exchange_order_book" );
+       auto book = dynamic_cast< const exchange_order_book_source* >( plugin.get() );
+       FC_ASSERT( book && book->is_enabled(), "exchange_order_book plugin is not enabled" );
+       return *book;
+    }
+
+    exchange_order_book_depth history_api::get_exchange_order_book( const address& contract, const string& exchange_pair, uint32_t limit )const
+    {
+       FC_ASSERT( limit <= 100 );
+       return get_exchange_order_book_source( _app ).get_depth( contract, exchange_pair, limit );
+    }
+
+    exchange_order_book_depth history_api::get_exchange_top_of_book( const address& contract, const string& exchange_pair )const
+    {
+       return get_exchange_order_book( contract, exchange_pair, 1 );
+    }
+
+    vector<exchange_open_order> history_api::get_exchange_open_orders( const address& contract, const string& owner )const
+    {
+       return get_exchange_order_book_source( _app ).get_open_orders( contract, owner );
+    }
+
     vector<bucket_object> history_api::get_market_history( asset_id_type a, asset_id_type b,
                                                            uint32_t bucket_seconds, fc::time_point_sec start, fc::time_point_sec end )const
     { try {
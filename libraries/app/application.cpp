@@ -36,6 +36,7 @@
 
 #include <graphene/utilities/key_conversion.hpp>
 #include <graphene/chain/worker_evaluator.hpp>
+#include <graphene/chain/block_summary_object.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 
@@ -44,6 +45,7 @@
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/network/resolve.hpp>
 #include <fc/network/http/connection.hpp>
+#include <fc/network/http/server.hpp>
 #include <fc/crypto/base64.hpp>
 
 #include <boost/filesystem/path.hpp>
@@ -62,6 +64,7 @@
 #include <graphene/crosschain/crosschain_impl.hpp>
 #include <graphene/crosschain/crosschain_interface_btc.hpp>
 #include <graphene/chain/contract_object.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 namespace graphene {
   namespace app {
     using net::item_hash_t;
@@ -81,6 +84,12 @@ namespace graphene {
 
 #define XWC_MIDDLEWARE_ENDPOINT "112.5.37.213:5005"
 
+// transactions from the network with more signatures than this are refused before they are verified,
+// unless p2p-max-signatures-per-trx says otherwise
+#define XWC_MAX_SIGNATURES_PER_NETWORK_TRANSACTION 64
+// times the failed transactions of a batch from the network are pushed again after the others went in
+#define XWC_MAX_NETWORK_TRANSACTION_RETRY_PASSES 2
+
     namespace detail {
 
       genesis_state_type create_example_genesis() {
@@ -153,6 +162,7 @@ namespace graphene {
         bool _is_block_producer = false;
         bool _force_validate = false;
         bool _stop_block_processing = false;
+        uint32_t _max_signatures_per_network_transaction = XWC_MAX_SIGNATURES_PER_NETWORK_TRANSACTION;
         void reset_p2p_node(const fc::path& data_dir)
         {
           try {
@@ -271,6 +281,12 @@ namespace graphene {
               }
             }
 
+            if (_options->count("p2p-io-threads"))
+              _p2p_network->set_advanced_node_parameters(fc::mutable_variant_object()("io_threads", _options->at("p2p-io-threads").as<uint32_t>()));
+            if (_options->count("p2p-max-trx-per-second-per-peer"))
+              _p2p_network->set_advanced_node_parameters(fc::mutable_variant_object()("maximum_transactions_per_second_per_peer",
+                                                                                      _options->at("p2p-max-trx-per-second-per-peer").as<uint32_t>()));
+
             if (_options->count("p2p-endpoint"))
               _p2p_network->listen_on_endpoint(fc::ip::endpoint::from_string(_options->at("p2p-endpoint").as<string>()), true);
             else
@@ -382,6 +398,32 @@ namespace graphene {
           } FC_CAPTURE_AND_RETHROW()
         }
 
+        void reset_p2p_metrics_server()
+        {
+          try {
+            if (!_options->count("p2p-metrics-endpoint"))
+              return;
+
+            _p2p_metrics_server = std::make_shared<fc::http::server>();
+            ilog("Configured p2p metrics to be served on ${ip}", ("ip", _options->at("p2p-metrics-endpoint").as<string>()));
+            _p2p_metrics_server->listen(fc::ip::endpoint::from_string(_options->at("p2p-metrics-endpoint").as<string>()));
+            // on_request() must come after listen()
+            _p2p_metrics_server->on_request([this](const fc::http::request& req, const fc::http::server::response& resp) {
+              std::string body;
+              if (req.path.substr(0, req.path.find('?')) == "/metrics" && _p2p_network)
+              {
+                body = _p2p_network->get_p2p_metrics_text();
+                resp.add_header("Content-Type", "text/plain; version=0.0.4");
+                resp.set_status(fc::http::reply::OK);
+              }
+              else
+                resp.set_status(fc::http::reply::NotFound);
+              resp.set_length(body.size());
+              resp.write(body.data(), body.size());
+            });
+          } FC_CAPTURE_AND_RETHROW()
+        }
+
         application_impl(application* self)
           : _self(self),
           _chain_db(std::make_shared<chain::database>())
@@ -664,6 +706,11 @@ namespace graphene {
               _force_validate = true;
             }
 
+            if (_options->count("p2p-max-signatures-per-trx"))
+              _max_signatures_per_network_transaction = _options->at("p2p-max-signatures-per-trx").as<uint32_t>();
+            if (_options->count("offline-contract-gas-cap"))
+              _chain_db->offline_executor().set_gas_cap(_options->at("offline-contract-gas-cap").as<uint64_t>());
+
             if (_options->count("api-access"))
               _apiaccess = fc::json::from_file(_options->at("api-access").as<boost::filesystem::path>())
               .as<api_access>();
@@ -689,6 +736,7 @@ namespace graphene {
             reset_p2p_node(_data_dir);
             reset_websocket_server();
             reset_websocket_tls_server();
+            reset_p2p_metrics_server();
 
             // maybe here should add crosschain initialize
           } FC_LOG_AND_RETHROW()
@@ -823,18 +871,117 @@ namespace graphene {
           try {
             if (_stop_block_processing)
               return;
-            static fc::time_point last_call;
-            static int trx_count = 0;
-            ++trx_count;
-            auto now = fc::time_point::now();
-            if (now - last_call > fc::seconds(1)) {
-              ilog("Got ${c} transactions from network", ("c", trx_count));
-              last_call = now;
-              trx_count = 0;
+            count_network_transaction();
+            precheck_network_transaction(*_chain_db, transaction_message.trx, _max_signatures_per_network_transaction);
+            _chain_db->push_transaction(transaction_message.trx, database::skip_contract_exec);
+          } FC_CAPTURE_AND_RETHROW((transaction_message))
+        }
+
+        /// logs how many transactions came from the network, once a second
+        static void count_network_transaction()
+        {
+          static fc::time_point last_call;
+          static int trx_count = 0;
+          ++trx_count;
+          auto now = fc::time_point::now();
+          if (now - last_call > fc::seconds(1)) {
+            ilog("Got ${c} transactions from network", ("c", trx_count));
+            last_call = now;
+            trx_count = 0;
+          }
+        }
+
+        struct operation_core_fee_visitor
+        {
+          typedef share_type result_type;
+          template<typename T>
+          share_type operator()(const T& op)const { return op.fee.asset_id == asset_id_type() ? op.fee.amount : share_type(0); }
+        };
+
+        /// the core asset fee a transaction pays per byte, contract gas included
+        static double transaction_fee_per_byte(const signed_transaction& trx)
+        {
+          share_type fee;
+          for (const operation& op : trx.operations)
+            fee += op.visit(operation_core_fee_visitor());
+          return double(fee.value) / std::max<size_t>(fc::raw::pack_size(trx), 1);
+        }
+
+        virtual std::vector<fc::oexception> handle_transactions(const std::vector<trx_message>& transaction_messages) override
+        {
+          std::vector<fc::oexception> results(transaction_messages.size());
+          if (_stop_block_processing)
+            return results;
+
+          // a transaction that fails the prechecks fails them whatever else goes in, it is never pushed again
+          std::vector<size_t> push_order;
+          std::vector<double> fees_per_byte(transaction_messages.size());
+          for (size_t i = 0; i < transaction_messages.size(); ++i)
+          {
+            count_network_transaction();
+            try
+            {
+              precheck_network_transaction(*_chain_db, transaction_messages[i].trx, _max_signatures_per_network_transaction);
             }
+            catch (const fc::exception& e)
+            {
+              results[i] = e;
+              continue;
+            }
+            push_order.push_back(i);
+            fees_per_byte[i] = transaction_fee_per_byte(transaction_messages[i].trx);
+          }
+          // push the best paying transactions first, they are the ones to keep if the pending block fills up
+          std::stable_sort(push_order.begin(), push_order.end(), [&fees_per_byte](size_t a, size_t b) {
+            return fees_per_byte[a] > fees_per_byte[b];
+          });
+
+          std::vector<size_t> failed;
+          for (size_t i : push_order)
+          {
+            if (!push_network_transaction(transaction_messages[i], results[i]))
+              failed.push_back(i);
+          }
 
+          // a transaction can depend on one of the batch that pays less, so it was pushed before it.  the node
+          // never fetches a failed transaction again, so retry them in the order they came in while some go in.
+          // the passes are capped, a batch of transactions that each need the next one costs no more than that
+          std::sort(failed.begin(), failed.end());
+          bool pushed_any = true;
+          for (uint32_t pass = 0; pass < XWC_MAX_NETWORK_TRANSACTION_RETRY_PASSES && pushed_any && !failed.empty(); ++pass)
+          {
+            pushed_any = false;
+            std::vector<size_t> still_failed;
+            for (size_t i : failed)
+            {
+              if (push_network_transaction(transaction_messages[i], results[i]))
+                pushed_any = true;
+              else
+                still_failed.push_back(i);
+            }
+            failed.swap(still_failed);
+          }
+          return results;
+        }
+
+        /// pushes a transaction that passed the prechecks, result is the reason it failed
+        bool push_network_transaction(const trx_message& transaction_message, fc::oexception& result)
+        {
+          try
+          {
             _chain_db->push_transaction(transaction_message.trx, database::skip_contract_exec);
-          } FC_CAPTURE_AND_RETHROW((transaction_message))
+            result.reset();
+            return true;
+          }
+          catch (const fc::canceled_exception&)
+          {
+            throw;
+          }
+          catch (const fc::exception& e)
+          {
+            result = e;
+            return false;
+          }
         }
 
         virtual void handle_message(const message& message_to_process) override
@@ -929,6 +1076,37 @@ namespace graphene {
           } FC_CAPTURE_AND_RETHROW((id))
         }
 
+        virtual signed_block_header get_block_header(const item_hash_t& block_id) override
+        {
+          // skips packing the whole block into a message like get_item would
+          auto opt_block = _chain_db->fetch_block_by_id(block_id);
+          if (!opt_block)
+            FC_THROW_EXCEPTION(fc::key_not_found_exception, "Couldn't find block ${id}", ("id", block_id));
+          return *opt_block;
+        }
+
+        virtual graphene::net::block_signing_schedule get_block_signing_schedule() override
+        {
+          graphene::net::block_signing_schedule schedule;
+          schedule.head_block_id = _chain_db->head_block_id();
+          // the miners are reshuffled after the last block of a round, and the block after a bonus block
+          // skips slots.  after the first block, slots are multiples of the block interval
+          uint32_t head_block_num = _chain_db->head_block_num();
+          if (head_block_num == 0)
+            schedule.last_scheduled_block_num = 1;
+          else
+            schedule.last_scheduled_block_num = std::min<uint64_t>((head_block_num / GRAPHENE_PRODUCT_PER_ROUND + 1) * GRAPHENE_PRODUCT_PER_ROUND,
+                                                                   (head_block_num / GRAPHENE_BONUS_DISTRIBUTE_BLOCK_NUM + 1) * GRAPHENE_BONUS_DISTRIBUTE_BLOCK_NUM);
+          schedule.first_slot_time = _chain_db->get_slot_time(1);
+          schedule.block_interval = _chain_db->block_interval();
+          schedule.next_maintenance_time = _chain_db->get_dynamic_global_properties().next_maintenance_time;
+          for (uint32_t slot = 1; slot <= GRAPHENE_PRODUCT_PER_ROUND; ++slot)
+            schedule.slot_signing_keys.push_back(_chain_db->get_scheduled_miner(slot)(*_chain_db).signing_key.key_data);
+          for (const miner_id_type& miner_id : _chain_db->get_global_properties().active_witnesses)
+            schedule.signing_keys.insert(miner_id(*_chain_db).signing_key.key_data);
+          return schedule;
+        }
+
         virtual chain_id_type get_chain_id()const override
         {
           return _chain_db->get_chain_id();
@@ -1185,6 +1363,7 @@ namespace graphene {
         std::shared_ptr<graphene::net::node>                  _p2p_network;
         std::shared_ptr<fc::http::websocket_server>      _websocket_server;
         std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+        std::shared_ptr<fc::http::server>                _p2p_metrics_server;
 
         std::map<string, std::shared_ptr<abstract_plugin>> _plugins;
 
@@ -1207,17 +1386,22 @@ namespace graphene {
     {
       configuration_file_options.add_options()
         ("p2p-endpoint", bpo::value<string>(), "Endpoint for P2P node to listen on")
+        ("p2p-io-threads", bpo::value<uint32_t>(), "Number of threads reading and writing P2P connections, 0 to use the P2P thread")
+        ("p2p-max-trx-per-second-per-peer", bpo::value<uint32_t>(), "Maximum rate at which transactions are requested from each P2P peer, 0 for no limit")
+        ("p2p-max-signatures-per-trx", bpo::value<uint32_t>(), "Transactions from P2P peers with more signatures are refused before they are verified, 64 by default")
         ("seed-node,s", bpo::value<vector<string>>()->composing(), "P2P nodes to connect to on startup (may specify multiple times)")
         ("seed-nodes", bpo::value<string>()->composing(), "JSON array of P2P nodes to connect to on startup")
         ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
         ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8090"), "Endpoint for websocket RPC to listen on")
         ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"), "Endpoint for TLS websocket RPC to listen on")
+        ("p2p-metrics-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:9102"), "Endpoint for HTTP to listen on, serving P2P metrics for Prometheus at /metrics")
         ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server")
         ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
         ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read Genesis State from")
         ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init mineres, overrides genesis file")
         ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
         ("min_gas_price", bpo::value<int>(), "Miner in this node would not pack contract trx which gas price to low")
+        ("offline-contract-gas-cap", bpo::value<uint64_t>(), "Gas limit of contract calls served by invoke_contract_offline, 100000000 by default")
         ("midware_servers", bpo::value<string>()->composing()->default_value(string("[\"").append(XWC_MIDDLEWARE_ENDPOINT).append("\"]")), "")
         ("midware_servers_backup", bpo::value<string>()->composing()->default_value(string("[\"").append(XWC_MIDDLEWARE_ENDPOINT).append("\"]")), "")
         ;
@@ -1395,6 +1579,23 @@ namespace graphene {
       return;
     }
 
+    void precheck_network_transaction(const chain::database& db, const chain::signed_transaction& trx, uint32_t max_signatures)
+    {
+      const chain_parameters& parameters = db.get_global_properties().parameters;
+      FC_ASSERT(fc::raw::pack_size(trx) <= parameters.maximum_transaction_size, "transaction is too large");
+      FC_ASSERT(trx.signatures.size() <= max_signatures, "transaction has too many signatures",
+                ("signatures", trx.signatures.size())("max_signatures", max_signatures));
+      if (db.head_block_num() == 0)
+        return;
+      fc::time_point_sec now = db.head_block_time();
+      FC_ASSERT(now <= trx.expiration, "transaction has expired", ("now", now)("trx.exp", trx.expiration));
+      FC_ASSERT(trx.expiration <= now + parameters.maximum_time_until_expiration, "transaction expires too late",
+                ("trx.expiration", trx.expiration)("now", now)("max_til_exp", parameters.maximum_time_until_expiration));
+      const block_summary_object* tapos_block_summary = db.find(block_summary_id_type(trx.ref_block_num));
+      FC_ASSERT(tapos_block_summary && trx.ref_block_prefix == tapos_block_summary->block_id._hash[1],
+                "transaction refers to a block we don't know");
+    }
+
     // namespace detail
   }
 }
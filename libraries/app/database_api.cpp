@@ -35,11 +35,13 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/contract_object.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 #include<graphene/chain/witness_schedule_object.hpp>
 #include <cctype>
 #include <fc/ntp.hpp>
 #include <cfenv>
 #include <iostream>
+
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
 
 typedef std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>, std::vector<fc::variant> > market_queue_type;
@@ -757,6 +759,9 @@ optional<graphene::chain::full_transaction> database_api_impl::get_transaction_b
 		case operation::tag<contract_invoke_operation>::value:
 			op.get<contract_invoke_operation>().fee.amount = ir.acctual_fee;
 			break;
+		case operation::tag<contract_batch_invoke_operation>::value:
+			op.get<contract_batch_invoke_operation>().fee.amount = ir.acctual_fee;
+			break;
 		case operation::tag<contract_register_operation>::value:
 			op.get<contract_register_operation>().fee.amount = ir.acctual_fee;
 			break;
@@ -3043,7 +3048,10 @@ execution_result database_api::invoke_contract_testing(const string & pubkey, co
 	}FC_CAPTURE_AND_RETHROW((pubkey)(contract_address_or_name)(contract_api)(contract_arg))
 
 }
-string database_api::invoke_contract_offline(const string & caller_pubkey_str, const string & contract_address_or_name, const string & contract_api, const string & contract_arg)
+static const fc::microseconds offline_invoke_timeout = fc::seconds(10);
+
+offline_invoke_result database_api::invoke_contract_offline_with_block(
+const string & caller_pubkey_str, const string & contract_address_or_name, const string & contract_api, const string & contract_arg)
 {
 	try {
 
@@ -3092,7 +3100,7 @@ string database_api::invoke_contract_offline(const string & caller_pubkey_str, c
 		}
 
 		contract_invoke_op.gas_price = 0;
-		contract_invoke_op.invoke_cost = GRAPHENE_CONTRACT_TESTING_GAS;
+		contract_invoke_op.invoke_cost = my->_db.offline_executor().gas_cap();
 		contract_invoke_op.caller_addr = caller_pubkey;
 		contract_invoke_op.caller_pubkey = caller_pubkey;
 		contract_invoke_op.contract_id = address(contract_address);
@@ -3100,35 +3108,16 @@ string database_api::invoke_contract_offline(const string & caller_pubkey_str, c
 		contract_invoke_op.contract_arg = contract_arg;
 		contract_invoke_op.fee.amount = 0;
 		contract_invoke_op.fee.asset_id = asset_id_type(0);
-		//contract_invoke_op.invoke_cost = GRAPHENE_CONTRACT_TESTING_GAS;
-		//contract_invoke_op.guarantee_id = get_guarantee_id();
-		signed_transaction tx;
-		tx.operations.push_back(contract_invoke_op);
-		auto current_fees = get_global_properties().parameters.current_fees;
-		for (auto& op : tx.operations)
-			current_fees->set_fee(op);
+		operation op = contract_invoke_op;
+		get_global_properties().parameters.current_fees->set_fee(op);
+		return my->_db.offline_executor().invoke(op.get<contract_invoke_operation>(), offline_invoke_timeout);
 
-		auto dyn_props = get_dynamic_global_properties();
-		tx.set_reference_block(dyn_props.head_block_id);
-		tx.set_expiration(dyn_props.time + fc::seconds(30));
-		tx.validate();
-		signed_transaction signed_tx(tx);
-		auto trx_res = validate_transaction(signed_tx, true);
-		share_type gas_count = 0;
-		string res = "some error happened, not api result get";
-		for (auto op_res : trx_res.operation_results)
-		{
-			try {
-				res = op_res.get<contract_operation_result_info>().api_result;
-			}
-			catch (...)
-			{
-				break;
-			}
-		}
-		return res;
 	}FC_CAPTURE_AND_RETHROW((caller_pubkey_str)(contract_address_or_name)(contract_api)(contract_arg))
 }
+string database_api::invoke_contract_offline(const string & caller_pubkey_str, const string & contract_address_or_name, const string & contract_api, const string & contract_arg)
+{
+	return invoke_contract_offline_with_block(caller_pubkey_str, contract_address_or_name, contract_api, contract_arg).api_result;
+}
 
 graphene::chain::vector<graphene::chain::transaction_id_type> database_api::get_contract_history(const string& contract_id, uint64_t start, uint64_t end)
 {
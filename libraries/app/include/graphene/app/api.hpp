@@ -29,6 +29,7 @@
 #include <graphene/chain/protocol/confidential.hpp>
 
 #include <graphene/market_history/market_history_plugin.hpp>
+#include <graphene/exchange_order_book/exchange_order_book.hpp>
 
 #include <graphene/debug_witness/debug_api.hpp>
 
@@ -49,6 +50,7 @@
 namespace graphene { namespace app {
    using namespace graphene::chain;
    using namespace graphene::market_history;
+   using namespace graphene::exchange_order_book;
    using namespace fc::ecc;
    using namespace std;
 
@@ -163,6 +165,19 @@ namespace graphene { namespace app {
          vector<bucket_object> get_market_history( asset_id_type a, asset_id_type b, uint32_t bucket_seconds,
                                                    fc::time_point_sec start, fc::time_point_sec end )const;
          flat_set<uint32_t> get_market_history_buckets()const;
+
+         /**
+          * @brief Get the aggregated open orders of a native exchange contract pair
+          * @param contract Address of the native exchange contract
+          * @param exchange_pair Trading pair as reported by the contract events, e.g. "HC/COIN"
+          * @param limit Maximum number of price levels per side (must not exceed 100)
+          * @return Bids from the highest price and asks from the lowest price
+          */
+         exchange_order_book_depth get_exchange_order_book( const address& contract, const string& exchange_pair, uint32_t limit )const;
+         /** @brief Get the best bid and ask level of a native exchange contract pair */
+         exchange_order_book_depth get_exchange_top_of_book( const address& contract, const string& exchange_pair )const;
+         /** @brief Get the open orders of one owner on a native exchange contract, oldest first */
+         vector<exchange_open_order> get_exchange_open_orders( const address& contract, const string& owner )const;
       private:
            application& _app;
    };
@@ -281,6 +296,13 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get traffic and latency metrics: messages and bytes by message type, request
+          *        latencies, block apply times, duplicate receives and send queue depths,
+          *        in total and for each connected peer
+          */
+         fc::variant_object get_p2p_metrics() const;
+
       private:
          application& _app;
    };
@@ -456,6 +478,9 @@ FC_API(graphene::app::history_api,
        (get_fill_order_history)
        (get_market_history)
        (get_market_history_buckets)
+       (get_exchange_order_book)
+       (get_exchange_top_of_book)
+       (get_exchange_open_orders)
      )
 FC_API(graphene::app::crosschain_api,
        (get_config)
@@ -489,6 +514,7 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_p2p_metrics)
      )
 FC_API(graphene::app::crypto_api,
        (blind)
@@ -103,4 +103,11 @@ namespace graphene { namespace app {
 		 std::vector<std::string> _crosschain_chain_types;
    };
 
+   /**
+    * Fails a transaction from the network on the checks push_transaction would fail it on that don't need
+    * its signatures verified or any state changed, so spam is turned away before the expensive part
+    */
+   void precheck_network_transaction( const chain::database& db, const chain::signed_transaction& trx,
+                                      uint32_t max_signatures );
+
 } }
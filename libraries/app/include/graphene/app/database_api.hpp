@@ -48,6 +48,7 @@
 #include <graphene/market_history/market_history_plugin.hpp>
 #include <graphene/chain/transaction_object.hpp>
 #include <graphene/chain/contract_object.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 #include <graphene/chain/pay_back_object.hpp>
 #include <fc/api.hpp>
 #include <fc/optional.hpp>
@@ -663,7 +664,17 @@ class database_api
 	  //
 	  std::pair<asset, share_type> register_contract_testing(const string& pubkey_str, const string& contract_filepath);
 	  std::pair<asset, share_type> transfer_to_contract_testing(string from, string to, string amount, string asset_symbol, const string& param);
+	  /**
+	   * @brief Runs an offline api of a contract against the head state, without a transaction
+	   *
+	   * The call may use as much gas as the node's offline-contract-gas-cap option allows, 100000000
+	   * by default, and fails when it needs more or runs longer than 10 seconds.
+	   */
 	  string invoke_contract_offline(const string& caller_pubkey, const string& contract_address_or_name, const string& contract_api, const string& contract_arg);
+	  /**
+	   * @brief Same as invoke_contract_offline, also returns the gas used and the head block the call was executed against
+	   */
+	  offline_invoke_result invoke_contract_offline_with_block(const string& caller_pubkey, const string& contract_address_or_name, const string& contract_api, const string& contract_arg);
 	  execution_result invoke_contract_testing(const string & caller_pubkey, const string & contract_address_or_name, const string & contract_api, const string & contract_arg);
 
 
@@ -857,6 +868,7 @@ FC_API(graphene::app::database_api,
 	(get_referendum_object)
 	(get_eths_multi_create_account_trx)
 	(invoke_contract_offline)
+	(invoke_contract_offline_with_block)
 	(register_contract_testing)
 	(get_referendum_transactions_waiting)
 	(transfer_to_contract_testing)
@@ -330,6 +330,39 @@ namespace graphene {
 			return core_fee_required+schedule.fee;
 		}
 
+		void            contract_batch_invoke_operation::validate()const
+		{
+			FC_ASSERT(contract_id.version == addressVersion::CONTRACT);
+			FC_ASSERT(caller_addr != address());
+			FC_ASSERT(address(caller_pubkey) == caller_addr);
+			FC_ASSERT(contract_id != address());
+			FC_ASSERT(!calls.empty() && calls.size() <= XWC_MAX_BATCH_INVOKE_CALLS, "a batch invoke has 1 to ${max} calls", ("max", XWC_MAX_BATCH_INVOKE_CALLS));
+			FC_ASSERT(invoke_cost > 0 && invoke_cost <= XWC_MAX_GAS_LIMIT);
+			FC_ASSERT(gas_price >= XWC_MIN_GAS_PRICE);
+			for (const auto& call : calls)
+				FC_ASSERT(contract_invoke_operation::contract_api_check(invoke_operation_of(call)), "api ${api} can't be called", ("api", call.contract_api));
+		}
+		share_type contract_batch_invoke_operation::calculate_fee(const fee_parameters_type& schedule)const
+		{
+			// base fee
+			share_type core_fee_required = count_gas_fee(gas_price, invoke_cost);
+			return core_fee_required + schedule.fee;
+		}
+		contract_invoke_operation contract_batch_invoke_operation::invoke_operation_of(const contract_call& call) const
+		{
+			contract_invoke_operation op;
+			op.fee = fee;
+			op.invoke_cost = invoke_cost;
+			op.gas_price = gas_price;
+			op.caller_addr = caller_addr;
+			op.caller_pubkey = caller_pubkey;
+			op.contract_id = contract_id;
+			op.contract_api = call.contract_api;
+			op.contract_arg = call.contract_arg;
+			op.guarantee_id = guarantee_id;
+			return op;
+		}
+
         bool contract_upgrade_operation::contract_name_check(const string & contract_name)
         {
             FC_ASSERT(contract_name.length() >= 2 && contract_name.length() <= 30);
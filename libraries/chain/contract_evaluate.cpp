@@ -3,9 +3,11 @@
 #include <graphene/chain/storage.hpp>
 #include <graphene/chain/contract_entry.hpp>
 #include <graphene/chain/contract_engine_builder.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 #include <graphene/chain/uvm_chain_api.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/transaction_object.hpp>
+#include <cbor_diff/cbor_diff.h>
 #include <iostream>
 #include <fc/array.hpp>
 #include <fc/crypto/ripemd160.hpp>
@@ -31,6 +33,10 @@ namespace graphene {
 			return (contract_invoke_evaluate*)uvm::lua::lib::get_lua_state_value(L, "invoke_evaluate_state").pointer_value;
 		}
 
+		static contract_batch_invoke_evaluate* get_batch_invoke_contract_evaluator(lua_State *L) {
+			return (contract_batch_invoke_evaluate*)uvm::lua::lib::get_lua_state_value(L, "batch_invoke_evaluate_state").pointer_value;
+		}
+
 		static contract_upgrade_evaluate* get_upgrade_contract_evaluator(lua_State *L) {
 			return (contract_upgrade_evaluate*)uvm::lua::lib::get_lua_state_value(L, "upgrade_evaluate_state").pointer_value;
 		}
@@ -48,6 +54,10 @@ namespace graphene {
 			if (invoke_contract_evaluator) {
                 return invoke_contract_evaluator;
 			}
+			auto batch_invoke_contract_evaluator = get_batch_invoke_contract_evaluator(L);
+			if (batch_invoke_contract_evaluator) {
+				return batch_invoke_contract_evaluator;
+			}
 			auto upgrade_contract_evaluator = get_upgrade_contract_evaluator(L);
 			if (upgrade_contract_evaluator) {
                 return upgrade_contract_evaluator;
@@ -408,6 +418,8 @@ namespace graphene {
 						FC_CAPTURE_AND_THROW(blockchain::contract_engine::invalid_contract_gas_limit);
 					gas_limit = limit;
 					engine->set_gas_limit(limit);
+					if (trx_state->vm_stopper)
+						trx_state->vm_stopper->attach(engine);
 					invoke_contract_result.storage_changes.clear();
 					std::string contract_result_str;
 					try
@@ -788,6 +800,156 @@ namespace graphene {
             return contract_operation_result_info(invoke_contract_result.ordered_digest(), gas_count, invoke_contract_result.api_result);
 		}
 
+        contract_operation_result_info contract_batch_invoke_evaluate::do_evaluate(const operation_type& o) {
+			auto &d = db();
+			FC_ASSERT(d.head_block_num() >= CONTRACT_BATCH_INVOKE_HEIGHT, "batch contract invoke is not enabled yet");
+            if (d.get_node_properties().skip_flags&database::validation_steps::check_gas_price)
+            {
+                FC_ASSERT(o.gas_price >= d.get_min_gas_price(), "gas is too cheap");
+            }
+			bool throw_over_limit = false;
+			if (d.get_node_properties().skip_flags&database::validation_steps::throw_over_limit)
+			{
+				throw_over_limit = true;
+			}
+
+			FC_ASSERT(o.contract_id.version == addressVersion::CONTRACT);
+            invoke_contract_result.invoker = o.caller_addr;
+			FC_ASSERT(d.has_contract(o.contract_id));
+			const auto &contract = d.get_contract(o.contract_id);
+			// a native contract keeps its own invoke result, so its calls can't share the batch state
+			FC_ASSERT(contract.type_of_contract != contract_type::native_contract, "native contract can't be invoked in a batch");
+			for (const auto& call : o.calls)
+			{
+				FC_ASSERT(contract_invoke_operation::contract_api_check(o.invoke_operation_of(call)));
+				FC_ASSERT(d.has_contract(o.contract_id, call.contract_api));
+			}
+
+			origin_op = o;
+			this->caller_address = std::make_shared<address>(o.caller_addr);
+			this->caller_pubkey = std::make_shared<fc::ecc::public_key>(o.caller_pubkey);
+            total_fee = o.fee.amount;
+            gas_count = o.invoke_cost;
+			try {
+				if (!global_uvm_chain_api)
+					global_uvm_chain_api = new UvmChainApi();
+
+				auto limit = o.invoke_cost;
+				if (limit == 0)
+					FC_CAPTURE_AND_THROW(blockchain::contract_engine::invalid_contract_gas_limit);
+				gas_used_counts = 0;
+				call_storage_changes.clear();
+				fc::variants api_results;
+				for (const auto& call : o.calls)
+				{
+					// each call gets a new vm state, the changes of the batch are kept by this evaluator
+					if (gas_used_counts >= limit)
+						FC_CAPTURE_AND_THROW(::blockchain::contract_engine::contract_run_out_of_money);
+					::blockchain::contract_engine::ContractEngineBuilder builder;
+					auto engine = builder.build();
+					engine->set_caller(o.caller_pubkey.to_base58(), (string)(o.caller_addr));
+					engine->set_state_pointer_value("batch_invoke_evaluate_state", this);
+					engine->clear_exceptions();
+					gas_limit = limit - gas_used_counts;
+					engine->set_gas_limit(gas_limit);
+					invoke_contract_result.storage_changes.clear();
+					std::string contract_result_str;
+					try
+					{
+						engine->execute_contract_api_by_address(o.contract_id.operator fc::string(), call.contract_api, call.contract_arg, &contract_result_str);
+					}
+					catch (std::exception &e)
+					{
+						FC_THROW_EXCEPTION(fc::assert_exception, std::string("contract execute error ") + e.what(), ("error", e.what()));
+					}
+					auto call_gas = engine->gas_used();
+					FC_ASSERT(call_gas <= gas_limit && call_gas > 0, "costs of execution can be only between 0 and invoke_cost");
+					gas_used_counts += call_gas;
+					call_storage_changes.push_back(invoke_contract_result.storage_changes);
+					api_results.push_back(contract_result_str);
+				}
+				gas_limit = limit;
+				// the stored result has the change of each storage by the whole batch, composed of the changes of the calls.
+				// do_apply applies the changes call by call
+				invoke_contract_result.storage_changes.clear();
+				for (const auto& changes : call_storage_changes)
+				{
+					for (const auto& contract_changes : changes)
+					{
+						for (const auto& change : contract_changes.second)
+							invoke_contract_result.storage_changes[contract_changes.first][change.first].after = change.second.after;
+					}
+				}
+				cbor_diff::CborDiff differ;
+				for (auto& contract_changes : invoke_contract_result.storage_changes)
+				{
+					for (auto& change : contract_changes.second)
+					{
+						// storages of the database, the batch isn't applied yet
+						change.second.before = contract_common_evaluate::get_storage(contract_changes.first, change.first);
+						auto diff = differ.diff_encoded(change.second.before.storage_data, change.second.after.storage_data);
+						change.second.storage_diff.storage_data = cbor_diff::cbor_encode(diff->value());
+					}
+				}
+				invoke_contract_result.api_result = fc::json::to_string(api_results);
+                gas_count = gas_used_counts;
+                unspent_fee = count_gas_fee(o.gas_price, o.invoke_cost) - count_gas_fee(o.gas_price, gas_used_counts);
+                invoke_contract_result.acctual_fee = total_fee - unspent_fee;
+                invoke_contract_result.exec_succeed = true;
+
+				invoke_contract_result.validate();
+			}
+			catch (::blockchain::contract_engine::contract_run_out_of_money& e)
+			{
+				if (throw_over_limit)
+					FC_CAPTURE_AND_THROW(::blockchain::contract_engine::contract_run_out_of_money, (("error", e.what())));
+				undo_contract_effected(total_fee);
+				call_storage_changes.clear();
+				invoke_contract_result.api_result = string("gas ran out");
+				unspent_fee = 0;
+			}
+			catch (const ::blockchain::contract_engine::contract_error& e)
+			{
+				FC_THROW_EXCEPTION(fc::assert_exception, std::string("contract execute error ") + e.what(), ("error", e.what()));
+			}
+			catch (std::exception &e)
+			{
+				FC_THROW_EXCEPTION(fc::assert_exception, std::string("contract execute error ") + e.what(), ("error", e.what()));
+			}
+
+            return contract_operation_result_info(invoke_contract_result.ordered_digest(), gas_count, invoke_contract_result.api_result);
+		}
+
+        contract_operation_result_info contract_batch_invoke_evaluate::do_apply(const operation_type& o) {
+            if (invoke_contract_result.exec_succeed)
+            {
+                database& d = db();
+                FC_ASSERT(d.has_contract(o.contract_id));
+                auto trx_id = get_current_trx_id();
+                // commit contract result to db, with the storage diffs of every call
+                for (const auto& changes : call_storage_changes)
+                    apply_storage_change(d, d.head_block_num(), trx_id, changes);
+                do_apply_contract_event_notifies();
+                do_apply_balance();
+            }
+            db().store_invoke_result(get_current_trx_id(), gen_eval->get_trx_eval_state()->op_num, invoke_contract_result,gas_count);
+            return contract_operation_result_info(invoke_contract_result.ordered_digest(), gas_count, invoke_contract_result.api_result);
+		}
+
+        StorageDataType contract_batch_invoke_evaluate::get_storage(const string &contract_id, const string &storage_name) const
+        {
+            for (auto it = call_storage_changes.rbegin(); it != call_storage_changes.rend(); ++it)
+            {
+                auto contract_changes = it->find(contract_id);
+                if (contract_changes == it->end())
+                    continue;
+                auto change = contract_changes->second.find(storage_name);
+                if (change != contract_changes->second.end())
+                    return change->second.after;
+            }
+            return contract_common_evaluate::get_storage(contract_id, storage_name);
+        }
+
         contract_operation_result_info contract_upgrade_evaluate::do_apply(const operation_type& o) {
             if (invoke_contract_result.exec_succeed)
             {
@@ -822,6 +984,10 @@ namespace graphene {
             pay_fee_and_refund();
 		}
 
+		void contract_batch_invoke_evaluate::pay_fee() {
+            pay_fee_and_refund();
+		}
+
 		void contract_upgrade_evaluate::pay_fee() {
             pay_fee_and_refund();
 		}
@@ -983,6 +1149,14 @@ namespace graphene {
 			return calculate_fee_for_operation(origin_op);
 		}
         optional<guarantee_object_id_type> contract_invoke_evaluate::get_guarantee_id()const
+        {
+            return origin_op.get_guarantee_id();
+        }
+		share_type contract_batch_invoke_evaluate::origin_op_fee() const
+		{
+			return calculate_fee_for_operation(origin_op);
+		}
+        optional<guarantee_object_id_type> contract_batch_invoke_evaluate::get_guarantee_id()const
         {
             return origin_op.get_guarantee_id();
         }
@@ -1635,10 +1809,15 @@ namespace graphene {
 			 return gas_limit;
 		 }
          void contract_common_evaluate::apply_storage_change(database& d, uint32_t block_num, const transaction_id_type & trx_id) const
+         {
+             apply_storage_change(d, block_num, trx_id, invoke_contract_result.storage_changes);
+         }
+         void contract_common_evaluate::apply_storage_change(database& d, uint32_t block_num, const transaction_id_type & trx_id,
+             const std::map<std::string, contract_storage_changes_type, std::less<std::string>>& storage_changes) const
          {
 
              set<address> contracts;
-             for (const auto &pair1 : invoke_contract_result.storage_changes)
+             for (const auto &pair1 : storage_changes)
              {
                  const auto &contract_id = pair1.first;
 
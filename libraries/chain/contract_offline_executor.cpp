@@ -0,0 +1,205 @@
+#include <graphene/chain/contract_offline_executor.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/contract_evaluate.hpp>
+#include <graphene/chain/uvm_chain_api.hpp>
+#include <graphene/chain/uvm_contract_engine.hpp>
+
+#include <boost/thread/locks.hpp>
+#include <chrono>
+#include <thread>
+
+namespace graphene { namespace chain {
+
+using uvm::lua::api::global_uvm_chain_api;
+
+void contract_vm_stopper::attach( std::shared_ptr<uvm::UvmContractEngine> engine )
+{
+   // looked up on the vm thread, the lua_State value map isn't safe to read from other threads
+   auto stop_flag = engine->stop_flag();
+   std::lock_guard<std::mutex> lock( _mutex );
+   _engine = engine;
+   _stop_flag = stop_flag;
+   if( _stopped || _preempted )
+      *_stop_flag = 1;
+}
+
+void contract_vm_stopper::detach()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _stop_flag = nullptr;
+   _engine.reset();
+}
+
+void contract_vm_stopper::stop()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _stopped = true;
+   // same as notify_lua_state_stop, the vm checks the flag between instructions
+   if( _stop_flag )
+      *_stop_flag = 1;
+}
+
+bool contract_vm_stopper::stopped()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _stopped;
+}
+
+void contract_vm_stopper::preempt()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _preempted = true;
+   if( _stop_flag )
+      *_stop_flag = 1;
+}
+
+bool contract_vm_stopper::preempted()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _preempted;
+}
+
+void contract_vm_stopper::rearm()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _preempted = false;
+}
+
+contract_offline_executor::contract_offline_executor( database& db, uint32_t thread_count )
+   : _db( db ), _next_thread( 0 ), _gas_cap( GRAPHENE_CONTRACT_TESTING_GAS )
+{
+   if( thread_count == 0 )
+      thread_count = std::max( 1u, std::min( 4u, std::thread::hardware_concurrency() ) );
+   // evaluators create it lazily, which is not safe once they run on several threads
+   if( !global_uvm_chain_api )
+      global_uvm_chain_api = new UvmChainApi();
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.push_back( std::make_shared<fc::thread>( "contract_offline_" + fc::to_string( uint64_t( i ) ) ) );
+   _db.register_offline_executor( this );
+}
+
+contract_offline_executor::~contract_offline_executor()
+{
+   _db.unregister_offline_executor( this );
+   {
+      std::lock_guard<std::mutex> lock( _running_mutex );
+      for( const auto& stopper : _running )
+         stopper->stop();
+   }
+   for( auto& t : _threads )
+      t->quit();
+}
+
+void contract_offline_executor::preempt()
+{
+   std::lock_guard<std::mutex> lock( _running_mutex );
+   for( const auto& stopper : _running )
+      stopper->preempt();
+}
+
+void contract_offline_executor::set_gas_cap( gas_count_type cap )
+{
+   FC_ASSERT( cap > 0 && cap <= XWC_MAX_GAS_LIMIT, "offline contract gas cap must be in 1..${max}", ("max", XWC_MAX_GAS_LIMIT) );
+   _gas_cap = cap;
+}
+
+offline_invoke_result contract_offline_executor::invoke( const contract_invoke_operation& op, const fc::microseconds& timeout,
+                                                        std::shared_ptr<uvm::lua::lib::UvmProfiler> profiler )
+{
+   auto stopper = std::make_shared<contract_vm_stopper>();
+   {
+      std::lock_guard<std::mutex> lock( _running_mutex );
+      _running.insert( stopper );
+   }
+   auto finished = [this, &stopper]() {
+      std::lock_guard<std::mutex> lock( _running_mutex );
+      _running.erase( stopper );
+   };
+   auto& t = _threads[ _next_thread++ % _threads.size() ];
+   auto f = t->async( [this, op, profiler, stopper]() { return run( op, profiler, stopper ); }, "contract_offline_invoke" );
+   try {
+      auto result = f.wait( timeout );
+      finished();
+      return result;
+   } catch( const fc::timeout_exception& ) {
+      // else the worker keeps running the vm, or keeps waiting to start it over
+      stopper->stop();
+      finished();
+      throw;
+   } catch( ... ) {
+      finished();
+      throw;
+   }
+}
+
+offline_invoke_result contract_offline_executor::run( const contract_invoke_operation& op, std::shared_ptr<uvm::lua::lib::UvmProfiler> profiler,
+                                                     std::shared_ptr<contract_vm_stopper> stopper )
+{ try {
+   contract_invoke_operation capped_op = op;
+   const gas_count_type cap = gas_cap();
+   if( capped_op.invoke_cost > cap )
+      capped_op.invoke_cost = cap;
+
+   std::unique_ptr<uvm::lua::lib::UvmProfilerScope> profiler_scope;
+   if( profiler )
+      profiler_scope.reset( new uvm::lua::lib::UvmProfilerScope( profiler ) );
+
+   while( true )
+   {
+      {
+         boost::shared_lock<boost::shared_mutex> read_lock( _db.chain_state_mutex() );
+         stopper->rearm();
+         // a writer that started waiting before the rearm may already have preempted this call
+         if( _db.chain_state_writers_waiting() == 0 )
+         {
+            try {
+               return run_once( capped_op, stopper );
+            } catch( const fc::exception& ) {
+               if( !stopper->preempted() || stopper->stopped() )
+                  throw;
+            }
+         }
+      }
+      FC_ASSERT( !stopper->stopped(), "offline contract call stopped" );
+      // the chain state the call started on is gone, so is its trace
+      if( profiler )
+         profiler->reset();
+      // shared_mutex blocks new readers once a writer waits, this only keeps the loop from spinning
+      // before the writer got there
+      while( _db.chain_state_writers_waiting() > 0 && !stopper->stopped() )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+   }
+} FC_CAPTURE_AND_RETHROW( (op) ) }
+
+offline_invoke_result contract_offline_executor::run_once( const contract_invoke_operation& op, std::shared_ptr<contract_vm_stopper> stopper )
+{
+   struct stopper_detach
+   {
+      std::shared_ptr<contract_vm_stopper> stopper;
+      ~stopper_detach() { stopper->detach(); }
+   } detach_on_exit{ stopper };
+
+   offline_invoke_result result;
+   result.block_num = _db.head_block_num();
+
+   signed_transaction trx;
+   trx.operations.push_back( op );
+   trx.set_reference_block( _db.head_block_id() );
+   trx.set_expiration( _db.head_block_time() + fc::seconds( 30 ) );
+   trx.validate();
+
+   transaction_evaluation_state eval_state( &_db );
+   eval_state._trx = &trx;
+   eval_state.testing = true;
+   eval_state.skip_fee_schedule_check = true;
+   eval_state.vm_stopper = stopper;
+
+   contract_invoke_evaluate evaluator;
+   auto op_result = evaluator.start_evaluate( eval_state, trx.operations[0], false );
+   const auto& info = op_result.get<contract_operation_result_info>();
+   result.api_result = info.api_result;
+   result.gas_count = info.gas_count;
+   return result;
+}
+
+} } // graphene::chain
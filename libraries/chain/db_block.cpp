@@ -138,6 +138,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   detail::chain_state_write_lock write_lock( *this );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -292,6 +293,7 @@ bool database::_push_block(const signed_block& new_block)
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
 { try {
+   detail::chain_state_write_lock write_lock( *this );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -334,6 +336,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
 
 processed_transaction database::validate_transaction( const signed_transaction& trx,bool testing )
 {
+   detail::chain_state_write_lock write_lock( *this );
    auto session = _undo_db.start_undo_session();
    auto res= _apply_transaction( trx,testing );
    return res;
@@ -450,6 +453,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   detail::chain_state_write_lock write_lock( *this );
    signed_block result;
    skip |= check_gas_price;
    detail::with_skip_flags( *this, skip, [&]()
@@ -544,6 +548,13 @@ signed_block database::_generate_block(
 			  contract_op_in_trx++;
 			  break;
 		  }
+		  case operation::tag<chain::contract_batch_invoke_operation>::value:
+		  {
+			  gas_count += op.get<contract_batch_invoke_operation>().invoke_cost;
+			  related_with_contract = true;
+			  contract_op_in_trx++;
+			  break;
+		  }
 		  case operation::tag<chain::transfer_contract_operation>::value:
 		  {
 			  gas_count += op.get<transfer_contract_operation>().invoke_cost;
@@ -689,6 +700,7 @@ SecretHashType database::get_secret(uint32_t block_num,
  */
 void database::pop_block()
 { try {
+   detail::chain_state_write_lock write_lock( *this );
    _pending_tx_session.reset();
    auto head_id = head_block_id();
    optional<signed_block> head_block = fetch_block_by_id( head_id );
@@ -704,6 +716,7 @@ void database::pop_block()
 
 void database::clear_pending()
 { try {
+   detail::chain_state_write_lock write_lock( *this );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
@@ -739,6 +752,8 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
 {
+   detail::chain_state_write_lock write_lock( *this );
+
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
    {
@@ -10,12 +10,105 @@
 #include <uvm/uvm_api.h>
 #include <cbor_diff/cbor_diff.h>
 #include <fc/crypto/ripemd160.hpp>
+#include <atomic>
 
 namespace graphene {
 	namespace chain {
+		// shared by all databases of the process, so a revision is never reused after a database is reopened
+		static std::atomic<uint64_t> next_storage_revision(1);
+
+		void contract_storage_cache_index::invalidate(const object& obj)
+		{
+			assert(dynamic_cast<const contract_storage_object*>(&obj));
+			const auto& storage_obj = static_cast<const contract_storage_object&>(obj);
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _storages.find(std::make_pair(storage_obj.contract_address, storage_obj.storage_name));
+			if (it != _storages.end())
+			{
+				_lru.erase(it->second.lru_it);
+				_storages.erase(it);
+			}
+			_revisions[storage_obj.contract_address] = next_storage_revision++;
+		}
+
+		void contract_storage_cache_index::object_inserted(const object& obj)
+		{
+			invalidate(obj);
+		}
+
+		void contract_storage_cache_index::object_removed(const object& obj)
+		{
+			invalidate(obj);
+		}
+
+		void contract_storage_cache_index::about_to_modify(const object& before)
+		{
+			invalidate(before);
+		}
+
+		void contract_storage_cache_index::object_modified(const object& after)
+		{
+			invalidate(after);
+		}
+
+		bool contract_storage_cache_index::find(const address& contract_id, const string& name, std::vector<char>& value) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _storages.find(std::make_pair(contract_id, name));
+			if (it == _storages.end())
+				return false;
+			_lru.splice(_lru.begin(), _lru, it->second.lru_it);
+			value = it->second.value;
+			return true;
+		}
+
+		void contract_storage_cache_index::store(const address& contract_id, const string& name, const std::vector<char>& value)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto key = std::make_pair(contract_id, name);
+			auto it = _storages.find(key);
+			if (it != _storages.end())
+			{
+				_lru.splice(_lru.begin(), _lru, it->second.lru_it);
+				it->second.value = value;
+				return;
+			}
+			while (_storages.size() >= max_cached_storages)
+			{
+				_storages.erase(_lru.back());
+				_lru.pop_back();
+			}
+			_lru.push_front(key);
+			_storages[key] = cached_storage{ value, _lru.begin() };
+		}
+
+		uint64_t contract_storage_cache_index::revision(const address& contract_id) const
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _revisions.find(contract_id);
+			if (it == _revisions.end())
+				it = _revisions.emplace(contract_id, next_storage_revision++).first;
+			return it->second;
+		}
+
+		bool database::get_contract_storage_revision(const address& contract_id, uint64_t& revision)
+		{
+			if (!_contract_storage_cache)
+				return false;
+			revision = _contract_storage_cache->revision(contract_id);
+			return true;
+		}
+
 		StorageDataType database::get_contract_storage(const address& contract_id, const string& name)
 		{
 			try {
+				if (_contract_storage_cache)
+				{
+					StorageDataType storage;
+					if (_contract_storage_cache->find(contract_id, name, storage.storage_data))
+						return storage;
+				}
+
 				auto& storage_index = get_index_type<contract_storage_object_index>().indices().get<by_contract_id_storage_name>();
 				auto storage_iter = storage_index.find(boost::make_tuple(contract_id, name));
 				if (storage_iter == storage_index.end())
@@ -33,6 +126,8 @@ namespace graphene {
 					const auto &storage_data = *storage_iter;
 					StorageDataType storage;
 					storage.storage_data = storage_data.storage_value;
+					if (_contract_storage_cache)
+						_contract_storage_cache->store(contract_id, name, storage_data.storage_value);
 					return storage;
 				}
 			} FC_CAPTURE_AND_RETHROW((contract_id)(name));
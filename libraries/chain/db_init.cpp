@@ -215,6 +215,7 @@ void database::initialize_evaluators()
    register_evaluator<contract_register_evaluate>();
    register_evaluator<native_contract_register_evaluate>();
    register_evaluator<contract_invoke_evaluate>();
+   register_evaluator<contract_batch_invoke_evaluate>();
    register_evaluator<contract_upgrade_evaluate>();
    register_evaluator<contract_transfer_evaluate>();
    register_evaluator<contract_transfer_fee_evaluate>();
@@ -316,7 +317,8 @@ void database::initialize_indexes()
    // contract
    add_index< primary_index<transaction_contract_storage_diff_index       > >();
    add_index<primary_index<contract_object_index>>();
-   add_index<primary_index<contract_storage_object_index>>();
+   auto contract_storage_index = add_index<primary_index<contract_storage_object_index>>();
+   _contract_storage_cache = contract_storage_index->add_secondary_index<contract_storage_cache_index>();
    add_index<primary_index<contract_event_notify_index>>();
    add_index<primary_index<contract_invoke_result_index>>();
    add_index<primary_index<contract_storage_change_index>>();
@@ -23,6 +23,8 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/db_with.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
@@ -46,11 +48,67 @@ database::database()
 
 database::~database()
 {
+   // its workers read the chain state, stop them first
+   _offline_executor.reset();
    clear_pending();
 }
 
+contract_offline_executor& database::offline_executor()
+{
+   std::lock_guard<std::mutex> lock( _offline_executor_mutex );
+   if( !_offline_executor )
+      _offline_executor.reset( new contract_offline_executor( *this ) );
+   return *_offline_executor;
+}
+
+void database::register_offline_executor( contract_offline_executor* executor )
+{
+   std::lock_guard<std::mutex> lock( _offline_executors_mutex );
+   _offline_executors.insert( executor );
+}
+
+void database::unregister_offline_executor( contract_offline_executor* executor )
+{
+   std::lock_guard<std::mutex> lock( _offline_executors_mutex );
+   _offline_executors.erase( executor );
+}
+
+void database::lock_chain_state()
+{
+   // only the holding thread can see its own id here, others see another id or none
+   if( _chain_state_writer.load() == std::this_thread::get_id() )
+   {
+      ++_chain_state_write_depth;
+      return;
+   }
+   // offline contract calls hold the lock shared for as long as their vm runs, don't wait for them
+   ++_chain_state_writers_waiting;
+   {
+      std::lock_guard<std::mutex> lock( _offline_executors_mutex );
+      for( auto executor : _offline_executors )
+         executor->preempt();
+   }
+   _chain_state_mutex.lock();
+   --_chain_state_writers_waiting;
+   _chain_state_writer = std::this_thread::get_id();
+   _chain_state_write_depth = 1;
+}
+
+void database::unlock_chain_state()
+{
+   assert( _chain_state_writer.load() == std::this_thread::get_id() );
+   if( --_chain_state_write_depth == 0 )
+   {
+      _chain_state_writer = std::thread::id();
+      _chain_state_mutex.unlock();
+   }
+}
+
 void database::reindex(fc::path data_dir, const genesis_state_type& initial_allocation)
 { try {
+   // the replay below takes the lock per block, so offline contract calls and api reads
+   // get a turn in between instead of waiting for the whole reindex
+   std::unique_ptr<detail::chain_state_write_lock> setup_lock( new detail::chain_state_write_lock( *this ) );
    ilog( "reindexing blockchain" );
    wipe(data_dir, false);
    try {
@@ -84,9 +142,11 @@ void database::reindex(fc::path data_dir, const genesis_state_type& initial_allo
    _undo_db.enable();
    _undo_db.set_max_size(GRAPHENE_UNDO_BUFF_MAX_SIZE);
    reinitialize_leveldb();
+   setup_lock.reset();
    uint32_t undo_enable_num = last_block_num - 1440;
    for( uint32_t i = 1; i <= last_block_num; ++i )
    {
+      detail::chain_state_write_lock write_lock( *this );
       if( i % 10000 == 0 ) std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
       fc::optional< signed_block > block = _block_id_to_block.fetch_by_number(i);
       if( !block.valid() )
@@ -155,6 +215,7 @@ void database::reindex(fc::path data_dir, const genesis_state_type& initial_allo
 
 void database::wipe(const fc::path& data_dir, bool include_blocks)
 {
+   detail::chain_state_write_lock write_lock( *this );
    ilog("Wiping database", ("include_blocks", include_blocks));
    close();
    object_database::wipe(data_dir);
@@ -168,6 +229,7 @@ void database::open(
 {
    try
    {
+      detail::chain_state_write_lock write_lock( *this );
       object_database::open(data_dir);
 	  _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
 	 
@@ -210,6 +272,7 @@ void database::clear()
 
 void database::close()
 {
+   detail::chain_state_write_lock write_lock( *this );
 
    // TODO:  Save pending tx's on close()
    clear_pending();
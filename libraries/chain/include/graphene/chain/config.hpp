@@ -163,6 +163,7 @@
 
 #define XWC_MIN_GAS_PRICE                                    0
 #define XWC_MAX_GAS_LIMIT                                    100000000
+#define XWC_MAX_BATCH_INVOKE_CALLS                           100
 
 #define GRAPHENE_MINER_PAY_RATIO							 0
 #define GRAPHENE_MINER_PLEDGE_PAY_RATIO						 100
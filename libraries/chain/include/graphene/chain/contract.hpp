@@ -188,6 +188,44 @@ namespace graphene {
 			}
 		};
 
+		// calls apis of one contract in order. the calls share one evaluator, the balance changes and the fee
+		// payment, and each call sees the storage changes of the calls before it, as consecutive
+		// contract_invoke_operations would. invoke_cost is the gas limit of all the calls together
+		struct contract_batch_invoke_operation : public base_operation
+		{
+			struct fee_parameters_type {
+				uint64_t fee = 0.001 * GRAPHENE_XWCCHAIN_PRECISION;
+				uint32_t price_per_kbyte = 10 * GRAPHENE_BLOCKCHAIN_PRECISION; /// only required for large fields.
+			};
+
+			struct contract_call
+			{
+				string contract_api;
+				string contract_arg;
+			};
+
+			asset fee; // transaction fee limit
+			gas_count_type invoke_cost; // gas limit of all the calls
+			gas_price_type gas_price; // gas price of this contract transaction
+			address caller_addr;
+			fc::ecc::public_key caller_pubkey;
+			address contract_id;
+			vector<contract_call> calls;
+
+			extensions_type   extensions;
+			optional<guarantee_object_id_type> guarantee_id;
+			optional<guarantee_object_id_type> get_guarantee_id()const { return guarantee_id; }
+			address fee_payer()const { return caller_addr; }
+			void            validate()const;
+			share_type      calculate_fee(const fee_parameters_type& k)const;
+			void get_required_authorities(vector<authority>& a)const
+			{
+				a.push_back(authority(1, caller_addr, 1));
+			}
+			// the call as a contract_invoke_operation, to reuse its checks
+			contract_invoke_operation invoke_operation_of(const contract_call& call) const;
+		};
+
 		struct transfer_contract_operation : public base_operation
         {
             struct fee_parameters_type {
@@ -259,6 +297,9 @@ FC_REFLECT(graphene::chain::contract_register_operation::fee_parameters_type, (f
 FC_REFLECT(graphene::chain::contract_register_operation, (fee)(init_cost)(gas_price)(owner_addr)(owner_pubkey)(register_time)(contract_id)(contract_code)(inherit_from)(guarantee_id))
 FC_REFLECT(graphene::chain::contract_invoke_operation::fee_parameters_type, (fee)(price_per_kbyte))
 FC_REFLECT(graphene::chain::contract_invoke_operation, (fee)(invoke_cost)(gas_price)(caller_addr)(caller_pubkey)(contract_id)(contract_api)(contract_arg)(guarantee_id))
+FC_REFLECT(graphene::chain::contract_batch_invoke_operation::fee_parameters_type, (fee)(price_per_kbyte))
+FC_REFLECT(graphene::chain::contract_batch_invoke_operation::contract_call, (contract_api)(contract_arg))
+FC_REFLECT(graphene::chain::contract_batch_invoke_operation, (fee)(invoke_cost)(gas_price)(caller_addr)(caller_pubkey)(contract_id)(calls)(guarantee_id))
 FC_REFLECT(graphene::chain::contract_upgrade_operation::fee_parameters_type, (fee)(price_per_kbyte))
 FC_REFLECT(graphene::chain::contract_upgrade_operation, (fee)(invoke_cost)(gas_price)(caller_addr)(caller_pubkey)(contract_id)(contract_name)(contract_desc)(guarantee_id))
 FC_REFLECT(graphene::chain::transfer_contract_operation::fee_parameters_type, (fee)(price_per_kbyte))
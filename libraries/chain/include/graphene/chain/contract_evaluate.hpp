@@ -48,7 +48,7 @@ namespace graphene {
             std::shared_ptr<address> get_caller_address() const;
             std::shared_ptr<fc::ecc::public_key> get_caller_pubkey() const;
             database& get_db() const;
-            StorageDataType get_storage(const string &contract_id, const string &storage_name) const;
+            virtual StorageDataType get_storage(const string &contract_id, const string &storage_name) const;
             std::shared_ptr<uvm::blockchain::Code> get_contract_code_by_name(const string &contract_name) const;
             asset asset_from_string(const string& symbol, const string& amount);
             std::shared_ptr<uvm::blockchain::Code> get_contract_code_from_db_by_id(const string &contract_id) const;
@@ -72,6 +72,8 @@ namespace graphene {
             void pay_fee_and_refund() const; 
             bool check_fee_for_gas(const address& addr, const gas_count_type& gas_count, const  gas_price_type& gas_price) const;
             void apply_storage_change(database& d, uint32_t block_num, const transaction_id_type & trx_id) const;
+            void apply_storage_change(database& d, uint32_t block_num, const transaction_id_type & trx_id,
+                const std::map<std::string, contract_storage_changes_type, std::less<std::string>>& storage_changes) const;
 
 			std::string get_address_role(const std::string& addr_str) const;
 
@@ -135,6 +137,26 @@ namespace graphene {
             optional<guarantee_object_id_type> get_guarantee_id()const;
 		};
 
+		class contract_batch_invoke_evaluate : public evaluator<contract_batch_invoke_evaluate>, public contract_common_evaluate {
+		private:
+			contract_batch_invoke_operation origin_op;
+			// storage changes of each call, in the order of the calls
+			std::vector<std::map<std::string, contract_storage_changes_type, std::less<std::string>>> call_storage_changes;
+		public:
+			typedef contract_batch_invoke_operation operation_type;
+			contract_batch_invoke_evaluate() : contract_common_evaluate(this) {}
+			contract_operation_result_info do_evaluate(const operation_type& o);
+			contract_operation_result_info do_apply(const operation_type& o);
+			bool if_evluate() override { return true; }
+			virtual void pay_fee() override;
+
+			// storage as the calls before the running one left it
+			virtual StorageDataType get_storage(const string &contract_id, const string &storage_name) const override;
+			virtual share_type origin_op_fee() const;
+
+			optional<guarantee_object_id_type> get_guarantee_id()const;
+		};
+
 		class contract_upgrade_evaluate : public evaluator<contract_upgrade_evaluate>, public contract_common_evaluate {
 		private:
 			contract_upgrade_operation origin_op;
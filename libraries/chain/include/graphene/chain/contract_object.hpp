@@ -5,6 +5,8 @@
 #include <graphene/chain/contract_entry.hpp>
 #include <graphene/chain/vesting_balance_object.hpp>
 #include <vector>
+#include <mutex>
+#include <list>
 namespace graphene {
     namespace chain {
 
@@ -109,6 +111,47 @@ namespace graphene {
 			>> contract_storage_object_multi_index_type;
 		typedef generic_index<contract_storage_object, contract_storage_object_multi_index_type> contract_storage_object_index;
 
+		/**
+		 *  @brief Keeps storage values read by contracts, so contracts touched by many transactions of a block
+		 *  don't look up contract_storage_object_index each time.
+		 *
+		 *  Every insert/modify/remove of a contract_storage_object (undo included) drops the cached value,
+		 *  so the cache never returns something different from the index.
+		 */
+		class contract_storage_cache_index : public secondary_index
+		{
+		public:
+			virtual void object_inserted(const object& obj) override;
+			virtual void object_removed(const object& obj) override;
+			virtual void about_to_modify(const object& before) override;
+			virtual void object_modified(const object& after) override;
+
+			// contract VMs on several threads can read storages at the same time
+			bool find(const address& contract_id, const string& name, std::vector<char>& value) const;
+			void store(const address& contract_id, const string& name, const std::vector<char>& value);
+			// a number that changes whenever any storage of the contract changes, unique in the process
+			uint64_t revision(const address& contract_id) const;
+
+			// least recently used storages are evicted beyond this
+			static const size_t max_cached_storages = 10000;
+		private:
+			typedef std::pair<address, string> storage_key;
+			struct cached_storage
+			{
+				std::vector<char> value;
+				std::list<storage_key>::iterator lru_it;
+			};
+
+			void invalidate(const object& obj);
+
+			mutable std::mutex _mutex;
+			std::map<storage_key, cached_storage> _storages;
+			// most recently used at front
+			mutable std::list<storage_key> _lru;
+			mutable std::map<address, uint64_t> _revisions;
+
+		};
+
 		class contract_event_notify_object : public abstract_object<contract_event_notify_object>
 		{
 		public:
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <graphene/chain/protocol/operations.hpp>
+#include <fc/thread/thread.hpp>
+#include <uvm/uvm_profiler.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace uvm { class UvmContractEngine; }
+
+namespace graphene { namespace chain {
+   class database;
+
+   /**
+    *  Lets another thread stop the vm of an offline call, e.g. when the caller gave up waiting.
+    *  contract_invoke_evaluate attaches its engine on the vm thread before running it.
+    */
+   class contract_vm_stopper
+   {
+      public:
+         void attach( std::shared_ptr<uvm::UvmContractEngine> engine );
+         void detach();
+         /** can be called from any thread, also before attach() */
+         void stop();
+         bool stopped();
+         /** stops the current run only, e.g. to let a writer take the chain state lock */
+         void preempt();
+         bool preempted();
+         /** clears preempted() before the call starts over */
+         void rearm();
+
+      private:
+         std::mutex                               _mutex;
+         std::shared_ptr<uvm::UvmContractEngine> _engine;
+         int64_t*                                 _stop_flag = nullptr;
+         bool                                     _stopped = false;
+         bool                                     _preempted = false;
+   };
+
+   struct offline_invoke_result
+   {
+      string     api_result;
+      share_type gas_count = 0;
+      /** head block the call was executed against */
+      uint32_t   block_num = 0;
+   };
+
+   /**
+    *  Runs offline contract apis on a small pool of worker threads.
+    *
+    *  Calls only evaluate the invoke operation, they never apply it and never
+    *  start an undo session, so they hold the database's chain_state_mutex shared
+    *  and run next to each other instead of queueing on the write lock taken by
+    *  push_block / push_transaction.  A writer doesn't wait for them either: it
+    *  preempts the running calls, which release the lock and start over against
+    *  the new state once the writer is done, until the timeout passed to invoke()
+    *  runs out.  The vm is bounded by the invoke_cost of the operation, capped at
+    *  gas_cap().
+    *
+    *  Registers itself with the database, database::offline_executor() is the one
+    *  shared by the api sessions.
+    */
+   class contract_offline_executor
+   {
+      public:
+         /** @param thread_count number of workers, 0 picks min(4, hardware threads) */
+         contract_offline_executor( database& db, uint32_t thread_count = 0 );
+         ~contract_offline_executor();
+
+         /**
+          *  @param profiler when set, the vm of the call is traced into it instead of the node profiler,
+          *         it is reset when the call starts over after being preempted
+          */
+         offline_invoke_result invoke( const contract_invoke_operation& op, const fc::microseconds& timeout,
+                                       std::shared_ptr<uvm::lua::lib::UvmProfiler> profiler = nullptr );
+
+         /** stops the running calls so a writer can take the chain state lock, they start over after it */
+         void preempt();
+
+         /** gas limit of a call, a larger invoke_cost is lowered to it. Defaults to GRAPHENE_CONTRACT_TESTING_GAS */
+         gas_count_type gas_cap()const { return _gas_cap; }
+         void set_gas_cap( gas_count_type cap );
+
+      private:
+         offline_invoke_result run( const contract_invoke_operation& op, std::shared_ptr<uvm::lua::lib::UvmProfiler> profiler,
+                                    std::shared_ptr<contract_vm_stopper> stopper );
+         offline_invoke_result run_once( const contract_invoke_operation& op, std::shared_ptr<contract_vm_stopper> stopper );
+
+         database&                                 _db;
+         std::vector< std::shared_ptr<fc::thread> > _threads;
+         std::atomic<uint32_t>                     _next_thread;
+         std::atomic<gas_count_type>               _gas_cap;
+         std::mutex                                _running_mutex;
+         std::set< std::shared_ptr<contract_vm_stopper> > _running;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::offline_invoke_result, (api_result)(gas_count)(block_num) )
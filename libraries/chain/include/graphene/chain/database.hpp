@@ -41,14 +41,21 @@
 #include <graphene/chain/contract_object.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/uint128.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace graphene { namespace chain {
    using graphene::db::abstract_object;
    using graphene::db::object;
    class op_evaluator;
    class transaction_evaluation_state;
+   class contract_offline_executor;
 
    struct budget_record;
 
@@ -165,6 +172,30 @@ namespace graphene { namespace chain {
 
          void pop_block();
          void clear_pending();
+
+         /**
+          *  Contract VMs reading the head state off the main thread hold this shared,
+          *  everything changing the state (push_block, push_transaction, pop_block...)
+          *  holds it exclusively.
+          */
+         boost::shared_mutex& chain_state_mutex() { return _chain_state_mutex; }
+         /**
+          *  Takes chain_state_mutex exclusively. Reentrant in the thread holding it, the
+          *  depth is kept per database so nested writes to another database on the same
+          *  thread lock that one too. Use detail::chain_state_write_lock.
+          */
+         void lock_chain_state();
+         void unlock_chain_state();
+         /** number of threads waiting in lock_chain_state(), offline contract calls give way to them */
+         uint32_t chain_state_writers_waiting()const { return _chain_state_writers_waiting; }
+         /**
+          *  Workers running offline contract calls against this database, shared by all api
+          *  sessions. Created on first use, stopped when the database is destroyed.
+          */
+         contract_offline_executor& offline_executor();
+         /** executors whose calls lock_chain_state() preempts, they register themselves */
+         void register_offline_executor( contract_offline_executor* executor );
+         void unregister_offline_executor( contract_offline_executor* executor );
 		 SecretHashType get_secret(uint32_t block_num,
 			 const fc::ecc::private_key& block_signing_private_key);
 
@@ -343,6 +374,7 @@ namespace graphene { namespace chain {
 		 void adjust_crosschain_confirm_trx(const hd_trx& handled_trx);
 		 //////contract//////
 		 StorageDataType get_contract_storage(const address& contract_id, const string& name);
+		 bool get_contract_storage_revision(const address& contract_id, uint64_t& revision);
                  std::map<std::string, StorageDataType> get_contract_all_storages(const address& contract_id);
 		 optional<contract_storage_object>  get_contract_storage_object(const address& contract_id, const string& name);
 		 void set_contract_storage(const address& contract_id, const string& name, const StorageDataType &value);
@@ -650,6 +682,19 @@ namespace graphene { namespace chain {
 
          node_property_object              _node_property_object;
 
+         contract_storage_cache_index*     _contract_storage_cache = nullptr;
+
+         boost::shared_mutex               _chain_state_mutex;
+         /** thread holding _chain_state_mutex exclusively, and how often it took it */
+         std::atomic<std::thread::id>      _chain_state_writer;
+         int                               _chain_state_write_depth = 0;
+         std::atomic<uint32_t>             _chain_state_writers_waiting{ 0 };
+
+         std::mutex                                  _offline_executor_mutex;
+         std::unique_ptr<contract_offline_executor> _offline_executor;
+         std::mutex                                  _offline_executors_mutex;
+         std::set<contract_offline_executor*>        _offline_executors;
+
          //gas_price check
 		 share_type                        _min_gas_price = 1;
 		 share_type						   _gas_limit_in_in_block = 2000000;
@@ -135,6 +135,31 @@ struct pending_transactions_restorer
    std::vector< processed_transaction > _pending_transactions;
 };
 
+/**
+ * Holds the database's chain_state_mutex exclusively while the chain state
+ * is being changed, so contract VMs reading it on other threads never see a
+ * half applied block or transaction.  The lock is reentrant in the writing
+ * thread, e.g. push_block() pops blocks and pushes transactions again, see
+ * database::lock_chain_state().  open(), reindex() and close() take it too:
+ * offline contract calls may already be served while the node is opening or
+ * replaying the chain.
+ */
+struct chain_state_write_lock
+{
+   chain_state_write_lock( database& db )
+      : _db( db )
+   {
+      _db.lock_chain_state();
+   }
+
+   ~chain_state_write_lock()
+   {
+      _db.unlock_chain_state();
+   }
+
+   database& _db;
+};
+
 /**
  * Set the skip_flags to the given value, call callback,
  * then reset skip_flags to their previous value after
@@ -40,5 +40,7 @@
 #define ETH_SER_MULTI_SOL_CREATE    1
 
 #define USE_MOD_CHANGE_LIST_HEIGHT              1
+#define NATIVE_CONTRACT_BINARY_ARGS_HEIGHT      1
+#define CONTRACT_BATCH_INVOKE_HEIGHT            1
 #define PASS_XWC_BLOCK_NUM 1
 
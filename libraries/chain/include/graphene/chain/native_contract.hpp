@@ -25,6 +25,11 @@ namespace graphene {
 			contract_invoke_result _contract_invoke_result;
 		private:
 			address contract_id;
+			// storage values set in this invocation by (contract address, storage name). the last value of each
+			// storage is diffed and put into _contract_invoke_result.storage_changes once, by flush_storage_changes
+			std::map<std::pair<std::string, std::string>, StorageDataType> _pending_storage;
+
+			void put_storage_change(const std::string& contract_address, const std::string& storage_name, const StorageDataType& value);
 		public:
 			abstract_native_contract(contract_common_evaluate* evaluate, const address& _contract_id) : _evaluate(evaluate), contract_id(_contract_id) {}
 			virtual ~abstract_native_contract() {}
@@ -64,9 +69,15 @@ namespace graphene {
 			void set_contract_storage(const address& contract_address, const std::string& storage_name, const StorageDataType& value);
 			void set_contract_storage(const address& contract_address, const std::string& storage_name, cbor::CborObjectP cbor_value);
 			void fast_map_set(const address& contract_address, const std::string& storage_name, const std::string& key, cbor::CborObjectP cbor_value);
+			void fast_map_set_int(const address& contract_address, const std::string& storage_name, const std::string& key, int64_t value);
+			void fast_map_set_string(const address& contract_address, const std::string& storage_name, const std::string& key, const std::string& value);
+			void fast_map_set_null(const address& contract_address, const std::string& storage_name, const std::string& key);
+			void flush_storage_changes();
 			StorageDataType get_contract_storage(const address& contract_address, const string& storage_name) const;
 			cbor::CborObjectP get_contract_storage_cbor(const address& contract_address, const std::string& storage_name) const;
 			cbor::CborObjectP fast_map_get(const address& contract_address, const std::string& storage_name, const std::string& key) const;
+			bool fast_map_get_int(const address& contract_address, const std::string& storage_name, const std::string& key, int64_t& value) const;
+			bool fast_map_get_string(const address& contract_address, const std::string& storage_name, const std::string& key, std::string& value) const;
 			std::string get_string_contract_storage(const address& contract_address, const std::string& storage_name) const;
 			int64_t get_int_contract_storage(const address& contract_address, const std::string& storage_name) const;
 
@@ -84,6 +95,21 @@ namespace graphene {
 			virtual cbor::CborObjectP current_fast_map_get(const std::string& storage_name, const std::string& key) const {
 				return fast_map_get(contract_address(), storage_name, key);
 			}
+			virtual bool current_fast_map_get_int(const std::string& storage_name, const std::string& key, int64_t& value) const {
+				return fast_map_get_int(contract_address(), storage_name, key, value);
+			}
+			virtual bool current_fast_map_get_string(const std::string& storage_name, const std::string& key, std::string& value) const {
+				return fast_map_get_string(contract_address(), storage_name, key, value);
+			}
+			virtual void current_fast_map_set_int(const std::string& storage_name, const std::string& key, int64_t value) {
+				fast_map_set_int(contract_address(), storage_name, key, value);
+			}
+			virtual void current_fast_map_set_string(const std::string& storage_name, const std::string& key, const std::string& value) {
+				fast_map_set_string(contract_address(), storage_name, key, value);
+			}
+			virtual void current_fast_map_set_null(const std::string& storage_name, const std::string& key) {
+				fast_map_set_null(contract_address(), storage_name, key);
+			}
 			virtual std::string get_string_current_contract_storage(const std::string& storage_name) const {
 				return get_string_contract_storage(contract_address(), storage_name);
 			}
@@ -117,13 +143,19 @@ namespace graphene {
 			void add_gas(uint64_t gas);
 			void set_invoke_result_caller();
 
-			virtual void* get_result() { return &_contract_invoke_result; }
+			virtual void* get_result() {
+				flush_storage_changes();
+				return &_contract_invoke_result;
+			}
+
 			virtual void set_api_result(const std::string& api_result) {
 				_contract_invoke_result.api_result = api_result;
 			}
 
 			virtual bool is_valid_address(const std::string& addr);
 			virtual uint32_t get_chain_now() const;
+			virtual bool current_storage_revision(std::string& contract_address, uint64_t& revision) const;
+			virtual bool binary_args_enabled() const;
 
 		};
 
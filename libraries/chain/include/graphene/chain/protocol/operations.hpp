@@ -184,7 +184,8 @@ namespace graphene { namespace chain {
 			vote_update_operation,
 			undertaker_operation,
 			name_transfer_operation,
-		    withdraw_limit_modify_operation
+		    withdraw_limit_modify_operation,
+	        contract_batch_invoke_operation
          > operation;
 
    /// @} // operations group
@@ -27,6 +27,7 @@
 namespace graphene { namespace chain {
    class database;
    struct signed_transaction;
+   class contract_vm_stopper;
 
    /**
     *  Place holder for state tracked while processing a transaction. This class provides helper methods that are
@@ -49,5 +50,7 @@ namespace graphene { namespace chain {
          bool                             skip_fee_schedule_check = false;
          int                              op_num=0;
          bool testing = false;
+         /** set for offline calls, lets contract_offline_executor stop the vm */
+         std::shared_ptr<contract_vm_stopper> vm_stopper;
    };
 } } // namespace graphene::chain
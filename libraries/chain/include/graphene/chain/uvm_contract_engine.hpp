@@ -25,6 +25,9 @@ namespace uvm
 		virtual void add_gas_used(int64_t delta_used);
 
 		virtual void stop();
+		// the flag stop() sets, the vm checks it between instructions. setting it to 1 stops the vm
+		// from other threads too, it must be got on the thread running the vm
+		int64_t* stop_flag();
 
 		virtual void add_global_bool_variable(std::string name, bool value);
 		virtual void add_global_int_variable(std::string name, int64_t value);
@@ -18,22 +18,92 @@ namespace graphene {
 		using namespace cbor_diff;
 		using namespace cbor;
 
+		// reads an integer storage value without building the cbor object.
+		// @return false when the value must be decoded by cbor_decode instead
+		static bool read_storage_int(const std::vector<char>& data, bool& is_integer, int64_t& value)
+		{
+			cbor::reader reader(data.data(), data.size());
+			unsigned char major_type;
+			uint64_t argument;
+			if (!reader.read_head(major_type, argument) || !reader.at_end())
+				return false;
+			if (major_type == 0 && argument <= (uint64_t) INT64_MAX) {
+				is_integer = true;
+				value = (int64_t) argument;
+				return true;
+			}
+			if (major_type == 1 && argument <= (uint64_t) INT64_MAX) {
+				is_integer = true;
+				value = -1 - (int64_t) argument;
+				return true;
+			}
+			if (major_type == 7) { // false, true, null, undefined
+				is_integer = false;
+				return true;
+			}
+			return false;
+		}
+
+		// same as read_storage_int for string values
+		static bool read_storage_string(const std::vector<char>& data, bool& is_string, std::string& value)
+		{
+			cbor::reader reader(data.data(), data.size());
+			const char* str;
+			size_t size;
+			if (reader.read_string(str, size)) {
+				if (!reader.at_end())
+					return false;
+				is_string = true;
+				value.assign(str, size);
+				return true;
+			}
+			unsigned char major_type;
+			uint64_t argument;
+			if (reader.read_head(major_type, argument) && major_type == 7 && reader.at_end()) {
+				is_string = false;
+				return true;
+			}
+			return false;
+		}
+
+		static StorageDataType encode_storage_int(int64_t value)
+		{
+			cbor::output_dynamic output;
+			cbor::encoder encoder(output);
+			encoder.write_int(value);
+			StorageDataType result;
+			result.storage_data = output.chars();
+			return result;
+		}
+
 		void abstract_native_contract::set_contract_storage(const address& contract_address, const string& storage_name, const StorageDataType& value)
 		{
-			if (_contract_invoke_result.storage_changes.find(string(contract_address)) == _contract_invoke_result.storage_changes.end())
+			_pending_storage[std::make_pair(string(contract_address), storage_name)] = value;
+		}
+
+		void abstract_native_contract::flush_storage_changes()
+		{
+			for (const auto& p : _pending_storage)
 			{
-				_contract_invoke_result.storage_changes[string(contract_address)] = contract_storage_changes_type();
+				put_storage_change(p.first.first, p.first.second, p.second);
 			}
-			auto& storage_changes = _contract_invoke_result.storage_changes[string(contract_address)];
+			_pending_storage.clear();
+		}
+
+		void abstract_native_contract::put_storage_change(const std::string& contract_address, const std::string& storage_name, const StorageDataType& value)
+		{
+			if (_contract_invoke_result.storage_changes.find(contract_address) == _contract_invoke_result.storage_changes.end())
+			{
+				_contract_invoke_result.storage_changes[contract_address] = contract_storage_changes_type();
+			}
+			auto& storage_changes = _contract_invoke_result.storage_changes[contract_address];
 			if (storage_changes.find(storage_name) == storage_changes.end())
 			{
 				StorageDataChangeType change;
 				change.after = value;
-				const auto &before = _evaluate->get_storage(string(contract_address), storage_name);
+				const auto &before = _evaluate->get_storage(contract_address, storage_name);
 				cbor_diff::CborDiff differ;
-				const auto& before_cbor = cbor_decode(before.storage_data);
-				const auto& after_cbor = cbor_decode(change.after.storage_data);
-				auto diff = differ.diff(before_cbor, after_cbor);
+				auto diff = differ.diff_encoded(before.storage_data, change.after.storage_data);
 				change.storage_diff.storage_data = cbor_encode(diff->value());
 				change.before = before;
 				storage_changes[storage_name] = change;
@@ -45,9 +115,7 @@ namespace graphene {
 				auto after = value;
 				change.after = after;
 				cbor_diff::CborDiff differ;
-				const auto& before_cbor = cbor_diff::cbor_decode(before.storage_data);
-				const auto& after_cbor = cbor_diff::cbor_decode(after.storage_data);
-				auto diff = differ.diff(before_cbor, after_cbor);
+				auto diff = differ.diff_encoded(before.storage_data, after.storage_data);
 				change.storage_diff.storage_data = cbor_encode(diff->value());
 			}
 		}
@@ -61,6 +129,7 @@ namespace graphene {
 		void abstract_native_contract::transfer_to_address(const address& from_contract_address, const address& to_address, const std::string& asset_symbol, const uint64_t amount) {
 			auto a = _evaluate->asset_from_string(asset_symbol, "0");
 			a.amount.value = amount;
+			flush_storage_changes();
 			_evaluate->invoke_contract_result = _contract_invoke_result;
 			_evaluate->transfer_to_address_only_update_invoke_result(from_contract_address, a, to_address);
 			_contract_invoke_result = _evaluate->invoke_contract_result;
@@ -68,6 +137,11 @@ namespace graphene {
 
 		StorageDataType abstract_native_contract::get_contract_storage(const address& contract_address, const std::string& storage_name) const
 		{
+			auto pending = _pending_storage.find(std::make_pair(string(contract_address), storage_name));
+			if (pending != _pending_storage.end())
+			{
+				return pending->second;
+			}
 			if (_contract_invoke_result.storage_changes.find(contract_address.operator fc::string()) == _contract_invoke_result.storage_changes.end())
 			{
 				return _evaluate->get_storage(contract_address.operator fc::string(), storage_name);
@@ -85,6 +159,27 @@ namespace graphene {
 			set_contract_storage(contract_address, full_key, cbor_value);
 		}
 
+		void abstract_native_contract::fast_map_set_int(const address& contract_address, const std::string& storage_name, const std::string& key, int64_t value) {
+			set_contract_storage(contract_address, storage_name + "." + key, encode_storage_int(value));
+		}
+
+		void abstract_native_contract::fast_map_set_string(const address& contract_address, const std::string& storage_name, const std::string& key, const std::string& value) {
+			cbor::output_dynamic output;
+			cbor::encoder encoder(output);
+			encoder.write_string(value);
+			StorageDataType data;
+			data.storage_data = output.chars();
+			set_contract_storage(contract_address, storage_name + "." + key, data);
+		}
+
+		void abstract_native_contract::fast_map_set_null(const address& contract_address, const std::string& storage_name, const std::string& key) {
+			cbor::output_dynamic output;
+			cbor::encoder encoder(output);
+			encoder.write_null();
+			StorageDataType data;
+			data.storage_data = output.chars();
+			set_contract_storage(contract_address, storage_name + "." + key, data);
+		}
 
 		cbor::CborObjectP abstract_native_contract::get_contract_storage_cbor(const address& contract_address, const std::string& storage_name) const {
 			const auto& data = get_contract_storage(contract_address, storage_name);
@@ -104,6 +199,30 @@ namespace graphene {
 			return get_contract_storage_cbor(contract_address, full_key);
 		}
 
+		bool abstract_native_contract::fast_map_get_int(const address& contract_address, const std::string& storage_name, const std::string& key, int64_t& value) const {
+			const auto& data = get_contract_storage(contract_address, storage_name + "." + key);
+			bool is_integer = false;
+			if (read_storage_int(data.storage_data, is_integer, value))
+				return is_integer;
+			auto cbor_value = cbor_decode(data.storage_data);
+			if (!cbor_value->is_integer())
+				return false;
+			value = cbor_value->force_as_int();
+			return true;
+		}
+
+		bool abstract_native_contract::fast_map_get_string(const address& contract_address, const std::string& storage_name, const std::string& key, std::string& value) const {
+			const auto& data = get_contract_storage(contract_address, storage_name + "." + key);
+			bool is_string = false;
+			if (read_storage_string(data.storage_data, is_string, value))
+				return is_string;
+			auto cbor_value = cbor_decode(data.storage_data);
+			if (!cbor_value->is_string())
+				return false;
+			value = cbor_value->as_string();
+			return true;
+		}
+
 		int64_t abstract_native_contract::get_int_contract_storage(const address& contract_address, const std::string& storage_name) const {
 			auto cbor_data = get_contract_storage_cbor(contract_address, storage_name);
 			if (!cbor_data->is_integer()) {
@@ -149,6 +268,23 @@ namespace graphene {
 			return _evaluate->get_db().head_block_time().sec_since_epoch();
 		}
 
+		bool abstract_native_contract::current_storage_revision(std::string& contract_address, uint64_t& revision) const {
+			contract_address = contract_id.address_to_string();
+			// storages changed by this invocation aren't in the database yet
+			for (const auto& p : _pending_storage)
+			{
+				if (p.first.first == contract_address)
+					return false;
+			}
+			if (_contract_invoke_result.storage_changes.find(contract_address) != _contract_invoke_result.storage_changes.end())
+				return false;
+			return _evaluate->get_db().get_contract_storage_revision(contract_id, revision);
+		}
+
+		bool abstract_native_contract::binary_args_enabled() const {
+			return _evaluate->get_db().head_block_num() >= NATIVE_CONTRACT_BINARY_ARGS_HEIGHT;
+		}
+
 		void abstract_native_contract::emit_event(const address& contract_address, const string& event_name, const string& event_arg)
 		{
 			FC_ASSERT(!event_name.empty());
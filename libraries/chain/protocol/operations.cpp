@@ -105,6 +105,8 @@ bool is_contract_operation(const operation& op)
 		return true;
 	case operation::tag<chain::contract_invoke_operation>::value:
 		return true;
+	case operation::tag<chain::contract_batch_invoke_operation>::value:
+		return true;
 	case operation::tag<chain::transfer_contract_operation>::value:
 		return true;
 	case operation::tag<chain::native_contract_register_operation>::value:
@@ -66,10 +66,8 @@ namespace graphene {
 		{
 			// auto storage_json = uvm_storage_value_to_json(lua_storage);
 			// StorageDataType storage_data(jsondiff::json_dumps(storage_json));
-			auto storage_cbor = uvm_storage_value_to_cbor(lua_storage);
-			// printf("lua to storage data: %s\n", storage_cbor->str().c_str());
 			StorageDataType storage_data;
-			storage_data.storage_data = cbor_diff::cbor_encode(storage_cbor);
+			storage_data.storage_data = uvm_storage_value_to_cbor_bytes(lua_storage);
 			return storage_data;
 		}
 
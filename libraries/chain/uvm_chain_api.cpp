@@ -19,8 +19,6 @@
 namespace graphene {
 	namespace chain {
 
-		static int has_error = 0;
-
 		static std::string get_file_name_str_from_contract_module_name(std::string name)
 		{
 			std::stringstream ss;
@@ -33,7 +31,7 @@ namespace graphene {
 		*/
 		bool UvmChainApi::has_exception(lua_State *L)
 		{
-			return has_error ? true : false;
+			return L->chain_api_has_error;
 		}
 
 		/**
@@ -41,7 +39,7 @@ namespace graphene {
 		*/
 		void UvmChainApi::clear_exceptions(lua_State *L)
 		{
-			has_error = 0;
+			L->chain_api_has_error = false;
 		}
 
 		/**
@@ -53,9 +51,9 @@ namespace graphene {
 		*/
 		void UvmChainApi::throw_exception(lua_State *L, int code, const char *error_format, ...)
 		{
-			if (has_error)
+			if (L->chain_api_has_error)
 				return;
-			has_error = 1;
+			L->chain_api_has_error = true;
 			char *msg = (char*)lua_malloc(L, LUA_EXCEPTION_MULTILINE_STRNG_MAX_LENGTH);
 			if (msg) {
 				memset(msg, 0x0, LUA_EXCEPTION_MULTILINE_STRNG_MAX_LENGTH);
@@ -60,6 +60,19 @@ namespace uvm
 		_scope->notify_stop();
 	}
 
+	int64_t* UvmContractEngine::stop_flag()
+	{
+		auto L = _scope->L();
+		auto flag = uvm::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+		if (nullptr == flag)
+		{
+			_scope->notify_stop();
+			_scope->resume_running();
+			flag = uvm::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+		}
+		return flag;
+	}
+
 	void UvmContractEngine::add_global_bool_variable(std::string name, bool value)
 	{
 		_scope->add_global_bool_variable(name.c_str(), value);
@@ -88,7 +101,7 @@ namespace uvm
 
 	void UvmContractEngine::clear_exceptions()
 	{
-		uvm::lua::api::global_uvm_chain_api->clear_exceptions(_scope->L());
+		uvm::lua::api::get_uvm_chain_api(_scope->L())->clear_exceptions(_scope->L());
 	}
 
 	void UvmContractEngine::execute_contract_api_by_address(std::string contract_id, std::string method, std::string argument, std::string *result_json_string)
@@ -96,8 +109,8 @@ namespace uvm
 		clear_exceptions();
 		cbor::CborArrayValue args;
 		args.push_back(cbor::CborObject::from_string(argument));
-		const auto& txid = uvm::lua::api::global_uvm_chain_api->get_transaction_id_without_gas(_scope->L());
-                uvm::lua::api::global_uvm_chain_api->before_contract_invoke(_scope->L(), contract_id, txid);
+		const auto& txid = uvm::lua::api::get_uvm_chain_api(_scope->L())->get_transaction_id_without_gas(_scope->L());
+                uvm::lua::api::get_uvm_chain_api(_scope->L())->before_contract_invoke(_scope->L(), contract_id, txid);
 		uvm::lua::lib::execute_contract_api_by_address(_scope->L(), contract_id.c_str(), method.c_str(), args, result_json_string);
 		if (_scope->L()->force_stopping == true && _scope->L()->exit_code == LUA_API_INTERNAL_ERROR)
 			FC_CAPTURE_AND_THROW(::blockchain::contract_engine::uvm_executor_internal_error, (""));
@@ -147,7 +160,7 @@ namespace uvm
 
 	std::shared_ptr<::blockchain::contract_engine::VMModuleByteStream> UvmContractEngine::get_bytestream_from_code(const uvm::blockchain::Code& code)
 	{
-		auto code_stream = uvm::lua::api::global_uvm_chain_api->get_bytestream_from_code(_scope->L(), code);
+		auto code_stream = uvm::lua::api::get_uvm_chain_api(_scope->L())->get_bytestream_from_code(_scope->L(), code);
 		return code_stream;
 	}
 
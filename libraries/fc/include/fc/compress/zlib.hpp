@@ -7,4 +7,9 @@ namespace fc
 
   string zlib_compress(const string& in);
 
+  /** level is 1 (fastest) to 9 (smallest output), as in zlib.  returns an empty string on failure */
+  string zlib_compress(const char* in, size_t in_size, int level);
+  /** returns false unless in is zlib data that inflates to exactly out_size bytes */
+  bool zlib_decompress(const char* in, size_t in_size, char* out, size_t out_size);
+
 } // namespace fc
@@ -15,6 +15,8 @@ namespace fc {
          ~aes_encoder();
      
          void init( const fc::sha256& key, const fc::uint128& init_value );
+         /** aes 256 ctr instead of cbc: any length, and both directions of a stream need their own key */
+         void init_ctr( const fc::sha256& key, const fc::uint128& init_value );
          uint32_t encode( const char* plaintxt, uint32_t len, char* ciphertxt );
  //        uint32_t final_encode( char* ciphertxt );
 
@@ -29,6 +31,7 @@ namespace fc {
          ~aes_decoder();
      
          void     init( const fc::sha256& key, const fc::uint128& init_value );
+         void     init_ctr( const fc::sha256& key, const fc::uint128& init_value );
          uint32_t decode( const char* ciphertxt, uint32_t len, char* plaintext );
 //         uint32_t final_decode( char* plaintext );
 
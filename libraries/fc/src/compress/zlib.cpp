@@ -12,4 +12,22 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  string zlib_compress(const char* in, size_t in_size, int level)
+  {
+    size_t compressed_message_length;
+    mz_uint flags = tdefl_create_comp_flags_from_zip_params(level, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+    char* compressed_message = (char*)tdefl_compress_mem_to_heap(in, in_size, &compressed_message_length, flags);
+    if (!compressed_message)
+      return string();
+    string result(compressed_message, compressed_message_length);
+    free(compressed_message);
+    return result;
+  }
+
+  bool zlib_decompress(const char* in, size_t in_size, char* out, size_t out_size)
+  {
+    size_t decompressed_length = tinfl_decompress_mem_to_mem(out, out_size, in, in_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+    return decompressed_length == out_size;
+  }
 }
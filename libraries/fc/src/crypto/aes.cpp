@@ -59,6 +59,21 @@ void aes_encoder::init( const fc::sha256& key, const fc::uint128& init_value )
     EVP_CIPHER_CTX_set_padding( my->ctx, 0 );
 }
 
+void aes_encoder::init_ctr( const fc::sha256& key, const fc::uint128& init_value )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    if(!my->ctx)
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+    if(1 != EVP_EncryptInit_ex(my->ctx, EVP_aes_256_ctr(), NULL, (unsigned char*)&key, (unsigned char*)&init_value))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 ctr encryption init", 
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+}
+
 uint32_t aes_encoder::encode( const char* plaintxt, uint32_t plaintext_len, char* ciphertxt )
 {
     int ciphertext_len = 0;
@@ -122,6 +137,21 @@ void aes_decoder::init( const fc::sha256& key, const fc::uint128& init_value )
     }
     EVP_CIPHER_CTX_set_padding( my->ctx, 0 );
 }
+
+void aes_decoder::init_ctr( const fc::sha256& key, const fc::uint128& init_value )
+{
+    my->ctx.obj = EVP_CIPHER_CTX_new();
+    if(!my->ctx)
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error allocating evp cipher context", 
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+    if(1 != EVP_DecryptInit_ex(my->ctx, EVP_aes_256_ctr(), NULL, (unsigned char*)&key, (unsigned char*)&init_value))
+    {
+        FC_THROW_EXCEPTION( aes_exception, "error during aes 256 ctr decryption init", 
+                           ("s", ERR_error_string( ERR_get_error(), nullptr) ) );
+    }
+}
 aes_decoder::~aes_decoder()
 {
 }
@@ -45,6 +45,74 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum get_compact_block_transactions_message::type  = core_message_type_enum::get_compact_block_transactions_message_type;
+  const core_message_type_enum compact_block_transactions_message::type      = core_message_type_enum::compact_block_transactions_message_type;
+  const core_message_type_enum cipher_switch_message::type                   = core_message_type_enum::cipher_switch_message_type;
+  const core_message_type_enum get_block_headers_message::type               = core_message_type_enum::get_block_headers_message_type;
+  const core_message_type_enum block_headers_message::type                   = core_message_type_enum::block_headers_message_type;
+
+  std::string message_type_name(uint32_t msg_type)
+  {
+    if (msg_type == core_message_type_first || msg_type == core_message_type_last)
+      return fc::to_string((int64_t)msg_type);
+    return fc::reflector<core_message_type_enum>::to_fc_string((int64_t)msg_type);
+  }
+
+  compact_block_message make_compact_block(const signed_block& block, const block_id_type& block_id,
+                                           const std::function<bool(const transaction_id_type&)>& peer_has_transaction)
+  {
+    compact_block_message compact_block;
+    compact_block.header = block;
+    compact_block.block_id = block_id;
+    compact_block.transactions.reserve(block.transactions.size());
+    for (uint32_t i = 0; i < block.transactions.size(); ++i)
+    {
+      const processed_transaction& transaction = block.transactions[i];
+      transaction_id_type transaction_id = transaction.id();
+      compact_block_transaction compact_transaction;
+      compact_transaction.short_id = compact_block_short_id(transaction_id);
+      if (peer_has_transaction(transaction_id))
+        compact_transaction.operation_results = transaction.operation_results;
+      else
+        compact_block.prefilled_transactions[i] = transaction;
+      compact_block.transactions.push_back(std::move(compact_transaction));
+    }
+    return compact_block;
+  }
+
+  bool reconstruct_compact_block(const compact_block_message& compact_block,
+                                 const std::function<fc::optional<signed_transaction>(uint64_t)>& find_transaction,
+                                 block_message& reconstructed_block, std::vector<uint32_t>& missing_transactions)
+  {
+    reconstructed_block = block_message();
+    static_cast<signed_block_header&>(reconstructed_block.block) = compact_block.header;
+    reconstructed_block.block_id = compact_block.block_id;
+    reconstructed_block.block.transactions.resize(compact_block.transactions.size());
+    missing_transactions.clear();
+
+    bool used_found_transactions = false;
+    for (uint32_t i = 0; i < compact_block.transactions.size(); ++i)
+    {
+      auto prefilled_iter = compact_block.prefilled_transactions.find(i);
+      if (prefilled_iter != compact_block.prefilled_transactions.end())
+      {
+        reconstructed_block.block.transactions[i] = prefilled_iter->second;
+        continue;
+      }
+      const compact_block_transaction& compact_transaction = compact_block.transactions[i];
+      fc::optional<signed_transaction> transaction = find_transaction(compact_transaction.short_id);
+      if (!transaction)
+      {
+        missing_transactions.push_back(i);
+        continue;
+      }
+      reconstructed_block.block.transactions[i] = processed_transaction(*transaction);
+      reconstructed_block.block.transactions[i].operation_results = compact_transaction.operation_results;
+      used_found_transactions = true;
+    }
+    return used_found_transactions;
+  }
 
 } } // graphene::net
 
@@ -23,7 +23,43 @@
  */
 #pragma once
 
-#define GRAPHENE_NET_PROTOCOL_VERSION                        106
+#define GRAPHENE_NET_PROTOCOL_VERSION                        110
+
+/**
+ * The first protocol version that can relay blocks as compact blocks
+ * (header, short transaction ids and the transactions the peer lacks)
+ */
+#define GRAPHENE_NET_COMPACT_BLOCKS_PROTOCOL_VERSION         107
+
+/**
+ * The first protocol version that can receive zlib compressed messages.
+ * Messages smaller than GRAPHENE_NET_MIN_SIZE_TO_COMPRESS aren't worth
+ * compressing, and the level favors speed over size
+ */
+#define GRAPHENE_NET_COMPRESSION_PROTOCOL_VERSION            108
+#define GRAPHENE_NET_MIN_SIZE_TO_COMPRESS                    512
+#define GRAPHENE_NET_COMPRESSION_LEVEL                       1
+
+/**
+ * The first protocol version that can switch its connections from aes 256 cbc
+ * to aes 256 ctr, which hardware accelerated aes encrypts several blocks at a time
+ */
+#define GRAPHENE_NET_CTR_CIPHER_PROTOCOL_VERSION             109
+
+/**
+ * The first protocol version that can send block headers during sync.  We
+ * check the headers of the blocks a peer offers before we fetch the blocks,
+ * on up to GRAPHENE_NET_MAX_HEADER_VERIFICATION_THREADS threads
+ */
+#define GRAPHENE_NET_BLOCK_HEADERS_PROTOCOL_VERSION          110
+#define GRAPHENE_NET_MAX_BLOCK_HEADERS_PER_FETCH             2000
+/**
+ * Each block header we send reads its block, so we send each peer no more than
+ * this many headers per second on average, in bursts of up to two full fetches
+ */
+#define GRAPHENE_NET_MAX_BLOCK_HEADERS_SENT_PER_SECOND_PER_PEER 2000
+#define GRAPHENE_NET_MAX_BLOCK_HEADERS_SENT_BURST_PER_PEER   (2 * GRAPHENE_NET_MAX_BLOCK_HEADERS_PER_FETCH)
+#define GRAPHENE_NET_MAX_HEADER_VERIFICATION_THREADS         4
 
 /**
  * Define this to enable debugging code in the p2p network interface.
@@ -84,6 +120,29 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * Number of threads reading and writing the peer connections.  With 0,
+ * connections are read by the p2p thread itself.  Otherwise the io threads
+ * queue what they read for the p2p thread, which hands the transactions to
+ * the client in batches.  Each io thread gets an equal share of the
+ * bandwidth limits.
+ */
+#define GRAPHENE_NET_DEFAULT_IO_THREADS                      0
+
+/**
+ * Size of the queue between the io threads and the p2p thread.  A connection
+ * stops reading while the queue is full, until the p2p thread takes a message.
+ */
+#define GRAPHENE_NET_MAX_QUEUED_INCOMING_MESSAGES            4096
+
+#define GRAPHENE_NET_MAX_TRANSACTIONS_PER_BATCH              100
+
+/**
+ * Sync blocks ready to push are handed to the client in batches of at most
+ * this many, each batch in one call on the client's thread.
+ */
+#define GRAPHENE_NET_MAX_SYNC_BLOCKS_PER_BATCH               20
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -106,3 +165,11 @@
 #define GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH               10000
 
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
+
+/**
+ * We request transactions from each peer at no more than this rate on average,
+ * with bursts of up to GRAPHENE_NET_DEFAULT_MAX_TRX_BURST_PER_PEER, so one peer
+ * can't flood the client with transactions
+ */
+#define GRAPHENE_NET_DEFAULT_MAX_TRX_PER_SECOND_PER_PEER     200
+#define GRAPHENE_NET_DEFAULT_MAX_TRX_BURST_PER_PEER          400
@@ -37,6 +37,7 @@
 #include <fc/io/enum_type.hpp>
 
 
+#include <functional>
 #include <vector>
 
 namespace graphene { namespace net {
@@ -44,6 +45,9 @@ namespace graphene { namespace net {
   using graphene::chain::block_id_type;
   using graphene::chain::transaction_id_type;
   using graphene::chain::signed_block;
+  using graphene::chain::signed_block_header;
+  using graphene::chain::processed_transaction;
+  using graphene::chain::operation_result;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,9 +90,20 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    get_compact_block_transactions_message_type  = 5019,
+    compact_block_transactions_message_type      = 5020,
+    compressed_message_type                      = 5021, // unwrapped by message_oriented_connection, never reaches the node
+    cipher_switch_message_type                   = 5022,
+    get_block_headers_message_type               = 5023,
+    block_headers_message_type                   = 5024,
     core_message_type_last                       = 5099
   };
 
+  /** the name of a message type in logs and metrics.  the item types, trx and block, are named like the
+   *  core messages, the range markers and types this node doesn't know by their number */
+  std::string message_type_name(uint32_t msg_type);
+
   const uint32_t core_protocol_version = GRAPHENE_NET_PROTOCOL_VERSION;
 
    struct trx_message
@@ -400,6 +415,110 @@ namespace graphene { namespace net {
     std::vector<current_connection_data> current_connections;
   };
 
+  /**
+   * Tells the peer that everything we send after this message is encrypted with
+   * aes 256 ctr.  message_oriented_connection switches the cipher of each direction
+   * when it sends or receives it, the node never sees it
+   */
+  struct cipher_switch_message
+  {
+    static const core_message_type_enum type;
+  };
+
+  /** the short id a compact block uses for a transaction: the first 8 bytes of its id */
+  inline uint64_t compact_block_short_id(const transaction_id_type& transaction_id)
+  {
+    uint64_t short_id;
+    memcpy(&short_id, transaction_id.data(), sizeof(short_id));
+    return short_id;
+  }
+
+  struct compact_block_transaction
+  {
+    uint64_t short_id;
+    std::vector<operation_result> operation_results; // the results are part of the block's merkle root
+  };
+
+  /**
+   * Sent in place of a block_message to peers that support compact blocks.  The
+   * receiver finds the transactions it already has by their short id and asks
+   * for the rest with a get_compact_block_transactions_message
+   */
+  struct compact_block_message
+  {
+    static const core_message_type_enum type;
+
+    signed_block_header header;
+    block_id_type       block_id;
+    std::vector<compact_block_transaction> transactions; // one per transaction of the block
+    std::map<uint32_t, processed_transaction> prefilled_transactions; // by index, the transactions we expect the peer doesn't have
+
+    compact_block_message() {}
+  };
+
+  struct get_compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type         block_id;
+    std::vector<uint32_t> transaction_indexes;
+
+    get_compact_block_transactions_message() {}
+    get_compact_block_transactions_message(const block_id_type& block_id, std::vector<uint32_t> transaction_indexes) :
+      block_id(block_id),
+      transaction_indexes(std::move(transaction_indexes))
+    {}
+  };
+
+  struct compact_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type block_id;
+    std::vector<processed_transaction> transactions; // in the order they were requested
+  };
+
+  /**
+   *  The compact block of a block.  The transactions peer_has_transaction returns false for
+   *  are prefilled, the others are sent by their short id
+   */
+  compact_block_message make_compact_block(const signed_block& block, const block_id_type& block_id,
+                                           const std::function<bool(const transaction_id_type&)>& peer_has_transaction);
+
+  /**
+   *  Rebuilds the block of a compact block from its prefilled transactions and those find_transaction
+   *  returns by short id.  The block isn't checked against its merkle root
+   *
+   *  @param missing_transactions set to the indexes of the transactions to fetch from the peer
+   *  @returns whether any transaction came from find_transaction, so a bad merkle root may be a short id collision
+   */
+  bool reconstruct_compact_block(const compact_block_message& compact_block,
+                                 const std::function<fc::optional<signed_transaction>(uint64_t)>& find_transaction,
+                                 block_message& reconstructed_block, std::vector<uint32_t>& missing_transactions);
+
+  /**
+   * Asks a peer that supports it for the headers of blocks it offered us during sync,
+   * so we can check them before downloading the blocks
+   */
+  struct get_block_headers_message
+  {
+    static const core_message_type_enum type;
+
+    std::vector<block_id_type> block_ids;
+
+    get_block_headers_message() {}
+    get_block_headers_message(std::vector<block_id_type> block_ids) :
+      block_ids(std::move(block_ids))
+    {}
+  };
+
+  struct block_headers_message
+  {
+    static const core_message_type_enum type;
+
+    std::vector<signed_block_header> headers; // in the order they were requested, up to the first one the peer doesn't have
+  };
+
 
 } } // graphene::net
 
@@ -424,6 +543,13 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (get_compact_block_transactions_message_type)
+                 (compact_block_transactions_message_type)
+                 (compressed_message_type)
+                 (cipher_switch_message_type)
+                 (get_block_headers_message_type)
+                 (block_headers_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
@@ -508,6 +634,13 @@ FC_REFLECT(graphene::net::get_current_connections_reply_message, (upload_rate_on
                                                             (upload_rate_one_hour)
                                                             (download_rate_one_hour)
                                                             (current_connections))
+FC_REFLECT_EMPTY(graphene::net::cipher_switch_message)
+FC_REFLECT(graphene::net::compact_block_transaction, (short_id)(operation_results))
+FC_REFLECT(graphene::net::compact_block_message, (header)(block_id)(transactions)(prefilled_transactions))
+FC_REFLECT(graphene::net::get_compact_block_transactions_message, (block_id)(transaction_indexes))
+FC_REFLECT(graphene::net::compact_block_transactions_message, (block_id)(transactions))
+FC_REFLECT(graphene::net::get_block_headers_message, (block_ids))
+FC_REFLECT(graphene::net::block_headers_message, (headers))
 
 #include <unordered_map>
 #include <fc/crypto/city.hpp>
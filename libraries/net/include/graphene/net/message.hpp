@@ -29,6 +29,8 @@
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/reflect/variant.hpp>
 
+#include <memory>
+
 namespace graphene { namespace net {
 
   /**
@@ -108,8 +110,11 @@ namespace graphene { namespace net {
      }
   };
 
-
-
+  /**
+   *  A message that is no longer modified, shared by the message cache and the send
+   *  queues of every peer it goes to instead of being copied for each of them
+   */
+  typedef std::shared_ptr<const message> shared_message_ptr;
 
 } } // graphene::net
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/net/node.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/tag.hpp>
+
+namespace graphene { namespace net {
+
+  /**
+   *  Messages we have received and may have to provide to other peers, kept for
+   *  GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS blocks
+   */
+  class blockchain_tied_message_cache
+  {
+  private:
+    static const uint32_t cache_duration_in_blocks = GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS;
+
+    struct message_hash_index{};
+    struct message_contents_hash_index{};
+    struct block_clock_index{};
+    struct message_info
+    {
+      message_hash_type message_hash;
+      shared_message_ptr message_body;
+      uint32_t          block_clock_when_received;
+
+      // for network performance stats
+      message_propagation_data propagation_data;
+      fc::uint160_t     message_contents_hash; // hash of whatever the message contains (if it's a transaction, this is the transaction id, if it's a block, it's the block_id)
+
+      message_info( const message_hash_type& message_hash,
+                    const shared_message_ptr& message_body,
+                    uint32_t                 block_clock_when_received,
+                    const message_propagation_data& propagation_data,
+                    fc::uint160_t            message_contents_hash ) :
+        message_hash( message_hash ),
+        message_body( message_body ),
+        block_clock_when_received( block_clock_when_received ),
+        propagation_data( propagation_data ),
+        message_contents_hash( message_contents_hash )
+      {}
+    };
+    typedef boost::multi_index_container
+      < message_info,
+          boost::multi_index::indexed_by<
+            boost::multi_index::ordered_unique< boost::multi_index::tag<message_hash_index>,
+                                                boost::multi_index::member<message_info, message_hash_type, &message_info::message_hash> >,
+            boost::multi_index::ordered_non_unique< boost::multi_index::tag<message_contents_hash_index>,
+                                                    boost::multi_index::member<message_info, fc::uint160_t, &message_info::message_contents_hash> >,
+            boost::multi_index::ordered_non_unique< boost::multi_index::tag<block_clock_index>,
+                                                    boost::multi_index::member<message_info, uint32_t, &message_info::block_clock_when_received> > >
+      > message_cache_container;
+
+    message_cache_container _message_cache;
+
+    uint32_t block_clock;
+
+  public:
+    blockchain_tied_message_cache() :
+      block_clock( 0 )
+    {}
+    void block_accepted();
+    void cache_message( const shared_message_ptr& message_to_cache, const message_hash_type& hash_of_message_to_cache,
+                      const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
+    shared_message_ptr get_message( const message_hash_type& hash_of_message_to_lookup );
+    message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
+    fc::optional<message_hash_type> get_message_hash( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
+    /** the cached transaction whose id starts with short_transaction_id, none if there is none or more than one */
+    fc::optional<signed_transaction> get_transaction( uint64_t short_transaction_id ) const;
+    size_t size() const { return _message_cache.size(); }
+  };
+
+} } // graphene::net
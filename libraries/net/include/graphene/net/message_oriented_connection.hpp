@@ -23,6 +23,8 @@
  */
 #pragma once
 #include <fc/network/tcp_socket.hpp>
+#include <fc/network/rate_limiting.hpp>
+#include <fc/thread/thread.hpp>
 #include <graphene/net/message.hpp>
 
 namespace graphene { namespace net {
@@ -47,11 +49,22 @@ namespace graphene { namespace net {
        ~message_oriented_connection();
        fc::tcp_socket& get_socket();
 
+       /** reads, decrypts and unpacks messages on io_thread instead of the calling thread, so the
+        *  delegate is called on io_thread.  messages are also written there, and the socket is closed
+        *  there, io_rate_limiter limits its bandwidth.  call before accept() or connect_to() */
+       void set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                          const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter);
+
        void accept();
        void bind(const fc::ip::endpoint& local_endpoint);
        void connect_to(const fc::ip::endpoint& remote_endpoint);
 
-       void send_message(const message& message_to_send);
+       /** compresses the large messages we send from now on.  only call this once the
+        *  remote end has said it can decompress them, compressed messages are always accepted */
+       void enable_compression();
+
+       /** the message may be queued for other peers too, it is sent without being copied */
+       void send_message(const shared_message_ptr& message_to_send);
        void close_connection();
        void destroy_connection();
 
@@ -59,6 +72,9 @@ namespace graphene { namespace net {
        uint64_t       get_total_bytes_received() const;
        fc::time_point get_last_message_sent_time() const;
        fc::time_point get_last_message_received_time() const;
+       /** bytes of messages on the wire / bytes of the messages they carry, 1 without compression */
+       double         get_compression_ratio_sent() const;
+       double         get_compression_ratio_received() const;
        fc::time_point get_connection_time() const;
        fc::sha512     get_shared_secret() const;
      private:
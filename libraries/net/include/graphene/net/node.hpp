@@ -30,6 +30,7 @@
 #include <graphene/chain/protocol/types.hpp>
 
 #include <list>
+#include <map>
 
 namespace graphene { namespace net {
 
@@ -54,6 +55,67 @@ namespace graphene { namespace net {
     node_id_t originating_peer;
   };
 
+  /**
+   *  Who may sign the blocks built on the client's head block, as far as the client can tell
+   *  before it has them.  Sync block headers are checked against it before we fetch the blocks
+   */
+  struct block_signing_schedule
+  {
+    item_hash_t        head_block_id;
+    /// the slots below are those of the blocks up to this one.  the miners are reshuffled after the
+    /// last block of a round, and the blocks after a maintenance block skip slots
+    uint32_t           last_scheduled_block_num = 0;
+    fc::time_point_sec first_slot_time; /// time of the first slot after the head block
+    uint32_t           block_interval = 0;
+    /// the first block at or after this time is a maintenance block, the last one the slots are known for
+    fc::time_point_sec next_maintenance_time;
+    /// key of the miner scheduled for each slot, starting with the one at first_slot_time and repeating
+    std::vector<fc::ecc::public_key_data> slot_signing_keys;
+    /// keys of the active miners, those of later rounds are picked from them
+    std::set<fc::ecc::public_key_data>    signing_keys;
+  };
+
+  /**
+   *  Checks that the headers link to each other, starting at previous_block_id if it is set, that their
+   *  timestamps increase and aren't after latest_acceptable_timestamp, and that the headers on the slots
+   *  of the schedule are at a slot time.  block_ids[i] is the id of headers[i] and signers[i] the key it
+   *  is signed with.
+   *
+   *  trusted_signers[i] is set when headers[i] is signed by the key of the miner of its slot, or for a
+   *  header past the known slots, when it is at a multiple of the block interval and signed by an active
+   *  miner.  It is set for every header when the schedule is empty, the client doesn't know it.
+   *
+   *  @returns the index of the first bad header, or headers.size() if there are none
+   */
+  size_t check_sync_block_headers( const std::vector<signed_block_header>& headers,
+                                   const std::vector<item_hash_t>& block_ids,
+                                   const std::vector<fc::ecc::public_key_data>& signers,
+                                   const fc::optional<item_hash_t>& previous_block_id,
+                                   const block_signing_schedule& schedule,
+                                   fc::time_point_sec latest_acceptable_timestamp,
+                                   std::vector<char>& trusted_signers );
+
+  /**
+   *  Sync blocks received before the blocks they build on, by block id.  A block id starts with the
+   *  block number, so they are in block number order.
+   */
+  typedef std::map<block_id_type, block_message> received_sync_blocks;
+
+  /**
+   *  Finds the block to push next: the lowest of the received blocks the peers are waiting for, given
+   *  the ids at the front of their lists.
+   *
+   *  @returns blocks.end() if none of them has been received
+   */
+  received_sync_blocks::iterator find_next_sync_block( received_sync_blocks& blocks,
+                                                       const std::vector<item_hash_t>& next_block_ids );
+
+  /**
+   *  Checks what can be checked of a sync block without the blocks before it: its header hashes to its
+   *  id and its transactions to the header's merkle root.
+   */
+  bool sync_block_matches_id( const block_message& block_message_to_check );
+
    /**
     *  @class node_delegate
     *  @brief used by node reports status to client or fetch data from client
@@ -79,6 +141,15 @@ namespace graphene { namespace net {
           */
          virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode, 
                                     std::vector<fc::uint160_t>& contained_transaction_message_ids,bool stoppable=false ) = 0;
+
+         /**
+          *  @brief Called with sync blocks in chain order, so they are passed to the client
+          *         in one call.  Calls handle_block in sync mode for each block unless
+          *         overridden
+          *
+          *  @returns for each block, the error pushing it if there was one
+          */
+         virtual std::vector<fc::oexception> handle_sync_blocks( const std::vector<graphene::net::block_message>& blk_msgs );
          
          /**
           *  @brief Called when a new transaction comes in from the network
@@ -88,6 +159,15 @@ namespace graphene { namespace net {
           */
          virtual void handle_transaction( const graphene::net::trx_message& trx_msg ) = 0;
 
+         /**
+          *  @brief Called with transactions that came in from the network together, so
+          *         they are passed to the client in one call.  Calls handle_transaction
+          *         for each transaction unless overridden
+          *
+          *  @returns for each transaction, the error validating it if there was one
+          */
+         virtual std::vector<fc::oexception> handle_transactions( const std::vector<graphene::net::trx_message>& trx_msgs );
+
          /**
           *  @brief Called when a new message comes in from the network other than a
           *         block or a transaction.  Currently there are no other possible 
@@ -114,6 +194,21 @@ namespace graphene { namespace net {
           */
          virtual message get_item( const item_id& id ) = 0;
 
+         /**
+          *  Returns the header of a block we have, taken from the block get_item returns
+          *  unless overridden
+          *
+          *  @throws key_not_found_exception if we don't have the block
+          */
+         virtual signed_block_header get_block_header( const item_hash_t& block_id );
+
+         /**
+          *  Returns the miners that may sign the blocks after our head block, so sync block
+          *  headers can be checked against them.  Empty unless overridden, when the client
+          *  doesn't know them
+          */
+         virtual block_signing_schedule get_block_signing_schedule();
+
          virtual chain_id_type get_chain_id()const = 0;
 
          /**
@@ -288,6 +383,14 @@ namespace graphene { namespace net {
         fc::variant_object network_get_info() const;
         fc::variant_object network_get_usage_stats() const;
 
+        /**
+         * Messages and bytes by message type, request latencies, block apply times, duplicate
+         * receives and send queue depths, in total and for each connected peer
+         */
+        fc::variant_object get_p2p_metrics() const;
+        /// the totals and per-peer aggregates of get_p2p_metrics(), in the Prometheus text format
+        std::string get_p2p_metrics_text() const;
+
         std::vector<potential_peer_record> get_potential_peers() const;
 
         void disable_peer_advertising();
@@ -61,6 +61,59 @@ namespace graphene { namespace net
       node_id_t        requesting_peer;
     };
 
+    /// messages of one type, counted when they have been sent or received in full
+    struct message_type_counters
+    {
+      uint64_t messages_sent = 0;
+      uint64_t bytes_sent = 0; /// including the message header, before compression
+      uint64_t messages_received = 0;
+      uint64_t bytes_received = 0;
+    };
+
+    struct latency_counter
+    {
+      uint64_t         count = 0;
+      fc::microseconds total;
+      fc::microseconds max;
+
+      void record(fc::microseconds latency);
+      void add(const latency_counter& other);
+    };
+
+    /// what went over one connection, or over all of them for the node's totals
+    struct traffic_metrics
+    {
+      std::map<uint32_t, message_type_counters> message_types; /// by msg_type
+      latency_counter item_ids_latency; /// fetch_blockchain_item_ids_message to blockchain_item_ids_inventory_message
+      latency_counter sync_item_latency; /// fetch_items_message to the sync block
+      latency_counter item_latency; /// fetch_items_message to the block or transaction during normal operation
+      latency_counter block_apply_latency; /// block received to block accepted by the client during normal operation
+      uint64_t duplicate_items_received = 0; /// blocks we had already accepted
+      uint64_t duplicate_inventory_received = 0; /// item ids we had already been offered, requested or advertised
+
+      void count_sent_message(const message& sent_message);
+      void count_received_message(const message& received_message);
+      void add(const traffic_metrics& other);
+    };
+
+    /** tokens that accrue at a fixed rate up to a burst size, each one pays for an item a peer asks of us or
+     *  we ask of it.  a new bucket is full */
+    class token_bucket
+    {
+    public:
+      token_bucket();
+      /** adds the tokens earned at tokens_per_second since the last refill, up to burst */
+      void refill(double tokens_per_second, double burst, fc::time_point now);
+      /** takes up to count whole tokens, returns how many were taken */
+      uint32_t take(uint32_t count = 1);
+      double tokens() const { return _tokens; }
+      /** when the bucket holds a whole token, at tokens_per_second after the last refill */
+      fc::time_point next_token_time(double tokens_per_second) const;
+    private:
+      double         _tokens;
+      fc::time_point _updated;
+    };
+
     class peer_connection;
     class peer_connection_delegate
     {
@@ -68,7 +121,12 @@ namespace graphene { namespace net
       virtual void on_message(peer_connection* originating_peer,
                               const message& received_message) = 0;
       virtual void on_connection_closed(peer_connection* originating_peer) = 0;
-      virtual message get_message_for_item(const item_id& item) = 0;
+      virtual shared_message_ptr get_message_for_item(const item_id& item) = 0;
+      /** called on the io thread of a peer read by an io thread, see peer_connection::set_io_thread.
+       *  the delegate passes the message to on_message on its own thread, in the order queued.
+       *  an unset message is passed to on_connection_closed instead */
+      virtual void queue_incoming_message(const std::weak_ptr<peer_connection>& originating_peer,
+                                          const fc::optional<message>& received_message) = 0;
     };
 
     class peer_connection;
@@ -109,6 +167,8 @@ namespace graphene { namespace net
       peer_connection_delegate*      _node;
       fc::optional<fc::ip::endpoint> _remote_endpoint;
       message_oriented_connection    _message_connection;
+      std::weak_ptr<peer_connection> _weak_self;
+      bool                           _reads_on_io_thread;
 
       /* a base class for messages on the queue, to hide the fact that some
        * messages are complete messages and some are only hashes of messages.
@@ -123,7 +183,7 @@ namespace graphene { namespace net
           enqueue_time(enqueue_time)
         {}
 
-        virtual message get_message(peer_connection_delegate* node) = 0;
+        virtual shared_message_ptr get_message(peer_connection_delegate* node) = 0;
         /** returns roughly the number of bytes of memory the message is consuming while
          * it is sitting on the queue
          */
@@ -131,21 +191,21 @@ namespace graphene { namespace net
         virtual ~queued_message() {}
       };
 
-      /* when you queue up a 'real_queued_message', a full copy of the message is
-       * stored on the heap until it is sent
+      /* when you queue up a 'real_queued_message', the message is kept on the heap
+       * until it is sent.  The message may be shared with other peers' queues
        */
       struct real_queued_message : queued_message
       {
-        message        message_to_send;
-        size_t         message_send_time_field_offset;
+        shared_message_ptr message_to_send;
+        size_t             message_send_time_field_offset;
 
-        real_queued_message(message message_to_send,
+        real_queued_message(shared_message_ptr message_to_send,
                             size_t message_send_time_field_offset = (size_t)-1) :
           message_to_send(std::move(message_to_send)),
           message_send_time_field_offset(message_send_time_field_offset)
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        shared_message_ptr get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
@@ -161,7 +221,7 @@ namespace graphene { namespace net
           item_to_send(std::move(item_to_send))
         {}
 
-        message get_message(peer_connection_delegate* node) override;
+        shared_message_ptr get_message(peer_connection_delegate* node) override;
         size_t get_size_in_queue() override;
       };
 
@@ -207,6 +267,8 @@ namespace graphene { namespace net
       fc::optional<fc::time_point_sec> fc_git_revision_unix_timestamp;
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
+      bool             supports_compact_blocks; /// the peer can rebuild blocks we send as compact_block_messages
+      bool             supports_block_headers; /// the peer answers get_block_headers_messages during sync
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -222,11 +284,15 @@ namespace graphene { namespace net
       /// @{
       boost::container::deque<item_hash_t> ids_of_items_to_get; /// id of items in the blockchain that this peer has told us about
       std::set<item_hash_t> ids_of_items_being_processed; /// list of all items this peer has offered use that we've already handed to the client but the client hasn't finished processing
+      uint32_t number_of_blocks_received; /// blocks we requested from the peer and received, for the peer database
       uint32_t number_of_unfetched_item_ids; /// number of items in the blockchain that follow ids_of_items_to_get but the peer hasn't yet told us their ids
       bool peer_needs_sync_items_from_us;
       bool we_need_sync_items_from_peer;
       fc::optional<boost::tuple<std::vector<item_hash_t>, fc::time_point> > item_ids_requested_from_peer; /// we check this to detect a timed-out request and in busy()
       item_to_time_map_type sync_items_requested_from_peer; /// ids of blocks we've requested from this peer during sync.  fetch from another peer if this peer disconnects
+      fc::optional<boost::tuple<std::vector<item_hash_t>, fc::time_point> > block_headers_requested_from_peer; /// ids of the sync blocks whose headers we've asked for, we check this to detect a timed-out request and in busy()
+      fc::optional<item_hash_t> block_headers_previous_id; /// the id the first requested header must link to, if we know it
+      token_bucket block_headers_sent_tokens; /// pays for each block header we send this peer, reading a header reads its block
       item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
       fc::time_point_sec last_block_time_delegate_has_seen;
       bool inhibit_fetching_sync_blocks;
@@ -253,14 +319,27 @@ namespace graphene { namespace net
       timestamped_items_set_type inventory_advertised_to_peer;
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+      fc::optional<block_message> pending_compact_block; /// a compact block from this peer waiting for the transactions we asked for
+      std::vector<uint32_t> pending_compact_block_missing_transactions; /// indexes of those transactions in pending_compact_block
+      bool pending_compact_block_used_our_transactions; /// whether a bad merkle root may be a short id collision in our cache
       /// @}
 
       // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
       // blockchain catch up
       fc::time_point transaction_fetching_inhibited_until;
 
+      /// transaction admission: a token bucket that pays for each transaction we request from this peer
+      /// @{
+      token_bucket   transaction_admission_tokens;
+      uint64_t       transactions_admitted; /// accepted by the client
+      uint64_t       transactions_rejected; /// rejected by the client
+      uint64_t       transaction_rate_limit_hits; /// times the peer ran out of tokens
+      /// @}
+
       uint32_t last_known_fork_block_number;
 
+      traffic_metrics metrics;
+
       fc::future<void> accept_or_connect_task_done;
 
       firewall_check_state_data *firewall_check_state;
@@ -277,6 +356,11 @@ namespace graphene { namespace net
       virtual ~peer_connection();
 
       fc::tcp_socket& get_socket();
+      /** reads and writes the connection on io_thread, messages are passed to the node with
+       *  queue_incoming_message.  call before accept_connection() or connect_to() */
+      void set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                         const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter);
+      bool reads_on_io_thread() const { return _reads_on_io_thread; }
       void accept_connection();
       void connect_to(const fc::ip::endpoint& remote_endpoint, fc::optional<fc::ip::endpoint> local_endpoint = fc::optional<fc::ip::endpoint>());
 
@@ -285,16 +369,24 @@ namespace graphene { namespace net
 
       void send_queueable_message(std::unique_ptr<queued_message>&& message_to_send);
       void send_message(const message& message_to_send, size_t message_send_time_field_offset = (size_t)-1);
+      /** queues a message without copying it, the caller must not modify it afterwards */
+      void send_message(shared_message_ptr message_to_send);
       void send_item(const item_id& item_to_send);
       void close_connection();
       void destroy_connection();
 
       uint64_t get_total_bytes_sent() const;
       uint64_t get_total_bytes_received() const;
+      size_t get_queued_message_count() const;
+      size_t get_total_queued_messages_size() const;
 
       fc::time_point get_last_message_sent_time() const;
       fc::time_point get_last_message_received_time() const;
 
+      void enable_compression();
+      double get_compression_ratio_sent() const;
+      double get_compression_ratio_received() const;
+
       fc::optional<fc::ip::endpoint> get_remote_endpoint();
       fc::ip::endpoint get_local_endpoint();
       void set_remote_endpoint(fc::optional<fc::ip::endpoint> new_remote_endpoint);
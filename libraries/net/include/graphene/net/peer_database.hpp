@@ -32,6 +32,8 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/raw.hpp>
 
+#include <vector>
+
 namespace graphene { namespace net {
 
   enum potential_peer_last_connection_disposition
@@ -52,10 +54,15 @@ namespace graphene { namespace net {
     uint32_t                          number_of_successful_connection_attempts;
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
+    fc::microseconds                  last_round_trip_delay; /// 0 if never measured
+    uint64_t                          seconds_connected; /// summed over all connections
+    uint64_t                          number_of_blocks_received;
 
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
-    number_of_failed_connection_attempts(0){}
+      number_of_failed_connection_attempts(0),
+      seconds_connected(0),
+      number_of_blocks_received(0){}
 
     potential_peer_record(fc::ip::endpoint endpoint,
                           fc::time_point_sec last_seen_time = fc::time_point_sec(),
@@ -64,8 +71,13 @@ namespace graphene { namespace net {
       last_seen_time(last_seen_time),
       last_connection_disposition(last_connection_disposition),
       number_of_successful_connection_attempts(0),
-      number_of_failed_connection_attempts(0)
+        number_of_failed_connection_attempts(0),
+      seconds_connected(0),
+      number_of_blocks_received(0)
     {}  
+
+    /** higher for peers that stayed connected, sent us blocks and answered quickly */
+    double get_score() const;
   };
 
   namespace detail
@@ -107,6 +119,8 @@ namespace graphene { namespace net {
     void update_entry(const potential_peer_record& updatedRecord);
     potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
     fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
+    /** all entries, best scored first */
+    std::vector<potential_peer_record> get_entries_by_score() const;
 
     typedef detail::peer_database_iterator iterator;
     iterator begin() const;
@@ -119,4 +133,5 @@ namespace graphene { namespace net {
 } } // end namespace graphene::net
 
 FC_REFLECT_ENUM(graphene::net::potential_peer_last_connection_disposition, (never_attempted_to_connect)(last_connection_failed)(last_connection_rejected)(last_connection_handshaking_failed)(last_connection_succeeded))
-FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error) )
+FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error)
+                                              (last_round_trip_delay)(seconds_connected)(number_of_blocks_received) )
@@ -26,6 +26,9 @@
 #include <fc/crypto/aes.hpp>
 #include <fc/crypto/elliptic.hpp>
 
+#include <utility>
+#include <vector>
+
 namespace graphene { namespace net {
 
 /**
@@ -53,11 +56,26 @@ class stcp_socket : public virtual fc::iostream
     virtual void     flush();
     virtual void     close();
 
+    /** encrypts the buffers, each a multiple of 16 bytes long, straight into one
+     *  ciphertext buffer and writes it with a single write */
+    void             write_buffers( const std::vector<std::pair<const char*, size_t> >& buffers );
+    /** reads exactly len bytes, a multiple of 16, and decrypts them with one call */
+    void             read_decrypted( char* buffer, size_t len );
+
+    /** everything written/read from now on uses aes 256 ctr instead of the original aes 256 cbc.
+     *  the two ends switch each direction at the same point of the stream */
+    void             switch_sending_to_ctr();
+    void             switch_receiving_to_ctr();
+
     using istream::get;
     void             get( char& c ) { read( &c, 1 ); }
     fc::sha512       get_shared_secret() const { return _shared_secret; }
   private:
-    void do_key_exchange();
+    void do_key_exchange( bool initiator );
+    void encrypt( const char* plaintext, size_t len, char* ciphertext );
+    void decrypt( const char* ciphertext, size_t len, char* plaintext );
+    void reserve_read_buffer( size_t len );
+    void reserve_write_buffer( size_t len );
 
     fc::sha512           _shared_secret;
     fc::ecc::private_key _priv_key;
@@ -66,8 +84,14 @@ class stcp_socket : public virtual fc::iostream
     fc::tcp_socket       _sock;
     fc::aes_encoder      _send_aes;
     fc::aes_decoder      _recv_aes;
+    fc::aes_encoder      _send_ctr_aes;
+    fc::aes_decoder      _recv_ctr_aes;
+    bool                 _sending_ctr;
+    bool                 _receiving_ctr;
     std::shared_ptr<char> _read_buffer;
+    size_t               _read_buffer_length;
     std::shared_ptr<char> _write_buffer;
+    size_t               _write_buffer_length;
 #ifndef NDEBUG
     bool _read_buffer_in_use;
     bool _write_buffer_in_use;
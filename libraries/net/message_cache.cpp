@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/net/message_cache.hpp>
+
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+namespace graphene { namespace net {
+
+  void blockchain_tied_message_cache::block_accepted()
+  {
+    ++block_clock;
+    if( block_clock > cache_duration_in_blocks )
+      _message_cache.get<block_clock_index>().erase(_message_cache.get<block_clock_index>().begin(),
+                                                    _message_cache.get<block_clock_index>().lower_bound(block_clock - cache_duration_in_blocks ) );
+  }
+
+  void blockchain_tied_message_cache::cache_message( const shared_message_ptr& message_to_cache,
+                                                   const message_hash_type& hash_of_message_to_cache,
+                                                   const message_propagation_data& propagation_data,
+                                                   const fc::uint160_t& message_content_hash )
+  {
+    _message_cache.insert( message_info(hash_of_message_to_cache,
+                                       message_to_cache,
+                                       block_clock,
+                                       propagation_data,
+                                       message_content_hash ) );
+  }
+
+  shared_message_ptr blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup )
+  {
+    message_cache_container::index<message_hash_index>::type::const_iterator iter =
+       _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
+    if( iter != _message_cache.get<message_hash_index>().end() )
+      return iter->message_body;
+    FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
+  }
+
+  message_propagation_data blockchain_tied_message_cache::get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
+  {
+    if( hash_of_message_contents_to_lookup != fc::uint160_t() )
+    {
+      message_cache_container::index<message_contents_hash_index>::type::const_iterator iter =
+         _message_cache.get<message_contents_hash_index>().find(hash_of_message_contents_to_lookup );
+      if( iter != _message_cache.get<message_contents_hash_index>().end() )
+        return iter->propagation_data;
+    }
+    FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
+  }
+
+  fc::optional<message_hash_type> blockchain_tied_message_cache::get_message_hash( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
+  {
+    message_cache_container::index<message_contents_hash_index>::type::const_iterator iter =
+       _message_cache.get<message_contents_hash_index>().find(hash_of_message_contents_to_lookup );
+    if( iter != _message_cache.get<message_contents_hash_index>().end() )
+      return iter->message_hash;
+    return fc::optional<message_hash_type>();
+  }
+
+  fc::optional<signed_transaction> blockchain_tied_message_cache::get_transaction( uint64_t short_transaction_id ) const
+  {
+    // the short id is a prefix of the transaction id, which orders the contents hash index
+    fc::uint160_t first_possible_id;
+    memcpy(first_possible_id.data(), &short_transaction_id, sizeof(short_transaction_id));
+    fc::optional<signed_transaction> result;
+    fc::optional<transaction_id_type> result_id;
+    for( auto iter = _message_cache.get<message_contents_hash_index>().lower_bound(first_possible_id);
+         iter != _message_cache.get<message_contents_hash_index>().end() &&
+         compact_block_short_id(iter->message_contents_hash) == short_transaction_id; ++iter )
+    {
+      if( iter->message_body->msg_type != trx_message_type )
+        continue;
+      if( result_id && *result_id != iter->message_contents_hash )
+        return fc::optional<signed_transaction>(); // ambiguous, let the peer send it
+      result_id = iter->message_contents_hash;
+      result = iter->message_body->as<trx_message>().trx;
+    }
+    return result;
+  }
+
+} } // graphene::net
@@ -27,8 +27,17 @@
 #include <fc/thread/future.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/enum_type.hpp>
+#include <fc/compress/zlib.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#include <fc/network/rate_limiting.hpp>
 
 #include <graphene/net/message_oriented_connection.hpp>
+#include <graphene/net/core_messages.hpp>
 #include <graphene/net/stcp_socket.hpp>
 #include <graphene/net/config.hpp>
 
@@ -52,13 +61,25 @@ namespace graphene { namespace net {
       message_oriented_connection* _self;
       message_oriented_connection_delegate *_delegate;
       stcp_socket _sock;
+      // with an io thread, the socket is read, written and closed only there
+      std::shared_ptr<fc::thread> _io_thread;
+      std::shared_ptr<fc::rate_limiting_group> _io_rate_limiter; // used on _io_thread only
       fc::future<void> _read_loop_done;
-      uint64_t _bytes_received;
-      uint64_t _bytes_sent;
+      fc::future<void> _write_done; // the last write on _io_thread
+      // written by the read and write loops, which may run on _io_thread
+      std::atomic<uint64_t> _bytes_received;
+      std::atomic<uint64_t> _bytes_sent;
+
+      bool _compression_enabled;
+      // sizes of the messages we were given and of what we actually sent, to measure compression
+      std::atomic<uint64_t> _message_bytes_sent;
+      std::atomic<uint64_t> _wire_message_bytes_sent;
+      std::atomic<uint64_t> _message_bytes_received;
+      std::atomic<uint64_t> _wire_message_bytes_received;
 
       fc::time_point _connected_time;
-      fc::time_point _last_message_received_time;
-      fc::time_point _last_message_sent_time;
+      std::atomic<int64_t> _last_message_received_time; // microseconds since epoch
+      std::atomic<int64_t> _last_message_sent_time; // microseconds since epoch
 
       bool _send_message_in_progress;
 
@@ -68,17 +89,21 @@ namespace graphene { namespace net {
 
       void read_loop();
       void start_read_loop();
+      void write_message(const shared_message_ptr& message_to_send);
     public:
       fc::tcp_socket& get_socket();
+      void set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                         const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter);
       void accept();
       void connect_to(const fc::ip::endpoint& remote_endpoint);
       void bind(const fc::ip::endpoint& local_endpoint);
+      void enable_compression();
 
       message_oriented_connection_impl(message_oriented_connection* self,
                                        message_oriented_connection_delegate* delegate = nullptr);
       ~message_oriented_connection_impl();
 
-      void send_message(const message& message_to_send);
+      void send_message(const shared_message_ptr& message_to_send);
       void close_connection();
       void destroy_connection();
 
@@ -87,6 +112,8 @@ namespace graphene { namespace net {
 
       fc::time_point get_last_message_sent_time() const;
       fc::time_point get_last_message_received_time() const;
+      double get_compression_ratio_sent() const;
+      double get_compression_ratio_received() const;
       fc::time_point get_connection_time() const { return _connected_time; }
       fc::sha512 get_shared_secret() const;
     };
@@ -97,6 +124,13 @@ namespace graphene { namespace net {
       _delegate(delegate),
       _bytes_received(0),
       _bytes_sent(0),
+      _compression_enabled(false),
+      _message_bytes_sent(0),
+      _wire_message_bytes_sent(0),
+      _message_bytes_received(0),
+      _wire_message_bytes_received(0),
+      _last_message_received_time(0),
+      _last_message_sent_time(0),
       _send_message_in_progress(false)
 #ifndef NDEBUG
       ,_thread(&fc::thread::current())
@@ -115,20 +149,38 @@ namespace graphene { namespace net {
       return _sock.get_socket();
     }
 
+    void message_oriented_connection_impl::set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                                                         const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter)
+    {
+      VERIFY_CORRECT_THREAD();
+      assert(!_read_loop_done.valid());
+      _io_thread = io_thread;
+      _io_rate_limiter = io_rate_limiter;
+    }
+
     void message_oriented_connection_impl::accept()
     {
       VERIFY_CORRECT_THREAD();
       _sock.accept();
-      assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-      _read_loop_done = fc::async([=](){ read_loop(); }, "message read_loop");
+      start_read_loop();
     }
 
     void message_oriented_connection_impl::connect_to(const fc::ip::endpoint& remote_endpoint)
     {
       VERIFY_CORRECT_THREAD();
       _sock.connect_to(remote_endpoint);
+      start_read_loop();
+    }
+
+    void message_oriented_connection_impl::start_read_loop()
+    {
+      VERIFY_CORRECT_THREAD();
       assert(!_read_loop_done.valid()); // check to be sure we never launch two read loops
-      _read_loop_done = fc::async([=](){ read_loop(); }, "message read_loop");
+      _connected_time = fc::time_point::now();
+      if (_io_thread)
+        _read_loop_done = _io_thread->async([=](){ read_loop(); }, "message read_loop");
+      else
+        _read_loop_done = fc::async([=](){ read_loop(); }, "message read_loop");
     }
 
     void message_oriented_connection_impl::bind(const fc::ip::endpoint& local_endpoint)
@@ -137,16 +189,94 @@ namespace graphene { namespace net {
       _sock.bind(local_endpoint);
     }
 
+    void message_oriented_connection_impl::enable_compression()
+    {
+      VERIFY_CORRECT_THREAD();
+      _compression_enabled = true;
+    }
+
+    // a compressed_message_type message holds the header of the original message followed by its deflated data.
+    // returns null when compressing doesn't make the message smaller
+    static shared_message_ptr compress_message(const message& message_to_compress)
+    {
+      std::string compressed_data = fc::zlib_compress(message_to_compress.data.data(), message_to_compress.data.size(),
+                                                      GRAPHENE_NET_COMPRESSION_LEVEL);
+      if (compressed_data.empty() || sizeof(message_header) + compressed_data.size() >= message_to_compress.size)
+        return shared_message_ptr();
+      std::shared_ptr<message> compressed_message = std::make_shared<message>();
+      compressed_message->msg_type = core_message_type_enum::compressed_message_type;
+      compressed_message->size = (uint32_t)(sizeof(message_header) + compressed_data.size());
+      compressed_message->data.resize(compressed_message->size);
+      memcpy(compressed_message->data.data(), (const char*)&message_to_compress, sizeof(message_header));
+      memcpy(compressed_message->data.data() + sizeof(message_header), compressed_data.data(), compressed_data.size());
+      return compressed_message;
+    }
+
+    // the compressed forms of the last messages sent compressed.  a block or transaction goes out to
+    // every peer within a short time, this compresses it for the first peer and reuses that for the
+    // others.  entries are found by the shared message they were made from, a copy of a message,
+    // e.g. one with the send time patched in, is compressed anew
+    class compressed_message_cache
+    {
+    public:
+      // null when compressing doesn't make the message smaller
+      shared_message_ptr get_compressed_message(const shared_message_ptr& message_to_compress)
+      {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          for (const entry& cached : _entries)
+            if (!cached.original.owner_before(message_to_compress) && !message_to_compress.owner_before(cached.original))
+              return cached.compressed;
+        }
+        // io threads compress outside the lock, two of them may compress the same message at once
+        entry new_entry{message_to_compress, compress_message(*message_to_compress)};
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[_next_entry] = new_entry;
+        _next_entry = (_next_entry + 1) % _entries.size();
+        return new_entry.compressed;
+      }
+
+    private:
+      struct entry
+      {
+        std::weak_ptr<const message> original;
+        shared_message_ptr compressed;
+      };
+      std::mutex _mutex;
+      std::array<entry, 8> _entries;
+      size_t _next_entry = 0;
+    };
+
+    static compressed_message_cache& get_compressed_message_cache()
+    {
+      static compressed_message_cache cache;
+      return cache;
+    }
+
+    static void decompress_message(const message& compressed_message, message& decompressed_message)
+    {
+      FC_ASSERT(compressed_message.data.size() >= sizeof(message_header), "compressed message too short");
+      memcpy((char*)&decompressed_message, compressed_message.data.data(), sizeof(message_header));
+      FC_ASSERT(decompressed_message.size <= MAX_MESSAGE_SIZE, "",
+                ("decompressed_message.size", decompressed_message.size)("MAX_MESSAGE_SIZE", MAX_MESSAGE_SIZE));
+      FC_ASSERT(decompressed_message.msg_type != core_message_type_enum::compressed_message_type, "nested compressed message");
+      decompressed_message.data.resize(decompressed_message.size);
+      FC_ASSERT(fc::zlib_decompress(compressed_message.data.data() + sizeof(message_header),
+                                    compressed_message.data.size() - sizeof(message_header),
+                                    decompressed_message.data.data(), decompressed_message.data.size()),
+                "invalid compressed message");
+    }
+
 
     void message_oriented_connection_impl::read_loop()
     {
-      VERIFY_CORRECT_THREAD();
+      assert(_io_thread ? _io_thread->is_current() : _thread->is_current());
+      if (_io_rate_limiter)
+        _io_rate_limiter->add_tcp_socket(&_sock.get_socket());
       const int BUFFER_SIZE = 16;
       const int LEFTOVER = BUFFER_SIZE - sizeof(message_header);
       static_assert(BUFFER_SIZE >= sizeof(message_header), "insufficient buffer");
 
-      _connected_time = fc::time_point::now();
-
       fc::oexception exception_to_rethrow;
       bool call_on_connection_closed = false;
 
@@ -167,17 +297,30 @@ namespace graphene { namespace net {
           std::copy(buffer + sizeof(message_header), buffer + sizeof(buffer), m.data.begin());
           if (remaining_bytes_with_padding)
           {
-            _sock.read(&m.data[LEFTOVER], remaining_bytes_with_padding);
+            _sock.read_decrypted(&m.data[LEFTOVER], remaining_bytes_with_padding);
             _bytes_received += remaining_bytes_with_padding;
           }
           m.data.resize(m.size); // truncate off the padding bytes
 
-          _last_message_received_time = fc::time_point::now();
+          _last_message_received_time = fc::time_point::now().time_since_epoch().count();
+
+          if (m.msg_type == core_message_type_enum::cipher_switch_message_type)
+          {
+            _sock.switch_receiving_to_ctr();
+            continue;
+          }
+
+          _wire_message_bytes_received += m.size;
+          message decompressed_message;
+          if (m.msg_type == core_message_type_enum::compressed_message_type)
+            decompress_message(m, decompressed_message);
+          const message& received_message = m.msg_type == core_message_type_enum::compressed_message_type ? decompressed_message : m;
+          _message_bytes_received += received_message.size;
 
           try
           {
             // message handling errors are warnings...
-            _delegate->on_message(_self, m);
+            _delegate->on_message(_self, received_message);
           }
           /// Dedicated catches needed to distinguish from general fc::exception
           catch ( const fc::canceled_exception& e ) { throw e; }
@@ -226,7 +369,7 @@ namespace graphene { namespace net {
         throw *exception_to_rethrow;
     }
 
-    void message_oriented_connection_impl::send_message(const message& message_to_send)
+    void message_oriented_connection_impl::send_message(const shared_message_ptr& message_to_send)
     {
       VERIFY_CORRECT_THREAD();
 #if 0 // this gets too verbose
@@ -253,27 +396,73 @@ namespace graphene { namespace net {
         ~verify_no_send_in_progress() { var = false; }
       } _verify_no_send_in_progress(_send_message_in_progress);
 
+      if (!_io_thread)
+      {
+        write_message(message_to_send);
+        return;
+      }
+      // a write left running by a canceled send_message must finish before the next one starts
+      if (_write_done.valid() && !_write_done.ready())
+        _write_done.wait();
+      // the message isn't modified once shared, the io thread writes it from where it is
+      _write_done = _io_thread->async([this, message_to_send](){ write_message(message_to_send); }, "write_message");
+      _write_done.wait();
+    }
+
+    void message_oriented_connection_impl::write_message(const shared_message_ptr& shared_message_to_send)
+    {
+      assert(_io_thread ? _io_thread->is_current() : _thread->is_current());
       try
       {
-        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
+        const message& message_to_send = *shared_message_to_send;
+        // compress before the socket encrypts it, encrypted data doesn't compress
+        shared_message_ptr compressed_message;
+        const message* message_to_write = &message_to_send;
+        if (_compression_enabled && message_to_send.size >= GRAPHENE_NET_MIN_SIZE_TO_COMPRESS)
+          compressed_message = get_compressed_message_cache().get_compressed_message(shared_message_to_send);
+        if (compressed_message)
+          message_to_write = compressed_message.get();
+
+        size_t size_of_message_and_header = sizeof(message_header) + message_to_write->size;
         if( message_to_send.size > MAX_MESSAGE_SIZE )
            elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
         //pad the message we send to a multiple of 16 bytes
         size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
-        std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
-        memcpy(padded_message.get(), (char*)&message_to_send, sizeof(message_header));
-        memcpy(padded_message.get() + sizeof(message_header), message_to_send.data.data(), message_to_send.size );
-        _sock.write(padded_message.get(), size_with_padding);
+
+        // the cipher works on 16 byte blocks: the first block holds the header and the start of the data,
+        // the blocks of data in between are encrypted from where they are, and the last block holds the
+        // rest of the data and the padding
+        const size_t LEFTOVER = 16 - sizeof(message_header);
+        char first_block[16] = {};
+        char last_block[16] = {};
+        memcpy(first_block, (const char*)message_to_write, sizeof(message_header));
+        size_t data_in_first_block = std::min<size_t>(LEFTOVER, message_to_write->size);
+        memcpy(first_block + sizeof(message_header), message_to_write->data.data(), data_in_first_block);
+        size_t middle_length = size_with_padding > 16 ? 16 * ((size_of_message_and_header - 16) / 16) : 0;
+        size_t last_length = size_with_padding - 16 - middle_length;
+        size_t data_in_last_block = message_to_write->size - data_in_first_block - middle_length;
+        if (last_length)
+          memcpy(last_block, message_to_write->data.data() + data_in_first_block + middle_length, data_in_last_block);
+        _sock.write_buffers({ {first_block, 16},
+                              {message_to_write->data.data() + data_in_first_block, middle_length},
+                              {last_block, last_length} });
         _sock.flush();
+        if (message_to_send.msg_type == core_message_type_enum::cipher_switch_message_type)
+          _sock.switch_sending_to_ctr();
         _bytes_sent += size_with_padding;
-        _last_message_sent_time = fc::time_point::now();
+        _message_bytes_sent += message_to_send.size;
+        _wire_message_bytes_sent += message_to_write->size;
+        _last_message_sent_time = fc::time_point::now().time_since_epoch().count();
       } FC_RETHROW_EXCEPTIONS( warn, "unable to send message" );
     }
 
     void message_oriented_connection_impl::close_connection()
     {
       VERIFY_CORRECT_THREAD();
-      _sock.close();
+      if (_io_thread)
+        _io_thread->async([this](){ _sock.close(); }, "close_connection").wait();
+      else
+        _sock.close();
     }
 
     void message_oriented_connection_impl::destroy_connection()
@@ -281,8 +470,14 @@ namespace graphene { namespace net {
       VERIFY_CORRECT_THREAD();
 
       fc::optional<fc::ip::endpoint> remote_endpoint;
-      if (_sock.get_socket().is_open())
-        remote_endpoint = _sock.get_socket().remote_endpoint();
+      auto get_remote_endpoint = [this, &remote_endpoint]() {
+        if (_sock.get_socket().is_open())
+          remote_endpoint = _sock.get_socket().remote_endpoint();
+      };
+      if (_io_thread)
+        _io_thread->async(get_remote_endpoint, "get_remote_endpoint").wait();
+      else
+        get_remote_endpoint();
       ilog( "in destroy_connection() for ${endpoint}", ("endpoint", remote_endpoint) );
 
       if (_send_message_in_progress)
@@ -302,6 +497,21 @@ namespace graphene { namespace net {
       {
         wlog( "Exception thrown while canceling message_oriented_connection's read_loop, ignoring" );
       }
+
+      if (_io_thread)
+      {
+        try
+        {
+          if (_write_done.valid())
+            _write_done.cancel_and_wait(__FUNCTION__);
+        }
+        catch ( const fc::exception& e )
+        {
+          wlog( "Exception thrown while canceling message_oriented_connection's write, ignoring: ${e}", ("e",e) );
+        }
+        if (_io_rate_limiter)
+          _io_thread->async([this](){ _io_rate_limiter->remove_tcp_socket(&_sock.get_socket()); }, "remove_tcp_socket").wait();
+      }
     }
 
     uint64_t message_oriented_connection_impl::get_total_bytes_sent() const
@@ -319,13 +529,27 @@ namespace graphene { namespace net {
     fc::time_point message_oriented_connection_impl::get_last_message_sent_time() const
     {
       VERIFY_CORRECT_THREAD();
-      return _last_message_sent_time;
+      return fc::time_point(fc::microseconds(_last_message_sent_time));
     }
 
     fc::time_point message_oriented_connection_impl::get_last_message_received_time() const
     {
       VERIFY_CORRECT_THREAD();
-      return _last_message_received_time;
+      return fc::time_point(fc::microseconds(_last_message_received_time));
+    }
+
+    double message_oriented_connection_impl::get_compression_ratio_sent() const
+    {
+      VERIFY_CORRECT_THREAD();
+      uint64_t message_bytes_sent = _message_bytes_sent;
+      return message_bytes_sent ? (double)_wire_message_bytes_sent / message_bytes_sent : 1.;
+    }
+
+    double message_oriented_connection_impl::get_compression_ratio_received() const
+    {
+      VERIFY_CORRECT_THREAD();
+      uint64_t message_bytes_received = _message_bytes_received;
+      return message_bytes_received ? (double)_wire_message_bytes_received / message_bytes_received : 1.;
     }
 
     fc::sha512 message_oriented_connection_impl::get_shared_secret() const
@@ -351,6 +575,12 @@ namespace graphene { namespace net {
     return my->get_socket();
   }
 
+  void message_oriented_connection::set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                                                  const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter)
+  {
+    my->set_io_thread(io_thread, io_rate_limiter);
+  }
+
   void message_oriented_connection::accept()
   {
     my->accept();
@@ -366,7 +596,12 @@ namespace graphene { namespace net {
     my->bind(local_endpoint);
   }
 
-  void message_oriented_connection::send_message(const message& message_to_send)
+  void message_oriented_connection::enable_compression()
+  {
+    my->enable_compression();
+  }
+
+  void message_oriented_connection::send_message(const shared_message_ptr& message_to_send)
   {
     my->send_message(message_to_send);
   }
@@ -400,6 +635,16 @@ namespace graphene { namespace net {
   {
     return my->get_last_message_received_time();
   }
+  double message_oriented_connection::get_compression_ratio_sent() const
+  {
+    return my->get_compression_ratio_sent();
+  }
+
+  double message_oriented_connection::get_compression_ratio_received() const
+  {
+    return my->get_compression_ratio_received();
+  }
+
   fc::time_point message_oriented_connection::get_connection_time() const
   {
     return my->get_connection_time();
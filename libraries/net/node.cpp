@@ -30,8 +30,11 @@
 #include <iostream>
 #include <algorithm>
 #include <tuple>
+#include <mutex>
+#include <thread>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
+#include <boost/lockfree/queue.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -77,6 +80,7 @@
 #include <graphene/net/stcp_socket.hpp>
 #include <graphene/net/config.hpp>
 #include <graphene/net/exceptions.hpp>
+#include <graphene/net/message_cache.hpp>
 
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
@@ -123,106 +127,6 @@ namespace graphene { namespace net {
 
   namespace detail
   {
-    namespace bmi = boost::multi_index;
-    class blockchain_tied_message_cache
-    {
-    private:
-      static const uint32_t cache_duration_in_blocks = GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS;
-
-      struct message_hash_index{};
-      struct message_contents_hash_index{};
-      struct block_clock_index{};
-      struct message_info
-      {
-        message_hash_type message_hash;
-        message           message_body;
-        uint32_t          block_clock_when_received;
-
-        // for network performance stats
-        message_propagation_data propagation_data;
-        fc::uint160_t     message_contents_hash; // hash of whatever the message contains (if it's a transaction, this is the transaction id, if it's a block, it's the block_id)
-
-        message_info( const message_hash_type& message_hash,
-                      const message&           message_body,
-                      uint32_t                 block_clock_when_received,
-                      const message_propagation_data& propagation_data,
-                      fc::uint160_t            message_contents_hash ) :
-          message_hash( message_hash ),
-          message_body( message_body ),
-          block_clock_when_received( block_clock_when_received ),
-          propagation_data( propagation_data ),
-          message_contents_hash( message_contents_hash )
-        {}
-      };
-      typedef boost::multi_index_container
-        < message_info,
-            bmi::indexed_by< bmi::ordered_unique< bmi::tag<message_hash_index>,
-                                                  bmi::member<message_info, message_hash_type, &message_info::message_hash> >,
-                             bmi::ordered_non_unique< bmi::tag<message_contents_hash_index>,
-                                                      bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash> >,
-                             bmi::ordered_non_unique< bmi::tag<block_clock_index>,
-                                                      bmi::member<message_info, uint32_t, &message_info::block_clock_when_received> > >
-        > message_cache_container;
-
-      message_cache_container _message_cache;
-
-      uint32_t block_clock;
-
-    public:
-      blockchain_tied_message_cache() :
-        block_clock( 0 )
-      {}
-      void block_accepted();
-      void cache_message( const message& message_to_cache, const message_hash_type& hash_of_message_to_cache,
-                        const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
-      message get_message( const message_hash_type& hash_of_message_to_lookup );
-      message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
-      size_t size() const { return _message_cache.size(); }
-    };
-
-    void blockchain_tied_message_cache::block_accepted()
-    {
-      ++block_clock;
-      if( block_clock > cache_duration_in_blocks )
-        _message_cache.get<block_clock_index>().erase(_message_cache.get<block_clock_index>().begin(),
-                                                      _message_cache.get<block_clock_index>().lower_bound(block_clock - cache_duration_in_blocks ) );
-    }
-
-    void blockchain_tied_message_cache::cache_message( const message& message_to_cache,
-                                                     const message_hash_type& hash_of_message_to_cache,
-                                                     const message_propagation_data& propagation_data,
-                                                     const fc::uint160_t& message_content_hash )
-    {
-      _message_cache.insert( message_info(hash_of_message_to_cache,
-                                         message_to_cache,
-                                         block_clock,
-                                         propagation_data,
-                                         message_content_hash ) );
-    }
-
-    message blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup )
-    {
-      message_cache_container::index<message_hash_index>::type::const_iterator iter =
-         _message_cache.get<message_hash_index>().find(hash_of_message_to_lookup );
-      if( iter != _message_cache.get<message_hash_index>().end() )
-        return iter->message_body;
-      FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
-    }
-
-    message_propagation_data blockchain_tied_message_cache::get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
-    {
-      if( hash_of_message_contents_to_lookup != fc::uint160_t() )
-      {
-        message_cache_container::index<message_contents_hash_index>::type::const_iterator iter =
-           _message_cache.get<message_contents_hash_index>().find(hash_of_message_contents_to_lookup );
-        if( iter != _message_cache.get<message_contents_hash_index>().end() )
-          return iter->propagation_data;
-      }
-      FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
-    }
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////
-
     // This specifies configuration info for the local node.  It's stored as JSON
     // in the configuration directory (application data directory)
     struct node_configuration
@@ -288,9 +192,13 @@ namespace graphene { namespace net { namespace detail {
 #define NODE_DELEGATE_METHOD_NAMES (has_item) \
                                    (handle_message) \
                                    (handle_block) \
+                                   (handle_sync_blocks) \
                                    (handle_transaction) \
+                                   (handle_transactions) \
                                    (get_block_ids) \
                                    (get_item) \
+                                   (get_block_header) \
+                                   (get_block_signing_schedule) \
                                    (get_chain_id) \
                                    (get_blockchain_synopsis) \
                                    (sync_status) \
@@ -384,11 +292,15 @@ namespace graphene { namespace net { namespace detail {
       bool has_item( const net::item_id& id ) override;
       void handle_message( const message& ) override;
       bool handle_block( const graphene::net::block_message& block_message, bool sync_mode, std::vector<fc::uint160_t>& contained_transaction_message_ids ,bool stoppable=false) override;
+      std::vector<fc::oexception> handle_sync_blocks( const std::vector<graphene::net::block_message>& block_messages ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
+      std::vector<fc::oexception> handle_transactions( const std::vector<graphene::net::trx_message>& transaction_messages ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
                                              uint32_t limit = 2000) override;
       message get_item( const item_id& id ) override;
+      signed_block_header get_block_header( const item_hash_t& block_id ) override;
+      block_signing_schedule get_block_signing_schedule() override;
       chain_id_type get_chain_id() const override;
       std::vector<item_hash_t> get_blockchain_synopsis(const item_hash_t& reference_point, 
                                                        uint32_t number_of_blocks_after_reference_point) override;
@@ -414,7 +326,7 @@ namespace graphene { namespace net { namespace detail {
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat" // converted from peers.json the first time it is opened
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -448,8 +360,15 @@ namespace graphene { namespace net { namespace detail {
       typedef std::unordered_map<graphene::net::block_id_type, fc::time_point> active_sync_requests_map;
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-      std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain.
+      /// a block id starts with the big-endian block number, so this is ordered by block number
+      received_sync_blocks                  _received_sync_items;
+      std::set<item_hash_t> _active_sync_header_requests; /// sync blocks whose headers we've asked a peer for but have not yet checked
+      std::set<item_hash_t> _verified_sync_block_headers; /// sync blocks whose headers passed our checks, so we can fetch them from any peer
+      /// sync blocks whose headers passed our checks but are signed by a key no miner we know has, yet.
+      /// we only fetch those from the peers that sent us the headers
+      std::map<item_hash_t, std::set<node_id_t> > _sync_block_headers_with_unknown_signer;
+      std::vector<std::shared_ptr<fc::thread> > _header_verification_threads; /// created the first time we check headers
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -461,6 +380,37 @@ namespace graphene { namespace net { namespace detail {
       bool                   _items_to_fetch_updated;
       fc::future<void>       _fetch_item_loop_done;
 
+      /// used by the task that handles the messages read by the io threads
+      // @{
+      struct queued_incoming_message
+      {
+        std::weak_ptr<peer_connection> originating_peer;
+        fc::optional<message> received_message; // unset when the connection was closed
+      };
+      struct queued_transaction
+      {
+        peer_connection_ptr originating_peer;
+        message message_to_process;
+        message_hash_type message_hash;
+        fc::time_point message_receive_time;
+        trx_message transaction_message;
+      };
+      struct connection_io_thread
+      {
+        std::shared_ptr<fc::thread> thread;
+        std::shared_ptr<fc::rate_limiting_group> rate_limiter; /// limits the connections of this thread, only used on it
+      };
+      std::vector<connection_io_thread> _io_threads; /// threads reading and writing the peer connections, empty to use our thread
+      uint32_t               _next_io_thread;
+      boost::lockfree::queue<queued_incoming_message*, boost::lockfree::fixed_sized<true> > _queued_incoming_messages;
+      /// guards _retrigger_process_queued_incoming_messages_loop_promise, which the io threads set, and
+      /// _queued_incoming_messages_room_promise, which the io threads wait on while the queue is full
+      std::mutex             _queued_incoming_messages_mutex;
+      fc::promise<void>::ptr _queued_incoming_messages_room_promise;
+      fc::promise<void>::ptr _retrigger_process_queued_incoming_messages_loop_promise;
+      fc::future<void>       _process_queued_incoming_messages_loop_done;
+      // @}
+
       struct item_id_index{};
       typedef boost::multi_index_container<prioritized_item_id,
                                            boost::multi_index::indexed_by<boost::multi_index::ordered_unique<boost::multi_index::identity<prioritized_item_id> >,
@@ -520,6 +470,7 @@ namespace graphene { namespace net { namespace detail {
       std::unordered_set<peer_connection_ptr>                     _closing_connections;
       /** stores connections we've closed, but are still waiting for the OS to notify us that the socket is really closed */
       std::unordered_set<peer_connection_ptr>                     _terminating_connections;
+      traffic_metrics                                             _closed_connection_metrics; /// so the totals include connections that are gone
 
       boost::circular_buffer<item_hash_t> _most_recent_blocks_accepted; // the /n/ most recent blocks we've accepted (currently tuned to the max number of connections)
 
@@ -575,8 +526,11 @@ namespace graphene { namespace net { namespace detail {
       unsigned _maximum_number_of_blocks_to_handle_at_one_time;
       unsigned _maximum_number_of_sync_blocks_to_prefetch;
       unsigned _maximum_blocks_per_peer_during_syncing;
+      unsigned _maximum_transactions_per_second_per_peer; /// 0 to fetch transactions from peers as fast as they come
+      unsigned _maximum_transaction_burst_per_peer;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
+      unsigned _sync_blocks_being_handled; /// blocks of the calls in _handle_message_calls_in_progress
 
       node_impl(const std::string& user_agent);
       virtual ~node_impl();
@@ -677,9 +631,30 @@ namespace graphene { namespace net { namespace detail {
       void on_get_current_connections_reply_message(peer_connection* originating_peer,
                                                     const get_current_connections_reply_message& get_current_connections_reply_message_received);
 
+      message make_compact_block_message(peer_connection* peer, const graphene::net::block_message& block_message_to_send);
+      void on_compact_block_message(peer_connection* originating_peer,
+                                    const compact_block_message& compact_block_message_received);
+      void on_get_compact_block_transactions_message(peer_connection* originating_peer,
+                                                     const get_compact_block_transactions_message& get_compact_block_transactions_message_received);
+      void on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                 const compact_block_transactions_message& compact_block_transactions_message_received);
+      void process_reconstructed_compact_block(peer_connection* originating_peer);
+
+      void request_block_headers_from_peer(const peer_connection_ptr& peer, const std::vector<item_hash_t>& block_ids,
+                                           const fc::optional<item_hash_t>& previous_block_id);
+      void on_get_block_headers_message(peer_connection* originating_peer,
+                                        const get_block_headers_message& get_block_headers_message_received);
+      void on_block_headers_message(peer_connection* originating_peer,
+                                    const block_headers_message& block_headers_message_received);
+      size_t check_block_headers_in_parallel(const std::vector<signed_block_header>& headers,
+                                             const std::vector<item_hash_t>& block_ids,
+                                             std::vector<fc::ecc::public_key_data>& signers);
+      void forget_sync_block_headers(const peer_connection_ptr& peer);
+
       void on_connection_closed(peer_connection* originating_peer) override;
 
-      void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
+      void send_sync_blocks_to_node_delegate(const std::vector<graphene::net::block_message>& block_messages_to_send);
+      void finish_sync_block(const graphene::net::block_message& block_message_to_send, const fc::oexception& handle_message_exception);
       void process_backlog_of_sync_blocks();
       void trigger_process_backlog_of_sync_blocks();
       void process_block_during_sync(peer_connection* originating_peer, const graphene::net::block_message& block_message, const message_hash_type& message_hash);
@@ -687,6 +662,22 @@ namespace graphene { namespace net { namespace detail {
       void process_block_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
 
       void process_ordinary_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      bool take_requested_item(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash);
+      void finish_ordinary_message(peer_connection* originating_peer, const message& message_to_process, const message_hash_type& message_hash,
+                                   fc::time_point message_receive_time, const fc::oexception& rejection);
+
+      bool take_transaction_admission_token(peer_connection* peer);
+
+      void set_io_thread_count(uint32_t io_thread_count);
+      void set_io_thread_bandwidth_limits();
+      void start_connection_io(const peer_connection_ptr& new_peer);
+      void queue_incoming_message(const std::weak_ptr<peer_connection>& originating_peer,
+                                  const fc::optional<message>& received_message) override;
+      void process_queued_incoming_messages_loop();
+      void trigger_process_queued_incoming_messages_loop();
+      void notify_queued_incoming_messages_room();
+      void process_queued_incoming_messages();
+      void process_queued_transactions(std::vector<queued_transaction>& transactions);
 
       void start_synchronizing();
       void start_synchronizing_with_peer(const peer_connection_ptr& peer);
@@ -750,10 +741,13 @@ namespace graphene { namespace net { namespace detail {
       void                       set_total_bandwidth_limit( uint32_t upload_bytes_per_second, uint32_t download_bytes_per_second );
       void                       disable_peer_advertising();
       fc::variant_object         get_call_statistics() const;
-      message                    get_message_for_item(const item_id& item) override;
+      shared_message_ptr         get_message_for_item(const item_id& item) override;
 
       fc::variant_object         network_get_info() const;
       fc::variant_object         network_get_usage_stats() const;
+      traffic_metrics            get_total_traffic_metrics() const;
+      fc::variant_object         get_p2p_metrics() const;
+      std::string                get_p2p_metrics_text() const;
 
       bool is_hard_fork_block(uint32_t block_number) const;
       uint32_t get_next_known_hard_fork_block_number(uint32_t block_number) const;
@@ -801,6 +795,8 @@ namespace graphene { namespace net { namespace detail {
       _sync_items_to_fetch_updated(false),
       _suspend_fetching_sync_blocks(false),
       _items_to_fetch_updated(false),
+      _next_io_thread(0),
+      _queued_incoming_messages(GRAPHENE_NET_MAX_QUEUED_INCOMING_MESSAGES),
       _items_to_fetch_sequence_counter(0),
       _recent_block_interval_in_seconds(GRAPHENE_MAX_BLOCK_INTERVAL),
       _user_agent_string(user_agent),
@@ -824,10 +820,14 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _maximum_transactions_per_second_per_peer(GRAPHENE_NET_DEFAULT_MAX_TRX_PER_SECOND_PER_PEER),
+      _maximum_transaction_burst_per_peer(GRAPHENE_NET_DEFAULT_MAX_TRX_BURST_PER_PEER),
+      _sync_blocks_being_handled(0)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_pseudo_bytes(&_node_id.data[0], (int)_node_id.size());
+      set_io_thread_count(GRAPHENE_NET_DEFAULT_IO_THREADS);
     }
 
     node_impl::~node_impl()
@@ -859,6 +859,11 @@ namespace graphene { namespace net { namespace detail {
       {
         wlog( "unexpected exception on close ${e}", ("e", e) );
       }
+
+      // messages read after the processing loop stopped
+      queued_incoming_message* unprocessed_message = nullptr;
+      while (_queued_incoming_messages.pop(unprocessed_message))
+        delete unprocessed_message;
       ilog( "done" );
     }
 
@@ -920,8 +925,10 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
+            // try the peers that served us best first
+            std::vector<potential_peer_record> potential_peers = _potential_peer_db.get_entries_by_score();
+            for (auto iter = potential_peers.begin();
+                 iter != potential_peers.end() && is_wanting_new_connections();
                  ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
@@ -990,10 +997,7 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      return _received_sync_items.find(item_hash) != _received_sync_items.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -1032,10 +1036,12 @@ namespace graphene { namespace net { namespace detail {
         if (!_suspend_fetching_sync_blocks)
         {
           std::map<peer_connection_ptr, std::vector<item_hash_t> > sync_item_requests_to_send;
+          std::map<peer_connection_ptr, std::pair<std::vector<item_hash_t>, fc::optional<item_hash_t> > > block_header_requests_to_send;
 
           {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
+            std::set<item_hash_t> sync_headers_to_request;
 
             // for each idle peer that we're syncing with
             for( const peer_connection_ptr& peer : _active_connections )
@@ -1055,6 +1061,29 @@ namespace graphene { namespace net { namespace detail {
                         sync_items_to_request.find(item_to_potentially_request) == sync_items_to_request.end() &&  // we have already decided to request it from another peer during this iteration
                         _active_sync_requests.find(item_to_potentially_request) == _active_sync_requests.end() ) // we've requested it in a previous iteration and we're still waiting for it to arrive
                     {
+                      // a peer that can send headers must pass the header check before we download the blocks.
+                      // once checked, the blocks can come from any peer that has them
+                      auto unknown_signer_iter = _sync_block_headers_with_unknown_signer.find(item_to_potentially_request);
+                      if( peer->supports_block_headers &&
+                          _verified_sync_block_headers.find(item_to_potentially_request) == _verified_sync_block_headers.end() &&
+                          (unknown_signer_iter == _sync_block_headers_with_unknown_signer.end() ||
+                           unknown_signer_iter->second.find(peer->node_id) == unknown_signer_iter->second.end()) )
+                      {
+                        if( sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() &&
+                            sync_headers_to_request.find(item_to_potentially_request) == sync_headers_to_request.end() &&
+                            _active_sync_header_requests.find(item_to_potentially_request) == _active_sync_header_requests.end() )
+                        {
+                          std::vector<item_hash_t>& header_ids = block_header_requests_to_send[peer].first;
+                          for( unsigned j = i; j < peer->ids_of_items_to_get.size() && header_ids.size() < GRAPHENE_NET_MAX_BLOCK_HEADERS_PER_FETCH; ++j )
+                          {
+                            header_ids.push_back(peer->ids_of_items_to_get[j]);
+                            sync_headers_to_request.insert(peer->ids_of_items_to_get[j]);
+                          }
+                          if( i > 0 )
+                            block_header_requests_to_send[peer].second = peer->ids_of_items_to_get[i - 1];
+                        }
+                        break;
+                      }
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
@@ -1071,6 +1100,9 @@ namespace graphene { namespace net { namespace detail {
           for( auto sync_item_request : sync_item_requests_to_send )
             request_sync_items_from_peer( sync_item_request.first, sync_item_request.second );
           sync_item_requests_to_send.clear();
+          for( const auto& block_header_request : block_header_requests_to_send )
+            request_block_headers_from_peer( block_header_request.first, block_header_request.second.first, block_header_request.second.second );
+          block_header_requests_to_send.clear();
         }
         else
           dlog("fetch_sync_items_loop is suspended pending backlog processing");
@@ -1161,7 +1193,8 @@ namespace graphene { namespace net { namespace detail {
               if (peer_iter->item_ids.size() < GRAPHENE_NET_MAX_ITEMS_PER_PEER_DURING_NORMAL_OPERATION &&
                   peer->inventory_peer_advertised_to_us.find(item_iter->item) != peer->inventory_peer_advertised_to_us.end())
               {
-                if (item_iter->item.item_type == graphene::net::trx_message_type && peer->is_transaction_fetching_inhibited())
+                if (item_iter->item.item_type == graphene::net::trx_message_type &&
+                    (peer->is_transaction_fetching_inhibited() || !take_transaction_admission_token(peer.get())))
                   next_peer_unblocked_time = std::min(peer->transaction_fetching_inhibited_until, next_peer_unblocked_time);
                 else
                 {
@@ -1399,6 +1432,15 @@ namespace graphene { namespace net { namespace detail {
                       ("synopsis", active_peer->item_ids_requested_from_peer->get<0>()));
                 disconnect_due_to_request_timeout = true;
               }
+            if (!disconnect_due_to_request_timeout &&
+                active_peer->block_headers_requested_from_peer &&
+                active_peer->block_headers_requested_from_peer->get<1>() < active_ignored_request_threshold)
+              {
+                wlog("Disconnecting peer ${peer} because they didn't respond to my request for ${count} block headers",
+                      ("peer", active_peer->get_remote_endpoint())
+                      ("count", active_peer->block_headers_requested_from_peer->get<0>().size()));
+                disconnect_due_to_request_timeout = true;
+              }
             if (!disconnect_due_to_request_timeout)
               for (const peer_connection::item_to_time_map_type::value_type& item_and_time : active_peer->items_requested_from_peer)
                 if (item_and_time.second < active_ignored_request_threshold)
@@ -1564,6 +1606,15 @@ namespace graphene { namespace net { namespace detail {
       seconds_since_last_update = std::max(UINT32_C(1), seconds_since_last_update);
       uint32_t bytes_read_this_second = _rate_limiter.get_actual_download_rate();
       uint32_t bytes_written_this_second = _rate_limiter.get_actual_upload_rate();
+      for (const connection_io_thread& io_thread : _io_threads)
+      {
+        std::shared_ptr<fc::rate_limiting_group> rate_limiter = io_thread.rate_limiter;
+        std::pair<uint32_t, uint32_t> io_thread_rates = io_thread.thread->async([rate_limiter]() {
+          return std::make_pair(rate_limiter->get_actual_download_rate(), rate_limiter->get_actual_upload_rate());
+        }, "get_actual_rates").wait();
+        bytes_read_this_second += io_thread_rates.first;
+        bytes_written_this_second += io_thread_rates.second;
+      }
       for (uint32_t i = 0; i < seconds_since_last_update - 1; ++i)
         update_bandwidth_data(0, 0);
       update_bandwidth_data(bytes_read_this_second, bytes_written_this_second);
@@ -1751,6 +1802,7 @@ namespace graphene { namespace net { namespace detail {
            ("type", graphene::net::core_message_type_enum(received_message.msg_type))("hash", message_hash)
            ("size", received_message.size)
            ("endpoint", originating_peer->get_remote_endpoint()));
+      originating_peer->metrics.count_received_message(received_message);
       switch ( received_message.msg_type )
       {
       case core_message_type_enum::hello_message_type:
@@ -1807,6 +1859,21 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::get_current_connections_reply_message_type:
         on_get_current_connections_reply_message(originating_peer, received_message.as<get_current_connections_reply_message>());
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::get_compact_block_transactions_message_type:
+        on_get_compact_block_transactions_message(originating_peer, received_message.as<get_compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::compact_block_transactions_message_type:
+        on_compact_block_transactions_message(originating_peer, received_message.as<compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::get_block_headers_message_type:
+        on_get_block_headers_message(originating_peer, received_message.as<get_block_headers_message>());
+        break;
+      case core_message_type_enum::block_headers_message_type:
+        on_block_headers_message(originating_peer, received_message.as<block_headers_message>());
+        break;
 
       default:
         // ignore any message in between core_message_type_first and _last that we don't handle above
@@ -1850,6 +1917,11 @@ namespace graphene { namespace net { namespace detail {
       if (!_hard_fork_block_numbers.empty())
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
 
+      user_data["compact_blocks"] = true;
+      user_data["compression"] = "zlib";
+      user_data["cipher"] = "aes-256-ctr";
+      user_data["block_headers"] = true;
+
       return user_data;
     }
     void node_impl::parse_hello_user_data_for_peer(peer_connection* originating_peer, const fc::variant_object& user_data)
@@ -1872,6 +1944,18 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>();
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>();
+      originating_peer->supports_compact_blocks = originating_peer->core_protocol_version >= GRAPHENE_NET_COMPACT_BLOCKS_PROTOCOL_VERSION &&
+                                                  user_data.contains("compact_blocks") && user_data["compact_blocks"].as_bool();
+      originating_peer->supports_block_headers = originating_peer->core_protocol_version >= GRAPHENE_NET_BLOCK_HEADERS_PROTOCOL_VERSION &&
+                                                 user_data.contains("block_headers") && user_data["block_headers"].as_bool();
+      if (originating_peer->core_protocol_version >= GRAPHENE_NET_COMPRESSION_PROTOCOL_VERSION &&
+          user_data.contains("compression") && user_data["compression"].as_string() == "zlib")
+        originating_peer->enable_compression();
+      // everything we send after the switch message is encrypted with ctr, the peer does the same
+      // for its direction when it parses our hello
+      if (originating_peer->core_protocol_version >= GRAPHENE_NET_CTR_CIPHER_PROTOCOL_VERSION &&
+          user_data.contains("cipher") && user_data["cipher"].as_string() == "aes-256-ctr")
+        originating_peer->send_message(cipher_switch_message());
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2439,6 +2523,7 @@ namespace graphene { namespace net { namespace detail {
       // ignore unless we asked for the data
       if( originating_peer->item_ids_requested_from_peer )
       {
+        originating_peer->metrics.item_ids_latency.record(fc::time_point::now() - originating_peer->item_ids_requested_from_peer->get<1>());
         // verify that the peer's the block ids the peer sent is a valid response to our request;
         // It should either be an empty list of blocks, or a list of blocks that builds off of one of 
         // the blocks in the synopsis we sent
@@ -2699,7 +2784,7 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
-    message node_impl::get_message_for_item(const item_id& item)
+    shared_message_ptr node_impl::get_message_for_item(const item_id& item)
     {
       try
       {
@@ -2709,11 +2794,11 @@ namespace graphene { namespace net { namespace detail {
       {}
       try
       {
-        return _delegate->get_item(item);
+        return std::make_shared<const message>(_delegate->get_item(item));
       }
       catch (fc::key_not_found_exception&)
       {}
-      return item_not_available_message(item);
+      return std::make_shared<const message>(item_not_available_message(item));
     }
 
     void node_impl::on_fetch_items_message(peer_connection* originating_peer, const fetch_items_message& fetch_items_message_received)
@@ -2724,18 +2809,22 @@ namespace graphene { namespace net { namespace detail {
            ("type", fetch_items_message_received.item_type)
            ("endpoint", originating_peer->get_remote_endpoint()));
 
-      fc::optional<message> last_block_message_sent;
+      shared_message_ptr last_block_message_sent;
 
-      std::list<message> reply_messages;
+      std::list<shared_message_ptr> reply_messages;
       for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
       {
         try
         {
-          message requested_message = _message_cache.get_message(item_hash);
+          shared_message_ptr requested_message = _message_cache.get_message(item_hash);
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
-               ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
+               ("id", requested_message->id()));
+          // blocks still in the cache are new ones, the peer has probably seen most of their transactions
+          if (requested_message->msg_type == block_message_type && originating_peer->supports_compact_blocks)
+            reply_messages.push_back(std::make_shared<const message>(make_compact_block_message(originating_peer, requested_message->as<graphene::net::block_message>())));
+          else
+            reply_messages.push_back(requested_message);
           if (fetch_items_message_received.item_type == block_message_type)
             last_block_message_sent = requested_message;
           continue;
@@ -2748,10 +2837,10 @@ namespace graphene { namespace net { namespace detail {
         item_id item_to_fetch(fetch_items_message_received.item_type, item_hash);
         try
         {
-          message requested_message = _delegate->get_item(item_to_fetch);
+          shared_message_ptr requested_message = std::make_shared<const message>(_delegate->get_item(item_to_fetch));
           dlog("received item request from peer ${endpoint}, returning the item from delegate with id ${id} size ${size}",
-               ("id", requested_message.id())
-               ("size", requested_message.size)
+               ("id", requested_message->id())
+               ("size", requested_message->size)
                ("endpoint", originating_peer->get_remote_endpoint()));
           reply_messages.push_back(requested_message);
           if (fetch_items_message_received.item_type == block_message_type)
@@ -2760,7 +2849,7 @@ namespace graphene { namespace net { namespace detail {
         }
         catch (fc::key_not_found_exception&)
         {
-          reply_messages.push_back(item_not_available_message(item_to_fetch));
+          reply_messages.push_back(std::make_shared<const message>(item_not_available_message(item_to_fetch)));
           dlog("received item request from peer ${endpoint} but we don't have it",
                ("endpoint", originating_peer->get_remote_endpoint()));
         }
@@ -2774,10 +2863,10 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->last_block_time_delegate_has_seen = _delegate->get_block_time(block.block_id);
       }
 
-      for (const message& reply : reply_messages)
+      for (const shared_message_ptr& reply : reply_messages)
       {
-        if (reply.msg_type == block_message_type)
-          originating_peer->send_item(item_id(block_message_type, reply.as<graphene::net::block_message>().block_id));
+        if (reply->msg_type == block_message_type)
+          originating_peer->send_item(item_id(block_message_type, reply->as<graphene::net::block_message>().block_id));
         else
           originating_peer->send_message(reply);
       }
@@ -2843,6 +2932,9 @@ namespace graphene { namespace net { namespace detail {
             we_requested_this_item_from_a_peer = true;
         }
 
+        if (we_advertised_this_item_to_a_peer || we_requested_this_item_from_a_peer)
+          ++originating_peer->metrics.duplicate_inventory_received;
+
         // if we have already advertised it to a peer, we must have it, no need to do anything else
         if (!we_advertised_this_item_to_a_peer)
         {
@@ -2876,6 +2968,7 @@ namespace graphene { namespace net { namespace detail {
               {
                 // another peer has told us about this item already, but this peer just told us it has the item
                 // too, we can expect it to be around in this peer's cache for longer, so update its timestamp
+                ++originating_peer->metrics.duplicate_inventory_received;
                 _items_to_fetch.get<item_id_index>().modify(items_to_fetch_iter,
                                                             [](prioritized_item_id& item) { item.timestamp = fc::time_point::now(); });
               } 
@@ -2921,7 +3014,10 @@ namespace graphene { namespace net { namespace detail {
     {
       VERIFY_CORRECT_THREAD();
       peer_connection_ptr originating_peer_ptr = originating_peer->shared_from_this();
-      _rate_limiter.remove_tcp_socket( &originating_peer->get_socket() );
+      // connections of the io threads leave their rate limiter when they are destroyed
+      if (!originating_peer->reads_on_io_thread())
+        _rate_limiter.remove_tcp_socket( &originating_peer->get_socket() );
+      _closed_connection_metrics.add(originating_peer->metrics);
 
       // if we closed the connection (due to timeout or handshake failure), we should have recorded an
       // error message to store in the peer database when we closed the connection
@@ -2949,6 +3045,13 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            // remember how well the peer served us so we reconnect to the good ones first
+            if (originating_peer->round_trip_delay.count() > 0)
+              updated_peer_record->last_round_trip_delay = originating_peer->round_trip_delay;
+            fc::time_point connection_time = originating_peer->get_connection_time();
+            if (connection_time != fc::time_point() && connection_time < fc::time_point::now())
+              updated_peer_record->seconds_connected += (fc::time_point::now() - connection_time).to_seconds();
+            updated_peer_record->number_of_blocks_received += originating_peer->number_of_blocks_received;
             _potential_peer_db.update_entry(*updated_peer_record);
           }
         }
@@ -2991,6 +3094,13 @@ namespace graphene { namespace net { namespace detail {
           _active_sync_requests.erase(sync_item_and_time.first.item_hash);
         trigger_fetch_sync_items_loop();
       }
+      if (originating_peer->block_headers_requested_from_peer)
+      {
+        for (const item_hash_t& block_id : originating_peer->block_headers_requested_from_peer->get<0>())
+          _active_sync_header_requests.erase(block_id);
+        trigger_fetch_sync_items_loop();
+      }
+      forget_sync_block_headers(originating_peer_ptr);
 
       if (!originating_peer->items_requested_from_peer.empty())
       {
@@ -3005,47 +3115,63 @@ namespace graphene { namespace net { namespace detail {
       schedule_peer_for_deletion(originating_peer_ptr);
     }
 
-    void node_impl::send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send)
+    void node_impl::send_sync_blocks_to_node_delegate(const std::vector<graphene::net::block_message>& block_messages_to_send)
     {
-      dlog("in send_sync_block_to_node_delegate()");
-      bool client_accepted_block = false;
-      bool discontinue_fetching_blocks_from_peer = false;
-
-      fc::oexception handle_message_exception;
+      dlog("in send_sync_blocks_to_node_delegate(), ${count} blocks", ("count", block_messages_to_send.size()));
+      struct blocks_being_handled_guard {
+        unsigned& count;
+        unsigned blocks;
+        ~blocks_being_handled_guard() { count -= blocks; }
+      } guard{_sync_blocks_being_handled, (unsigned)block_messages_to_send.size()};
 
+      std::vector<fc::oexception> handle_message_exceptions;
       try
       {
-        std::vector<fc::uint160_t> contained_transaction_message_ids;
-        _delegate->handle_block(block_message_to_send, true, contained_transaction_message_ids,true);
+        handle_message_exceptions = _delegate->handle_sync_blocks(block_messages_to_send);
+        FC_ASSERT(handle_message_exceptions.size() == block_messages_to_send.size());
+      }
+      catch (const fc::canceled_exception&)
+      {
+        throw;
+      }
+      catch (const fc::exception& e)
+      {
+        handle_message_exceptions.assign(block_messages_to_send.size(), fc::oexception(e));
+      }
+      for (size_t i = 0; i < block_messages_to_send.size(); ++i)
+        finish_sync_block(block_messages_to_send[i], handle_message_exceptions[i]);
+    }
+
+    void node_impl::finish_sync_block(const graphene::net::block_message& block_message_to_send, const fc::oexception& handle_message_exception)
+    {
+      bool client_accepted_block = !handle_message_exception;
+      bool discontinue_fetching_blocks_from_peer = false;
+
+      if (client_accepted_block)
+      {
         ilog("Successfully pushed sync block ${num} (id:${id})",
              ("num", block_message_to_send.block.block_num())
              ("id", block_message_to_send.block_id));
         _most_recent_blocks_accepted.push_back(block_message_to_send.block_id);
-
-        client_accepted_block = true;
       }
-      catch (const block_older_than_undo_history& e)
+      else if (handle_message_exception->code() == block_older_than_undo_history::code_value)
       {
         wlog("Failed to push sync block ${num} (id:${id}): block is on a fork older than our undo history would "
              "allow us to switch to: ${e}",
              ("num", block_message_to_send.block.block_num())
              ("id", block_message_to_send.block_id)
-             ("e", (fc::exception)e));
-        handle_message_exception = e;
+             ("e", *handle_message_exception));
         discontinue_fetching_blocks_from_peer = true;
       }
-      catch (const fc::canceled_exception&)
-      {
-        throw;
-      }
-      catch (const fc::exception& e)
+      else
       {
         wlog("Failed to push sync block ${num} (id:${id}): client rejected sync block sent by peer: ${e}",
              ("num", block_message_to_send.block.block_num())
              ("id", block_message_to_send.block_id)
-             ("e", e));
-        handle_message_exception = e;
+             ("e", *handle_message_exception));
       }
+      _verified_sync_block_headers.erase(block_message_to_send.block_id);
+      _sync_block_headers_with_unknown_signer.erase(block_message_to_send.block_id);
 
       // build up lists for any potentially-blocking operations we need to do, then do them
       // at the end of this function
@@ -3166,7 +3292,7 @@ namespace graphene { namespace net { namespace detail {
       for (const peer_connection_ptr& peer : peers_we_need_to_sync_to)
         start_synchronizing_with_peer(peer);
 
-      dlog("Leaving send_sync_block_to_node_delegate");
+      dlog("Leaving finish_sync_block");
 
       if (// _suspend_fetching_sync_blocks && <-- you can use this if "maximum_number_of_blocks_to_handle_at_one_time" == "maximum_number_of_sync_blocks_to_prefetch"
           !_node_is_shutting_down &&
@@ -3189,18 +3315,18 @@ namespace graphene { namespace net { namespace detail {
       }
 
       dlog("in process_backlog_of_sync_blocks");
-      if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+      if (_sync_blocks_being_handled >= _maximum_number_of_blocks_to_handle_at_one_time)
       {
         dlog("leaving process_backlog_of_sync_blocks because we're already processing too many blocks");
         return; // we will be rescheduled when the next block finishes its processing
       }
-      dlog("currently ${count} blocks in the process of being handled", ("count", _handle_message_calls_in_progress.size()));
+      dlog("currently ${count} blocks in the process of being handled", ("count", _sync_blocks_being_handled));
 
 
       if (_suspend_fetching_sync_blocks)
       {
         dlog("resuming processing sync block backlog because we only ${count} blocks in progress",
-             ("count", _handle_message_calls_in_progress.size()));
+             ("count", _sync_blocks_being_handled));
         _suspend_fetching_sync_blocks = false;
       }
 
@@ -3213,6 +3339,18 @@ namespace graphene { namespace net { namespace detail {
 
       bool block_processed_this_iteration;
       unsigned blocks_processed = 0;
+      // the blocks are handed to the delegate in batches, in the order we pick them
+      std::vector<graphene::net::block_message> blocks_to_send;
+      auto send_blocks = [this, &blocks_to_send]() {
+        if (blocks_to_send.empty())
+          return;
+        _sync_blocks_being_handled += (unsigned)blocks_to_send.size();
+        std::vector<graphene::net::block_message> block_messages_to_send;
+        block_messages_to_send.swap(blocks_to_send);
+        _handle_message_calls_in_progress.emplace_back(fc::async([this, block_messages_to_send](){
+          send_sync_blocks_to_node_delegate(block_messages_to_send);
+        }, "send_sync_blocks_to_node_delegate"));
+      };
 
       std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
       std::set<peer_connection_ptr> peers_we_need_to_sync_to;
@@ -3220,70 +3358,70 @@ namespace graphene { namespace net { namespace detail {
 
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
-
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+
+        // the next block on the active chain or one of the forks is at the front of a peer's list
+        // of ids.  if we have several, push the lowest one first
+        std::vector<item_hash_t> next_block_ids;
+        for (const peer_connection_ptr& peer : _active_connections)
         {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty())
+            next_block_ids.push_back(peer->ids_of_items_to_get.front());
+        }
+        auto next_block_iter = find_next_sync_block(_received_sync_items, next_block_ids);
+        if (next_block_iter == _received_sync_items.end())
+          break;
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
-          for (const peer_connection_ptr& peer : _active_connections)
-          {
-            ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
-            if (!peer->ids_of_items_to_get.empty() &&
-                peer->ids_of_items_to_get.front() == received_block_iter->block_id)
-            {
-              potential_first_block = true;
-              peer->ids_of_items_to_get.pop_front();
-              peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
-            }
-          }
+        graphene::net::block_message block_message_to_process = std::move(next_block_iter->second);
+        _received_sync_items.erase(next_block_iter);
+        block_processed_this_iteration = true;
+
+        // we can get into an interesting situation near the end of synchronization.  We can be in
+        // sync with one peer who is sending us the last block on the chain via a regular inventory
+        // message, while at the same time still be synchronizing with a peer who is sending us the
+        // block through the sync mechanism.  Further, we must request both blocks because
+        // we don't know they're the same (for the peer in normal operation, it has only told us the
+        // message id, for the peer in the sync case we only known the block_id).
+        bool already_accepted = std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                                          block_message_to_process.block_id) != _most_recent_blocks_accepted.end();
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+        // remove it from all sync peers lists
+        for (const peer_connection_ptr& peer : _active_connections)
+        {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty() &&
+              peer->ids_of_items_to_get.front() == block_message_to_process.block_id)
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            peer->ids_of_items_to_get.pop_front();
+            if (!already_accepted)
+              peer->ids_of_items_being_processed.insert(block_message_to_process.block_id);
+          }
+        }
 
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+        if (!already_accepted)
+        {
+          blocks_to_send.push_back(std::move(block_message_to_process));
+          if (blocks_to_send.size() >= GRAPHENE_NET_MAX_SYNC_BLOCKS_PER_BATCH)
+            send_blocks();
+          ++blocks_processed;
+        }
+        else
+          dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
 
-        if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
+        if (_sync_blocks_being_handled + blocks_to_send.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
           dlog("stopping processing sync block backlog because we have ${count} blocks in progress",
-               ("count", _handle_message_calls_in_progress.size()));
+               ("count", _sync_blocks_being_handled + blocks_to_send.size()));
           //ulog("stopping processing sync block backlog because we have ${count} blocks in progress, total on hand: ${received}",
-          //     ("count", _handle_message_calls_in_progress.size())("received", _received_sync_items.size()));
+          //     ("count", _sync_blocks_being_handled + blocks_to_send.size())("received", _received_sync_items.size()));
           if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch)
             _suspend_fetching_sync_blocks = true;
           break;
         }
       } while (block_processed_this_iteration);
+      send_blocks();
 
       dlog("leaving process_backlog_of_sync_blocks, ${count} processed", ("count", blocks_processed));
 
@@ -3304,9 +3442,23 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
-      // add it to the front of _received_sync_items, then process _received_sync_items to try to
+      // check what we can without the blocks before it, so a bad block doesn't sit in the backlog
+      // holding up the blocks behind it.  the miner's signature can only be checked in chain order
+      if (!sync_block_matches_id(block_message_to_process))
+      {
+        wlog("received a sync block ${block_id} that doesn't match its id from peer ${endpoint}, disconnecting from peer",
+             ("endpoint", originating_peer->get_remote_endpoint())("block_id", block_message_to_process.block_id));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a block whose contents don't match its id, block_id: ${block_id}",
+                                                    ("block_id", block_message_to_process.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me a block whose contents don't match its id", true, detailed_error);
+        // someone else will have to send it
+        trigger_fetch_sync_items_loop();
+        return;
+      }
+
+      // add it to _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
-      _new_received_sync_items.push_front( block_message_to_process );
+      _received_sync_items.insert( std::make_pair( block_message_to_process.block_id, block_message_to_process ) );
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3336,6 +3488,7 @@ namespace graphene { namespace net { namespace detail {
           std::vector<fc::uint160_t> contained_transaction_message_ids;
           _delegate->handle_block(block_message_to_process, false, contained_transaction_message_ids,true);
           message_validated_time = fc::time_point::now();
+          originating_peer->metrics.block_apply_latency.record(message_validated_time - message_receive_time);
           ilog("Successfully pushed block ${num} (id:${id})",
                 ("num", block_message_to_process.block.block_num())
                 ("id", block_message_to_process.block_id));
@@ -3360,7 +3513,10 @@ namespace graphene { namespace net { namespace detail {
             trigger_advertise_inventory_loop();
         }
         else
+        {
           dlog( "Already received and accepted this block (presumably through sync mechanism), treating it as accepted" );
+          ++originating_peer->metrics.duplicate_items_received;
+        }
 
         dlog( "client validated the block, advertising it to other peers" );
 
@@ -3473,7 +3629,9 @@ namespace graphene { namespace net { namespace detail {
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
+        originating_peer->metrics.item_latency.record(fc::time_point::now() - item_iter->second);
         originating_peer->items_requested_from_peer.erase(item_iter);
+        ++originating_peer->number_of_blocks_received;
         process_block_during_normal_operation(originating_peer, block_message_to_process, message_hash);
         if (originating_peer->idle())
           trigger_fetch_items_loop();
@@ -3486,7 +3644,9 @@ namespace graphene { namespace net { namespace detail {
                                                                                             block_message_to_process.block_id));
         if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
         {
+          originating_peer->metrics.sync_item_latency.record(fc::time_point::now() - sync_item_iter->second);
           originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
+          ++originating_peer->number_of_blocks_received;
           _active_sync_requests.erase(block_message_to_process.block_id);
           process_block_during_sync(originating_peer, block_message_to_process, message_hash);
           if (originating_peer->idle())
@@ -3774,6 +3934,350 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
     }
 
+    message node_impl::make_compact_block_message(peer_connection* peer, const graphene::net::block_message& block_message_to_send)
+    {
+      VERIFY_CORRECT_THREAD();
+      // the peer has the transaction if it offered it to us or fetched it after we offered it
+      compact_block_message compact_block = make_compact_block(block_message_to_send.block, block_message_to_send.block_id,
+                                                               [this, peer](const transaction_id_type& transaction_id) {
+        fc::optional<message_hash_type> transaction_message_hash = _message_cache.get_message_hash(transaction_id);
+        if (!transaction_message_hash)
+          return false;
+        item_id transaction_item(trx_message_type, *transaction_message_hash);
+        return peer->inventory_peer_advertised_to_us.find(transaction_item) != peer->inventory_peer_advertised_to_us.end() ||
+               peer->inventory_advertised_to_peer.find(transaction_item) != peer->inventory_advertised_to_peer.end();
+      });
+      dlog("sending block ${id} as a compact block with ${prefilled} of ${count} transactions prefilled to peer ${endpoint}",
+           ("id", compact_block.block_id)("prefilled", compact_block.prefilled_transactions.size())
+           ("count", compact_block.transactions.size())("endpoint", peer->get_remote_endpoint()));
+      return compact_block;
+    }
+
+    void node_impl::on_compact_block_message(peer_connection* originating_peer,
+                                             const compact_block_message& compact_block_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      graphene::net::block_message reconstructed_block;
+      std::vector<uint32_t> missing_transactions;
+      bool used_our_transactions = reconstruct_compact_block(compact_block_message_received,
+                                                             [this](uint64_t short_id) { return _message_cache.get_transaction(short_id); },
+                                                             reconstructed_block, missing_transactions);
+
+      originating_peer->pending_compact_block = reconstructed_block;
+      originating_peer->pending_compact_block_missing_transactions = missing_transactions;
+      originating_peer->pending_compact_block_used_our_transactions = used_our_transactions;
+      if (missing_transactions.empty())
+      {
+        process_reconstructed_compact_block(originating_peer);
+        return;
+      }
+      dlog("requesting ${missing} of ${count} transactions of compact block ${id} from peer ${endpoint}",
+           ("missing", missing_transactions.size())("count", compact_block_message_received.transactions.size())
+           ("id", reconstructed_block.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+      originating_peer->send_message(get_compact_block_transactions_message(reconstructed_block.block_id, missing_transactions));
+    }
+
+    void node_impl::on_get_compact_block_transactions_message(peer_connection* originating_peer,
+                                                              const get_compact_block_transactions_message& get_compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      compact_block_transactions_message reply;
+      reply.block_id = get_compact_block_transactions_message_received.block_id;
+      try
+      {
+        graphene::net::block_message requested_block = _delegate->get_item(item_id(block_message_type, reply.block_id)).as<graphene::net::block_message>();
+        for (uint32_t transaction_index : get_compact_block_transactions_message_received.transaction_indexes)
+        {
+          FC_ASSERT(transaction_index < requested_block.block.transactions.size(), "no transaction ${index} in block ${id}",
+                    ("index", transaction_index)("id", reply.block_id));
+          reply.transactions.push_back(requested_block.block.transactions[transaction_index]);
+        }
+      }
+      catch (const fc::canceled_exception&)
+      {
+        throw;
+      }
+      catch (const fc::exception& e)
+      {
+        // an empty reply tells the peer to get the block elsewhere
+        dlog("can't send the transactions of block ${id} to peer ${endpoint}: ${e}",
+             ("id", reply.block_id)("endpoint", originating_peer->get_remote_endpoint())("e", e));
+        reply.transactions.clear();
+      }
+      originating_peer->send_message(reply);
+    }
+
+    void node_impl::on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                          const compact_block_transactions_message& compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (!originating_peer->pending_compact_block ||
+          originating_peer->pending_compact_block->block_id != compact_block_transactions_message_received.block_id)
+      {
+        wlog("received transactions of a compact block ${id} I'm not waiting for from peer ${endpoint}, ignoring",
+             ("id", compact_block_transactions_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      const std::vector<uint32_t>& missing_transactions = originating_peer->pending_compact_block_missing_transactions;
+      if (compact_block_transactions_message_received.transactions.size() != missing_transactions.size())
+      {
+        // the block request will time out and we'll fetch it from someone else
+        wlog("peer ${endpoint} didn't send the transactions of compact block ${id}",
+             ("id", compact_block_transactions_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        originating_peer->pending_compact_block.reset();
+        return;
+      }
+      for (uint32_t i = 0; i < missing_transactions.size(); ++i)
+        originating_peer->pending_compact_block->block.transactions[missing_transactions[i]] = compact_block_transactions_message_received.transactions[i];
+      process_reconstructed_compact_block(originating_peer);
+    }
+
+    void node_impl::process_reconstructed_compact_block(peer_connection* originating_peer)
+    {
+      VERIFY_CORRECT_THREAD();
+      graphene::net::block_message reconstructed_block = *originating_peer->pending_compact_block;
+      if (reconstructed_block.block.calculate_merkle_root() != reconstructed_block.block.transaction_merkle_root)
+      {
+        if (originating_peer->pending_compact_block_used_our_transactions)
+        {
+          // one of our transactions has the same short id as one of the block's, ask for all of them
+          std::vector<uint32_t> missing_transactions;
+          for (uint32_t i = 0; i < reconstructed_block.block.transactions.size(); ++i)
+            missing_transactions.push_back(i);
+          originating_peer->pending_compact_block_missing_transactions = missing_transactions;
+          originating_peer->pending_compact_block_used_our_transactions = false;
+          originating_peer->send_message(get_compact_block_transactions_message(reconstructed_block.block_id, missing_transactions));
+          return;
+        }
+        originating_peer->pending_compact_block.reset();
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "The transactions of compact block ${id} don't match its merkle root",
+                                                    ("id", reconstructed_block.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me a compact block that doesn't match its merkle root", true, detailed_error);
+        return;
+      }
+      originating_peer->pending_compact_block.reset();
+
+      // from here on, the block is handled exactly as if the peer had sent the block_message we requested
+      message block_message_to_process(reconstructed_block);
+      process_block_message(originating_peer, block_message_to_process, block_message_to_process.id());
+    }
+
+    void node_impl::request_block_headers_from_peer(const peer_connection_ptr& peer, const std::vector<item_hash_t>& block_ids,
+                                                    const fc::optional<item_hash_t>& previous_block_id)
+    {
+      VERIFY_CORRECT_THREAD();
+      dlog("requesting ${count} block header(s) starting at ${first} from peer ${endpoint}",
+           ("count", block_ids.size())("first", block_ids.front())("endpoint", peer->get_remote_endpoint()));
+      for (const item_hash_t& block_id : block_ids)
+        _active_sync_header_requests.insert(block_id);
+      peer->block_headers_requested_from_peer = boost::make_tuple(block_ids, fc::time_point::now());
+      peer->block_headers_previous_id = previous_block_id;
+      peer->send_message(get_block_headers_message(block_ids));
+    }
+
+    void node_impl::on_get_block_headers_message(peer_connection* originating_peer,
+                                                 const get_block_headers_message& get_block_headers_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      // every header reads a block from disk, so a peer gets no more headers than it has tokens for.  a short
+      // reply is a valid one, the peer asks for the rest later
+      originating_peer->block_headers_sent_tokens.refill(GRAPHENE_NET_MAX_BLOCK_HEADERS_SENT_PER_SECOND_PER_PEER,
+                                                         GRAPHENE_NET_MAX_BLOCK_HEADERS_SENT_BURST_PER_PEER, fc::time_point::now());
+
+      block_headers_message reply;
+      size_t requested_count = std::min<size_t>(get_block_headers_message_received.block_ids.size(), GRAPHENE_NET_MAX_BLOCK_HEADERS_PER_FETCH);
+      size_t header_count = originating_peer->block_headers_sent_tokens.take((uint32_t)requested_count);
+      if (header_count < requested_count)
+        dlog("peer ${endpoint} asked for ${count} block header(s) but has only earned ${tokens}",
+             ("endpoint", originating_peer->get_remote_endpoint())("count", requested_count)("tokens", header_count));
+      for (size_t i = 0; i < header_count; ++i)
+      {
+        try
+        {
+          reply.headers.push_back(_delegate->get_block_header(get_block_headers_message_received.block_ids[i]));
+        }
+        catch (const fc::canceled_exception&)
+        {
+          throw;
+        }
+        catch (const fc::exception& e)
+        {
+          // the reply stops at the first block we don't have
+          dlog("can't send the header of block ${id} to peer ${endpoint}: ${e}",
+               ("id", get_block_headers_message_received.block_ids[i])("endpoint", originating_peer->get_remote_endpoint())("e", e));
+          break;
+        }
+      }
+      originating_peer->send_message(reply);
+    }
+
+    // returns the index of the first header that doesn't match its id or whose signature
+    // doesn't recover, or headers.size() if they're all good.  signers[i] is the key header i
+    // was signed with
+    size_t node_impl::check_block_headers_in_parallel(const std::vector<signed_block_header>& headers,
+                                                      const std::vector<item_hash_t>& block_ids,
+                                                      std::vector<fc::ecc::public_key_data>& signers)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_header_verification_threads.empty())
+      {
+        uint32_t thread_count = std::max<uint32_t>(1, std::min<uint32_t>(std::thread::hardware_concurrency(),
+                                                                         GRAPHENE_NET_MAX_HEADER_VERIFICATION_THREADS));
+        for (uint32_t i = 0; i < thread_count; ++i)
+          _header_verification_threads.push_back(std::make_shared<fc::thread>("p2p header verification " + std::to_string(i)));
+      }
+
+      // the tasks may outlive this call if we're canceled while waiting for them
+      auto shared_headers = std::make_shared<const std::vector<signed_block_header> >(headers);
+      auto shared_block_ids = std::make_shared<const std::vector<item_hash_t> >(block_ids);
+      // the chunks write the keys of their own headers concurrently
+      auto shared_signers = std::make_shared<std::vector<fc::ecc::public_key_data> >(headers.size());
+      size_t chunk_size = (headers.size() + _header_verification_threads.size() - 1) / _header_verification_threads.size();
+      std::vector<std::pair<size_t, fc::future<size_t> > > chunk_checks; // end of the chunk -> first bad header in the chunk
+      for (size_t chunk_begin = 0; chunk_begin < headers.size(); chunk_begin += chunk_size)
+      {
+        size_t chunk_end = std::min(chunk_begin + chunk_size, headers.size());
+        fc::thread* verification_thread = _header_verification_threads[chunk_checks.size()].get();
+        chunk_checks.emplace_back(chunk_end, verification_thread->async([shared_headers, shared_block_ids, shared_signers,
+                                                                         chunk_begin, chunk_end]() -> size_t {
+          for (size_t i = chunk_begin; i < chunk_end; ++i)
+          {
+            const signed_block_header& header = (*shared_headers)[i];
+            if (header.id() != (*shared_block_ids)[i])
+              return i;
+            try
+            {
+              (*shared_signers)[i] = header.signee().serialize();
+            }
+            catch (const fc::exception&)
+            {
+              return i;
+            }
+          }
+          return chunk_end;
+        }, "check_block_headers"));
+      }
+
+      size_t first_bad_header = headers.size();
+      for (auto& chunk_check : chunk_checks)
+      {
+        size_t result = chunk_check.second.wait();
+        if (result != chunk_check.first)
+          first_bad_header = std::min(first_bad_header, result);
+      }
+      signers = *shared_signers;
+      return first_bad_header;
+    }
+
+    void node_impl::on_block_headers_message(peer_connection* originating_peer,
+                                             const block_headers_message& block_headers_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      peer_connection_ptr peer = originating_peer->shared_from_this();
+      if (!peer->block_headers_requested_from_peer)
+      {
+        wlog("received block headers I didn't ask for from peer ${endpoint}, disconnecting from peer",
+             ("endpoint", peer->get_remote_endpoint()));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me block headers that I didn't ask for"));
+        disconnect_from_peer(originating_peer, "You sent me block headers that I didn't ask for", true, detailed_error);
+        return;
+      }
+      std::vector<item_hash_t> requested_block_ids = peer->block_headers_requested_from_peer->get<0>();
+      fc::optional<item_hash_t> previous_block_id = peer->block_headers_previous_id;
+      const std::vector<signed_block_header>& headers = block_headers_message_received.headers;
+
+      // the header is checked before we spend bandwidth on the block.  the signer of a block built on our
+      // head block is matched against the miner of its slot, that of a later block against the active miners.
+      // a block whose signer we can't match is still fetched, but only from the peers vouching for it
+      fc::oexception header_error;
+      std::vector<char> trusted_signers;
+      if (headers.size() > requested_block_ids.size())
+        header_error = fc::exception(FC_LOG_MESSAGE(error, "You sent me ${count} block headers when I asked for ${requested}",
+                                                    ("count", headers.size())("requested", requested_block_ids.size())));
+      else if (!headers.empty())
+      {
+        std::vector<fc::ecc::public_key_data> signers;
+        size_t first_bad_header = check_block_headers_in_parallel(headers, requested_block_ids, signers);
+        // the connection may have closed while we were waiting, or the request been answered twice
+        if (_active_connections.find(peer) == _active_connections.end() || !peer->block_headers_requested_from_peer)
+          return;
+        if (first_bad_header != headers.size())
+          header_error = fc::exception(FC_LOG_MESSAGE(error, "The header of block ${id} doesn't match its id or signature",
+                                                      ("id", requested_block_ids[first_bad_header])));
+        else
+        {
+          fc::time_point_sec latest_acceptable_timestamp = fc::time_point_sec(fc::time_point::now()) + GRAPHENE_NET_FUTURE_SYNC_BLOCKS_GRACE_PERIOD_SEC;
+          first_bad_header = check_sync_block_headers(headers, requested_block_ids, signers, previous_block_id,
+                                                      _delegate->get_block_signing_schedule(), latest_acceptable_timestamp,
+                                                      trusted_signers);
+          if (first_bad_header != headers.size())
+            header_error = fc::exception(FC_LOG_MESSAGE(error, "The header of block ${id} doesn't follow the block before it or isn't on a slot",
+                                                        ("id", requested_block_ids[first_bad_header])));
+        }
+      }
+
+      for (const item_hash_t& block_id : requested_block_ids)
+        _active_sync_header_requests.erase(block_id);
+      peer->block_headers_requested_from_peer.reset();
+      peer->block_headers_previous_id.reset();
+
+      if (header_error)
+      {
+        wlog("received an invalid block header from peer ${endpoint}, disconnecting from peer: ${e}",
+             ("endpoint", peer->get_remote_endpoint())("e", *header_error));
+        disconnect_from_peer(originating_peer, "You sent me an invalid block header", true, *header_error);
+      }
+      else if (headers.empty())
+      {
+        // the peer no longer has the blocks it offered us, it switched forks since, or it is limiting how
+        // many headers we read.  either way the list of blocks we have from it is stale, so ask it again
+        dlog("peer ${endpoint} sent none of the ${count} block header(s) we asked for, restarting sync with it",
+             ("endpoint", peer->get_remote_endpoint())("count", requested_block_ids.size()));
+        start_synchronizing_with_peer(peer);
+      }
+      else
+      {
+        dlog("${count} block header(s) from peer ${endpoint} passed our checks",
+             ("count", headers.size())("endpoint", peer->get_remote_endpoint()));
+        for (size_t i = 0; i < headers.size(); ++i)
+          if (trusted_signers[i])
+            _verified_sync_block_headers.insert(requested_block_ids[i]);
+          else
+          {
+            dlog("block ${id} isn't signed by a miner we expect", ("id", requested_block_ids[i]));
+            _sync_block_headers_with_unknown_signer[requested_block_ids[i]].insert(peer->node_id);
+          }
+      }
+      trigger_fetch_sync_items_loop();
+    }
+
+    // drops the headers peer vouched for, and the checked headers of the sync blocks no other peer offers us.
+    // called when we start syncing with the peer over and when it disconnects, so both sets stay as small as
+    // the lists of blocks our peers offer
+    void node_impl::forget_sync_block_headers(const peer_connection_ptr& peer)
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_verified_sync_block_headers.empty() && _sync_block_headers_with_unknown_signer.empty())
+        return;
+      std::set<item_hash_t> offered_block_ids;
+      for (const peer_connection_ptr& active_peer : _active_connections)
+        if (active_peer != peer)
+          offered_block_ids.insert(active_peer->ids_of_items_to_get.begin(), active_peer->ids_of_items_to_get.end());
+
+      for (auto iter = _verified_sync_block_headers.begin(); iter != _verified_sync_block_headers.end();)
+        if (offered_block_ids.find(*iter) == offered_block_ids.end())
+          iter = _verified_sync_block_headers.erase(iter);
+        else
+          ++iter;
+      for (auto iter = _sync_block_headers_with_unknown_signer.begin(); iter != _sync_block_headers_with_unknown_signer.end();)
+      {
+        iter->second.erase(peer->node_id);
+        if (iter->second.empty() || offered_block_ids.find(iter->first) == offered_block_ids.end())
+          iter = _sync_block_headers_with_unknown_signer.erase(iter);
+        else
+          ++iter;
+      }
+    }
 
     // this handles any message we get that doesn't require any special processing.
     // currently, this is any message other than block messages and p2p-specific
@@ -3787,6 +4291,37 @@ namespace graphene { namespace net { namespace detail {
       fc::time_point message_receive_time = fc::time_point::now();
 
       // only process it if we asked for it
+      if (!take_requested_item(originating_peer, message_to_process, message_hash))
+        return;
+
+      // Next: have the delegate process the message
+      fc::oexception rejection;
+      try
+      {
+        if (message_to_process.msg_type == trx_message_type)
+        {
+          trx_message transaction_message_to_process = message_to_process.as<trx_message>();
+          dlog("passing message containing transaction ${trx} to client", ("trx", transaction_message_to_process.trx.id()));
+          _delegate->handle_transaction(transaction_message_to_process);
+        }
+        else
+          _delegate->handle_message( message_to_process );
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        throw;
+      }
+      catch ( const fc::exception& e )
+      {
+        rejection = e;
+      }
+      finish_ordinary_message(originating_peer, message_to_process, message_hash, message_receive_time, rejection);
+    }
+
+    bool node_impl::take_requested_item( peer_connection* originating_peer,
+                                         const message& message_to_process, const message_hash_type& message_hash )
+    {
+      VERIFY_CORRECT_THREAD();
       auto iter = originating_peer->items_requested_from_peer.find( item_id(message_to_process.msg_type, message_hash) );
       if( iter == originating_peer->items_requested_from_peer.end() )
       {
@@ -3795,27 +4330,234 @@ namespace graphene { namespace net { namespace detail {
         fc::exception detailed_error( FC_LOG_MESSAGE(error, "You sent me a message that I didn't ask for, message_hash: ${message_hash}",
                                                     ( "message_hash", message_hash ) ) );
         disconnect_from_peer( originating_peer, "You sent me a message that I didn't request", true, detailed_error );
+        return false;
+      }
+      originating_peer->metrics.item_latency.record(fc::time_point::now() - iter->second);
+      originating_peer->items_requested_from_peer.erase( iter );
+      if (originating_peer->idle())
+        trigger_fetch_items_loop();
+      return true;
+    }
+
+    void node_impl::finish_ordinary_message( peer_connection* originating_peer,
+                                             const message& message_to_process, const message_hash_type& message_hash,
+                                             fc::time_point message_receive_time, const fc::oexception& rejection )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (message_to_process.msg_type == trx_message_type)
+      {
+        if (rejection)
+          ++originating_peer->transactions_rejected;
+        else
+          ++originating_peer->transactions_admitted;
+      }
+      if (rejection)
+      {
+        wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", *rejection) );
+        // record it so we don't try to fetch this item again
+        _recently_failed_items.insert(peer_connection::timestamped_item_id(item_id(message_to_process.msg_type, message_hash ), fc::time_point::now()));
         return;
       }
-      else
+
+      // finally, if the delegate validated the message, broadcast it to our other peers
+      message_propagation_data propagation_data{message_receive_time, fc::time_point::now(), originating_peer->node_id};
+      broadcast( message_to_process, propagation_data );
+    }
+
+    bool node_impl::take_transaction_admission_token( peer_connection* peer )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_maximum_transactions_per_second_per_peer == 0)
+        return true;
+      peer->transaction_admission_tokens.refill(_maximum_transactions_per_second_per_peer, _maximum_transaction_burst_per_peer,
+                                                fc::time_point::now());
+      bool token_taken = peer->transaction_admission_tokens.take() == 1;
+      if (peer->transaction_admission_tokens.tokens() < 1.0)
       {
-        originating_peer->items_requested_from_peer.erase( iter );
-        if (originating_peer->idle())
-          trigger_fetch_items_loop();
+        // don't ask this peer for transactions until it has earned another token, other peers can still provide them
+        if (token_taken)
+        {
+          ++peer->transaction_rate_limit_hits;
+          dlog("peer ${endpoint} reached its transaction rate limit", ("endpoint", peer->get_remote_endpoint()));
+        }
+        peer->transaction_fetching_inhibited_until = peer->transaction_admission_tokens.next_token_time(_maximum_transactions_per_second_per_peer);
+      }
+      return token_taken;
+    }
 
-        // Next: have the delegate process the message
-        fc::time_point message_validated_time;
-        try
+    void node_impl::set_io_thread_count( uint32_t io_thread_count )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (io_thread_count == _io_threads.size())
+        return;
+      // connections already using the old threads keep them and their rate limiters alive until they close
+      _io_threads.clear();
+      for (uint32_t i = 0; i < io_thread_count; ++i)
+      {
+        std::shared_ptr<fc::thread> thread = std::make_shared<fc::thread>("p2p io " + std::to_string(i));
+        // a rate limiter runs its tasks on the thread using it, it isn't thread safe.  it is also destroyed there
+        std::shared_ptr<fc::rate_limiting_group> rate_limiter = thread->async([thread]() {
+          return std::shared_ptr<fc::rate_limiting_group>(new fc::rate_limiting_group(0, 0), [thread](fc::rate_limiting_group* rate_limiter) {
+            thread->async([rate_limiter]() { delete rate_limiter; }, "delete rate_limiting_group").wait();
+          });
+        }, "create rate_limiting_group").wait();
+        _io_threads.push_back(connection_io_thread{thread, rate_limiter});
+      }
+      _next_io_thread = 0;
+      set_io_thread_bandwidth_limits();
+    }
+
+    void node_impl::set_io_thread_bandwidth_limits()
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_io_threads.empty())
+        return;
+      // each io thread gets an equal share of the limits.  0 is no limit
+      auto share_of = [this](uint32_t limit) { return limit ? std::max<uint32_t>(limit / _io_threads.size(), 1) : 0; };
+      uint32_t upload_bytes_per_second = share_of(_rate_limiter.get_upload_limit());
+      uint32_t download_bytes_per_second = share_of(_rate_limiter.get_download_limit());
+      for (const connection_io_thread& io_thread : _io_threads)
+      {
+        std::shared_ptr<fc::rate_limiting_group> rate_limiter = io_thread.rate_limiter;
+        io_thread.thread->async([=]() {
+          rate_limiter->set_upload_limit(upload_bytes_per_second);
+          rate_limiter->set_download_limit(download_bytes_per_second);
+          rate_limiter->set_actual_rate_time_constant(fc::seconds(2));
+        }, "set_bandwidth_limits").wait();
+      }
+    }
+
+    void node_impl::start_connection_io( const peer_connection_ptr& new_peer )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (_io_threads.empty())
+      {
+        _rate_limiter.add_tcp_socket( &new_peer->get_socket() );
+        return;
+      }
+      const connection_io_thread& io_thread = _io_threads[_next_io_thread++ % _io_threads.size()];
+      new_peer->set_io_thread(io_thread.thread, io_thread.rate_limiter);
+    }
+
+    void node_impl::queue_incoming_message( const std::weak_ptr<peer_connection>& originating_peer,
+                                            const fc::optional<message>& received_message )
+    {
+      // called by the io threads
+      std::unique_ptr<queued_incoming_message> incoming_message(new queued_incoming_message{originating_peer, received_message});
+      // while the queue is full, this connection isn't read until the p2p thread has taken a message
+      while (!_queued_incoming_messages.bounded_push(incoming_message.get()))
+      {
+        fc::promise<void>::ptr room_promise;
+        {
+          std::lock_guard<std::mutex> lock(_queued_incoming_messages_mutex);
+          // the p2p thread checks for the promise after each message it takes, with the lock held
+          if (_queued_incoming_messages.bounded_push(incoming_message.get()))
+            break;
+          if (!_queued_incoming_messages_room_promise)
+            _queued_incoming_messages_room_promise = fc::promise<void>::ptr(new fc::promise<void>("graphene::net::queue_incoming_message"));
+          room_promise = _queued_incoming_messages_room_promise;
+        }
+        room_promise->wait();
+      }
+      incoming_message.release();
+      trigger_process_queued_incoming_messages_loop();
+    }
+
+    void node_impl::notify_queued_incoming_messages_room()
+    {
+      VERIFY_CORRECT_THREAD();
+      fc::promise<void>::ptr room_promise;
+      {
+        std::lock_guard<std::mutex> lock(_queued_incoming_messages_mutex);
+        room_promise = _queued_incoming_messages_room_promise;
+        _queued_incoming_messages_room_promise.reset();
+      }
+      if (room_promise)
+        room_promise->set_value();
+    }
+
+    void node_impl::trigger_process_queued_incoming_messages_loop()
+    {
+      fc::promise<void>::ptr retrigger_promise;
+      {
+        std::lock_guard<std::mutex> lock(_queued_incoming_messages_mutex);
+        retrigger_promise = _retrigger_process_queued_incoming_messages_loop_promise;
+        _retrigger_process_queued_incoming_messages_loop_promise.reset();
+      }
+      if (retrigger_promise)
+        retrigger_promise->set_value();
+    }
+
+    void node_impl::process_queued_incoming_messages_loop()
+    {
+      VERIFY_CORRECT_THREAD();
+      while (!_process_queued_incoming_messages_loop_done.canceled())
+      {
+        process_queued_incoming_messages();
+
+        fc::promise<void>::ptr retrigger_promise;
+        {
+          std::lock_guard<std::mutex> lock(_queued_incoming_messages_mutex);
+          // a message queued since we drained won't have found a promise to set
+          if (!_queued_incoming_messages.empty())
+            continue;
+          retrigger_promise = fc::promise<void>::ptr(new fc::promise<void>("graphene::net::process_queued_incoming_messages_loop"));
+          _retrigger_process_queued_incoming_messages_loop_promise = retrigger_promise;
+        }
+        retrigger_promise->wait();
+      }
+    }
+
+    void node_impl::process_queued_incoming_messages()
+    {
+      VERIFY_CORRECT_THREAD();
+      std::vector<queued_transaction> transactions;
+      queued_incoming_message* incoming_message = nullptr;
+      while (_queued_incoming_messages.pop(incoming_message))
+      {
+        std::unique_ptr<queued_incoming_message> incoming_message_holder(incoming_message);
+        notify_queued_incoming_messages_room();
+        peer_connection_ptr originating_peer = incoming_message->originating_peer.lock();
+        if (!originating_peer)
+          continue;
+
+        if (!incoming_message->received_message)
         {
-          if (message_to_process.msg_type == trx_message_type)
+          process_queued_transactions(transactions);
+          originating_peer->negotiation_status = peer_connection::connection_negotiation_status::closed;
+          on_connection_closed(originating_peer.get());
+          continue;
+        }
+
+        const message& received_message = *incoming_message->received_message;
+        if (received_message.msg_type == trx_message_type)
+        {
+          // transactions are handed to the delegate in batches, everything else as it comes.
+          // on_message counts the other messages
+          originating_peer->metrics.count_received_message(received_message);
+          message_hash_type message_hash = received_message.id();
+          if (!take_requested_item(originating_peer.get(), received_message, message_hash))
+            continue;
+          queued_transaction transaction{originating_peer, received_message, message_hash, fc::time_point::now()};
+          try
           {
-            trx_message transaction_message_to_process = message_to_process.as<trx_message>();
-            dlog("passing message containing transaction ${trx} to client", ("trx", transaction_message_to_process.trx.id()));
-            _delegate->handle_transaction(transaction_message_to_process);
+            transaction.transaction_message = received_message.as<trx_message>();
           }
-          else
-            _delegate->handle_message( message_to_process );
-          message_validated_time = fc::time_point::now();
+          catch ( const fc::exception& e )
+          {
+            finish_ordinary_message(originating_peer.get(), received_message, message_hash, transaction.message_receive_time, e);
+            continue;
+          }
+          transactions.push_back(std::move(transaction));
+          if (transactions.size() >= GRAPHENE_NET_MAX_TRANSACTIONS_PER_BATCH)
+            process_queued_transactions(transactions);
+          continue;
+        }
+
+        process_queued_transactions(transactions);
+        try
+        {
+          on_message(originating_peer.get(), received_message);
         }
         catch ( const fc::canceled_exception& )
         {
@@ -3823,22 +4565,38 @@ namespace graphene { namespace net { namespace detail {
         }
         catch ( const fc::exception& e )
         {
-          wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
-          // record it so we don't try to fetch this item again
-          _recently_failed_items.insert(peer_connection::timestamped_item_id(item_id(message_to_process.msg_type, message_hash ), fc::time_point::now()));
-          return;
+          wlog( "disconnecting peer ${peer} after an error processing its message: ${e}",
+                ("peer", originating_peer->get_remote_endpoint())("e", e) );
+          originating_peer->close_connection();
         }
-
-        // finally, if the delegate validated the message, broadcast it to our other peers
-        message_propagation_data propagation_data{message_receive_time, message_validated_time, originating_peer->node_id};
-        broadcast( message_to_process, propagation_data );
       }
+      process_queued_transactions(transactions);
+    }
+
+    void node_impl::process_queued_transactions( std::vector<queued_transaction>& transactions )
+    {
+      VERIFY_CORRECT_THREAD();
+      if (transactions.empty())
+        return;
+      std::vector<trx_message> transaction_messages;
+      transaction_messages.reserve(transactions.size());
+      for (const queued_transaction& transaction : transactions)
+        transaction_messages.push_back(transaction.transaction_message);
+      dlog("passing ${count} transactions to client", ("count", transaction_messages.size()));
+
+      std::vector<fc::oexception> rejections = _delegate->handle_transactions(transaction_messages);
+      FC_ASSERT(rejections.size() == transactions.size());
+      for (size_t i = 0; i < transactions.size(); ++i)
+        finish_ordinary_message(transactions[i].originating_peer.get(), transactions[i].message_to_process,
+                                transactions[i].message_hash, transactions[i].message_receive_time, rejections[i]);
+      transactions.clear();
     }
 
     void node_impl::start_synchronizing_with_peer( const peer_connection_ptr& peer )
     {
       VERIFY_CORRECT_THREAD();
       peer->ids_of_items_to_get.clear();
+      forget_sync_block_headers(peer);
       peer->number_of_unfetched_item_ids = 0;
       peer->we_need_sync_items_from_peer = true;
       peer->last_block_delegate_has_seen = item_hash_t();
@@ -3934,6 +4692,27 @@ namespace graphene { namespace net { namespace detail {
         wlog( "Exception thrown while terminating P2P connect loop, ignoring" );
       }
 
+      try
+      {
+        _process_queued_incoming_messages_loop_done.cancel("node_impl::close()");
+        // cancel() is currently broken, so we need to wake up the task to allow it to finish
+        trigger_process_queued_incoming_messages_loop();
+        _process_queued_incoming_messages_loop_done.wait();
+        dlog("Process queued incoming messages loop terminated");
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        dlog("Process queued incoming messages loop terminated");
+      }
+      catch ( const fc::exception& e )
+      {
+        wlog( "Exception thrown while terminating Process queued incoming messages loop, ignoring: ${e}", ("e", e) );
+      }
+      catch (...)
+      {
+        wlog( "Exception thrown while terminating Process queued incoming messages loop, ignoring" );
+      }
+
       try
       {
         _process_backlog_of_sync_blocks_done.cancel_and_wait("node_impl::close()");
@@ -4181,7 +4960,7 @@ namespace graphene { namespace net { namespace detail {
             return;
           new_peer->connection_initiation_time = fc::time_point::now();
           _handshaking_connections.insert( new_peer );
-          _rate_limiter.add_tcp_socket( &new_peer->get_socket() );
+          start_connection_io( new_peer );
           std::weak_ptr<peer_connection> new_weak_peer(new_peer);
           new_peer->accept_or_connect_task_done = fc::async( [this, new_weak_peer]() {
             peer_connection_ptr new_peer(new_weak_peer.lock());
@@ -4546,6 +5325,7 @@ namespace graphene { namespace net { namespace detail {
       _p2p_network_connect_loop_done = fc::async( [=]() { p2p_network_connect_loop(); }, "p2p_network_connect_loop" );
       _fetch_sync_items_loop_done = fc::async( [=]() { fetch_sync_items_loop(); }, "fetch_sync_items_loop" );
       _fetch_item_loop_done = fc::async( [=]() { fetch_items_loop(); }, "fetch_items_loop" );
+      _process_queued_incoming_messages_loop_done = fc::async( [=]() { process_queued_incoming_messages_loop(); }, "process_queued_incoming_messages_loop" );
       _advertise_inventory_loop_done = fc::async( [=]() { advertise_inventory_loop(); }, "advertise_inventory_loop" );
       _terminate_inactive_connections_loop_done = fc::async( [=]() { terminate_inactive_connections_loop(); }, "terminate_inactive_connections_loop" );
       _fetch_updated_peer_lists_loop_done = fc::async([=](){ fetch_updated_peer_lists_loop(); }, "fetch_updated_peer_lists_loop");
@@ -4574,7 +5354,7 @@ namespace graphene { namespace net { namespace detail {
       new_peer->get_socket().set_reuse_address();
       new_peer->connection_initiation_time = fc::time_point::now();
       _handshaking_connections.insert(new_peer);
-      _rate_limiter.add_tcp_socket(&new_peer->get_socket());
+      start_connection_io(new_peer);
 
       if (_node_is_shutting_down)
         return;
@@ -4680,7 +5460,6 @@ namespace graphene { namespace net { namespace detail {
       ilog( "--------- MEMORY USAGE ------------" );
       ilog( "node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size() ) );
       ilog( "node._received_sync_items size: ${size}", ("size", _received_sync_items.size() ) );
-      ilog( "node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size() ) );
       ilog( "node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size() ) );
       ilog( "node._new_inventory size: ${size}", ("size", _new_inventory.size() ) );
       ilog( "node._message_cache size: ${size}", ("size", _message_cache.size() ) );
@@ -4799,6 +5578,12 @@ namespace graphene { namespace net { namespace detail {
         peer_details["lastrecv"] = peer->get_last_message_received_time().sec_since_epoch();
         peer_details["bytessent"] = peer->get_total_bytes_sent();
         peer_details["bytesrecv"] = peer->get_total_bytes_received();
+        peer_details["compression_ratio_sent"] = peer->get_compression_ratio_sent();
+        peer_details["compression_ratio_received"] = peer->get_compression_ratio_received();
+        peer_details["transactions_admitted"] = peer->transactions_admitted;
+        peer_details["transactions_rejected"] = peer->transactions_rejected;
+        peer_details["transaction_rate_limit_hits"] = peer->transaction_rate_limit_hits;
+        peer_details["transaction_admission_tokens"] = peer->transaction_admission_tokens.tokens();
         peer_details["conntime"] = peer->get_connection_time();
         peer_details["pingtime"] = "";
         peer_details["pingwait"] = "";
@@ -4873,7 +5658,7 @@ namespace graphene { namespace net { namespace detail {
       }
       message_hash_type hash_of_item_to_broadcast = item_to_broadcast.id();
 
-      _message_cache.cache_message( item_to_broadcast, hash_of_item_to_broadcast, propagation_data, hash_of_message_contents );
+      _message_cache.cache_message( std::make_shared<const message>(item_to_broadcast), hash_of_item_to_broadcast, propagation_data, hash_of_message_contents );
       _new_inventory.insert( item_id(item_to_broadcast.msg_type, hash_of_item_to_broadcast ) );
       trigger_advertise_inventory_loop();
     }
@@ -4926,6 +5711,12 @@ namespace graphene { namespace net { namespace detail {
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>();
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>();
+      if (params.contains("io_threads"))
+        set_io_thread_count(params["io_threads"].as<uint32_t>());
+      if (params.contains("maximum_transactions_per_second_per_peer"))
+        _maximum_transactions_per_second_per_peer = params["maximum_transactions_per_second_per_peer"].as<uint32_t>();
+      if (params.contains("maximum_transaction_burst_per_peer"))
+        _maximum_transaction_burst_per_peer = std::max<uint32_t>(params["maximum_transaction_burst_per_peer"].as<uint32_t>(), 1);
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4945,6 +5736,9 @@ namespace graphene { namespace net { namespace detail {
       result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
       result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
       result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+      result["io_threads"] = (uint32_t)_io_threads.size();
+      result["maximum_transactions_per_second_per_peer"] = _maximum_transactions_per_second_per_peer;
+      result["maximum_transaction_burst_per_peer"] = _maximum_transaction_burst_per_peer;
       return result;
     }
 
@@ -4991,6 +5785,7 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       _rate_limiter.set_upload_limit( upload_bytes_per_second );
       _rate_limiter.set_download_limit( download_bytes_per_second );
+      set_io_thread_bandwidth_limits();
     }
 
     void node_impl::disable_peer_advertising()
@@ -5063,6 +5858,140 @@ namespace graphene { namespace net { namespace detail {
       return result;
     }
 
+    traffic_metrics node_impl::get_total_traffic_metrics() const
+    {
+      VERIFY_CORRECT_THREAD();
+      traffic_metrics totals = _closed_connection_metrics;
+      for (const std::unordered_set<peer_connection_ptr>* connections : {&_handshaking_connections, &_active_connections, &_closing_connections})
+        for (const peer_connection_ptr& peer : *connections)
+          totals.add(peer->metrics);
+      return totals;
+    }
+
+    static fc::mutable_variant_object latency_counter_to_variant(const latency_counter& counter)
+    {
+      fc::mutable_variant_object result;
+      result["count"] = counter.count;
+      result["total_us"] = counter.total.count();
+      result["average_us"] = counter.count ? counter.total.count() / (int64_t)counter.count : 0;
+      result["max_us"] = counter.max.count();
+      return result;
+    }
+
+    static fc::mutable_variant_object traffic_metrics_to_variant(const traffic_metrics& metrics)
+    {
+      fc::mutable_variant_object message_types;
+      for (const auto& type_and_counters : metrics.message_types)
+      {
+        fc::mutable_variant_object counters;
+        counters["messages_sent"] = type_and_counters.second.messages_sent;
+        counters["bytes_sent"] = type_and_counters.second.bytes_sent;
+        counters["messages_received"] = type_and_counters.second.messages_received;
+        counters["bytes_received"] = type_and_counters.second.bytes_received;
+        message_types[message_type_name(type_and_counters.first)] = counters;
+      }
+      fc::mutable_variant_object result;
+      result["message_types"] = message_types;
+      result["item_ids_latency"] = latency_counter_to_variant(metrics.item_ids_latency);
+      result["sync_item_latency"] = latency_counter_to_variant(metrics.sync_item_latency);
+      result["item_latency"] = latency_counter_to_variant(metrics.item_latency);
+      result["block_apply_latency"] = latency_counter_to_variant(metrics.block_apply_latency);
+      result["duplicate_items_received"] = metrics.duplicate_items_received;
+      result["duplicate_inventory_received"] = metrics.duplicate_inventory_received;
+      return result;
+    }
+
+    fc::variant_object node_impl::get_p2p_metrics() const
+    {
+      VERIFY_CORRECT_THREAD();
+      std::vector<fc::variant> peers;
+      for (const peer_connection_ptr& peer : _active_connections)
+      {
+        fc::mutable_variant_object peer_metrics = traffic_metrics_to_variant(peer->metrics);
+        fc::optional<fc::ip::endpoint> endpoint = peer->get_remote_endpoint();
+        peer_metrics["addr"] = endpoint ? (std::string)*endpoint : std::string();
+        peer_metrics["bytessent"] = peer->get_total_bytes_sent();
+        peer_metrics["bytesrecv"] = peer->get_total_bytes_received();
+        peer_metrics["queued_messages"] = peer->get_queued_message_count();
+        peer_metrics["queued_bytes"] = peer->get_total_queued_messages_size();
+        peers.push_back(fc::variant(peer_metrics));
+      }
+      fc::mutable_variant_object result = traffic_metrics_to_variant(get_total_traffic_metrics());
+      result["peers"] = peers;
+      return result;
+    }
+
+    std::string node_impl::get_p2p_metrics_text() const
+    {
+      VERIFY_CORRECT_THREAD();
+      std::ostringstream text;
+      auto describe = [&](const char* name, const char* type, const char* help) {
+        text << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+      };
+      auto write_latencies = [&](const char* name, const std::string& labels, const traffic_metrics& metrics) {
+        std::vector<std::pair<const char*, const latency_counter*> > latencies{{"item_ids", &metrics.item_ids_latency},
+                                                                               {"sync_item", &metrics.sync_item_latency},
+                                                                               {"item", &metrics.item_latency},
+                                                                               {"block_apply", &metrics.block_apply_latency}};
+        for (const auto& kind_and_latency : latencies)
+        {
+          std::string kind_labels = labels + "kind=\"" + kind_and_latency.first + "\"";
+          text << name << "_sum{" << kind_labels << "} " << kind_and_latency.second->total.count() / 1000000.0 << "\n";
+          text << name << "_count{" << kind_labels << "} " << kind_and_latency.second->count << "\n";
+        }
+      };
+      text << std::fixed << std::setprecision(6);
+
+      traffic_metrics totals = get_total_traffic_metrics();
+      describe("graphene_p2p_connections", "gauge", "Peers we're fully connected to");
+      text << "graphene_p2p_connections " << _active_connections.size() << "\n";
+      std::vector<boost::tuple<const char*, const char*, uint64_t message_type_counters::*> > counters{
+        boost::make_tuple("graphene_p2p_messages_sent_total", "Messages sent to all peers, by message type", &message_type_counters::messages_sent),
+        boost::make_tuple("graphene_p2p_message_bytes_sent_total", "Bytes sent to all peers before compression, by message type", &message_type_counters::bytes_sent),
+        boost::make_tuple("graphene_p2p_messages_received_total", "Messages received from all peers, by message type", &message_type_counters::messages_received),
+        boost::make_tuple("graphene_p2p_message_bytes_received_total", "Bytes received from all peers after decompression, by message type", &message_type_counters::bytes_received)};
+      for (const auto& counter : counters)
+      {
+        describe(counter.get<0>(), "counter", counter.get<1>());
+        for (const auto& type_and_counters : totals.message_types)
+          text << counter.get<0>() << "{type=\"" << message_type_name(type_and_counters.first)
+               << "\"} " << type_and_counters.second.*(counter.get<2>()) << "\n";
+      }
+      describe("graphene_p2p_latency_seconds", "summary", "Request to response delays, and block receipt to apply times");
+      write_latencies("graphene_p2p_latency_seconds", "", totals);
+      describe("graphene_p2p_duplicate_items_received_total", "counter", "Blocks received that we had already accepted");
+      text << "graphene_p2p_duplicate_items_received_total " << totals.duplicate_items_received << "\n";
+      describe("graphene_p2p_duplicate_inventory_received_total", "counter", "Item ids we had already been offered, requested or advertised");
+      text << "graphene_p2p_duplicate_inventory_received_total " << totals.duplicate_inventory_received << "\n";
+
+      // per peer, only the aggregates, to keep the number of series down
+      std::vector<std::pair<std::string, peer_connection_ptr> > peers;
+      for (const peer_connection_ptr& peer : _active_connections)
+      {
+        fc::optional<fc::ip::endpoint> endpoint = peer->get_remote_endpoint();
+        peers.emplace_back("peer=\"" + (endpoint ? (std::string)*endpoint : std::string("unknown")) + "\"", peer);
+      }
+      describe("graphene_p2p_peer_bytes_sent_total", "counter", "Bytes sent on the wire to the peer");
+      for (const auto& labels_and_peer : peers)
+        text << "graphene_p2p_peer_bytes_sent_total{" << labels_and_peer.first << "} " << labels_and_peer.second->get_total_bytes_sent() << "\n";
+      describe("graphene_p2p_peer_bytes_received_total", "counter", "Bytes received on the wire from the peer");
+      for (const auto& labels_and_peer : peers)
+        text << "graphene_p2p_peer_bytes_received_total{" << labels_and_peer.first << "} " << labels_and_peer.second->get_total_bytes_received() << "\n";
+      describe("graphene_p2p_peer_queued_messages", "gauge", "Messages waiting to be sent to the peer");
+      for (const auto& labels_and_peer : peers)
+        text << "graphene_p2p_peer_queued_messages{" << labels_and_peer.first << "} " << labels_and_peer.second->get_queued_message_count() << "\n";
+      describe("graphene_p2p_peer_queued_bytes", "gauge", "Memory used by the messages waiting to be sent to the peer");
+      for (const auto& labels_and_peer : peers)
+        text << "graphene_p2p_peer_queued_bytes{" << labels_and_peer.first << "} " << labels_and_peer.second->get_total_queued_messages_size() << "\n";
+      describe("graphene_p2p_peer_duplicate_items_received_total", "counter", "Blocks received from the peer that we had already accepted");
+      for (const auto& labels_and_peer : peers)
+        text << "graphene_p2p_peer_duplicate_items_received_total{" << labels_and_peer.first << "} " << labels_and_peer.second->metrics.duplicate_items_received << "\n";
+      describe("graphene_p2p_peer_latency_seconds", "summary", "Request to response delays, and block receipt to apply times, by peer");
+      for (const auto& labels_and_peer : peers)
+        write_latencies("graphene_p2p_peer_latency_seconds", labels_and_peer.first + ",", labels_and_peer.second->metrics);
+      return text.str();
+    }
+
     bool node_impl::is_hard_fork_block(uint32_t block_number) const
     {
       return std::binary_search(_hard_fork_block_numbers.begin(), _hard_fork_block_numbers.end(), block_number);
@@ -5240,6 +6169,16 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(network_get_usage_stats);
   }
 
+  fc::variant_object node::get_p2p_metrics() const
+  {
+    INVOKE_IN_IMPL(get_p2p_metrics);
+  }
+
+  std::string node::get_p2p_metrics_text() const
+  {
+    INVOKE_IN_IMPL(get_p2p_metrics_text);
+  }
+
   void node::close()
   {
     INVOKE_IN_IMPL(close);
@@ -5302,6 +6241,131 @@ namespace graphene { namespace net { namespace detail {
     network_nodes.push_back(new node_info(node_delegate_to_add));
   }
 
+  signed_block_header node_delegate::get_block_header( const item_hash_t& block_id )
+  {
+    return get_item(item_id(block_message_type, block_id)).as<graphene::net::block_message>().block;
+  }
+
+  block_signing_schedule node_delegate::get_block_signing_schedule()
+  {
+    return block_signing_schedule();
+  }
+
+  size_t check_sync_block_headers( const std::vector<signed_block_header>& headers,
+                                   const std::vector<item_hash_t>& block_ids,
+                                   const std::vector<fc::ecc::public_key_data>& signers,
+                                   const fc::optional<item_hash_t>& previous_block_id,
+                                   const block_signing_schedule& schedule,
+                                   fc::time_point_sec latest_acceptable_timestamp,
+                                   std::vector<char>& trusted_signers )
+  {
+    FC_ASSERT(block_ids.size() >= headers.size() && signers.size() == headers.size());
+    trusted_signers.assign(headers.size(), 0);
+    bool schedule_known = !schedule.slot_signing_keys.empty() || !schedule.signing_keys.empty();
+    // we only know the slots of the blocks built on our head block
+    bool on_scheduled_slots = !headers.empty() && headers.front().previous == schedule.head_block_id &&
+                              !schedule.slot_signing_keys.empty() && schedule.block_interval > 0;
+    for (size_t i = 0; i < headers.size(); ++i)
+    {
+      const signed_block_header& header = headers[i];
+      bool links_to_previous = i > 0 ? header.previous == block_ids[i - 1] :
+                                       !previous_block_id || header.previous == *previous_block_id;
+      if (!links_to_previous ||
+          (i > 0 && header.timestamp <= headers[i - 1].timestamp) ||
+          header.timestamp > latest_acceptable_timestamp)
+        return i;
+
+      if (on_scheduled_slots && header.block_num() > schedule.last_scheduled_block_num)
+        on_scheduled_slots = false;
+      if (on_scheduled_slots)
+      {
+        // the chain rejects a block that isn't at a slot time, whoever signed it.  the signer is only
+        // trusted when it is the scheduled miner, a miner may have changed its key in the blocks before
+        if (header.timestamp < schedule.first_slot_time ||
+            (header.timestamp - schedule.first_slot_time).to_seconds() % schedule.block_interval != 0)
+          return i;
+        uint64_t slot = (header.timestamp - schedule.first_slot_time).to_seconds() / schedule.block_interval;
+        trusted_signers[i] = signers[i] == schedule.slot_signing_keys[slot % schedule.slot_signing_keys.size()];
+        if (header.timestamp >= schedule.next_maintenance_time)
+          on_scheduled_slots = false;
+      }
+      else
+        trusted_signers[i] = !schedule_known ||
+                             (schedule.block_interval > 0 &&
+                              header.timestamp.sec_since_epoch() % schedule.block_interval == 0 &&
+                              schedule.signing_keys.find(signers[i]) != schedule.signing_keys.end());
+    }
+    return headers.size();
+  }
+
+  received_sync_blocks::iterator find_next_sync_block( received_sync_blocks& blocks,
+                                                       const std::vector<item_hash_t>& next_block_ids )
+  {
+    auto next_block_iter = blocks.end();
+    for (const item_hash_t& next_block_id : next_block_ids)
+    {
+      auto received_block_iter = blocks.find(next_block_id);
+      if (received_block_iter != blocks.end() &&
+          (next_block_iter == blocks.end() || received_block_iter->first < next_block_iter->first))
+        next_block_iter = received_block_iter;
+    }
+    return next_block_iter;
+  }
+
+  bool sync_block_matches_id( const block_message& block_message_to_check )
+  {
+    const signed_block& block = block_message_to_check.block;
+    return block.id() == block_message_to_check.block_id &&
+           block.calculate_merkle_root() == block.transaction_merkle_root;
+  }
+
+  std::vector<fc::oexception> node_delegate::handle_sync_blocks( const std::vector<graphene::net::block_message>& blk_msgs )
+  {
+    std::vector<fc::oexception> results;
+    results.reserve(blk_msgs.size());
+    for (const graphene::net::block_message& blk_msg : blk_msgs)
+    {
+      try
+      {
+        std::vector<fc::uint160_t> contained_transaction_message_ids;
+        handle_block(blk_msg, true, contained_transaction_message_ids, true);
+        results.push_back(fc::oexception());
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        throw;
+      }
+      catch ( const fc::exception& e )
+      {
+        results.push_back(e);
+      }
+    }
+    return results;
+  }
+
+  std::vector<fc::oexception> node_delegate::handle_transactions( const std::vector<graphene::net::trx_message>& trx_msgs )
+  {
+    std::vector<fc::oexception> results;
+    results.reserve(trx_msgs.size());
+    for (const graphene::net::trx_message& trx_msg : trx_msgs)
+    {
+      try
+      {
+        handle_transaction(trx_msg);
+        results.push_back(fc::oexception());
+      }
+      catch ( const fc::canceled_exception& )
+      {
+        throw;
+      }
+      catch ( const fc::exception& e )
+      {
+        results.push_back(e);
+      }
+    }
+    return results;
+  }
+
   namespace detail
   {
 #define ROLLING_WINDOW_SIZE 1000
@@ -5417,11 +6481,21 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids, stoppable);
     }
 
+    std::vector<fc::oexception> statistics_gathering_node_delegate_wrapper::handle_sync_blocks( const std::vector<graphene::net::block_message>& block_messages )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(handle_sync_blocks, block_messages);
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
     }
 
+    std::vector<fc::oexception> statistics_gathering_node_delegate_wrapper::handle_transactions( const std::vector<graphene::net::trx_message>& transaction_messages )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(handle_transactions, transaction_messages);
+    }
+
     std::vector<item_hash_t> statistics_gathering_node_delegate_wrapper::get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                                                                        uint32_t& remaining_item_count,
                                                                                        uint32_t limit /* = 2000 */)
@@ -5434,6 +6508,16 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(get_item, id);
     }
 
+    signed_block_header statistics_gathering_node_delegate_wrapper::get_block_header( const item_hash_t& block_id )
+    {
+      INVOKE_AND_COLLECT_STATISTICS(get_block_header, block_id);
+    }
+
+    block_signing_schedule statistics_gathering_node_delegate_wrapper::get_block_signing_schedule()
+    {
+      INVOKE_AND_COLLECT_STATISTICS(get_block_signing_schedule);
+    }
+
     chain_id_type statistics_gathering_node_delegate_wrapper::get_chain_id() const
     {
       INVOKE_AND_COLLECT_STATISTICS(get_chain_id);
@@ -42,24 +42,72 @@
 
 namespace graphene { namespace net
   {
-    message peer_connection::real_queued_message::get_message(peer_connection_delegate*)
+    void latency_counter::record(fc::microseconds latency)
+    {
+      ++count;
+      total += latency;
+      max = std::max(max, latency);
+    }
+
+    void latency_counter::add(const latency_counter& other)
+    {
+      count += other.count;
+      total += other.total;
+      max = std::max(max, other.max);
+    }
+
+    void traffic_metrics::count_sent_message(const message& sent_message)
+    {
+      message_type_counters& counters = message_types[sent_message.msg_type];
+      ++counters.messages_sent;
+      counters.bytes_sent += sizeof(message_header) + sent_message.size;
+    }
+
+    void traffic_metrics::count_received_message(const message& received_message)
+    {
+      message_type_counters& counters = message_types[received_message.msg_type];
+      ++counters.messages_received;
+      counters.bytes_received += sizeof(message_header) + received_message.size;
+    }
+
+    void traffic_metrics::add(const traffic_metrics& other)
+    {
+      for (const auto& type_and_counters : other.message_types)
+      {
+        message_type_counters& counters = message_types[type_and_counters.first];
+        counters.messages_sent += type_and_counters.second.messages_sent;
+        counters.bytes_sent += type_and_counters.second.bytes_sent;
+        counters.messages_received += type_and_counters.second.messages_received;
+        counters.bytes_received += type_and_counters.second.bytes_received;
+      }
+      item_ids_latency.add(other.item_ids_latency);
+      sync_item_latency.add(other.sync_item_latency);
+      item_latency.add(other.item_latency);
+      block_apply_latency.add(other.block_apply_latency);
+      duplicate_items_received += other.duplicate_items_received;
+      duplicate_inventory_received += other.duplicate_inventory_received;
+    }
+
+    shared_message_ptr peer_connection::real_queued_message::get_message(peer_connection_delegate*)
     {
       if (message_send_time_field_offset != (size_t)-1)
       {
-        // patch the current time into the message.  Since this operates on the packed version of the structure,
-        // it won't work for anything after a variable-length field
+        // patch the current time into a copy of the message, the original may be shared.  Since this operates
+        // on the packed version of the structure, it won't work for anything after a variable-length field
         std::vector<char> packed_current_time = fc::raw::pack(fc::time_point::now());
-        assert(message_send_time_field_offset + packed_current_time.size() <= message_to_send.data.size());
-        memcpy(message_to_send.data.data() + message_send_time_field_offset,
+        assert(message_send_time_field_offset + packed_current_time.size() <= message_to_send->data.size());
+        std::shared_ptr<message> patched_message = std::make_shared<message>(*message_to_send);
+        memcpy(patched_message->data.data() + message_send_time_field_offset,
                packed_current_time.data(), packed_current_time.size());
+        return patched_message;
       }
       return message_to_send;
     }
     size_t peer_connection::real_queued_message::get_size_in_queue()
     {
-      return message_to_send.data.size();
+      return message_to_send->data.size();
     }
-    message peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
+    shared_message_ptr peer_connection::virtual_queued_message::get_message(peer_connection_delegate* node)
     {
       return node->get_message_for_item(item_to_send);
     }
@@ -69,9 +117,39 @@ namespace graphene { namespace net
       return sizeof(item_id);
     }
 
+    token_bucket::token_bucket() :
+      _tokens(0),
+      _updated(fc::time_point::min())
+    {
+    }
+
+    void token_bucket::refill(double tokens_per_second, double burst, fc::time_point now)
+    {
+      if (_updated == fc::time_point::min())
+        _tokens = burst;
+      else if (now > _updated)
+        _tokens = std::min<double>(burst, _tokens + (now - _updated).count() / 1000000.0 * tokens_per_second);
+      _updated = std::max(now, _updated);
+    }
+
+    uint32_t token_bucket::take(uint32_t count)
+    {
+      uint32_t taken = (uint32_t)std::min<double>(count, std::max<double>(_tokens, 0));
+      _tokens -= taken;
+      return taken;
+    }
+
+    fc::time_point token_bucket::next_token_time(double tokens_per_second) const
+    {
+      if (_tokens >= 1.0)
+        return _updated;
+      return _updated + fc::microseconds((int64_t)((1.0 - _tokens) / tokens_per_second * 1000000.0) + 1);
+    }
+
     peer_connection::peer_connection(peer_connection_delegate* delegate) :
       _node(delegate),
       _message_connection(this),
+      _reads_on_io_thread(false),
       _total_queued_messages_size(0),
       direction(peer_connection_direction::unknown),
       is_firewalled(firewalled_state::unknown),
@@ -80,11 +158,18 @@ namespace graphene { namespace net
       their_state(their_connection_state::disconnected),
       we_have_requested_close(false),
       negotiation_status(connection_negotiation_status::disconnected),
+      supports_compact_blocks(false),
+      supports_block_headers(false),
+      number_of_blocks_received(0),
       number_of_unfetched_item_ids(0),
       peer_needs_sync_items_from_us(true),
       we_need_sync_items_from_peer(true),
       inhibit_fetching_sync_blocks(false),
+      pending_compact_block_used_our_transactions(false),
       transaction_fetching_inhibited_until(fc::time_point::min()),
+      transactions_admitted(0),
+      transactions_rejected(0),
+      transaction_rate_limit_hits(0),
       last_known_fork_block_number(0),
       firewall_check_state(nullptr)
 #ifndef NDEBUG
@@ -104,8 +189,10 @@ namespace graphene { namespace net
       // current task yields.  In the (not uncommon) case where it is the task executing
       // connect_to or read_loop, this allows the task to finish before the destructor is forced
       // to cancel it.
-      return peer_connection_ptr(new peer_connection(delegate));
+      peer_connection_ptr new_peer(new peer_connection(delegate));
       //, [](peer_connection* peer_to_delete){ fc::async([peer_to_delete](){delete peer_to_delete;}); });
+      new_peer->_weak_self = new_peer;
+      return new_peer;
     }
 
     void peer_connection::destroy()
@@ -182,6 +269,14 @@ namespace graphene { namespace net
       return _message_connection.get_socket();
     }
 
+    void peer_connection::set_io_thread(const std::shared_ptr<fc::thread>& io_thread,
+                                        const std::shared_ptr<fc::rate_limiting_group>& io_rate_limiter)
+    {
+      VERIFY_CORRECT_THREAD();
+      _message_connection.set_io_thread(io_thread, io_rate_limiter);
+      _reads_on_io_thread = true;
+    }
+
     void peer_connection::accept_connection()
     {
       VERIFY_CORRECT_THREAD();
@@ -264,12 +359,22 @@ namespace graphene { namespace net
 
     void peer_connection::on_message( message_oriented_connection* originating_connection, const message& received_message )
     {
+      if (_reads_on_io_thread)
+      {
+        _node->queue_incoming_message( _weak_self, received_message );
+        return;
+      }
       VERIFY_CORRECT_THREAD();
       _node->on_message( this, received_message );
     }
 
     void peer_connection::on_connection_closed( message_oriented_connection* originating_connection )
     {
+      if (_reads_on_io_thread)
+      {
+        _node->queue_incoming_message( _weak_self, fc::optional<message>() );
+        return;
+      }
       VERIFY_CORRECT_THREAD();
       negotiation_status = connection_negotiation_status::closed;
       _node->on_connection_closed( this );
@@ -288,13 +393,14 @@ namespace graphene { namespace net
       while (!_queued_messages.empty())
       {
         _queued_messages.front()->transmission_start_time = fc::time_point::now();
-        message message_to_send = _queued_messages.front()->get_message(_node);
+        shared_message_ptr message_to_send = _queued_messages.front()->get_message(_node);
         try
         {
           //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
           //     "to send message of type ${type} for peer ${endpoint}",
-          //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
+          //     ("type", message_to_send->msg_type)("endpoint", get_remote_endpoint()));
           _message_connection.send_message(message_to_send);
+          metrics.count_sent_message(*message_to_send);
           //dlog("peer_connection::send_queued_messages_task()'s call to message_oriented_connection::send_message() completed normally for peer ${endpoint}",
           //     ("endpoint", get_remote_endpoint()));
         }
@@ -368,7 +474,15 @@ namespace graphene { namespace net
       VERIFY_CORRECT_THREAD();
       //dlog("peer_connection::send_message() enqueueing message of type ${type} for peer ${endpoint}",
       //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
-      std::unique_ptr<queued_message> message_to_enqueue(new real_queued_message(message_to_send, message_send_time_field_offset));
+      std::unique_ptr<queued_message> message_to_enqueue(new real_queued_message(std::make_shared<const message>(message_to_send),
+                                                                                 message_send_time_field_offset));
+      send_queueable_message(std::move(message_to_enqueue));
+    }
+
+    void peer_connection::send_message(shared_message_ptr message_to_send)
+    {
+      VERIFY_CORRECT_THREAD();
+      std::unique_ptr<queued_message> message_to_enqueue(new real_queued_message(std::move(message_to_send)));
       send_queueable_message(std::move(message_to_enqueue));
     }
 
@@ -409,6 +523,18 @@ namespace graphene { namespace net
       return _message_connection.get_total_bytes_received();
     }
 
+    size_t peer_connection::get_queued_message_count() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _queued_messages.size();
+    }
+
+    size_t peer_connection::get_total_queued_messages_size() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _total_queued_messages_size;
+    }
+
     fc::time_point peer_connection::get_last_message_sent_time() const
     {
       VERIFY_CORRECT_THREAD();
@@ -421,6 +547,24 @@ namespace graphene { namespace net
       return _message_connection.get_last_message_received_time();
     }
 
+    void peer_connection::enable_compression()
+    {
+      VERIFY_CORRECT_THREAD();
+      _message_connection.enable_compression();
+    }
+
+    double peer_connection::get_compression_ratio_sent() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _message_connection.get_compression_ratio_sent();
+    }
+
+    double peer_connection::get_compression_ratio_received() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _message_connection.get_compression_ratio_received();
+    }
+
     fc::optional<fc::ip::endpoint> peer_connection::get_remote_endpoint()
     {
       VERIFY_CORRECT_THREAD();
@@ -441,7 +585,8 @@ namespace graphene { namespace net
     bool peer_connection::busy()
     {
       VERIFY_CORRECT_THREAD();
-      return !items_requested_from_peer.empty() || !sync_items_requested_from_peer.empty() || item_ids_requested_from_peer;
+      return !items_requested_from_peer.empty() || !sync_items_requested_from_peer.empty() || item_ids_requested_from_peer ||
+             block_headers_requested_from_peer;
     }
 
     bool peer_connection::idle()
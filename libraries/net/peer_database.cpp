@@ -30,11 +30,22 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
 
 #include <graphene/net/peer_database.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#define MAXIMUM_PEERDB_SIZE 1000
+// the log is rewritten once it holds this many more entries than there are peers
+#define PEERDB_LOG_COMPACTION_SLACK 1000
+// appended entries are buffered and written out at most this often, and on close
+#define PEERDB_LOG_FLUSH_INTERVAL_SEC 10
 
 
 namespace graphene { namespace net {
@@ -59,10 +70,34 @@ namespace graphene { namespace net {
                                                                     std::hash<fc::ip::endpoint> > > > potential_peer_set;
 
     private:
+      /**
+       * The database file is a log of changes, each a uint32_t size followed by the packed
+       * peer_database_log_entry_type and potential_peer_record (just the endpoint matters
+       * for an erase).  Changes are appended as they happen and flushed every few seconds;
+       * a crash loses the last ones, a partly written entry is dropped when the log is loaded.
+       * The log is rewritten with one entry per peer when it grows too long
+       */
+      enum peer_database_log_entry_type
+      {
+        update_log_entry = 0,
+        erase_log_entry = 1
+      };
+
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      std::ofstream _log_file;
+      size_t _log_entry_count;
+      fc::time_point _last_log_flush_time;
+
+      void load_log();
+      void load_legacy_json(const fc::path& json_filename);
+      bool prune();
+      void append_log_entry(peer_database_log_entry_type entry_type, const potential_peer_record& record);
+      void compact();
 
     public:
+      peer_database_impl() : _log_entry_count(0) {}
+
       void open(const fc::path& databaseFilename);
       void close();
       void clear();
@@ -70,6 +105,7 @@ namespace graphene { namespace net {
       void update_entry(const potential_peer_record& updatedRecord);
       potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
       fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
+      std::vector<potential_peer_record> get_entries_by_score() const;
 
       peer_database::iterator begin() const;
       peer_database::iterator end() const;
@@ -91,60 +127,207 @@ namespace graphene { namespace net {
     void peer_database_impl::open(const fc::path& peer_database_filename)
     {
       _peer_database_filename = peer_database_filename;
-      if (fc::exists(_peer_database_filename))
+      _potential_peer_set.clear();
+      _log_entry_count = 0;
+      bool needs_compaction = true;
+      try
+      {
+        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
+        if (!fc::exists(peer_database_filename_dir))
+          fc::create_directories(peer_database_filename_dir);
+
+        fc::path legacy_json_filename = _peer_database_filename;
+        legacy_json_filename.replace_extension(".json");
+        if (fc::exists(_peer_database_filename))
+        {
+          load_log();
+          needs_compaction = _log_entry_count > _potential_peer_set.size() + PEERDB_LOG_COMPACTION_SLACK;
+        }
+        else if (legacy_json_filename != _peer_database_filename && fc::exists(legacy_json_filename))
+          load_legacy_json(legacy_json_filename);
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e));
+        _potential_peer_set.clear();
+      }
+
+      if (prune())
+        needs_compaction = true;
+
+      try
       {
+        if (needs_compaction)
+          compact();
+        else
+        {
+          _log_file.open(_peer_database_filename.generic_string().c_str(), std::ios::binary | std::ios::out | std::ios::app);
+          _last_log_flush_time = fc::time_point::now();
+        }
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error writing peer database file ${peer_database_filename}: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e));
+      }
+    }
+
+    void peer_database_impl::load_log()
+    {
+      std::string contents;
+      fc::read_file_contents(_peer_database_filename, contents);
+      size_t position = 0;
+      while (position + sizeof(uint32_t) <= contents.size())
+      {
+        uint32_t entry_size;
+        memcpy(&entry_size, contents.data() + position, sizeof(entry_size));
+        if (entry_size > contents.size() - position - sizeof(uint32_t))
+          break;
         try
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >();
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-#define MAXIMUM_PEERDB_SIZE 1000
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
-          {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
-          }
+          fc::datastream<const char*> ds(contents.data() + position + sizeof(uint32_t), entry_size);
+          uint8_t entry_type;
+          potential_peer_record record;
+          fc::raw::unpack(ds, entry_type);
+          fc::raw::unpack(ds, record);
+          if (entry_type == erase_log_entry)
+            _potential_peer_set.get<endpoint_index>().erase(record.endpoint);
+          else
+            update_entry(record);
         }
-        catch (const fc::exception& e)
+        catch (const fc::exception&)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
-               ("peer_database_filename", _peer_database_filename));
+          break;
         }
+        position += sizeof(uint32_t) + entry_size;
+        ++_log_entry_count;
+      }
+      // force a compaction to drop the rest
+      if (position != contents.size())
+      {
+        wlog("ignoring ${count} bytes of damaged peer database entries in ${peer_database_filename}",
+             ("count", contents.size() - position)("peer_database_filename", _peer_database_filename));
+        _log_entry_count = std::numeric_limits<size_t>::max();
       }
     }
 
-    void peer_database_impl::close()
+    void peer_database_impl::load_legacy_json(const fc::path& json_filename)
+    {
+      ilog("converting peer database ${json_filename} to ${peer_database_filename}",
+           ("json_filename", json_filename)("peer_database_filename", _peer_database_filename));
+      std::vector<potential_peer_record> peer_records = fc::json::from_file(json_filename).as<std::vector<potential_peer_record> >();
+      for (const potential_peer_record& record : peer_records)
+        update_entry(record);
+    }
+
+    bool peer_database_impl::prune()
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
+      if (_potential_peer_set.size() <= MAXIMUM_PEERDB_SIZE)
+        return false;
+      // prune database to a reasonable size, keeping the best peers
+      std::vector<potential_peer_record> peer_records = get_entries_by_score();
+      for (size_t i = MAXIMUM_PEERDB_SIZE; i < peer_records.size(); ++i)
+        _potential_peer_set.get<endpoint_index>().erase(peer_records[i].endpoint);
+      return true;
+    }
 
-      try
+    void peer_database_impl::append_log_entry(peer_database_log_entry_type entry_type, const potential_peer_record& record)
+    {
+      if (!_log_file.is_open())
+        return;
+      uint8_t packed_entry_type = (uint8_t)entry_type;
+      std::vector<char> entry(sizeof(uint32_t) + fc::raw::pack_size(packed_entry_type) + fc::raw::pack_size(record));
+      uint32_t entry_size = (uint32_t)(entry.size() - sizeof(uint32_t));
+      memcpy(entry.data(), &entry_size, sizeof(entry_size));
+      fc::datastream<char*> ds(entry.data() + sizeof(uint32_t), entry_size);
+      fc::raw::pack(ds, packed_entry_type);
+      fc::raw::pack(ds, record);
+      _log_file.write(entry.data(), entry.size());
+      fc::time_point now = fc::time_point::now();
+      if (now - _last_log_flush_time >= fc::seconds(PEERDB_LOG_FLUSH_INTERVAL_SEC))
       {
-        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
-        if (!fc::exists(peer_database_filename_dir))
-          fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file(peer_records, _peer_database_filename);
+        _log_file.flush();
+        _last_log_flush_time = now;
       }
-      catch (const fc::exception& e)
+      if (!_log_file)
+      {
+        elog("error appending to peer database file ${peer_database_filename}", ("peer_database_filename", _peer_database_filename));
+        _log_file.close();
+        return;
+      }
+
+      if (++_log_entry_count > _potential_peer_set.size() + PEERDB_LOG_COMPACTION_SLACK)
+      {
+        try
+        {
+          compact();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error compacting peer database file ${peer_database_filename}: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e));
+        }
+      }
+    }
+
+    void peer_database_impl::compact()
+    {
+      _log_file.close();
+      fc::path temporary_filename = _peer_database_filename;
+      temporary_filename.replace_extension(".tmp");
       {
-        elog("error saving peer database to file ${peer_database_filename}", 
-             ("peer_database_filename", _peer_database_filename));
+        std::ofstream temporary_file(temporary_filename.generic_string().c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+        for (const potential_peer_record& record : _potential_peer_set)
+        {
+          std::vector<char> packed_record = fc::raw::pack(record);
+          uint8_t entry_type = update_log_entry;
+          uint32_t entry_size = (uint32_t)(fc::raw::pack_size(entry_type) + packed_record.size());
+          temporary_file.write((const char*)&entry_size, sizeof(entry_size));
+          temporary_file.write((const char*)&entry_type, sizeof(entry_type));
+          temporary_file.write(packed_record.data(), packed_record.size());
+        }
+        temporary_file.flush();
+        FC_ASSERT(temporary_file, "error writing ${temporary_filename}", ("temporary_filename", temporary_filename));
       }
+      fc::rename(temporary_filename, _peer_database_filename);
+      _log_entry_count = _potential_peer_set.size();
+      _log_file.open(_peer_database_filename.generic_string().c_str(), std::ios::binary | std::ios::out | std::ios::app);
+      _last_log_flush_time = fc::time_point::now();
+    }
+
+    void peer_database_impl::close()
+    {
+      // closing flushes the changes still buffered
+      _log_file.close();
       _potential_peer_set.clear();
     }
 
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      if (_log_file.is_open())
+      {
+        try
+        {
+          compact();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error clearing peer database file ${peer_database_filename}: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e));
+        }
+      }
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+        append_log_entry(erase_log_entry, potential_peer_record(endpointToErase));
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
@@ -154,6 +337,7 @@ namespace graphene { namespace net {
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
       else
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+      append_log_entry(update_log_entry, updatedRecord);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -172,6 +356,26 @@ namespace graphene { namespace net {
       return fc::optional<potential_peer_record>();
     }
 
+    std::vector<potential_peer_record> peer_database_impl::get_entries_by_score() const
+    {
+      std::vector<std::pair<double, const potential_peer_record*> > scored_records;
+      scored_records.reserve(_potential_peer_set.size());
+      for (const potential_peer_record& record : _potential_peer_set)
+        scored_records.emplace_back(record.get_score(), &record);
+      // the most recently seen first among equally scored peers
+      std::stable_sort(scored_records.begin(), scored_records.end(),
+                       [](const std::pair<double, const potential_peer_record*>& a, const std::pair<double, const potential_peer_record*>& b) {
+        if (a.first != b.first)
+          return a.first > b.first;
+        return a.second->last_seen_time > b.second->last_seen_time;
+      });
+      std::vector<potential_peer_record> result;
+      result.reserve(scored_records.size());
+      for (const auto& scored_record : scored_records)
+        result.push_back(*scored_record.second);
+      return result;
+    }
+
     peer_database::iterator peer_database_impl::begin() const
     {
       return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<last_seen_time_index>().begin()));
@@ -217,6 +421,16 @@ namespace graphene { namespace net {
 
   } // end namespace detail
 
+  double potential_peer_record::get_score() const
+  {
+    // each term grows slowly so no single one dominates: a peer needs about e times the uptime
+    // or blocks to gain a point, and loses one per failed attempt and per 100ms of latency
+    double score = std::log1p(seconds_connected / 60.0) + std::log1p((double)number_of_blocks_received);
+    score -= number_of_failed_connection_attempts;
+    score -= last_round_trip_delay.count() / 100000.0;
+    return score;
+  }
+
   peer_database::peer_database() :
     my(new detail::peer_database_impl)
   {
@@ -260,6 +474,11 @@ namespace graphene { namespace net {
     return my->lookup_entry_for_endpoint(endpoint_to_lookup);
   }
 
+  std::vector<potential_peer_record> peer_database::get_entries_by_score() const
+  {
+    return my->get_entries_by_score();
+  }
+
   peer_database::iterator peer_database::begin() const
   {
     return my->begin();
@@ -38,8 +38,12 @@ namespace graphene { namespace net {
 
 stcp_socket::stcp_socket()
 //:_buf_len(0)
+   : _sending_ctr(false),
+     _receiving_ctr(false),
+     _read_buffer_length(0),
+     _write_buffer_length(0)
 #ifndef NDEBUG
-   : _read_buffer_in_use(false),
+   , _read_buffer_in_use(false),
      _write_buffer_in_use(false)
 #endif
 {
@@ -48,7 +52,7 @@ stcp_socket::~stcp_socket()
 {
 }
 
-void stcp_socket::do_key_exchange()
+void stcp_socket::do_key_exchange( bool initiator )
 {
   _priv_key = fc::ecc::private_key::generate();
   fc::ecc::public_key pub = _priv_key.get_public_key();
@@ -66,13 +70,63 @@ void stcp_socket::do_key_exchange()
                   fc::city_hash_crc_128((char*)&_shared_secret,sizeof(_shared_secret) ) );
   _recv_aes.init( fc::sha256::hash( (char*)&_shared_secret, sizeof(_shared_secret) ), 
                   fc::city_hash_crc_128((char*)&_shared_secret,sizeof(_shared_secret) ) );
+
+  // a ctr keystream must never encrypt two streams, so each direction gets its own key
+  std::string secret((char*)&_shared_secret, sizeof(_shared_secret));
+  fc::sha256 initiator_key = fc::sha256::hash( secret + "initiator" );
+  fc::sha256 acceptor_key = fc::sha256::hash( secret + "acceptor" );
+  fc::uint128 ctr_init_value = fc::city_hash_crc_128( (char*)&_shared_secret, sizeof(_shared_secret) );
+  _send_ctr_aes.init_ctr( initiator ? initiator_key : acceptor_key, ctr_init_value );
+  _recv_ctr_aes.init_ctr( initiator ? acceptor_key : initiator_key, ctr_init_value );
+}
+
+void stcp_socket::encrypt( const char* plaintext, size_t len, char* ciphertext )
+{
+  uint32_t ciphertext_len = _sending_ctr ? _send_ctr_aes.encode( plaintext, len, ciphertext )
+                                         : _send_aes.encode( plaintext, len, ciphertext );
+  assert(ciphertext_len == len);
+}
+
+void stcp_socket::decrypt( const char* ciphertext, size_t len, char* plaintext )
+{
+  if( _receiving_ctr )
+    _recv_ctr_aes.decode( ciphertext, len, plaintext );
+  else
+    _recv_aes.decode( ciphertext, len, plaintext );
+}
+
+void stcp_socket::reserve_read_buffer( size_t len )
+{
+  if( _read_buffer_length >= len )
+    return;
+  // a read still in progress keeps its own reference to the old buffer
+  _read_buffer.reset(new char[len], [](char* p){ delete[] p; });
+  _read_buffer_length = len;
+}
+
+void stcp_socket::reserve_write_buffer( size_t len )
+{
+  if( _write_buffer_length >= len )
+    return;
+  _write_buffer.reset(new char[len], [](char* p){ delete[] p; });
+  _write_buffer_length = len;
+}
+
+void stcp_socket::switch_sending_to_ctr()
+{
+  _sending_ctr = true;
+}
+
+void stcp_socket::switch_receiving_to_ctr()
+{
+  _receiving_ctr = true;
 }
 
 
 void stcp_socket::connect_to( const fc::ip::endpoint& remote_endpoint )
 {
   _sock.connect_to( remote_endpoint );
-  do_key_exchange();
+  do_key_exchange( true );
 }
 
 void stcp_socket::bind( const fc::ip::endpoint& local_endpoint )
@@ -101,8 +155,7 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
 #endif
 
     const size_t read_buffer_length = 4096;
-    if (!_read_buffer)
-      _read_buffer.reset(new char[read_buffer_length], [](char* p){ delete[] p; });
+    reserve_read_buffer(read_buffer_length);
 
     len = std::min<size_t>(read_buffer_length, len);
 
@@ -112,7 +165,7 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
       _sock.read(_read_buffer, 16 - (s%16), s);
       s += 16-(s%16);
     }
-    _recv_aes.decode( _read_buffer.get(), s, buffer );
+    decrypt( _read_buffer.get(), s, buffer );
     return s;
 } FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
 
@@ -142,8 +195,7 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
 #endif
 
     const std::size_t write_buffer_length = 4096;
-    if (!_write_buffer)
-      _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
+    reserve_write_buffer(write_buffer_length);
     len = std::min<size_t>(write_buffer_length, len);
     memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
     /**
@@ -152,10 +204,9 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
      * for now because we are going to upgrade to something
      * better.
      */
-    uint32_t ciphertext_len = _send_aes.encode( buffer, len, _write_buffer.get() );
-    assert(ciphertext_len == len);
-    _sock.write( _write_buffer, ciphertext_len );
-    return ciphertext_len;
+    encrypt( buffer, len, _write_buffer.get() );
+    _sock.write( _write_buffer, len );
+    return len;
 } FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
 
 size_t stcp_socket::writesome( const std::shared_ptr<const char>& buf, size_t len, size_t offset )
@@ -163,6 +214,49 @@ size_t stcp_socket::writesome( const std::shared_ptr<const char>& buf, size_t le
   return writesome(buf.get() + offset, len);
 }
 
+void stcp_socket::write_buffers( const std::vector<std::pair<const char*, size_t> >& buffers )
+{ try {
+#ifndef NDEBUG
+    struct check_buffer_in_use {
+      bool& _buffer_in_use;
+      check_buffer_in_use(bool& buffer_in_use) : _buffer_in_use(buffer_in_use) { assert(!_buffer_in_use); _buffer_in_use = true; }
+      ~check_buffer_in_use() { assert(_buffer_in_use); _buffer_in_use = false; }
+    } buffer_in_use_checker(_write_buffer_in_use);
+#endif
+
+    size_t len = 0;
+    for( const auto& buffer : buffers )
+    {
+      assert( (buffer.second % 16) == 0 );
+      len += buffer.second;
+    }
+    reserve_write_buffer(len);
+    size_t offset = 0;
+    for( const auto& buffer : buffers )
+    {
+      if( buffer.second )
+        encrypt( buffer.first, buffer.second, _write_buffer.get() + offset );
+      offset += buffer.second;
+    }
+    _sock.write( _write_buffer, len );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("buffers",buffers.size()) ) }
+
+void stcp_socket::read_decrypted( char* buffer, size_t len )
+{ try {
+    assert( (len % 16) == 0 );
+#ifndef NDEBUG
+    struct check_buffer_in_use {
+      bool& _buffer_in_use;
+      check_buffer_in_use(bool& buffer_in_use) : _buffer_in_use(buffer_in_use) { assert(!_buffer_in_use); _buffer_in_use = true; }
+      ~check_buffer_in_use() { assert(_buffer_in_use); _buffer_in_use = false; }
+    } buffer_in_use_checker(_read_buffer_in_use);
+#endif
+
+    reserve_read_buffer(len);
+    _sock.read( _read_buffer, len, 0 );
+    decrypt( _read_buffer.get(), len, buffer );
+} FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
+
 void stcp_socket::flush()
 {
   _sock.flush();
@@ -179,7 +273,7 @@ void stcp_socket::close()
 
 void stcp_socket::accept()
 {
-  do_key_exchange();
+  do_key_exchange( false );
 }
 
 
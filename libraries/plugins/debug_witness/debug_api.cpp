@@ -7,6 +7,7 @@
 #include <graphene/app/application.hpp>
 
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/contract_offline_executor.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/witness_object.hpp>
 
@@ -30,8 +31,12 @@ class debug_api_impl
       //void debug_save_db( std::string db_path );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
+      std::string debug_profile_contract_offline( const std::string& caller_pubkey, const std::string& contract_address_or_name,
+                                                  const std::string& contract_api, const std::string& contract_arg,
+                                                  uvm::lua::lib::UvmProfileMetric metric );
       std::shared_ptr< graphene::debug_miner_plugin::debug_miner_plugin > get_plugin();
       graphene::app::application& app;
+      std::unique_ptr< graphene::chain::contract_offline_executor > offline_executor;
 };
 
 debug_api_impl::debug_api_impl( graphene::app::application& _app ) : app( _app )
@@ -121,6 +126,35 @@ void debug_api_impl::debug_stream_json_objects_flush()
    get_plugin()->flush_json_object_stream();
 }
 
+std::string debug_api_impl::debug_profile_contract_offline( const std::string& caller_pubkey, const std::string& contract_address_or_name,
+                                                            const std::string& contract_api, const std::string& contract_arg,
+                                                            uvm::lua::lib::UvmProfileMetric metric )
+{
+   std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   graphene::chain::contract_object cont = db->get_contract( contract_address_or_name );
+   if( cont.type_of_contract != graphene::chain::contract_type::native_contract )
+      FC_ASSERT( cont.code.offline_abi.find( contract_api ) != cont.code.offline_abi.end(), "contract api not found" );
+
+   graphene::chain::contract_invoke_operation op;
+   op.gas_price = 0;
+   op.invoke_cost = GRAPHENE_CONTRACT_TESTING_GAS;
+   op.caller_addr = graphene::chain::public_key_type( caller_pubkey );
+   op.caller_pubkey = graphene::chain::public_key_type( caller_pubkey );
+   op.contract_id = cont.contract_address;
+   op.contract_api = contract_api;
+   op.contract_arg = contract_arg;
+   op.fee.amount = 0;
+   op.fee.asset_id = graphene::chain::asset_id_type( 0 );
+   graphene::chain::operation generic_op = op;
+   db->get_global_properties().parameters.current_fees->set_fee( generic_op );
+
+   if( !offline_executor )
+      offline_executor.reset( new graphene::chain::contract_offline_executor( *db, 1 ) );
+   auto profiler = std::make_shared< uvm::lua::lib::UvmProfiler >();
+   offline_executor->invoke( generic_op.get< graphene::chain::contract_invoke_operation >(), fc::seconds( 10 ), profiler );
+   return profiler->collapsed( metric );
+}
+
 } // detail
 
 debug_api::debug_api( graphene::app::application& app )
@@ -153,5 +187,33 @@ void debug_api::debug_stream_json_objects_flush()
    my->debug_stream_json_objects_flush();
 }
 
+static uvm::lua::lib::UvmProfileMetric profile_metric( const std::string& name )
+{
+   uvm::lua::lib::UvmProfileMetric metric;
+   FC_ASSERT( uvm::lua::lib::parse_profile_metric( name, metric ), "unknown profile metric ${m}", ("m", name) );
+   return metric;
+}
+
+void debug_api::debug_set_contract_profiling( bool enabled )
+{
+   uvm::lua::lib::set_node_profiling_enabled( enabled );
+}
+
+void debug_api::debug_reset_contract_profile()
+{
+   uvm::lua::lib::node_profiler()->reset();
+}
+
+std::string debug_api::debug_get_contract_profile( std::string metric )
+{
+   return uvm::lua::lib::node_profiler()->collapsed( profile_metric( metric ) );
+}
+
+std::string debug_api::debug_profile_contract_offline( std::string caller_pubkey, std::string contract_address_or_name,
+                                                       std::string contract_api, std::string contract_arg, std::string metric )
+{
+   return my->debug_profile_contract_offline( caller_pubkey, contract_address_or_name, contract_api, contract_arg, profile_metric( metric ) );
+}
+
 
 } } // graphene::debug_miner
@@ -82,6 +82,30 @@ class debug_api
        */
       void debug_stream_json_objects_flush();
 
+      /**
+       * Trace the contract vms of this node (block and transaction applying and offline calls) into the node profiler.
+       */
+      void debug_set_contract_profiling( bool enabled );
+
+      /**
+       * Clear the counters of the node profiler.
+       */
+      void debug_reset_contract_profile();
+
+      /**
+       * Counters of the node profiler as collapsed stacks (contract;source:linedefined;...;line:N count),
+       * the input of flamegraph.pl.
+       * @param metric one of instructions, gas, wall_time (ns), storage_reads, storage_writes
+       */
+      std::string debug_get_contract_profile( std::string metric );
+
+      /**
+       * Run an offline contract call like database_api::invoke_contract_offline and return its own profile
+       * as collapsed stacks, whether node profiling is enabled or not.
+       */
+      std::string debug_profile_contract_offline( std::string caller_pubkey, std::string contract_address_or_name,
+                                                  std::string contract_api, std::string contract_arg, std::string metric );
+
       std::shared_ptr< detail::debug_api_impl > my;
 };
 
@@ -93,4 +117,8 @@ FC_API(graphene::debug_miner::debug_api,
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
+       (debug_set_contract_profiling)
+       (debug_reset_contract_profile)
+       (debug_get_contract_profile)
+       (debug_profile_contract_offline)
      )
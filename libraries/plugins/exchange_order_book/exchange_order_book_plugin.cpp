@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/exchange_order_book/exchange_order_book_plugin.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/contract_object.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/iterator/reverse_iterator.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/member.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/uint128.hpp>
+
+#include <deque>
+
+namespace graphene { namespace exchange_order_book {
+
+namespace detail
+{
+
+using namespace boost::multi_index;
+
+/** price of an order as quote/base, compared without rounding */
+struct order_price
+{
+   int64_t base;
+   int64_t quote;
+
+   friend bool operator < ( const order_price& a, const order_price& b )
+   {
+      return fc::uint128( uint64_t(a.quote) ) * uint64_t(b.base) < fc::uint128( uint64_t(b.quote) ) * uint64_t(a.base);
+   }
+};
+
+struct order_price_key
+{
+   typedef order_price result_type;
+   result_type operator()( const exchange_open_order& o )const
+   {
+      // the remaining amounts are rounded by the contract on each fill, so they would move
+      // the order between levels and behind orders of the same price
+      return order_price{ o.base_amount, o.quote_amount };
+   }
+};
+
+struct by_order_id;
+struct by_price;
+struct by_owner;
+typedef multi_index_container<
+   exchange_open_order,
+   indexed_by<
+      ordered_unique< tag<by_order_id>,
+         composite_key< exchange_open_order,
+            member< exchange_open_order, address, &exchange_open_order::contract_address >,
+            member< exchange_open_order, string, &exchange_open_order::order_id >
+         >
+      >,
+      ordered_non_unique< tag<by_price>,
+         composite_key< exchange_open_order,
+            member< exchange_open_order, address, &exchange_open_order::contract_address >,
+            member< exchange_open_order, string, &exchange_open_order::exchange_pair >,
+            member< exchange_open_order, bool, &exchange_open_order::is_buy >,
+            order_price_key,
+            member< exchange_open_order, uint64_t, &exchange_open_order::sequence >
+         >
+      >,
+      ordered_non_unique< tag<by_owner>,
+         composite_key< exchange_open_order,
+            member< exchange_open_order, address, &exchange_open_order::contract_address >,
+            member< exchange_open_order, string, &exchange_open_order::owner >,
+            member< exchange_open_order, uint64_t, &exchange_open_order::sequence >
+         >
+      >
+   >
+> open_order_multi_index_type;
+
+/** an order as it was before a change, invalid when the change inserted it */
+struct order_undo
+{
+   address                       contract_address;
+   string                        order_id;
+   optional<exchange_open_order> old_order;
+};
+
+/** the changes a block made to the book, undone in reverse order when the block is popped */
+struct block_undo
+{
+   uint32_t           block_num = 0;
+   uint64_t           next_sequence = 0; ///< _next_sequence before the block
+   vector<order_undo> changes;
+};
+
+class exchange_order_book_plugin_impl
+{
+   public:
+      exchange_order_book_plugin_impl(exchange_order_book_plugin& _plugin);
+      virtual ~exchange_order_book_plugin_impl();
+
+      /** this method is called as a callback after a block is applied
+       * and applies the exchange events of the block to the book.
+       */
+      void on_applied_block( const signed_block& b );
+      /** drop the book and replay all exchange events up to and including block_num */
+      void rebuild( uint32_t block_num );
+      /** undo the blocks after block_num, false when they are not all in the undo history */
+      bool undo_to( uint32_t block_num );
+      void apply_block_events( uint32_t block_num );
+      void record_change( const address& contract_address, const string& order_id,
+                          const optional<exchange_open_order>& old_order );
+      void apply_event( const contract_event_notify_object& e );
+      void apply_filled_orders( const contract_event_notify_object& e, const string& exchange_pair,
+                                bool is_buy, const fc::variants& orders );
+      bool is_tracked_contract( const address& addr );
+
+      graphene::chain::database& database()
+      {
+         return _self.database();
+      }
+
+      exchange_order_book_plugin& _self;
+      bool                        _enabled = false;
+      flat_set<address>           _tracked_contracts;
+      std::map<address, bool>     _exchange_contracts;
+      open_order_multi_index_type _orders;
+      uint64_t                    _next_sequence = 0;
+      uint32_t                    _last_block_num = 0;
+      /** undo info of the last GRAPHENE_MAX_UNDO_HISTORY blocks applied after the last rebuild */
+      std::deque<block_undo>      _undo_blocks;
+};
+
+exchange_order_book_plugin_impl::exchange_order_book_plugin_impl(exchange_order_book_plugin& plugin):_self(plugin){}
+exchange_order_book_plugin_impl::~exchange_order_book_plugin_impl(){}
+
+void exchange_order_book_plugin_impl::on_applied_block( const signed_block& b )
+{
+   const uint32_t block_num = b.block_num();
+   // a block at or below the last one seen means a fork switch, the popped blocks are undone.
+   // only a gap (blocks applied before the plugin was listening) or a fork deeper than the
+   // undo history rereads the events from the index
+   if( block_num == _last_block_num + 1 )
+      apply_block_events( block_num );
+   else if( block_num <= _last_block_num && undo_to( block_num - 1 ) )
+      apply_block_events( block_num );
+   else
+      rebuild( block_num );
+   _last_block_num = block_num;
+}
+
+void exchange_order_book_plugin_impl::rebuild( uint32_t block_num )
+{
+   _orders.clear();
+   _exchange_contracts.clear();
+   _undo_blocks.clear();
+   _next_sequence = 0;
+
+   const auto& event_idx = database().get_index_type<contract_event_notify_index>().indices().get<by_block_num>();
+   auto itr = event_idx.begin();
+   auto end = event_idx.upper_bound( block_num );
+   for( ; itr != end; ++itr )
+      apply_event( *itr );
+   _last_block_num = block_num;
+}
+
+bool exchange_order_book_plugin_impl::undo_to( uint32_t block_num )
+{
+   if( _undo_blocks.empty() || _undo_blocks.front().block_num > block_num + 1 )
+      return false;
+   auto& idx = _orders.get<by_order_id>();
+   while( !_undo_blocks.empty() && _undo_blocks.back().block_num > block_num )
+   {
+      const auto& undo = _undo_blocks.back();
+      for( auto change = undo.changes.rbegin(); change != undo.changes.rend(); ++change )
+      {
+         auto itr = idx.find( boost::make_tuple( change->contract_address, change->order_id ) );
+         if( itr != idx.end() )
+            idx.erase( itr );
+         if( change->old_order.valid() )
+            _orders.insert( *change->old_order );
+      }
+      _next_sequence = undo.next_sequence;
+      _undo_blocks.pop_back();
+   }
+   // a contract of the popped blocks may not exist on the new fork
+   _exchange_contracts.clear();
+   return true;
+}
+
+void exchange_order_book_plugin_impl::record_change( const address& contract_address, const string& order_id,
+                                                     const optional<exchange_open_order>& old_order )
+{
+   if( _undo_blocks.empty() )
+      return;
+   _undo_blocks.back().changes.push_back( order_undo{ contract_address, order_id, old_order } );
+}
+
+void exchange_order_book_plugin_impl::apply_block_events( uint32_t block_num )
+{
+   _undo_blocks.emplace_back();
+   _undo_blocks.back().block_num = block_num;
+   _undo_blocks.back().next_sequence = _next_sequence;
+   while( _undo_blocks.size() > GRAPHENE_MAX_UNDO_HISTORY )
+      _undo_blocks.pop_front();
+
+   const auto& event_idx = database().get_index_type<contract_event_notify_index>().indices().get<by_block_num>();
+   auto range = event_idx.equal_range( block_num );
+   for( auto itr = range.first; itr != range.second; ++itr )
+      apply_event( *itr );
+}
+
+bool exchange_order_book_plugin_impl::is_tracked_contract( const address& addr )
+{
+   if( _tracked_contracts.size() && _tracked_contracts.find( addr ) == _tracked_contracts.end() )
+      return false;
+   auto cached = _exchange_contracts.find( addr );
+   if( cached != _exchange_contracts.end() )
+      return cached->second;
+
+   const auto& contract_idx = database().get_index_type<contract_object_index>().indices().get<by_contract_id>();
+   auto itr = contract_idx.find( addr );
+   // "exchange" is exchange_native_contract::native_contract_key()
+   bool is_exchange = itr != contract_idx.end() && itr->type_of_contract == native_contract
+                      && itr->native_contract_key == "exchange";
+   _exchange_contracts[addr] = is_exchange;
+   return is_exchange;
+}
+
+void exchange_order_book_plugin_impl::apply_event( const contract_event_notify_object& e )
+{
+   if( e.event_name != "BuyOrderPutedOn" && e.event_name != "SellOrderPutedOn" && e.event_name != "CancelOrders" )
+      return;
+   if( !is_tracked_contract( e.contract_address ) )
+      return;
+   try {
+      if( e.event_name == "CancelOrders" )
+      {
+         auto& idx = _orders.get<by_order_id>();
+         for( const auto& id : fc::json::from_string( e.event_arg ).as<vector<string>>() )
+         {
+            auto itr = idx.find( boost::make_tuple( e.contract_address, id ) );
+            if( itr != idx.end() )
+            {
+               record_change( e.contract_address, id, *itr );
+               idx.erase( itr );
+            }
+         }
+         return;
+      }
+      const auto arg = fc::json::from_string( e.event_arg ).get_object();
+      const auto exchange_pair = arg["exchangPair"].as_string();
+      apply_filled_orders( e, exchange_pair, true, arg["transactionBuys"].get_array() );
+      apply_filled_orders( e, exchange_pair, false, arg["transactionSells"].get_array() );
+   } catch( const fc::exception& ex ) {
+      elog( "failed to apply exchange event ${e}: ${ex}", ("e", e)("ex", ex.to_detail_string()) );
+   }
+
+}
+
+void exchange_order_book_plugin_impl::apply_filled_orders( const contract_event_notify_object& e, const string& exchange_pair,
+                                                           bool is_buy, const fc::variants& orders )
+{
+   auto& idx = _orders.get<by_order_id>();
+   for( const auto& order : orders )
+   {
+      // "baseRemain,quoteRemain,owner,orderId,baseFilled,quoteFilled,..." as written by
+      // exchange_native_contract::checkOrder, the filled amounts are totals over all fills
+      vector<string> parts;
+      const auto order_str = order.as_string();
+      boost::split( parts, order_str, boost::is_any_of( "," ) );
+      if( parts.size() < 4 )
+         continue;
+      const int64_t base_remain = fc::to_int64( parts[0] );
+      const int64_t quote_remain = fc::to_int64( parts[1] );
+
+      auto itr = idx.find( boost::make_tuple( e.contract_address, parts[3] ) );
+      if( base_remain <= 0 || quote_remain < 0 )
+      {
+         if( itr != idx.end() )
+         {
+            record_change( e.contract_address, parts[3], *itr );
+            idx.erase( itr );
+         }
+         continue;
+      }
+      if( itr == idx.end() )
+      {
+         record_change( e.contract_address, parts[3], optional<exchange_open_order>() );
+         exchange_open_order o;
+         o.contract_address = e.contract_address;
+         o.exchange_pair = exchange_pair;
+         o.is_buy = is_buy;
+         o.owner = parts[2];
+         o.order_id = parts[3];
+         o.base_remain = base_remain;
+         o.quote_remain = quote_remain;
+         o.base_amount = base_remain;
+         o.quote_amount = quote_remain;
+         if( parts.size() >= 6 )
+         {
+            o.base_amount += fc::to_int64( parts[4] );
+            o.quote_amount += fc::to_int64( parts[5] );
+         }
+         o.block_num = e.block_num;
+         o.sequence = _next_sequence++;
+         _orders.insert( o );
+      }
+      else
+      {
+         record_change( e.contract_address, parts[3], *itr );
+         idx.modify( itr, [&]( exchange_open_order& o ) {
+            o.base_remain = base_remain;
+            o.quote_remain = quote_remain;
+            o.block_num = e.block_num;
+         });
+      }
+   }
+}
+
+template<typename Iter>
+static void collect_price_levels( Iter itr, Iter end, uint32_t limit, vector<exchange_price_level>& levels )
+{
+   optional<order_price> last_price;
+   for( ; itr != end; ++itr )
+   {
+      order_price price{ itr->base_amount, itr->quote_amount };
+      if( !last_price.valid() || *last_price < price || price < *last_price )
+      {
+         if( levels.size() >= limit )
+            break;
+         levels.emplace_back();
+         levels.back().price = double( price.quote ) / double( price.base );
+         last_price = price;
+      }
+      auto& level = levels.back();
+      level.total_base += itr->base_remain;
+      level.total_quote += itr->quote_remain;
+      ++level.order_count;
+   }
+}
+
+} // end namespace detail
+
+exchange_order_book_plugin::exchange_order_book_plugin() :
+   my( new detail::exchange_order_book_plugin_impl(*this) )
+{
+}
+
+exchange_order_book_plugin::~exchange_order_book_plugin()
+{
+}
+
+std::string exchange_order_book_plugin::plugin_name()const
+{
+   return "exchange_order_book";
+}
+
+void exchange_order_book_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+   cli.add_options()
+         ("exchange-order-book", boost::program_options::bool_switch()->default_value(false),
+          "keep an order book of native exchange contracts for the history api")
+         ("exchange-contract", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(),
+          "native exchange contract to keep an order book for (may specify multiple times, default all)");
+   cfg.add(cli);
+}
+
+void exchange_order_book_plugin::plugin_initialize(const boost::program_options::variables_map& options)
+{
+   my->_enabled = options.count("exchange-order-book") && options.at("exchange-order-book").as<bool>();
+   if( !my->_enabled )
+      return;
+   database().applied_block.connect( [&]( const signed_block& b){ my->on_applied_block(b); } );
+   LOAD_VALUE_SET(options, "exchange-contract", my->_tracked_contracts, graphene::chain::address);
+}
+
+void exchange_order_book_plugin::plugin_startup()
+{
+   if( !my->_enabled )
+      return;
+   const uint32_t head = database().head_block_num();
+   if( head != my->_last_block_num )
+      my->rebuild( head );
+}
+
+bool exchange_order_book_plugin::is_enabled()const
+{
+   return my->_enabled;
+}
+
+exchange_order_book_depth exchange_order_book_plugin::get_depth( const address& contract, const string& exchange_pair, uint32_t limit )const
+{
+   exchange_order_book_depth result;
+   result.exchange_pair = exchange_pair;
+
+   const auto& idx = my->_orders.get<detail::by_price>();
+   auto asks = idx.equal_range( boost::make_tuple( contract, exchange_pair, false ) );
+   detail::collect_price_levels( asks.first, asks.second, limit, result.asks );
+
+   auto bids = idx.equal_range( boost::make_tuple( contract, exchange_pair, true ) );
+   detail::collect_price_levels( boost::make_reverse_iterator( bids.second ), boost::make_reverse_iterator( bids.first ),
+                                 limit, result.bids );
+   return result;
+}
+
+vector<exchange_open_order> exchange_order_book_plugin::get_open_orders( const address& contract, const string& owner )const
+{
+   const auto& idx = my->_orders.get<detail::by_owner>();
+   auto range = idx.equal_range( boost::make_tuple( contract, owner ) );
+   return vector<exchange_open_order>( range.first, range.second );
+}
+
+} }
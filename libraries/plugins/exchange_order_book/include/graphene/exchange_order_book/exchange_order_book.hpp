@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/address.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <string>
+#include <vector>
+
+namespace graphene { namespace exchange_order_book {
+   using graphene::chain::address;
+   using std::string;
+   using std::vector;
+
+/**
+ *  An order of the native exchange contract that has been partly filled on chain
+ *  and still has an amount left. Amounts are in the units of the trading pair
+ *  "base/quote" reported by the contract events.
+ */
+struct exchange_open_order
+{
+   address      contract_address;
+   string       exchange_pair;
+   bool         is_buy = false;
+   string       owner;
+   string       order_id;
+   int64_t      base_remain = 0;
+   int64_t      quote_remain = 0;
+   /** remaining plus filled amounts when the order entered the book, its price in the book */
+   int64_t      base_amount = 0;
+   int64_t      quote_amount = 0;
+   uint64_t     block_num = 0;
+   uint64_t     sequence = 0; ///< order of first appearance, used for time priority
+};
+
+/** all open orders of one side of a pair sharing the same price */
+struct exchange_price_level
+{
+   double       price = 0;
+   int64_t      total_base = 0;
+   int64_t      total_quote = 0;
+   uint32_t     order_count = 0;
+};
+
+struct exchange_order_book_depth
+{
+   string                        exchange_pair;
+   vector<exchange_price_level>  bids; ///< highest price first
+   vector<exchange_price_level>  asks; ///< lowest price first
+};
+
+/**
+ *  The queries of the exchange_order_book plugin. The api reaches the plugin through
+ *  this header only interface, so graphene_app doesn't link the plugin.
+ */
+class exchange_order_book_source
+{
+   public:
+      virtual ~exchange_order_book_source() {}
+
+      /** false unless the node was started with exchange-order-book */
+      virtual bool is_enabled()const = 0;
+      virtual exchange_order_book_depth get_depth( const address& contract, const string& exchange_pair, uint32_t limit )const = 0;
+      virtual vector<exchange_open_order> get_open_orders( const address& contract, const string& owner )const = 0;
+};
+
+} } //graphene::exchange_order_book
+
+FC_REFLECT( graphene::exchange_order_book::exchange_open_order,
+            (contract_address)(exchange_pair)(is_buy)(owner)(order_id)(base_remain)(quote_remain)(base_amount)(quote_amount)(block_num)(sequence) )
+FC_REFLECT( graphene::exchange_order_book::exchange_price_level,
+            (price)(total_base)(total_quote)(order_count) )
+FC_REFLECT( graphene::exchange_order_book::exchange_order_book_depth,
+            (exchange_pair)(bids)(asks) )
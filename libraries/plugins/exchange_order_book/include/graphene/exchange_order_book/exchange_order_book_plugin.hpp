@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/exchange_order_book/exchange_order_book.hpp>
+#include <graphene/chain/database.hpp>
+
+namespace graphene { namespace exchange_order_book {
+   using namespace chain;
+
+namespace detail
+{
+    class exchange_order_book_plugin_impl;
+}
+
+/**
+ *  Keeps an in-memory book of the open orders of native exchange contracts.
+ *
+ *  Orders of the native exchange contract are signed off chain and only reach the
+ *  chain when they are matched or canceled, so the book is derived from the
+ *  BuyOrderPutedOn/SellOrderPutedOn/CancelOrders events: an order enters the book
+ *  the first time it is partly filled and leaves it when it is completed or canceled.
+ *  The book is rebuilt from the contract event index on startup, blocks popped by a fork
+ *  switch are undone from the changes recorded for each block.
+ *
+ *  Off unless the node is started with exchange-order-book.
+ */
+class exchange_order_book_plugin : public graphene::app::plugin, public exchange_order_book_source
+{
+   public:
+      exchange_order_book_plugin();
+      virtual ~exchange_order_book_plugin();
+
+      std::string plugin_name()const override;
+      virtual void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg) override;
+      virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
+      virtual void plugin_startup() override;
+
+      bool is_enabled()const override;
+      exchange_order_book_depth get_depth( const address& contract, const string& exchange_pair, uint32_t limit )const override;
+      vector<exchange_open_order> get_open_orders( const address& contract, const string& owner )const override;
+
+      friend class detail::exchange_order_book_plugin_impl;
+      std::unique_ptr<detail::exchange_order_book_plugin_impl> my;
+};
+
+} } //graphene::exchange_order_book
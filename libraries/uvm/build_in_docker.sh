@@ -1,11 +1,13 @@
 #!/bin/bash
 container_id="uvm_uvmbuild_dev"
 docker exec $container_id ./build_deps.sh
-docker exec $container_id cmake .
+docker exec $container_id cmake -DUVM_BUILD_DISPATCH_TEST=ON .
 docker exec $container_id make
 docker exec $container_id chmod +x /code/uvm_single_exec
 docker exec $container_id chmod +x /code/simplechain_runner
+docker exec $container_id chmod +x /code/uvm_single_exec_jumptable
 docker exec $container_id ./test/install_deps.sh
 docker exec $container_id ./test/run_tests.sh
 test -e ./uvm_single_exec
 test -e ./simplechain_runner
+test -e ./uvm_single_exec_jumptable
@@ -61,6 +61,11 @@ namespace cbor_diff {
 		// @throws CborDiffException
 		DiffResultP diff(const cbor::CborObjectP old_val, const cbor::CborObjectP new_val);
 
+		// diff two cbor encoded buffers, same result as diff(cbor_decode(old_bytes), cbor_decode(new_bytes)),
+		// but maps and arrays are walked on the encoded bytes, and only changed items are decoded
+		// @throws CborDiffException
+		DiffResultP diff_encoded(const std::vector<char>& old_bytes, const std::vector<char>& new_bytes);
+
 		cbor::CborObjectP patch_by_string(const std::string& old_hex, DiffResultP diff_info);
 
 		// Ѿɰ汾json,ʹdiffõ°汾
@@ -72,5 +77,8 @@ namespace cbor_diff {
 		// °汾ʹdiffعɰ汾
 		// @throws CborDiffException
 		cbor::CborObjectP rollback(const cbor::CborObjectP new_val, DiffResultP diff_info);
+	private:
+		DiffResultP diff_encoded_items(const cbor::item_span& old_item, const cbor::item_span& new_item);
 	};
+
 }
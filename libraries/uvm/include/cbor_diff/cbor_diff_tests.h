@@ -4,5 +4,6 @@ namespace cbor_diff {
 
 	void test_cbor_json();
 	void test_cbor_diff();
+	void test_cbor_diff_encoded();
 
 }
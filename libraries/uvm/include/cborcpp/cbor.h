@@ -19,6 +19,7 @@
 #include "cborcpp/input.h"
 #include "cborcpp/encoder.h"
 #include "cborcpp/decoder.h"
+#include "cborcpp/reader.h"
 #include "cborcpp/output_static.h"
 #include "cborcpp/output_dynamic.h"
 #include "cborcpp/exceptions.h"
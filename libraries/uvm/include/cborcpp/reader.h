@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cbor {
+
+    // encoded bytes of one complete cbor item(with its nested items)
+    struct item_span {
+        const unsigned char *data;
+        size_t size;
+
+        unsigned char major_type() const { return data[0] >> 5; }
+        bool same_bytes(const item_span &other) const;
+    };
+
+    // zero-copy walker over a cbor encoded buffer.
+    // only accepts the encodings decoder::run consumes the same way as the reader does,
+    // any other input(floats, 8-bytes negative integers, unsorted or duplicate map keys, truncated data...)
+    // makes read_* return false, and the caller should fallback to decoder
+    class reader {
+    private:
+        const unsigned char *_data;
+        size_t _size;
+        size_t _offset;
+    public:
+        reader(const void *data, size_t size);
+        reader(const item_span &item);
+
+        size_t offset() const { return _offset; }
+        bool at_end() const { return _offset == _size; }
+
+        // reads the initial byte and the argument(integer value, length or count) of next item
+        bool read_head(unsigned char &major_type, uint64_t &argument);
+
+        // reads a text string without copying it
+        bool read_string(const char *&str, size_t &size);
+
+        // reads next complete item and returns its encoded bytes
+        bool read_item(item_span &item);
+
+    private:
+        bool skip_item(int depth);
+    };
+
+    // same order as std::map<std::string, ...> keys
+    int compare_map_keys(const char *a, size_t a_size, const char *b, size_t b_size);
+}
@@ -32,6 +32,35 @@ namespace uvm {
 			virtual void current_fast_map_set(const std::string& storage_name, const std::string& key, cbor::CborObjectP cbor_value) = 0;
 			virtual cbor::CborObjectP get_current_contract_storage_cbor(const std::string& storage_name) const = 0;
 			virtual cbor::CborObjectP current_fast_map_get(const std::string& storage_name, const std::string& key) const = 0;
+
+			// typed fast map accessors. implementations can override them to read and write the encoded storage
+			// directly, the storage bytes must be the same as the cbor object versions'
+			// @return false when the value is not an integer(e.g. not set yet)
+			virtual bool current_fast_map_get_int(const std::string& storage_name, const std::string& key, int64_t& value) const {
+				auto cbor_value = current_fast_map_get(storage_name, key);
+				if (!cbor_value->is_integer())
+					return false;
+				value = cbor_value->force_as_int();
+				return true;
+			}
+			// @return false when the value is not a string
+			virtual bool current_fast_map_get_string(const std::string& storage_name, const std::string& key, std::string& value) const {
+				auto cbor_value = current_fast_map_get(storage_name, key);
+				if (!cbor_value->is_string())
+					return false;
+				value = cbor_value->as_string();
+				return true;
+			}
+			virtual void current_fast_map_set_int(const std::string& storage_name, const std::string& key, int64_t value) {
+				current_fast_map_set(storage_name, key, cbor::CborObject::from_int(value));
+			}
+			virtual void current_fast_map_set_string(const std::string& storage_name, const std::string& key, const std::string& value) {
+				current_fast_map_set(storage_name, key, cbor::CborObject::from_string(value));
+			}
+			virtual void current_fast_map_set_null(const std::string& storage_name, const std::string& key) {
+				current_fast_map_set(storage_name, key, cbor::CborObject::create_null());
+			}
+
 			virtual std::string get_string_current_contract_storage(const std::string& storage_name) const = 0;
 			virtual int64_t get_int_current_contract_storage(const std::string& storage_name) const = 0;
 			virtual void set_current_contract_storage(const std::string& storage_name, cbor::CborObjectP cbor_value) = 0;
@@ -50,6 +79,17 @@ namespace uvm {
 			virtual bool is_valid_address(const std::string& addr) = 0;
 
 			virtual uint32_t get_chain_now() const = 0;
+
+			// gets an id of the current storage values of the contract, which changes whenever any storage of the contract changes.
+			// returns false when the storages can't be identified this way, eg. they have changes not written to the chain yet
+			virtual bool current_storage_revision(std::string& contract_address, uint64_t& revision) const {
+				return false;
+			}
+
+			// whether apis accept arguments in the binary calling convention, see native_args
+			virtual bool binary_args_enabled() const {
+				return false;
+			}
 		};
 
 		class abstract_native_contract_impl : public native_contract_interface {
@@ -66,6 +106,22 @@ namespace uvm {
 			virtual cbor::CborObjectP current_fast_map_get(const std::string& storage_name, const std::string& key) const {
 				return get_proxy()->current_fast_map_get(storage_name, key);
 			}
+			virtual bool current_fast_map_get_int(const std::string& storage_name, const std::string& key, int64_t& value) const {
+				return get_proxy()->current_fast_map_get_int(storage_name, key, value);
+			}
+			virtual bool current_fast_map_get_string(const std::string& storage_name, const std::string& key, std::string& value) const {
+				return get_proxy()->current_fast_map_get_string(storage_name, key, value);
+			}
+			virtual void current_fast_map_set_int(const std::string& storage_name, const std::string& key, int64_t value) {
+				get_proxy()->current_fast_map_set_int(storage_name, key, value);
+			}
+			virtual void current_fast_map_set_string(const std::string& storage_name, const std::string& key, const std::string& value) {
+				get_proxy()->current_fast_map_set_string(storage_name, key, value);
+			}
+			virtual void current_fast_map_set_null(const std::string& storage_name, const std::string& key) {
+				get_proxy()->current_fast_map_set_null(storage_name, key);
+			}
+
 			virtual std::string get_string_current_contract_storage(const std::string& storage_name) const {
 				return get_proxy()->get_string_current_contract_storage(storage_name);
 			}
@@ -114,6 +170,14 @@ namespace uvm {
 			virtual uint32_t get_chain_now() const {
 				return get_proxy()->get_chain_now();
 			}
+
+			virtual bool current_storage_revision(std::string& contract_address, uint64_t& revision) const {
+				return get_proxy()->current_storage_revision(contract_address, revision);
+			}
+
+			virtual bool binary_args_enabled() const {
+				return get_proxy()->binary_args_enabled();
+			}
 		};
 	}
 }
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <cborcpp/cbor.h>
+
+namespace uvm {
+	namespace contract {
+
+		// positional arguments of a native contract api.
+		// an argument is the comma separated text all apis accept, or in the binary calling convention a marker
+		// followed by a cbor encoded array of text strings and integers, see encode_binary. integers of binary
+		// arguments don't need to be parsed again by the apis
+		class native_args
+		{
+		public:
+			// allow_binary: whether the binary calling convention is accepted, see native_contract_interface::binary_args_enabled.
+			// trim_text: trim the spaces around each comma separated argument
+			native_args(const std::string& api_arg, bool allow_binary, bool trim_text = false);
+
+			// the argument of the binary calling convention with these items
+			static std::string encode_binary(const cbor::CborArrayValue& items);
+
+			bool is_binary() const { return _binary; }
+			// 0 when a binary argument is malformed, so the size checks of the apis reject it
+			size_t size() const { return _texts.size(); }
+
+			// argument as the comma separated form has it. integers of binary arguments are written in decimal
+			const std::string& string_at(size_t index) const { return _texts[index]; }
+			// whether the argument is an integer. text arguments are checked as the apis always did
+			bool is_int_at(size_t index) const;
+			// the integer argument. text arguments are parsed with std::stoll, which throws when out of range
+			int64_t int_at(size_t index) const;
+		private:
+			bool _binary = false;
+			std::vector<std::string> _texts;
+			std::vector<bool> _is_int;
+			std::vector<int64_t> _ints;
+		};
+
+		// writes an event argument, the same text as uvm::util::json_ordered_dumps of a flat jsondiff::JsonObject
+		// with these fields, without building and sorting the variant object
+		class native_event_builder
+		{
+		public:
+			native_event_builder& add(const std::string& key, const std::string& value);
+			native_event_builder& add(const std::string& key, int64_t value);
+
+			std::string str() const;
+		private:
+			native_event_builder& add_json(const std::string& key, std::string&& json_value);
+
+			// key and its json encoded value
+			std::vector<std::pair<std::string, std::string>> _fields;
+		};
+
+	}
+}
@@ -2,10 +2,24 @@
 
 #include <native_contract/native_contract_api.h>
 #include <native_contract/native_token_contract.h>
+#include <safenumber/safenumber.h>
 
 namespace uvm {
 	namespace contract {
 
+		// pool storages of an uniswap contract read by the quote apis. when state isn't COMMON the other fields aren't read
+		struct uniswap_pool_snapshot
+		{
+			uint64_t revision = 0;
+			std::string state;
+			std::string asset1;
+			std::string asset2;
+			int64_t asset_1_pool_amount = 0;
+			int64_t asset_2_pool_amount = 0;
+			int64_t supply = 0;
+			SafeNumber fee_rate = safe_number_zero();
+		};
+
 		// this is native contract for uniswap   
 		class uniswap_native_contract : public token_native_contract
 		{
@@ -37,6 +51,10 @@ namespace uvm {
 			void balanceOfAsset_api(const std::string& api_name, const std::string& api_arg);
 			void caculateExchangeAmount_api(const std::string& api_name, const std::string& api_arg);
 			void getInfo_api(const std::string& api_name, const std::string& api_arg);
+
+			// the quote apis are called offline many times between two changes of the pool,
+			// so the decoded pool storages are kept until the contract storage revision changes
+			uniswap_pool_snapshot get_pool_snapshot();
 			
 		};
 
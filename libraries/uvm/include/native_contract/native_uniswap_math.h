@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <safenumber/safenumber.h>
+
+namespace uvm {
+	namespace contract {
+		// integer versions of the SafeNumber expressions used by uniswap_native_contract.
+		// results are the same as the SafeNumber code, including where SafeNumber truncates to 16 decimals
+		// (which decides some of the round up cases). inputs out of the integer fast path's range are
+		// computed with SafeNumber
+		namespace uniswap_math {
+
+			// input_amount * output_reserve / (input_reserve + input_amount), rounded down
+			int64_t get_input_price(int64_t input_amount, int64_t input_reserve, int64_t output_reserve);
+
+			// x * y / z, rounded down
+			int64_t mul_div_floor(int64_t x, int64_t y, int64_t z);
+
+			// x * y / z, rounded up when the SafeNumber quotient has decimals
+			int64_t mul_div_ceil(int64_t x, int64_t y, int64_t z);
+
+			// (token_amount / supply) * pool_amount, the quota is truncated to SafeNumber precision before multiply
+			int64_t pool_share(int64_t token_amount, int64_t supply, int64_t pool_amount);
+
+			// amount * fee_rate rounded up, and at least 1
+			int64_t swap_fee(int64_t amount, const SafeNumber& fee_rate);
+
+		}
+	}
+}
@@ -11,6 +11,7 @@
 
 #include <stdarg.h>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 
@@ -406,13 +407,16 @@ namespace uvm_types {
 		int tt_ = LUA_TLNGSTR;
 		std::string value;
 		lu_byte extra = 0;
+		// interned strings are unique by content and never change, see vmgc::GcState::gc_intern_string
+		bool interned = false;
+		unsigned int interned_hash = 0;
 
 		inline GcString() : tt_(LUA_TLNGSTR){ }
 
 		virtual ~GcString() {}
 
 		inline unsigned int hash() const {
-			return luaS_hash(value.data(), value.size(), 1);
+			return interned ? interned_hash : luaS_hash(value.data(), value.size(), 1);
 		}
 	};
 	struct GcUserdata : vmgc::GcObject
@@ -480,6 +484,8 @@ namespace uvm_types {
 		int tt_ = LUA_TTABLE;
 		std::map<TValue, GcTableItemType, table_sort_comparator> entries; // must use map, not unordered_map
 		std::map<std::string, TValue> keys;
+		// values found by interned string keys. entries are never erased, so the pointers stay valid
+		std::unordered_map<const GcString*, const TValue*> interned_keys;
 		std::vector<GcTableItemType> array;
 		GcTable* metatable;
 		lu_byte flags; // flag to mask meta methods
@@ -135,6 +135,17 @@ inline UvmStatePreProcessorFunction make_lua_state_preprocessor(std::list<void*>
 
 struct lua_State;
 
+namespace uvm {
+	namespace lua {
+		namespace api {
+			class IUvmChainApi;
+		}
+		namespace lib {
+			class UvmStateProfile;
+		}
+	}
+}
+
 namespace uvm_types {
 	struct GcString;
 	struct GcTable;
@@ -222,6 +233,10 @@ struct lua_State : vmgc::GcObject {
     
 	int cbor_diff_state; // 0: not_set, 1: true, 2: false
 
+	uvm::lua::api::IUvmChainApi *chain_api; // nullptr to use global_uvm_chain_api
+	bool chain_api_has_error; // exception marked by chain api's throw_exception
+	uvm::lua::lib::UvmStateProfile *profile; // nullptr when the state isn't profiled
+
 	inline lua_State() :tt_(LUA_TTHREAD) {}
 	virtual ~lua_State() {}
 };
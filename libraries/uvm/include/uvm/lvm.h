@@ -105,6 +105,7 @@ namespace uvm {
 			TValue *k;
 			StkId base;
 			std::stack<contract_info_stack_entry> using_contract_id_stack;
+			uvm::lua::lib::UvmStateProfile *profile = nullptr;
 
 			void step_out(lua_State *L);
 			void step_into(lua_State* L);
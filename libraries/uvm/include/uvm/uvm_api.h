@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <deque>
 #include <set>
 #include <map>
 #include <unordered_map>
@@ -260,6 +261,7 @@ public:
 // storage structs
 #define LUA_STORAGE_CHANGELIST_KEY "__lua_storage_changelist__"
 #define LUA_STORAGE_READ_TABLES_KEY "__lua_storage_read_tables__"
+#define LUA_STORAGE_READ_CACHE_KEY "__lua_storage_read_cache__"
 
 #define GLUA_OUTSIDE_OBJECT_POOLS_KEY "__uvm_outside_object_pools__"
 
@@ -432,9 +434,50 @@ typedef struct UvmStorageChangeItem
 
 
 
-typedef std::list<UvmStorageChangeItem> UvmStorageChangeList;
+// storage changes in the order they were made.  the changes of each property are indexed, so reads and
+// writes find the last one without walking the list
+class UvmStorageChangeList : private std::list<UvmStorageChangeItem>
+{
+public:
+	typedef std::list<UvmStorageChangeItem> base_type;
+	typedef std::deque<const UvmStorageChangeItem*> property_changes;
+	using base_type::iterator;
+	using base_type::const_iterator;
+	using base_type::begin;
+	using base_type::end;
+	using base_type::rbegin;
+	using base_type::rend;
+	using base_type::size;
+	using base_type::empty;
+
+	UvmStorageChangeList() {}
+	UvmStorageChangeList(const UvmStorageChangeList&) = delete;
+	UvmStorageChangeList& operator=(const UvmStorageChangeList&) = delete;
+
+	void push_back(const UvmStorageChangeItem& item);
+	void pop_back();
+	void pop_front();
+	void clear();
+
+	// the changes of a property in the order they were made, nullptr if it has none
+	const property_changes* find_all(const std::string& contract_id, const std::string& key,
+		const std::string& fast_map_key, bool is_fast_map) const;
+	// the last change of a property, nullptr if it has none
+	const UvmStorageChangeItem* find_last(const std::string& contract_id, const std::string& key,
+		const std::string& fast_map_key, bool is_fast_map) const;
+
+private:
+	static std::string property_key(const std::string& contract_id, const std::string& key,
+		const std::string& fast_map_key, bool is_fast_map);
+	void forget(const UvmStorageChangeItem& item, bool last);
+
+	std::unordered_map<std::string, property_changes> _changes_by_property;
+};
 
-typedef std::list<UvmStorageChangeItem> UvmStorageTableReadList;
+typedef UvmStorageChangeList UvmStorageTableReadList;
+
+// decoded storage values read from chain in this lua_State, key is global key of the storage property
+typedef std::unordered_map<std::string, UvmStorageValue> UvmStorageReadCache;
 
 struct UvmStorageValue lua_type_to_storage_value_type(lua_State *L, int index);
 
@@ -447,6 +490,9 @@ jsondiff::JsonValue uvm_storage_value_to_json(UvmStorageValue value);
 
 UvmStorageValue cbor_to_uvm_storage_value(lua_State *L, cbor::CborObject* cbor_value);
 cbor::CborObjectP uvm_storage_value_to_cbor(UvmStorageValue value);
+// writes the bytes cbor_encode(uvm_storage_value_to_cbor(value)) would, without building the cbor objects
+void uvm_storage_value_write_cbor(cbor::encoder &encoder, const UvmStorageValue &value);
+std::vector<char> uvm_storage_value_to_cbor_bytes(const UvmStorageValue &value);
 
 typedef std::unordered_map<std::string, UvmStorageChangeItem> ContractChangesMap;
 
@@ -658,6 +704,12 @@ namespace uvm {
 
           extern IUvmChainApi *global_uvm_chain_api;
 
+          // the chain api binded to L by set_uvm_chain_api, or global_uvm_chain_api when L has no own chain api
+          IUvmChainApi *get_uvm_chain_api(lua_State *L);
+
+          // bind a chain api to L, so VMs in different threads can work with their own chain api instances
+          void set_uvm_chain_api(lua_State *L, IUvmChainApi *chain_api);
+
         }
     }
 }
@@ -0,0 +1,42 @@
+#ifndef uvm_code_cache_h
+#define uvm_code_cache_h
+
+#include <uvm/lprefix.h>
+#include <string>
+#include <vector>
+
+#include <fc/crypto/sha256.hpp>
+
+#include <uvm/lua.h>
+#include <uvm/uvm_api.h>
+
+namespace uvm
+{
+	namespace lua
+	{
+		namespace lib
+		{
+			// what check_contract_proto depends on besides the bytecode: the contracts imported
+			// by constant name or address must exist, which can change with the chain
+			struct UvmVerifiedContractCode
+			{
+				std::vector<std::string> imported_contracts;
+				std::vector<std::string> imported_contract_addresses;
+			};
+
+			fc::sha256 contract_code_digest(const UvmModuleByteStream *stream);
+
+			// whether the bytecode with this digest passed check_contract_proto before and the contracts
+			// it imports still exist, so the check would pass again
+			bool is_verified_contract_code(lua_State *L, const fc::sha256& digest);
+
+			// remember bytecode which passed check_contract_proto, shared by all lua_States of the process
+			void add_verified_contract_code(const fc::sha256& digest, UvmVerifiedContractCode&& code);
+
+			// forget all verified bytecode, the next load of each contract checks it again
+			void clear_verified_contract_codes();
+		}
+	}
+}
+
+#endif
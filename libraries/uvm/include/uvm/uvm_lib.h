@@ -434,10 +434,14 @@ namespace uvm
              */
             bool check_contract_bytecode_stream(lua_State *L, UvmModuleByteStreamP stream, char *error = nullptr);
 
+            struct UvmVerifiedContractCode;
+
             /**
              * check contract lua bytecode proto is right(whether safe)
+             * @param verified when not nullptr, collects the imported contracts the check depends on
              */
-            bool check_contract_proto(lua_State *L, uvm_types::GcProto *proto, char *error = nullptr, std::list<uvm_types::GcProto*> *parents = nullptr);
+            bool check_contract_proto(lua_State *L, uvm_types::GcProto *proto, char *error = nullptr, std::list<uvm_types::GcProto*> *parents = nullptr,
+                UvmVerifiedContractCode *verified = nullptr);
 
             std::string wrap_contract_name(const char *contract_name);
 
@@ -456,7 +460,7 @@ namespace uvm
         error_msg[LUA_COMPILE_ERROR_MAX_LENGTH-1] = '\0';       \
         memcpy(error, error_msg, sizeof(char)*(1 + strlen(error_msg)));								\
      }												\
-     global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error_format, ##__VA_ARGS__);		\
+     uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error_format, ##__VA_ARGS__);		\
 } while(0)
 
 #define lcompile_error_set(L, error, error_format, ...) do {	   \
@@ -478,7 +482,7 @@ namespace uvm
 }
 
 #define lmalloc_error(L) do { \
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "malloc memory error"); \
+		uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "malloc memory error"); \
 	} while(0)
 
 #define GLUA_TYPE_NAMESPACE_PREFIX "$type$"
@@ -0,0 +1,118 @@
+#ifndef uvm_profiler_h
+#define uvm_profiler_h
+
+#include <uvm/lprefix.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <uvm/lua.h>
+#include <uvm/lstate.h>
+
+namespace uvm
+{
+	namespace lua
+	{
+		namespace lib
+		{
+			enum class UvmProfileMetric
+			{
+				instructions,
+				gas,
+				wall_time, // nanoseconds
+				storage_reads,
+				storage_writes
+			};
+
+			// "instructions", "gas", "wall_time", "storage_reads" or "storage_writes"
+			bool parse_profile_metric(const std::string& name, UvmProfileMetric& metric);
+
+			struct UvmProfileCounters
+			{
+				int64_t instructions = 0;
+				int64_t gas = 0;
+				int64_t wall_time = 0;
+				int64_t storage_reads = 0;
+				int64_t storage_writes = 0;
+
+				int64_t get(UvmProfileMetric metric) const;
+				void add(const UvmProfileCounters& other);
+			};
+
+			// counters of finished lua_States, by collapsed stack "contract;source:linedefined;...;line:N"
+			class UvmProfiler
+			{
+			public:
+				void merge(const std::map<std::string, UvmProfileCounters>& stacks);
+				void reset();
+				// one "stack count" line per stack whose count isn't 0, the input format of flamegraph.pl
+				std::string collapsed(UvmProfileMetric metric) const;
+			private:
+				mutable std::mutex _mutex;
+				std::map<std::string, UvmProfileCounters> _stacks;
+			};
+
+			// profiler of all lua_States created while node profiling is enabled
+			std::shared_ptr<UvmProfiler> node_profiler();
+			void set_node_profiling_enabled(bool enabled);
+			bool is_node_profiling_enabled();
+
+			// lua_States created by this thread while the scope lives are profiled into profiler,
+			// in place of the node profiler. used to profile a single offline call
+			class UvmProfilerScope
+			{
+			public:
+				explicit UvmProfilerScope(std::shared_ptr<UvmProfiler> profiler);
+				~UvmProfilerScope();
+			private:
+				std::shared_ptr<UvmProfiler> _previous;
+			};
+
+			// traces the instructions of one lua_State. each instruction is charged the gas and
+			// wall time spent until the next one, so api calls are charged to the calling line
+			class UvmStateProfile
+			{
+			public:
+				explicit UvmStateProfile(std::shared_ptr<UvmProfiler> profiler);
+
+				void on_instruction(lua_State *L, CallInfo *ci, int64_t executed_count);
+				void on_storage_read();
+				void on_storage_write();
+				// charges the last instruction and merges the counters into the profiler
+				void flush(int64_t executed_count);
+			private:
+				void charge(std::chrono::steady_clock::time_point now, int64_t executed_count);
+				void enter_stack(lua_State *L, CallInfo *ci);
+				uint32_t frame_id(const std::string& name);
+				uint32_t proto_frame_id(const uvm_types::GcProto *proto);
+
+				std::shared_ptr<UvmProfiler> _profiler;
+				// frame ids from the root to the current function
+				std::vector<uint32_t> _stack;
+				std::vector<std::string> _frame_names;
+				std::unordered_map<std::string, uint32_t> _frame_ids;
+				std::unordered_map<const uvm_types::GcProto*, uint32_t> _proto_frame_ids;
+				// key is _stack followed by the line
+				std::map<std::vector<uint32_t>, UvmProfileCounters> _counters;
+				UvmProfileCounters *_current = nullptr;
+				const CallInfo *_last_ci = nullptr;
+				const uvm_types::GcProto *_last_proto = nullptr;
+				int _last_line = -1;
+				int64_t _last_count = 0;
+				std::chrono::steady_clock::time_point _last_time;
+			};
+
+			// called by create_lua_state, attaches a UvmStateProfile when profiling is on
+			void attach_state_profile(lua_State *L);
+			// called by close_lua_state
+			void close_state_profile(lua_State *L, int64_t executed_count);
+		}
+	}
+}
+
+#endif
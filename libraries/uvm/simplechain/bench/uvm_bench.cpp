@@ -0,0 +1,294 @@
+// uvm_bench: contract execution benchmark on top of simplechain
+// usage: uvm_bench [--workload name] [--count N] [--contracts-dir dir]
+// prints one json object per workload with ops/sec, gas/sec, allocations/op and latency percentiles
+
+#include <simplechain/blockchain.h>
+#include <simplechain/operations_helper.h>
+#include <fc/io/json.hpp>
+#include <fc/variant_object.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// counts the allocations through operator new. allocations of the vm made with malloc aren't counted
+static std::atomic<uint64_t> bench_allocations(0);
+
+void* operator new(std::size_t size) {
+	bench_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+using namespace simplechain;
+
+namespace {
+
+	struct bench_context {
+		std::shared_ptr<blockchain> chain;
+		std::string caller_addr;
+		std::string contracts_dir;
+		// op_time of each operation is unique, so contract addresses derived from it don't collide
+		uint32_t next_op_time;
+		int32_t next_nonce = 0;
+	};
+
+	struct bench_stats {
+		std::string workload;
+		size_t count = 0;
+		size_t failures = 0;
+		int64_t total_gas = 0;
+		uint64_t allocations = 0;
+		std::vector<int64_t> latencies_ns;
+		double wall_seconds = 0;
+
+		fc::mutable_variant_object to_json() {
+			std::sort(latencies_ns.begin(), latencies_ns.end());
+			auto percentile = [this](double p) -> int64_t {
+				if (latencies_ns.empty())
+					return 0;
+				auto index = static_cast<size_t>(p * (latencies_ns.size() - 1));
+				return latencies_ns[index];
+			};
+			fc::mutable_variant_object info;
+			info["workload"] = workload;
+			info["count"] = count;
+			info["failures"] = failures;
+			info["ops_per_sec"] = wall_seconds > 0 ? count / wall_seconds : 0.0;
+			info["gas_per_sec"] = wall_seconds > 0 ? total_gas / wall_seconds : 0.0;
+			info["total_gas"] = total_gas;
+			info["allocations_per_op"] = count > 0 ? double(allocations) / count : 0.0;
+			info["p50_latency_us"] = percentile(0.50) / 1000.0;
+			info["p99_latency_us"] = percentile(0.99) / 1000.0;
+			info["max_latency_us"] = latencies_ns.empty() ? 0.0 : latencies_ns.back() / 1000.0;
+			return info;
+		}
+	};
+
+	template <typename OpType>
+	std::shared_ptr<transaction> make_tx(bench_context& ctx, OpType op) {
+		op.op_time = fc::time_point_sec(ctx.next_op_time++);
+		auto tx = std::make_shared<transaction>();
+		tx->tx_nonce = ctx.next_nonce++;
+		tx->tx_time = op.op_time;
+		tx->operations.push_back(op);
+		return tx;
+	}
+
+	// applies a setup transaction, which must succeed
+	std::shared_ptr<contract_invoke_result> setup_tx(bench_context& ctx, std::shared_ptr<transaction> tx) {
+		auto result = std::dynamic_pointer_cast<contract_invoke_result>(ctx.chain->apply_transaction(tx));
+		FC_ASSERT(!result || result->exec_succeed, "setup transaction failed: ${error}", ("error", result->error));
+		return result;
+	}
+
+	std::string create_native(bench_context& ctx, const std::string& key) {
+		auto op = operations_helper::create_native_contract(ctx.caller_addr, key);
+		op.op_time = fc::time_point_sec(ctx.next_op_time);
+		auto addr = op.calculate_contract_id();
+		setup_tx(ctx, make_tx(ctx, op));
+		return addr;
+	}
+
+	contract_invoke_operation invoke_op(bench_context& ctx, const std::string& contract_addr, const std::string& api,
+		const std::string& arg, asset_id_t deposit_asset_id = 0, share_type deposit_amount = 0) {
+		fc::variants args;
+		args.push_back(fc::variant(arg));
+		return operations_helper::invoke_contract(ctx.caller_addr, contract_addr, api, args, 10000000, 10, deposit_asset_id, deposit_amount);
+	}
+
+	std::string create_from_file(bench_context& ctx, const std::string& filename) {
+		auto path = (boost::filesystem::path(ctx.contracts_dir) / filename).string();
+		auto op = operations_helper::create_contract_from_file(ctx.caller_addr, path, 1000000);
+		op.op_time = fc::time_point_sec(ctx.next_op_time);
+		auto addr = op.calculate_contract_id();
+		setup_tx(ctx, make_tx(ctx, op));
+		return addr;
+	}
+
+	// runs count transactions built by make_tx_at(i) and measures each apply_transaction
+	bench_stats run_workload(bench_context& ctx, const std::string& name, size_t count,
+		const std::function<std::shared_ptr<transaction>(size_t)>& make_tx_at) {
+		bench_stats stats;
+		stats.workload = name;
+		stats.count = count;
+		stats.latencies_ns.reserve(count);
+		std::vector<std::shared_ptr<transaction>> txs;
+		txs.reserve(count);
+		for (size_t i = 0; i < count; i++)
+			txs.push_back(make_tx_at(i));
+		auto allocations_before = bench_allocations.load();
+		auto wall_start = std::chrono::steady_clock::now();
+		for (const auto& tx : txs) {
+			auto start = std::chrono::steady_clock::now();
+			bool succeed = false;
+			try {
+				auto result = std::dynamic_pointer_cast<contract_invoke_result>(ctx.chain->apply_transaction(tx));
+				if (result) {
+					succeed = result->exec_succeed;
+					stats.total_gas += result->gas_used;
+				}
+			}
+			catch (const std::exception& e) {
+				std::cerr << "error of " << name << ": " << e.what() << std::endl;
+			}
+			auto end = std::chrono::steady_clock::now();
+			stats.latencies_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+			if (!succeed)
+				stats.failures++;
+		}
+		stats.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+		stats.allocations = bench_allocations.load() - allocations_before;
+		return stats;
+	}
+
+	std::string bench_address(size_t i) {
+		return std::string(SIMPLECHAIN_ADDRESS_PREFIX) + "bench" + std::to_string(i);
+	}
+
+	// deploys every bytecode contract of the contracts dir
+	bench_stats bench_deploy(bench_context& ctx, size_t count) {
+		std::vector<std::string> files;
+		for (boost::filesystem::directory_iterator it(ctx.contracts_dir), end; it != end; ++it) {
+			if (it->path().extension() == ".gpc")
+				files.push_back(it->path().string());
+		}
+		std::sort(files.begin(), files.end());
+		FC_ASSERT(!files.empty(), "no .gpc contract in ${dir}", ("dir", ctx.contracts_dir));
+		return run_workload(ctx, "deploy", count, [&](size_t i) {
+			return make_tx(ctx, operations_helper::create_contract_from_file(ctx.caller_addr, files[i % files.size()], 1000000));
+		});
+	}
+
+	bench_stats bench_token_transfer(bench_context& ctx, size_t count) {
+		auto token_addr = create_native(ctx, "token");
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, token_addr, "init_token", "test,TEST,100000000000,10")));
+		return run_workload(ctx, "native_token_transfer", count, [&](size_t i) {
+			return make_tx(ctx, invoke_op(ctx, token_addr, "transfer", bench_address(i % 100) + ",1"));
+		});
+	}
+
+	// filling exchange orders needs orders signed by the makers, so the exchange workload moves balances
+	// in and out of the contract, which runs the same balance maps and events as the fills
+	bench_stats bench_exchange(bench_context& ctx, size_t count) {
+		auto exchange_addr = create_native(ctx, "exchange");
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, exchange_addr, "init_config", ctx.caller_addr)));
+		return run_workload(ctx, "native_exchange_deposit_withdraw", count, [&](size_t i) {
+			if (i % 2 == 0)
+				return make_tx(ctx, invoke_op(ctx, exchange_addr, "on_deposit_asset", "", 0, 100));
+			return make_tx(ctx, invoke_op(ctx, exchange_addr, "withdraw", std::string("50,") + SIMPLECHAIN_CORE_ASSET_SYMBOL));
+		});
+	}
+
+	bench_stats bench_uniswap(bench_context& ctx, size_t count) {
+		auto quote_asset = ctx.chain->get_asset_by_symbol("BENCH");
+		if (!quote_asset) {
+			asset new_asset;
+			new_asset.symbol = "BENCH";
+			new_asset.precision = SIMPLECHAIN_CORE_ASSET_PRECISION;
+			ctx.chain->add_asset(new_asset);
+			quote_asset = ctx.chain->get_asset_by_symbol("BENCH");
+		}
+		setup_tx(ctx, make_tx(ctx, operations_helper::mint(ctx.caller_addr, quote_asset->asset_id, 100000000000)));
+		auto pool_addr = create_native(ctx, "uniswap");
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, pool_addr, "init_config",
+			std::string(SIMPLECHAIN_CORE_ASSET_SYMBOL) + ",BENCH,1,1,0.003,benchpool,BPOOL")));
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, pool_addr, "on_deposit_asset", "", 0, 1000000000)));
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, pool_addr, "on_deposit_asset", "", quote_asset->asset_id, 1000000000)));
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, pool_addr, "addLiquidity", "500000000,500000000,100000000")));
+		auto quote_asset_id = quote_asset->asset_id;
+		return run_workload(ctx, "native_uniswap_swap", count, [&](size_t i) {
+			if (i % 2 == 0)
+				return make_tx(ctx, invoke_op(ctx, pool_addr, "on_deposit_asset", "BENCH,1,100000000", 0, 1000));
+			return make_tx(ctx, invoke_op(ctx, pool_addr, "on_deposit_asset", std::string(SIMPLECHAIN_CORE_ASSET_SYMBOL) + ",1,100000000", quote_asset_id, 1000));
+		});
+	}
+
+	// every transfer goes to a new address, so the users map of the contract keeps growing
+	bench_stats bench_storage_map(bench_context& ctx, size_t count) {
+		auto token_addr = create_from_file(ctx, "token.gpc");
+		setup_tx(ctx, make_tx(ctx, invoke_op(ctx, token_addr, "init_token", "test,TEST,100000000000,100")));
+		return run_workload(ctx, "storage_map_transfer", count, [&](size_t i) {
+			return make_tx(ctx, invoke_op(ctx, token_addr, "transfer", bench_address(i) + ",1"));
+		});
+	}
+
+	bench_stats bench_compute(bench_context& ctx, size_t count) {
+		auto contract_addr = create_from_file(ctx, "test_many_objects.lua.gpc");
+		return run_workload(ctx, "compute_many_objects", count, [&](size_t i) {
+			return make_tx(ctx, invoke_op(ctx, contract_addr, "hello", "test"));
+		});
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string workload = "all";
+	size_t count = 1000;
+	std::string contracts_dir = "../test/test_contracts";
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string key(argv[i]);
+		std::string value(argv[i + 1]);
+		if (key == "--workload")
+			workload = value;
+		else if (key == "--count")
+			count = std::stoul(value);
+		else if (key == "--contracts-dir")
+			contracts_dir = value;
+		else {
+			std::cerr << "usage: uvm_bench [--workload all|deploy|token|exchange|uniswap|storage|compute] [--count N] [--contracts-dir dir]" << std::endl;
+			return 1;
+		}
+	}
+	try {
+		const std::vector<std::pair<std::string, std::function<bench_stats(bench_context&, size_t)>>> workloads = {
+			{ "deploy", bench_deploy },
+			{ "token", bench_token_transfer },
+			{ "exchange", bench_exchange },
+			{ "uniswap", bench_uniswap },
+			{ "storage", bench_storage_map },
+			{ "compute", bench_compute }
+		};
+		fc::variants results;
+		for (const auto& item : workloads) {
+			if (workload != "all" && workload != item.first)
+				continue;
+			// each workload runs on a new chain, so the state left by the others doesn't change its costs
+			bench_context ctx;
+			ctx.chain = std::make_shared<blockchain>();
+			ctx.caller_addr = std::string(SIMPLECHAIN_ADDRESS_PREFIX) + "caller1";
+			ctx.contracts_dir = contracts_dir;
+			ctx.next_op_time = fc::time_point_sec(fc::time_point::now()).sec_since_epoch();
+			setup_tx(ctx, make_tx(ctx, operations_helper::mint(ctx.caller_addr, 0, 100000000000)));
+			results.push_back(item.second(ctx, count).to_json());
+		}
+		if (results.empty()) {
+			std::cerr << "unknown workload " << workload << std::endl;
+			return 1;
+		}
+		std::cout << fc::json::to_pretty_string(results) << std::endl;
+	}
+	catch (const fc::exception& e) {
+		std::cerr << e.to_detail_string() << std::endl;
+		return 1;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -40,7 +40,9 @@ namespace simplechain {
 		// @throws exception
 		std::shared_ptr<evaluate_result> evaluate_transaction(std::shared_ptr<transaction> tx);
 		void clear_debugger_info();
-		void apply_transaction(std::shared_ptr<transaction> tx);
+		// @throws exception
+		// returns the apply result of the last operation
+		std::shared_ptr<evaluate_result> apply_transaction(std::shared_ptr<transaction> tx);
 		block latest_block() const;
 		uint64_t head_block_number() const;
 		std::string head_block_hash() const;
@@ -3,7 +3,7 @@
 
 namespace simplechain {
 	struct evaluate_result {
-
+		virtual ~evaluate_result() {}
 	};
 
 	struct void_evaluate_result : public evaluate_result {
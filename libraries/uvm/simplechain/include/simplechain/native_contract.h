@@ -119,6 +119,8 @@ namespace simplechain {
 
 		virtual bool is_valid_address(const std::string& addr);
 		virtual uint32_t get_chain_now() const;
+		// simplechain has no chain history to keep compatible with
+		virtual bool binary_args_enabled() const { return true; }
 	};
 
 	class native_contract_finder
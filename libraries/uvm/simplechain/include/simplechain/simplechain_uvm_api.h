@@ -147,6 +147,7 @@ namespace simplechain {
 		virtual uint32_t get_chain_safe_random(lua_State *L, bool diff_in_diff_txs);
         virtual std::string get_transaction_id(lua_State *L);
 		virtual std::string get_transaction_id_without_gas(lua_State *L) const override;
+		virtual std::string get_signature_address(lua_State *L, const char * hash, const char * v, const char * r, const char * s) override;
         virtual uint32_t get_header_block_num(lua_State *L);
 		virtual uint32_t get_header_block_num_without_gas(lua_State *L) const;
         virtual uint32_t wait_for_future_random(lua_State *L, int next);
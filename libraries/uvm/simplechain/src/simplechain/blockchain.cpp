@@ -50,17 +50,19 @@ namespace simplechain {
 	void blockchain::clear_debugger_info() {
 		this->last_evaluator_when_debugger = nullptr;
 	}
-	void blockchain::apply_transaction(std::shared_ptr<transaction> tx) {
+	std::shared_ptr<evaluate_result> blockchain::apply_transaction(std::shared_ptr<transaction> tx) {
 		try {
 			// TODO: evaluate_state of block or tx(need nested evaluate state)
 			for (const auto& op : tx->operations) {
 				auto evaluator_instance = get_operation_evaluator(tx.get(), op);
 				auto op_result = evaluator_instance->evaluate(op);
 			}
+			std::shared_ptr<evaluate_result> last_op_result;
 			for (const auto& op : tx->operations) {
 				auto evaluator_instance = get_operation_evaluator(tx.get(), op);
-				auto op_result = evaluator_instance->apply(op);
+				last_op_result = evaluator_instance->apply(op);
 			}
+			return last_op_result;
 		}
 		catch (const std::exception& e) {
 			throw e;
@@ -255,11 +255,11 @@ namespace simplechain {
 				if (!contract) {
 					throw uvm::core::UvmException(std::string("Can't find contract by address ") + o.contract_address);
 				}
+				if (o.deposit_amount > 0) {
+					update_account_asset_balance(o.caller_address, o.deposit_asset_id, - int64_t(o.deposit_amount));
+					update_account_asset_balance(o.contract_address, o.deposit_asset_id, o.deposit_amount);
+				}
 				if (contract->native_contract_key.empty()) {
-					if (o.deposit_amount > 0) {
-						update_account_asset_balance(o.caller_address, o.deposit_asset_id, - int64_t(o.deposit_amount));
-						update_account_asset_balance(o.contract_address, o.deposit_asset_id, o.deposit_amount);
-					}
 					engine->set_gas_limit(limit);
 					engine->execute_contract_api_by_address(o.contract_address, o.contract_api, arr, &result_json_str);
 					invoke_contract_result.api_result = result_json_str;
@@ -825,6 +825,21 @@ namespace simplechain {
 				return get_transaction_id_without_gas(L);
 			}
 
+			std::string SimpleChainUvmChainApi::get_signature_address(lua_State *L, const char * hash, const char * v, const char * r, const char * s)
+			{
+				uvm::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
+				std::string sig = std::string(v) + r + s;
+				try {
+					fc::ecc::compact_signature com_sig;
+					fc::from_hex(sig, (char *)com_sig.data, size_t(65));
+					fc::sha256 ori_hash{ std::string(hash) };
+					return pubkey_to_address_string(fc::ecc::public_key(com_sig, ori_hash, false));
+				}
+				catch (...) {
+					return "";
+				}
+			}
+
 			std::string SimpleChainUvmChainApi::get_transaction_id_without_gas(lua_State *L) const {
 				try {
 					auto evaluator = get_contract_evaluator(L);
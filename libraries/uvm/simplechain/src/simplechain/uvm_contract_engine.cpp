@@ -93,14 +93,14 @@ namespace simplechain
 
 	void UvmContractEngine::clear_exceptions()
 	{
-		uvm::lua::api::global_uvm_chain_api->clear_exceptions(_scope->L());
+		uvm::lua::api::get_uvm_chain_api(_scope->L())->clear_exceptions(_scope->L());
 	}
 
 	void UvmContractEngine::execute_contract_api_by_address(std::string contract_id, std::string method, cbor::CborArrayValue& args, std::string *result_json_string)
 	{
 		clear_exceptions();
 		auto L = _scope->L();
-                uvm::lua::api::global_uvm_chain_api->before_contract_invoke(L, contract_id, uvm::lua::api::global_uvm_chain_api->get_transaction_id_without_gas(L));
+                uvm::lua::api::get_uvm_chain_api(L)->before_contract_invoke(L, contract_id, uvm::lua::api::get_uvm_chain_api(L)->get_transaction_id_without_gas(L));
 		uvm::lua::lib::execute_contract_api_by_address(_scope->L(), contract_id.c_str(), method.c_str(), args, result_json_string);
 		if (_scope->L()->force_stopping == true && _scope->L()->exit_code == LUA_API_INTERNAL_ERROR)
 			throw uvm::core::UvmException("uvm_executor_internal_error");
@@ -143,7 +143,7 @@ namespace simplechain
 
 	std::shared_ptr<VMModuleByteStream> UvmContractEngine::get_bytestream_from_code(const uvm::blockchain::Code& code)
 	{
-		auto code_stream = uvm::lua::api::global_uvm_chain_api->get_bytestream_from_code(_scope->L(), code);
+		auto code_stream = uvm::lua::api::get_uvm_chain_api(_scope->L())->get_bytestream_from_code(_scope->L(), code);
 		return code_stream;
 	}
 
@@ -63,13 +63,19 @@ namespace cbor_diff {
 	}
 
 	cbor::CborObjectP cbor_decode(const std::vector<char>& input_bytes) {
-		std::vector<char> source(input_bytes);
-		cbor::input input(source.data(), source.size());
+		// cbor::input never writes to the buffer, so no need to copy it
+		cbor::input input(const_cast<char*>(input_bytes.data()), input_bytes.size());
 		cbor::decoder decoder(input);
 		auto result_cbor = decoder.run();
 		return result_cbor;
 	}
 
+	static cbor::CborObjectP cbor_decode_item(const cbor::item_span& item) {
+		cbor::input input(const_cast<unsigned char*>(item.data), item.size);
+		cbor::decoder decoder(input);
+		return decoder.run();
+	}
+
 	cbor::CborObjectP cbor_deep_clone(cbor::CborObject* object) {
 		return cbor_decode(cbor_encode(*object));
 	}
@@ -385,6 +391,142 @@ namespace cbor_diff {
 		}
 	}
 
+	DiffResultP CborDiff::diff_encoded(const std::vector<char>& old_bytes, const std::vector<char>& new_bytes) {
+		cbor::reader old_reader(old_bytes.data(), old_bytes.size());
+		cbor::reader new_reader(new_bytes.data(), new_bytes.size());
+		cbor::item_span old_item;
+		cbor::item_span new_item;
+		if (!old_reader.read_item(old_item) || !old_reader.at_end()
+			|| !new_reader.read_item(new_item) || !new_reader.at_end()) {
+			// encodings the reader can't walk, decoder gives the result(or the error)
+			return diff(cbor_decode(old_bytes), cbor_decode(new_bytes));
+		}
+		return diff_encoded_items(old_item, new_item);
+	}
+
+	// same steps and output order as diff(), items with same encoded bytes have no diff
+	DiffResultP CborDiff::diff_encoded_items(const cbor::item_span& old_item, const cbor::item_span& new_item) {
+		auto old_type = old_item.major_type();
+		auto new_type = new_item.major_type();
+		unsigned char major_type;
+		uint64_t old_count;
+		uint64_t new_count;
+		if (old_item.same_bytes(new_item))
+		{
+			return DiffResult::make_undefined_diff_result();
+		}
+		else if (old_type == 5 && new_type == 5)
+		{
+			// both are maps, keys are sorted and unique(checked by reader)
+			cbor::reader a_reader(old_item);
+			cbor::reader b_reader(new_item);
+			a_reader.read_head(major_type, old_count);
+			b_reader.read_head(major_type, new_count);
+			const char* a_key = nullptr;
+			const char* b_key = nullptr;
+			size_t a_key_size = 0;
+			size_t b_key_size = 0;
+			cbor::item_span a_value;
+			cbor::item_span b_value;
+			uint64_t a_index = 0;
+			uint64_t b_index = 0;
+			bool has_b = false;
+			cbor::CborMapValue diff_json;
+			std::vector<std::pair<std::string, cbor::item_span>> added_items;
+			auto next_b = [&]() {
+				has_b = b_index < new_count;
+				if (has_b) {
+					b_reader.read_string(b_key, b_key_size);
+					b_reader.read_item(b_value);
+					b_index++;
+				}
+			};
+			next_b();
+			for (; a_index < old_count; a_index++)
+			{
+				a_reader.read_string(a_key, a_key_size);
+				a_reader.read_item(a_value);
+				int key_cmp = 1;
+				while (has_b && (key_cmp = cbor::compare_map_keys(a_key, a_key_size, b_key, b_key_size)) > 0)
+				{
+					added_items.push_back(std::make_pair(std::string(b_key, b_key_size), b_value));
+					next_b();
+				}
+				if (!has_b || key_cmp < 0)
+				{
+					diff_json[std::string(a_key, a_key_size) + CBORDIFF_KEY_DELETED_POSTFIX] = cbor_decode_item(a_value);
+					continue;
+				}
+				auto sub_diff_value = diff_encoded_items(a_value, b_value);
+				if (!sub_diff_value->is_undefined())
+					diff_json[std::string(a_key, a_key_size)] = std::make_shared<cbor::CborObject>(sub_diff_value->value());
+				next_b();
+			}
+			while (has_b)
+			{
+				added_items.push_back(std::make_pair(std::string(b_key, b_key_size), b_value));
+				next_b();
+			}
+			// added keys are put after the deleted and modified ones like diff() does
+			for (const auto& p : added_items)
+			{
+				diff_json[p.first + CBORDIFF_KEY_ADDED_POSTFIX] = cbor_decode_item(p.second);
+			}
+			if (diff_json.size() < 1)
+				return DiffResult::make_undefined_diff_result();
+			return std::make_shared<DiffResult>(*cbor::CborObject::create_map(diff_json));
+		}
+		else if (old_type == 4 && new_type == 4)
+		{
+			cbor::reader a_reader(old_item);
+			cbor::reader b_reader(new_item);
+			a_reader.read_head(major_type, old_count);
+			b_reader.read_head(major_type, new_count);
+			cbor::item_span a_value;
+			cbor::item_span b_value;
+			cbor::CborArrayValue diff_json;
+			for (size_t i = 0; i < old_count; i++)
+			{
+				a_reader.read_item(a_value);
+				if (i >= new_count)
+				{
+					cbor::CborArrayValue item_diff;
+					item_diff.push_back(cbor::CborObject::from_string("-"));
+					item_diff.push_back(cbor::CborObject::from_int(i));
+					item_diff.push_back(cbor_decode_item(a_value));
+					diff_json.push_back(cbor::CborObject::create_array(item_diff));
+				}
+				else
+				{
+					b_reader.read_item(b_value);
+					auto item_value_diff = diff_encoded_items(a_value, b_value);
+					if (item_value_diff->is_undefined())
+						continue;
+					cbor::CborArrayValue item_diff;
+					item_diff.push_back(cbor::CborObject::from_string("~"));
+					item_diff.push_back(cbor::CborObject::from_int(i));
+					item_diff.push_back(std::make_shared<cbor::CborObject>(item_value_diff->value()));
+					diff_json.push_back(cbor::CborObject::create_array(item_diff));
+				}
+			}
+			for (size_t i = old_count; i < new_count; i++)
+			{
+				b_reader.read_item(b_value);
+				cbor::CborArrayValue item_diff;
+				item_diff.push_back(cbor::CborObject::from_string("+"));
+				item_diff.push_back(cbor::CborObject::from_int(i));
+				item_diff.push_back(cbor_decode_item(b_value));
+				diff_json.push_back(cbor::CborObject::create_array(item_diff));
+			}
+			if (diff_json.size() < 1)
+			{
+				return DiffResult::make_undefined_diff_result();
+			}
+			return std::make_shared<DiffResult>(*cbor::CborObject::create_array(diff_json));
+		}
+		return diff(cbor_decode_item(old_item), cbor_decode_item(new_item));
+	}
+
 	cbor::CborObjectP CborDiff::patch_by_string(const std::string& old_hex, DiffResultP diff_info) {
 		auto old_val = cbor_from_hex(old_hex);
 		return patch(old_val, diff_info);
@@ -6,6 +6,7 @@
 #include <uvm/uvm_lib.h>
 #include <iostream>
 #include <fc/io/json.hpp>
+#include <random>
 
 namespace cbor_diff {
 
@@ -201,4 +202,132 @@ namespace cbor_diff {
 			std::cout << "d1: " << d1->str() << " e1: " << e1->str() << " f1: " << f1->str() << " g1: " << g1->str() << " h1: " << h1->str() << std::endl;
 		}
 	}
+
+	static CborObjectP random_cbor_object(std::mt19937& rng, int depth) {
+		auto kind = rng() % (depth > 0 ? 9 : 7);
+		switch (kind) {
+		case 0: return CborObject::from_int((int64_t)(rng() % 1000) - 500);
+		case 1: return CborObject::from_int((int64_t)rng() * 3);
+		case 2: return CborObject::from_extra_integer(6000000000ULL + rng(), true);
+		case 3: return CborObject::from_string(std::string(rng() % 30, (char)('a' + rng() % 26)));
+		case 4: return CborObject::from_bool(rng() % 2 == 0);
+		// floats are encoded as strings, keep them short so decoder reads them back
+		case 5: return rng() % 8 == 0 ? CborObject::from_float64(rng() % 70 / 7.0) : CborObject::create_null();
+		case 6: return CborObject::from_bytes(CborBytesValue(rng() % 5, 'x'));
+		case 7: {
+			CborArrayValue items;
+			auto size = rng() % 6;
+			for (size_t i = 0; i < size; i++)
+				items.push_back(random_cbor_object(rng, depth - 1));
+			return CborObject::create_array(items);
+		}
+		default: {
+			CborMapValue items;
+			auto size = rng() % 8;
+			for (size_t i = 0; i < size; i++)
+				items[std::string("k") + std::to_string(rng() % 12) + (rng() % 4 == 0 ? "__added" : "")] = random_cbor_object(rng, depth - 1);
+			return CborObject::create_map(items);
+		}
+		}
+	}
+
+	// change some items of a decoded copy, so most of the new value is same as the old one
+	static void mutate_cbor_object(std::mt19937& rng, CborObjectP& value, int depth) {
+		if (rng() % 5 == 0) {
+			value = random_cbor_object(rng, depth);
+			return;
+		}
+		if (value->is_map()) {
+			auto items = value->as_map();
+			for (auto& p : items) {
+				if (rng() % 3 == 0)
+					mutate_cbor_object(rng, p.second, depth - 1);
+			}
+			if (!items.empty() && rng() % 4 == 0)
+				items.erase(items.begin());
+			if (rng() % 4 == 0)
+				items[std::string("k") + std::to_string(rng() % 12)] = random_cbor_object(rng, depth - 1);
+			value = CborObject::create_map(items);
+		}
+		else if (value->is_array()) {
+			auto items = value->as_array();
+			for (auto& item : items) {
+				if (rng() % 3 == 0)
+					mutate_cbor_object(rng, item, depth - 1);
+			}
+			if (!items.empty() && rng() % 4 == 0)
+				items.pop_back();
+			if (rng() % 4 == 0)
+				items.push_back(random_cbor_object(rng, depth - 1));
+			value = CborObject::create_array(items);
+		}
+	}
+
+	// unlike assert, also checks in release builds
+	static void check_cbor_diff_test(bool condition, const std::string& error_msg) {
+		if (!condition)
+			throw CborDiffException("test_cbor_diff_encoded", error_msg);
+	}
+
+	// diff_encoded must give the same result as the decoded diff, byte by byte
+	// @throws CborDiffException when a check fails
+	void test_cbor_diff_encoded() {
+		std::mt19937 rng(20181018);
+		CborDiff differ;
+		for (size_t round = 0; round < 2000; round++) {
+			auto a = random_cbor_object(rng, 4);
+			const auto& a_bytes = cbor_encode(a);
+			auto b = cbor_decode(a_bytes);
+			mutate_cbor_object(rng, b, 4);
+			const auto& b_bytes = cbor_encode(b);
+			// re-encoding a decoded value gives the same bytes
+			check_cbor_diff_test(cbor_encode(cbor_decode(b_bytes)) == b_bytes, "re-encoded bytes differ");
+
+			auto expected = differ.diff(cbor_decode(a_bytes), cbor_decode(b_bytes));
+			auto result = differ.diff_encoded(a_bytes, b_bytes);
+			check_cbor_diff_test(expected->is_undefined() == result->is_undefined(), "diff_encoded found a different change");
+			if (!expected->is_undefined())
+				check_cbor_diff_test(cbor_encode(expected->value()) == cbor_encode(result->value()), "diff_encoded result differs from diff");
+			check_cbor_diff_test(differ.diff_encoded(a_bytes, a_bytes)->is_undefined(), "diff_encoded of same bytes is not empty");
+		}
+		{
+			// negative 8 bytes integers are left to decoder, which fails on them in a map
+			auto a = CborObject::create_map({ { "a", CborObject::from_extra_integer(6000000000, false) }, { "b", CborObject::from_int(1) } });
+			auto b = CborObject::create_map({ { "a", CborObject::from_extra_integer(6000000000, false) }, { "b", CborObject::from_int(2) } });
+			const auto& a_bytes = cbor_encode(a);
+			const auto& b_bytes = cbor_encode(b);
+			bool expected_failed = false;
+			bool failed = false;
+			try {
+				differ.diff(cbor_decode(a_bytes), cbor_decode(b_bytes));
+			}
+			catch (const std::exception&) {
+				expected_failed = true;
+			}
+			try {
+				differ.diff_encoded(a_bytes, b_bytes);
+			}
+			catch (const std::exception&) {
+				failed = true;
+			}
+			check_cbor_diff_test(expected_failed == failed, "diff_encoded of negative 8 bytes integer differs from diff");
+		}
+
+		{
+			// truncated and trailing bytes still fail like cbor_decode
+			auto a = CborObject::create_map({ { "a", CborObject::from_int(1) } });
+			auto a_bytes = cbor_encode(a);
+			auto truncated = a_bytes;
+			truncated.pop_back();
+			bool failed = false;
+			try {
+				differ.diff_encoded(truncated, a_bytes);
+			}
+			catch (const std::exception&) {
+				failed = true;
+			}
+			check_cbor_diff_test(failed, "diff_encoded of truncated bytes didn't fail");
+		}
+		std::cout << "cbor diff encoded tests passed" << std::endl;
+	}
 }
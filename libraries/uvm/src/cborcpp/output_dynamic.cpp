@@ -25,7 +25,7 @@ using namespace cbor;
 
 void output_dynamic::init(unsigned int initalCapacity) {
     this->_capacity = initalCapacity;
-    this->_buffer = new unsigned char[initalCapacity];
+    this->_buffer = (unsigned char *) malloc(initalCapacity);
     this->_offset = 0;
 }
 
@@ -38,7 +38,7 @@ output_dynamic::output_dynamic(unsigned int inital_capacity) {
 }
 
 output_dynamic::~output_dynamic() {
-    delete _buffer;
+    free(_buffer); // grown by realloc
 }
 
 unsigned char *output_dynamic::data() const {
@@ -0,0 +1,153 @@
+#include "cborcpp/reader.h"
+
+#include <string.h>
+#include <limits.h>
+
+using namespace cbor;
+
+// deeper items are left to decoder, which has no recursion
+static const int max_reader_depth = 128;
+
+bool item_span::same_bytes(const item_span &other) const {
+    return size == other.size && memcmp(data, other.data, size) == 0;
+}
+
+int cbor::compare_map_keys(const char *a, size_t a_size, const char *b, size_t b_size) {
+    int result = memcmp(a, b, a_size < b_size ? a_size : b_size);
+    if (result != 0)
+        return result;
+    if (a_size == b_size)
+        return 0;
+    return a_size < b_size ? -1 : 1;
+}
+
+reader::reader(const void *data, size_t size) {
+    _data = (const unsigned char *) data;
+    _size = size;
+    _offset = 0;
+}
+
+reader::reader(const item_span &item) {
+    _data = item.data;
+    _size = item.size;
+    _offset = 0;
+}
+
+bool reader::read_head(unsigned char &major_type, uint64_t &argument) {
+    if (_offset >= _size)
+        return false;
+    unsigned char type = _data[_offset];
+    major_type = type >> 5;
+    unsigned char minor_type = (unsigned char) (type & 31);
+    if (major_type == 7) {
+        // false, true, null, undefined. floats are encoded as padded strings which decoder reads in its own way
+        if (minor_type < 20 || minor_type > 23)
+            return false;
+        argument = minor_type;
+        _offset += 1;
+        return true;
+    }
+    size_t argument_size;
+    if (minor_type < 24)
+        argument_size = 0;
+    else if (minor_type == 24)
+        argument_size = 1;
+    else if (minor_type == 25)
+        argument_size = 2;
+    else if (minor_type == 26)
+        argument_size = 4;
+    else if (minor_type == 27)
+        argument_size = 8;
+    else
+        return false;
+    // decoder only reads 8 bytes argument of positive integers and tags correctly
+    if (argument_size == 8 && major_type != 0 && major_type != 6)
+        return false;
+    if (_size - _offset - 1 < argument_size)
+        return false;
+    if (argument_size == 0) {
+        argument = minor_type;
+    } else {
+        argument = 0;
+        for (size_t i = 0; i < argument_size; i++) {
+            argument = (argument << 8) | _data[_offset + 1 + i];
+        }
+    }
+    // decoder keeps lengths in int
+    if ((major_type == 2 || major_type == 3) && argument > INT_MAX)
+        return false;
+    _offset += 1 + argument_size;
+    return true;
+}
+
+bool reader::read_string(const char *&str, size_t &size) {
+    auto old_offset = _offset;
+    unsigned char major_type;
+    uint64_t length;
+    if (!read_head(major_type, length) || major_type != 3 || length > _size - _offset) {
+        _offset = old_offset;
+        return false;
+    }
+    str = (const char *) (_data + _offset);
+    size = (size_t) length;
+    _offset += size;
+    return true;
+}
+
+bool reader::read_item(item_span &item) {
+    auto old_offset = _offset;
+    if (!skip_item(0)) {
+        _offset = old_offset;
+        return false;
+    }
+    item.data = _data + old_offset;
+    item.size = _offset - old_offset;
+    return true;
+}
+
+bool reader::skip_item(int depth) {
+    if (depth > max_reader_depth)
+        return false;
+    unsigned char major_type;
+    uint64_t argument;
+    if (!read_head(major_type, argument))
+        return false;
+    switch (major_type) {
+    case 2: // bytes
+    case 3: // string
+        if (argument > _size - _offset)
+            return false;
+        _offset += (size_t) argument;
+        return true;
+    case 4: // array
+        if (argument > _size - _offset)
+            return false;
+        for (uint64_t i = 0; i < argument; i++) {
+            if (!skip_item(depth + 1))
+                return false;
+        }
+        return true;
+    case 5: { // map
+        if (argument > _size - _offset)
+            return false;
+        const char *last_key = nullptr;
+        size_t last_key_size = 0;
+        for (uint64_t i = 0; i < argument; i++) {
+            const char *key;
+            size_t key_size;
+            if (!read_string(key, key_size))
+                return false;
+            // decoder merges duplicate keys, so only the sorted unique keys written by encoder are accepted
+            if (last_key && compare_map_keys(last_key, last_key_size, key, key_size) >= 0)
+                return false;
+            last_key = key;
+            last_key_size = key_size;
+            if (!skip_item(depth + 1))
+                return false;
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
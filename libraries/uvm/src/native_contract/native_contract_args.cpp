@@ -0,0 +1,166 @@
+#include <native_contract/native_contract_args.h>
+#include <boost/algorithm/string.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+namespace uvm {
+	namespace contract {
+
+		static bool is_numeric(const std::string& number)
+		{
+			char* end = 0;
+			std::strtod(number.c_str(), &end);
+			return end != 0 && *end == 0;
+		}
+
+		static bool is_integral(const std::string& number)
+		{
+			return is_numeric(number) && std::strchr(number.c_str(), '.') == 0;
+		}
+
+		// starts arguments in the binary calling convention. text arguments can't start with a nul byte
+		static const char binary_args_marker[] = { '\0', 'c', 'b', 'o', 'r' };
+
+		static bool is_binary_args(const std::string& api_arg)
+		{
+			return api_arg.size() >= sizeof(binary_args_marker)
+				&& std::memcmp(api_arg.data(), binary_args_marker, sizeof(binary_args_marker)) == 0;
+		}
+
+		// integers of binary arguments beyond int64 are malformed
+		static bool is_int64_arg(const cbor::CborObject& item)
+		{
+			if (item.is_int())
+				return true;
+			return item.is_extra_int() && item.as_extra_int() <= static_cast<uint64_t>(INT64_MAX);
+		}
+
+		native_args::native_args(const std::string& api_arg, bool allow_binary, bool trim_text)
+		{
+			if (allow_binary && is_binary_args(api_arg)) {
+				_binary = true;
+				cbor::CborObjectP value;
+				try {
+					// cbor::input never writes to the buffer
+					cbor::input input(const_cast<char*>(api_arg.data()) + sizeof(binary_args_marker), static_cast<int>(api_arg.size() - sizeof(binary_args_marker)));
+					cbor::decoder decoder(input);
+					value = decoder.run();
+				}
+				catch (const cbor::CborException&) {
+					return;
+				}
+				if (!value || !value->is_array())
+					return;
+				const auto& items = value->as_array();
+				// the decoder returns the items read so far when the input ends inside the array
+				if (items.size() != value->array_or_map_size)
+					return;
+				std::vector<std::string> texts;
+				std::vector<bool> is_int;
+				std::vector<int64_t> ints;
+				for (const auto& item : items) {
+					if (item && is_int64_arg(*item)) {
+						// small integers are decoded as int, larger ones or 8 byte encoded ones as extra int
+						const auto int_value = item->force_as_int();
+						texts.push_back(std::to_string(int_value));
+						is_int.push_back(true);
+						ints.push_back(int_value);
+					}
+					else if (item && item->is_string()) {
+						texts.push_back(item->as_string());
+						is_int.push_back(false);
+						ints.push_back(0);
+					}
+					else {
+						return;
+					}
+				}
+				_texts = std::move(texts);
+				_is_int = std::move(is_int);
+				_ints = std::move(ints);
+				return;
+			}
+			boost::split(_texts, api_arg, [](char c) {return c == ','; });
+			if (trim_text) {
+				for (auto& text : _texts)
+					boost::trim(text);
+			}
+		}
+
+		std::string native_args::encode_binary(const cbor::CborArrayValue& items)
+		{
+			cbor::output_dynamic output;
+			cbor::encoder encoder(output);
+			const auto& value = cbor::CborObject::create_array(items);
+			encoder.write_cbor_object(value.get());
+			const auto& bytes = output.chars();
+			std::string result(binary_args_marker, sizeof(binary_args_marker));
+			result.append(bytes.begin(), bytes.end());
+			return result;
+		}
+
+		bool native_args::is_int_at(size_t index) const
+		{
+			if (_binary)
+				return _is_int[index];
+			return is_integral(_texts[index]);
+		}
+
+		int64_t native_args::int_at(size_t index) const
+		{
+			if (_binary)
+				return _ints[index];
+			return std::stoll(_texts[index]);
+		}
+
+		native_event_builder& native_event_builder::add(const std::string& key, const std::string& value)
+		{
+			return add_json(key, fc::json::to_string(value));
+		}
+
+		native_event_builder& native_event_builder::add(const std::string& key, int64_t value)
+		{
+			return add_json(key, fc::json::to_string(fc::variant(value)));
+		}
+
+		native_event_builder& native_event_builder::add_json(const std::string& key, std::string&& json_value)
+		{
+			// like JsonObject, setting a key again replaces its value
+			for (auto& field : _fields) {
+				if (field.first == key) {
+					field.second = std::move(json_value);
+					return *this;
+				}
+			}
+			_fields.emplace_back(key, std::move(json_value));
+			return *this;
+		}
+
+		std::string native_event_builder::str() const
+		{
+			std::vector<const std::pair<std::string, std::string>*> sorted;
+			sorted.reserve(_fields.size());
+			for (const auto& field : _fields)
+				sorted.push_back(&field);
+			std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, std::string>* a, const std::pair<std::string, std::string>* b) {
+				return a->first < b->first;
+			});
+			std::string result = "{";
+			bool is_first = true;
+			for (const auto* field : sorted) {
+				if (!is_first)
+					result += ",";
+				is_first = false;
+				result += fc::json::to_string(field->first);
+				result += ":";
+				result += field->second;
+			}
+			result += "}";
+			return result;
+		}
+
+	}
+}
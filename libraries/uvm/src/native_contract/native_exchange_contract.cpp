@@ -11,6 +11,7 @@
 #include <fc/array.hpp>
 #include <fc/crypto/ripemd160.hpp>
 #include <safenumber/safenumber.h>
+#include <native_contract/native_contract_args.h>
 
 #define NATIVE_EXCHANGE_ORDER_STATE_CANCELED 0
 #define NATIVE_EXCHANGE_ORDER_STATE_COMPLETED 1
@@ -203,10 +204,7 @@ namespace uvm {
 			}
 			
 			int64_t spentFee = safe_number_to_int64(safe_number_multiply(safe_number_create(spentNum), safe_number_create(orderInfo.fee)));
-			const auto& temp_minFee = current_fast_map_get(orderInfo.payAsset, "minFee");
-			if (temp_minFee->is_integer()) {
-				minFee = temp_minFee->force_as_int();
-			}
+			current_fast_map_get_int(orderInfo.payAsset, "minFee", minFee);
 			if (spentFee < 0) {
 				throw_error("fee percentage must positive");
 			}
@@ -237,11 +235,10 @@ namespace uvm {
 			}
 
 			//check balance
-			auto balance = current_fast_map_get(addr, orderInfo.payAsset);
-			if (!balance->is_integer()) {
+			int64_t bal;
+			if (!current_fast_map_get_int(addr, orderInfo.payAsset, bal)) {
 				throw_error(std::string("no balance of user ") + addr);
 			}
-			auto bal = balance->force_as_int();
 			if (bal < (spentNum+ spentFee)) {   //add fee
 				throw_error("not enough balance");
 			}
@@ -314,23 +311,16 @@ namespace uvm {
 			}
 
 			////write bal
-			current_fast_map_set(addr, orderInfo.payAsset, CborObject::from_int(bal - spentNum - spentFee));
-			balance = current_fast_map_get(addr, orderInfo.purchaseAsset);
-			if (!balance->is_integer()) {
+			current_fast_map_set_int(addr, orderInfo.payAsset, bal - spentNum - spentFee);
+			if (!current_fast_map_get_int(addr, orderInfo.purchaseAsset, bal)) {
 				bal = 0;
 			}
-			else {
-				bal = balance->force_as_int();
-			}
-			current_fast_map_set(addr, orderInfo.purchaseAsset, CborObject::from_int(bal + getNum));
+			current_fast_map_set_int(addr, orderInfo.purchaseAsset, bal + getNum);
 			//fee
 			if (spentFee > 0) {
-				balance = current_fast_map_get(feeReceiver, orderInfo.payAsset);
 				int64_t feeReceiverBal = 0;
-				if (balance->is_integer()) {
-					bal = balance->force_as_int();
-				}
-				current_fast_map_set(feeReceiver, orderInfo.payAsset, CborObject::from_int(feeReceiverBal + spentFee));
+				current_fast_map_get_int(feeReceiver, orderInfo.payAsset, bal);
+				current_fast_map_set_int(feeReceiver, orderInfo.payAsset, feeReceiverBal + spentFee);
 			}
 
 			std::stringstream ss;
@@ -374,24 +364,18 @@ namespace uvm {
 
 
 			//UserBalanceChange event
-			jsondiff::JsonObject event_arg;
+			native_event_builder event_arg;
 			//spent
-			event_arg["symbol"] = orderInfo.payAsset;
-			event_arg["address"] = addr;
-			event_arg["amount"] = -(spentNum + spentFee);
-			emit_event("UserBalanceChange", uvm::util::json_ordered_dumps(event_arg));
+			event_arg.add("symbol", orderInfo.payAsset).add("address", addr).add("amount", -(spentNum + spentFee));
+			emit_event("UserBalanceChange", event_arg.str());
 
 			if (spentFee > 0) {
-				event_arg["symbol"] = orderInfo.payAsset;
-				event_arg["address"] = feeReceiver;
-				event_arg["amount"] = spentFee;
-				emit_event("UserBalanceChange", uvm::util::json_ordered_dumps(event_arg));
+				event_arg.add("symbol", orderInfo.payAsset).add("address", feeReceiver).add("amount", spentFee);
+				emit_event("UserBalanceChange", event_arg.str());
 			}
 			
-			event_arg["symbol"] = orderInfo.purchaseAsset;
-			event_arg["address"] = addr;
-			event_arg["amount"] = getNum;
-			emit_event("UserBalanceChange", uvm::util::json_ordered_dumps(event_arg));
+			event_arg.add("symbol", orderInfo.purchaseAsset).add("address", addr).add("amount", getNum);
+			emit_event("UserBalanceChange", event_arg.str());
 
 			return orderInfo;
 		}
@@ -537,10 +521,7 @@ namespace uvm {
 		void exchange_native_contract::minFee_api(const std::string& api_name, const std::string& api_arg)
 		{
 			int64_t minFee = 0;
-			const auto& temp_minFee = current_fast_map_get(api_arg, "minFee");
-			if (temp_minFee->is_integer()) {
-				minFee = temp_minFee->force_as_int();
-			}
+			current_fast_map_get_int(api_arg, "minFee", minFee);
 			set_api_result(fc::to_string(minFee));
 			return ;
 		}
@@ -664,23 +645,18 @@ namespace uvm {
 			const auto& addr = caller_address_string();
 
 			//check balance
-			auto balance = current_fast_map_get(addr, symbol);
 			int64_t bal = 0;
-			if (balance->is_integer()) {
-				bal = balance->force_as_int();
-			}
-			current_fast_map_set(addr, symbol, CborObject::from_int(bal + amount));
+			current_fast_map_get_int(addr, symbol, bal);
+			current_fast_map_set_int(addr, symbol, bal + amount);
 
-			jsondiff::JsonObject event_arg;
-			event_arg["from_address"] = addr;
-			event_arg["symbol"] = symbol;
-			event_arg["amount"] = amount;
-			emit_event("Deposited", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add("from_address", addr).add("symbol", symbol).add("amount", amount);
+			emit_event("Deposited", event_arg.str());
 
 			//UserBalanceChange
-			event_arg.erase("from_address");
-			event_arg["address"] = addr;
-			emit_event("UserBalanceChange", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder balance_change_arg;
+			balance_change_arg.add("symbol", symbol).add("amount", amount).add("address", addr);
+			emit_event("UserBalanceChange", balance_change_arg.str());
 		}
 
 		//args:amount,symbol
@@ -707,38 +683,31 @@ namespace uvm {
 				throw_error("symbol is empty");
 			}
 			const auto& caller = caller_address_string();
-			auto balance = current_fast_map_get(caller, symbol);
 			int64_t bal = 0;
-			if (!balance->is_integer()) {
+			if (!current_fast_map_get_int(caller, symbol, bal)) {
 				throw_error("no balance to withdraw");
 			}
-			else {
-				bal = balance->force_as_int();
-			}
 			if (amount > bal) {
 				throw_error("not enough balance to withdraw");
 			}
 			auto newBalance = bal - amount;
 			if (newBalance == 0) {
-				current_fast_map_set(caller, parsed_args[1], CborObject::create_null());
+				current_fast_map_set_null(caller, parsed_args[1]);
 			}
 			else {
-				current_fast_map_set(caller, parsed_args[1], CborObject::from_int(newBalance));
+				current_fast_map_set_int(caller, parsed_args[1], newBalance);
 			}
 
 			current_transfer_to_address(caller, symbol, amount);
 			//{"amount":35000,"realAmount":34996,"fee":4,"symbol":"BTC","to_address":"test11"}
-			jsondiff::JsonObject event_arg;
-			event_arg["symbol"] = symbol;
-			event_arg["to_address"] = caller;
-			event_arg["amount"] = amount;
-			emit_event("Withdrawed", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add("symbol", symbol).add("to_address", caller).add("amount", amount);
+			emit_event("Withdrawed", event_arg.str());
 
 			//UserBalanceChange
-			event_arg.erase("to_address");
-			event_arg["amount"] = -amount;
-			event_arg["address"] = caller;
-			emit_event("UserBalanceChange", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder balance_change_arg;
+			balance_change_arg.add("symbol", symbol).add("amount", -amount).add("address", caller);
+			emit_event("UserBalanceChange", balance_change_arg.str());
 		}
 
 
@@ -749,14 +718,10 @@ namespace uvm {
 			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
 			if (parsed_args.size() != 2)
 				throw_error("argument format error, need format: address,symbol");
-			auto balance = current_fast_map_get(parsed_args[0], parsed_args[1]);
 			int64_t bal = 0;
-			if (!balance->is_integer()) {
+			if (!current_fast_map_get_int(parsed_args[0], parsed_args[1], bal)) {
 				bal = 0;
 			}
-			else {
-				bal = balance->force_as_int();
-			}
 			set_api_result(std::to_string(bal));
 			return;
 		}
@@ -798,15 +763,12 @@ namespace uvm {
 				throw_error("invalid publicKey_hexString");
 			}
 			
-			auto balance = current_fast_map_get(addr, parsed_args[1]);
 			int64_t bal = 0;
-			if (!balance->is_integer()) {
+			if (!current_fast_map_get_int(addr, parsed_args[1], bal)) {
 				bal = 0;
 			}
-			else {
-				bal = balance->force_as_int();
-			}
 			set_api_result(std::to_string(bal));
+
 			return;
 		}
 
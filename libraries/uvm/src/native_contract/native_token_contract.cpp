@@ -3,6 +3,7 @@
 #include <jsondiff/jsondiff.h>
 #include <cbor_diff/cbor_diff.h>
 #include <uvm/uvm_lutil.h>
+#include <native_contract/native_contract_args.h>
 
 namespace uvm {
 	namespace contract {
@@ -86,10 +87,10 @@ namespace uvm {
 
 		int64_t token_native_contract::get_balance_of_user(const std::string& owner_addr) const
 		{
-			auto user_balance_cbor = current_fast_map_get("users", owner_addr);
-			if (!user_balance_cbor->is_integer())
+			int64_t balance;
+			if (!current_fast_map_get_int("users", owner_addr, balance))
 				return 0;
-			return user_balance_cbor->force_as_int();
+			return balance;
 		}
 
 		cbor::CborMapValue token_native_contract::get_allowed_of_user(const std::string& from_addr) const {
@@ -157,7 +158,7 @@ namespace uvm {
 			set_current_contract_storage("symbol", CborObject::from_string(symbol));
 
 			auto caller_addr = caller_address_string();
-			current_fast_map_set("users", caller_addr, CborObject::from_int(supply));
+			current_fast_map_set_int("users", caller_addr, supply);
 			emit_event("Inited", supply_str);
 			return;
 		}
@@ -251,17 +252,13 @@ namespace uvm {
 		{
 			if (get_storage_state() != common_state_of_token_contract)
 				throw_error("this token contract state doesn't allow transfer");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() < 2)
+			native_args args(api_arg, binary_args_enabled(), true);
+			if (args.size() < 2)
 				throw_error("argument format error, need format: toAddress,amount(with precision, integer)");
-			std::string to_address = parsed_args[0];
-			boost::trim(to_address);
-			std::string amount_str = parsed_args[1];
-			boost::trim(amount_str);
-			if (!is_integral(amount_str))
+			const auto& to_address = args.string_at(0);
+			if (!args.is_int_at(1))
 				throw_error("argument format error, amount must be positive integer");
-			int64_t amount = std::stoll(amount_str);
+			int64_t amount = args.int_at(1);
 			if (amount <= 0)
 				throw_error("argument format error, amount must be positive integer");
 
@@ -271,18 +268,16 @@ namespace uvm {
 				throw_error("you have not enoungh amount to transfer out");
 			auto from_addr_remain = from_user_balance - amount;
 			if (from_addr_remain > 0) {
-				current_fast_map_set("users", from_addr, CborObject::from_int(from_addr_remain));
+				current_fast_map_set_int("users", from_addr, from_addr_remain);
 			}
 			else {
-				current_fast_map_set("users", from_addr, CborObject::create_null());
+				current_fast_map_set_null("users", from_addr);
 			}
 			auto to_amount = get_balance_of_user(to_address);
-			current_fast_map_set("users", to_address, CborObject::from_int(to_amount + amount));
-			jsondiff::JsonObject event_arg;
-			event_arg["from"] = from_addr;
-			event_arg["to"] = to_address;
-			event_arg["amount"] = amount;
-			emit_event("Transfer", uvm::util::json_ordered_dumps(event_arg));
+			current_fast_map_set_int("users", to_address, to_amount + amount);
+			native_event_builder event_arg;
+			event_arg.add("from", from_addr).add("to", to_address).add("amount", amount);
+			emit_event("Transfer", event_arg.str());
 			return;
 		}
 
@@ -290,17 +285,13 @@ namespace uvm {
 		{
 			if (get_storage_state() != common_state_of_token_contract)
 				throw_error("this token contract state doesn't allow approve");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() < 2)
+			native_args args(api_arg, binary_args_enabled(), true);
+			if (args.size() < 2)
 				throw_error("argument format error, need format: spenderAddress, amount(with precision, integer)");
-			std::string spender_address = parsed_args[0];
-			boost::trim(spender_address);
-			std::string amount_str = parsed_args[1];
-			boost::trim(amount_str);
-			if (!is_integral(amount_str))
+			const auto& spender_address = args.string_at(0);
+			if (!args.is_int_at(1))
 				throw_error("argument format error, amount must be positive integer");
-			int64_t amount = std::stoll(amount_str);
+			int64_t amount = args.int_at(1);
 			if (amount <= 0)
 				throw_error("argument format error, amount must be positive integer");
 			std::string contract_caller = get_from_address();
@@ -309,11 +300,9 @@ namespace uvm {
 			if (allowed_data.size() > 1000)
 				throw_error("you approved to too many users");
 			current_fast_map_set("allowed", contract_caller, CborObject::create_map(allowed_data));
-			jsondiff::JsonObject event_arg;
-			event_arg["from"] = contract_caller;
-			event_arg["spender"] = spender_address;
-			event_arg["amount"] = amount;
-			emit_event("Approved", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add("from", contract_caller).add("spender", spender_address).add("amount", amount);
+			emit_event("Approved", event_arg.str());
 			return;
 		}
 
@@ -321,19 +310,14 @@ namespace uvm {
 		{
 			if (get_storage_state() != common_state_of_token_contract)
 				throw_error("this token contract state doesn't allow transferFrom");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() < 3)
+			native_args args(api_arg, binary_args_enabled(), true);
+			if (args.size() < 3)
 				throw_error("argument format error, need format:fromAddress, toAddress, amount(with precision, integer)");
-			std::string from_address = parsed_args[0];
-			boost::trim(from_address);
-			std::string to_address = parsed_args[1];
-			boost::trim(to_address);
-			std::string amount_str = parsed_args[2];
-			boost::trim(amount_str);
-			if (!is_integral(amount_str))
+			const auto& from_address = args.string_at(0);
+			const auto& to_address = args.string_at(1);
+			if (!args.is_int_at(2))
 				throw_error("argument format error, amount must be positive integer");
-			int64_t amount = std::stoll(amount_str);
+			int64_t amount = args.int_at(2);
 			if (amount <= 0)
 				throw_error("argument format error, amount must be positive integer");
 
@@ -350,22 +334,20 @@ namespace uvm {
 				throw_error("not enough approved amount to withdraw");
 			auto from_addr_remain = get_balance_of_user(from_address) - amount;
 			if (from_addr_remain > 0)
-				current_fast_map_set("users", from_address, CborObject::from_int(from_addr_remain));
+				current_fast_map_set_int("users", from_address, from_addr_remain);
 			else
-				current_fast_map_set("users", from_address, CborObject::create_null());
+				current_fast_map_set_null("users", from_address);
 			auto to_amount = get_balance_of_user(to_address);
-			current_fast_map_set("users", to_address, CborObject::from_int(to_amount + amount));
+			current_fast_map_set_int("users", to_address, to_amount + amount);
 
 			allowed_data[contract_caller] = CborObject::from_int(approved_amount - amount);
 			if (allowed_data[contract_caller]->force_as_int() == 0)
 				allowed_data.erase(contract_caller);
 			current_fast_map_set("allowed", from_address, CborObject::create_map(allowed_data));
 
-			jsondiff::JsonObject event_arg;
-			event_arg["from"] = from_address;
-			event_arg["to"] = to_address;
-			event_arg["amount"] = amount;
-			emit_event("Transfer", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add("from", from_address).add("to", to_address).add("amount", amount);
+			emit_event("Transfer", event_arg.str());
 
 			return;
 		}
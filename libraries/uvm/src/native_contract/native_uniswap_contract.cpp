@@ -4,6 +4,10 @@
 #include <cbor_diff/cbor_diff.h>
 #include <uvm/uvm_lutil.h>
 #include <safenumber/safenumber.h>
+#include <native_contract/native_uniswap_math.h>
+#include <native_contract/native_contract_args.h>
+#include <map>
+#include <mutex>
 
 namespace uvm {
 	namespace contract {
@@ -35,6 +39,40 @@ namespace uvm {
 		static const std::string not_inited_state_of_contract = "NOT_INITED";
 		static const std::string common_state_of_contract = "COMMON";
 
+		static std::mutex pool_snapshots_mutex;
+		static std::map<std::string, uniswap_pool_snapshot> pool_snapshots;
+		static const size_t max_pool_snapshots = 1000;
+
+		uniswap_pool_snapshot uniswap_native_contract::get_pool_snapshot() {
+			std::string contract_address;
+			uint64_t revision = 0;
+			bool has_revision = current_storage_revision(contract_address, revision);
+			if (has_revision) {
+				std::lock_guard<std::mutex> lock(pool_snapshots_mutex);
+				auto it = pool_snapshots.find(contract_address);
+				if (it != pool_snapshots.end() && it->second.revision == revision)
+					return it->second;
+			}
+			uniswap_pool_snapshot snapshot;
+			snapshot.revision = revision;
+			snapshot.state = get_storage_state();
+			if (snapshot.state == common_state_of_contract) {
+				snapshot.asset1 = get_string_current_contract_storage("asset_1_symbol");
+				snapshot.asset2 = get_string_current_contract_storage("asset_2_symbol");
+				snapshot.asset_1_pool_amount = get_int_current_contract_storage("asset_1_pool_amount");
+				snapshot.asset_2_pool_amount = get_int_current_contract_storage("asset_2_pool_amount");
+				snapshot.supply = get_int_current_contract_storage("supply");
+				snapshot.fee_rate = safe_number_create(get_string_current_contract_storage("fee_rate"));
+			}
+			if (has_revision) {
+				std::lock_guard<std::mutex> lock(pool_snapshots_mutex);
+				if (pool_snapshots.size() >= max_pool_snapshots)
+					pool_snapshots.clear();
+				pool_snapshots[contract_address] = snapshot;
+			}
+			return snapshot;
+		}
+
 		static bool is_numeric(std::string number)
 		{
 			char* end = 0;
@@ -61,12 +99,7 @@ namespace uvm {
 		}
 
 		static int64_t getInputPrice(int64_t input_amount, int64_t input_reserve, int64_t output_reserve) {
-			const auto& a = safe_number_create(input_reserve);
-			const auto& b = safe_number_create(output_reserve);
-			const auto& x = safe_number_create(input_amount);
-			const auto& n = safe_number_multiply(x, b);
-			int64_t r = safe_number_to_int64(safe_number_div(n, safe_number_add(a, x)));
-			return r;
+			return uniswap_math::get_input_price(input_amount, input_reserve, output_reserve);
 		}
 
 		//ʱС
@@ -169,21 +202,18 @@ namespace uvm {
 		void uniswap_native_contract::addLiquidity_api(const std::string& api_name, const std::string& api_arg) {
 			if (get_storage_state() != common_state_of_contract)
 				throw_error("state not common!");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() != 3)
+			native_args args(api_arg, binary_args_enabled());
+			if (args.size() != 3)
 				throw_error("argument format error, need format: add_asset1_amount,max_add_asset2_amount,expired_blocknum");
 			
-			std::string add_asset1_amount_str = parsed_args[0];
-			std::string max_add_asset2_amount_str = parsed_args[1];
-			std::string expired_blocknum_str = parsed_args[2];
+			const auto& expired_blocknum_str = args.string_at(2);
 
-			if (!is_integral(add_asset1_amount_str) || !is_integral(max_add_asset2_amount_str) || !is_integral(expired_blocknum_str))
+			if (!args.is_int_at(0) || !args.is_int_at(1) || !args.is_int_at(2))
 				throw_error("argument format error, need format: add_asset1_amount,max_add_asset2_amount,expired_blocknum");
 
-			int64_t add_asset1_amount = std::stoll(add_asset1_amount_str);
-			int64_t max_add_asset2_amount = std::stoll(max_add_asset2_amount_str);
-			int64_t expired_blocknum = std::stoll(expired_blocknum_str);
+			int64_t add_asset1_amount = args.int_at(0);
+			int64_t max_add_asset2_amount = args.int_at(1);
+			int64_t expired_blocknum = args.int_at(2);
 
 			if (add_asset1_amount <= 0 || max_add_asset2_amount <= 0 )
 				throw_error("argument format error, add_asset_amount to add liquidity must be positive integer");
@@ -204,15 +234,9 @@ namespace uvm {
 			int64_t asset_1_pool_amount = get_int_current_contract_storage("asset_1_pool_amount");
 			int64_t asset_2_pool_amount = get_int_current_contract_storage("asset_2_pool_amount");
 			
-			const auto& a = safe_number_create(asset_1_pool_amount);
-			const auto& b = safe_number_create(asset_2_pool_amount);
-			const auto& x = safe_number_create(add_asset1_amount);
 			int64_t caculate_asset2_amount = max_add_asset2_amount;
 			if (asset_1_pool_amount != 0 && asset_2_pool_amount != 0) {
-				const auto& temp = safe_number_div(safe_number_multiply(x, b), a);
-				caculate_asset2_amount = safe_number_to_int64(temp);
-				if (safe_number_ne(safe_number_create(caculate_asset2_amount), temp))
-					caculate_asset2_amount++;
+				caculate_asset2_amount = uniswap_math::mul_div_ceil(add_asset1_amount, asset_2_pool_amount, asset_1_pool_amount);
 				if (caculate_asset2_amount > max_add_asset2_amount) {
 					throw_error("caculate_asset2_amount > max_add_asset2_amount");
 				}
@@ -223,18 +247,15 @@ namespace uvm {
 			const auto& asset1 = get_string_current_contract_storage("asset_1_symbol");
 			const auto& asset2 = get_string_current_contract_storage("asset_2_symbol");
 
-			auto user_asset1_balance_cbor = current_fast_map_get(from_address, asset1);
-			if (!user_asset1_balance_cbor->is_integer()) {
+			int64_t asset1_balance;
+			if (!current_fast_map_get_int(from_address, asset1, asset1_balance)) {
 				throw_error("no balance of "+ asset1);
 			}
-			auto user_asset2_balance_cbor = current_fast_map_get(from_address, asset2);
-			if (!user_asset2_balance_cbor->is_integer()) {
+			int64_t asset2_balance;
+			if (!current_fast_map_get_int(from_address, asset2, asset2_balance)) {
 				throw_error("no balance of " + asset2);
 			}
 
-			int64_t asset1_balance = user_asset1_balance_cbor->force_as_int();
-			int64_t asset2_balance = user_asset2_balance_cbor->force_as_int();
-
 			if ((add_asset1_amount > asset1_balance) || (caculate_asset2_amount > asset2_balance)) {
 				throw_error("not enough balance");
 			}
@@ -242,8 +263,8 @@ namespace uvm {
 			asset2_balance = asset2_balance - caculate_asset2_amount;
 
 			//sub  balances
-			current_fast_map_set(from_address, asset1, CborObject::from_int(asset1_balance));
-			current_fast_map_set(from_address, asset2, CborObject::from_int(asset2_balance));
+			current_fast_map_set_int(from_address, asset1, asset1_balance);
+			current_fast_map_set_int(from_address, asset2, asset2_balance);
 			
 			// mint token
 			int64_t supply = get_int_current_contract_storage("supply");
@@ -253,8 +274,7 @@ namespace uvm {
 				token_amount = add_asset1_amount *1000;
 			}
 			else if (asset_1_pool_amount != 0 && asset_2_pool_amount != 0 && supply != 0) {
-				const auto& temp = safe_number_div(safe_number_multiply(x, safe_number_create(supply)), a);
-				token_amount = safe_number_to_int64(temp);
+				token_amount = uniswap_math::mul_div_floor(add_asset1_amount, supply, asset_1_pool_amount);
 			}
 			else {
 				throw_error("internal error, asset_1_pool_amount,asset_2_pool_amount,supply not unified 0");
@@ -273,26 +293,20 @@ namespace uvm {
 			set_current_contract_storage("asset_2_pool_amount", CborObject::from_int(asset_2_pool_amount));
 			set_current_contract_storage("supply", CborObject::from_int(supply + token_amount));
 
-			auto cbor_token_balance = current_fast_map_get("users", from_address);
 			int64_t token_balance = 0;
-			if (cbor_token_balance->is_integer()) {
-				token_balance = cbor_token_balance->force_as_int();
-			}
-			current_fast_map_set("users", from_address, CborObject::from_int(token_balance+token_amount));
+			current_fast_map_get_int("users", from_address, token_balance);
+			current_fast_map_set_int("users", from_address, token_balance+token_amount);
 			
-			jsondiff::JsonObject event_arg;
-			event_arg[asset1] = add_asset1_amount;
-			event_arg[asset2] = caculate_asset2_amount;
-			emit_event("LiquidityAdded", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add(asset1, add_asset1_amount).add(asset2, caculate_asset2_amount);
+			emit_event("LiquidityAdded", event_arg.str());
 
 			emit_event("LiquidityTokenMinted", std::to_string(token_amount));
 			set_api_result(std::to_string(token_amount));
 
-			jsondiff::JsonObject event_arg2;
-			event_arg2["from"] = "";
-			event_arg2["to"] = from_address;
-			event_arg2["amount"] = token_amount;
-			emit_event("Transfer", uvm::util::json_ordered_dumps(event_arg2));
+			native_event_builder event_arg2;
+			event_arg2.add("from", "").add("to", from_address).add("amount", token_amount);
+			emit_event("Transfer", event_arg2.str());
 
 		}
 
@@ -300,23 +314,19 @@ namespace uvm {
 		void uniswap_native_contract::removeLiquidity_api(const std::string& api_name, const std::string& api_arg) {
 			if (get_storage_state() != common_state_of_contract)
 				throw_error("state not common!");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() != 4)
+			native_args args(api_arg, binary_args_enabled());
+			if (args.size() != 4)
 				throw_error("argument format error, need format: destory_token_amount,min_remove_asset1_amount,min_remove_asset2_amount,expired_blocknum");
 
-			std::string destory_token_amount_str = parsed_args[0];
-			std::string min_remove_asset1_amount_str = parsed_args[1];
-			std::string min_remove_asset2_amount_str = parsed_args[2];
-			std::string expired_blocknum_str = parsed_args[3];
+			const auto& expired_blocknum_str = args.string_at(3);
 
-			if (!is_integral(min_remove_asset1_amount_str) || !is_integral(min_remove_asset2_amount_str) || !is_integral(destory_token_amount_str) || !is_integral(expired_blocknum_str))
+			if (!args.is_int_at(1) || !args.is_int_at(2) || !args.is_int_at(0) || !args.is_int_at(3))
 				throw_error("argument format error, need format: destory_token_amount,min_remove_asset1_amount,min_remove_asset2_amount,expired_blocknum");
 
-			int64_t destory_token_amount = std::stoll(destory_token_amount_str);
-			int64_t min_remove_asset1_amount = std::stoll(min_remove_asset1_amount_str);
-			int64_t min_remove_asset2_amount = std::stoll(min_remove_asset2_amount_str);
-			int64_t expired_blocknum = std::stoll(expired_blocknum_str);
+			int64_t destory_token_amount = args.int_at(0);
+			int64_t min_remove_asset1_amount = args.int_at(1);
+			int64_t min_remove_asset2_amount = args.int_at(2);
+			int64_t expired_blocknum = args.int_at(3);
 
 			if (min_remove_asset1_amount < 0 || min_remove_asset2_amount < 0 || destory_token_amount <= 0 || expired_blocknum <= 0)
 				throw_error("argument format error, input args must be positive integers");
@@ -327,11 +337,8 @@ namespace uvm {
 
 			//check liquidity token 
 			auto from_address = get_from_address();
-			auto cbor_token_balance = current_fast_map_get("users", from_address);
 			int64_t token_balance = 0;
-			if (cbor_token_balance->is_integer()) {
-				token_balance = cbor_token_balance->force_as_int();
-			}
+			current_fast_map_get_int("users", from_address, token_balance);
 			if (destory_token_amount > token_balance) {
 				throw_error("you have not enough liquidity to remove");
 			}
@@ -355,13 +362,8 @@ namespace uvm {
 				caculate_asset2_amount = asset_2_pool_amount;
 			}
 			else {
-				const auto& a = safe_number_create(asset_1_pool_amount);
-				const auto& b = safe_number_create(asset_2_pool_amount);
-				const auto& s = safe_number_create(supply);
-				const auto& tk = safe_number_create(destory_token_amount);
-				const auto& quota = safe_number_div(tk, s);
-				caculate_asset1_amount = safe_number_to_int64(safe_number_multiply(quota, a));
-				caculate_asset2_amount = safe_number_to_int64(safe_number_multiply(quota, b));
+				caculate_asset1_amount = uniswap_math::pool_share(destory_token_amount, supply, asset_1_pool_amount);
+				caculate_asset2_amount = uniswap_math::pool_share(destory_token_amount, supply, asset_2_pool_amount);
 			}
 			
 			if (caculate_asset1_amount < min_remove_asset1_amount) {
@@ -400,12 +402,11 @@ namespace uvm {
 			set_current_contract_storage("asset_1_pool_amount", CborObject::from_int(asset_1_pool_amount));
 			set_current_contract_storage("asset_2_pool_amount", CborObject::from_int(asset_2_pool_amount));
 			set_current_contract_storage("supply", CborObject::from_int(supply));
-			current_fast_map_set("users", from_address, CborObject::from_int(token_balance - destory_token_amount));
+			current_fast_map_set_int("users", from_address, token_balance - destory_token_amount);
 
-			jsondiff::JsonObject event_arg;
-			event_arg[asset1] = caculate_asset1_amount;
-			event_arg[asset2] = caculate_asset2_amount;
-			emit_event("LiquidityRemoved", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add(asset1, caculate_asset1_amount).add(asset2, caculate_asset2_amount);
+			emit_event("LiquidityRemoved", event_arg.str());
 
 			emit_event("LiquidityTokenDestoryed", std::to_string(destory_token_amount));
 		}
@@ -437,19 +438,14 @@ namespace uvm {
 			}
 
 			if (param.empty()) { // deposit
-				auto balance_cbor = current_fast_map_get(from_address, symbol);
 				int64_t user_balance = 0;
-				if (balance_cbor->is_integer()) {
-					user_balance = balance_cbor->force_as_int();
-				}
+				current_fast_map_get_int(from_address, symbol, user_balance);
 				user_balance += amount;
-				current_fast_map_set(from_address, symbol, CborObject::from_int(user_balance));
+				current_fast_map_set_int(from_address, symbol, user_balance);
 				
-				jsondiff::JsonObject event_arg;
-				event_arg["from_address"] = from_address;
-				event_arg["symbol"] = symbol;
-				event_arg["amount"] = amount;
-				emit_event("Deposited", uvm::util::json_ordered_dumps(event_arg));
+				native_event_builder event_arg;
+				event_arg.add("from_address", from_address).add("symbol", symbol).add("amount", amount);
+				emit_event("Deposited", event_arg.str());
 			}
 			else { //exchange
 				std::vector<std::string> parsed_args;
@@ -495,20 +491,13 @@ namespace uvm {
 				}
 				
 				const auto& feeRate = get_string_current_contract_storage("fee_rate");
-				const auto& nFeeRate = safe_number_create(feeRate);
-				const auto& temp = safe_number_multiply(safe_number_create(amount), nFeeRate);
-				int64_t fee = safe_number_to_int64(temp);
-				if (safe_number_ne(safe_number_create(fee), temp))
-					fee++;
-				if (fee <= 0) {
-					fee = 1;
-				}
+				int64_t fee = uniswap_math::swap_fee(amount, safe_number_create(feeRate));
 				if (amount <= fee) {
 					throw_error("can't get any");
 					return;
 				}
 
-				jsondiff::JsonObject event_arg;
+				native_event_builder event_arg;
 				int64_t get_asset_amount = 0;
 				if (symbol == asset1) {
 					if (want_buy_asset_amount >= asset_2_pool_amount) {
@@ -524,7 +513,7 @@ namespace uvm {
 					asset_1_pool_amount += amount;
 					asset_2_pool_amount -= get_asset_amount;
 					
-					event_arg["buy_asset"] = asset2;
+					event_arg.add("buy_asset", asset2);
 				}
 				else {
 					if (want_buy_asset_amount >= asset_1_pool_amount) {
@@ -539,7 +528,7 @@ namespace uvm {
 					}
 					asset_2_pool_amount += amount;
 					asset_1_pool_amount -= get_asset_amount;
-					event_arg["buy_asset"] = asset1;
+					event_arg.add("buy_asset", asset1);
 					
 				}
 				if (asset_1_pool_amount <= 0 || asset_2_pool_amount <= 0) {
@@ -550,12 +539,12 @@ namespace uvm {
 
 				current_transfer_to_address(from_address, want_buy_asset_symbol, get_asset_amount);
 
-				event_arg["addr"] = from_address;
-				event_arg["fee"] = fee; // fee symbol ->sell_asset
-				event_arg["sell_asset"] = symbol;
-				event_arg["sell_amount"] = amount;
-				event_arg["buy_amount"] = get_asset_amount;
-				emit_event("Exchanged", uvm::util::json_ordered_dumps(event_arg));
+				event_arg.add("addr", from_address);
+				event_arg.add("fee", fee); // fee symbol ->sell_asset
+				event_arg.add("sell_asset", symbol);
+				event_arg.add("sell_amount", amount);
+				event_arg.add("buy_amount", get_asset_amount);
+				emit_event("Exchanged", event_arg.str());
 				set_api_result(std::to_string(get_asset_amount));
 			}
 		}
@@ -567,11 +556,8 @@ namespace uvm {
 			
 			const auto& addr = api_arg;
 
-			auto cbor_token_balance = current_fast_map_get("users", addr);
 			int64_t token_balance = 0;
-			if (cbor_token_balance->is_integer()) {
-				token_balance = cbor_token_balance->force_as_int();
-			}
+			current_fast_map_get_int("users", addr, token_balance);
 
 			jsondiff::JsonObject result;
 			const auto& asset1 = get_string_current_contract_storage("asset_1_symbol");
@@ -590,12 +576,8 @@ namespace uvm {
 					result[asset2] = asset_2_pool_amount;
 				}
 				else {
-					const auto& a = safe_number_create(asset_1_pool_amount);
-					const auto& b = safe_number_create(asset_2_pool_amount);
-					const auto& quota = safe_number_div(safe_number_create(token_balance), safe_number_create(supply));
-
-					result[asset1] = safe_number_to_int64(safe_number_multiply(quota, a));
-					result[asset2] = safe_number_to_int64(safe_number_multiply(quota, b));
+					result[asset1] = uniswap_math::pool_share(token_balance, supply, asset_1_pool_amount);
+					result[asset2] = uniswap_math::pool_share(token_balance, supply, asset_2_pool_amount);
 				}
 			}
 
@@ -605,14 +587,15 @@ namespace uvm {
 
 		//args:tokenAmount
 		void uniswap_native_contract::caculatePoolShareByToken_api(const std::string& api_name, const std::string& api_arg) {
-			if (get_storage_state() != common_state_of_contract)
+			const auto& pool = get_pool_snapshot();
+			if (pool.state != common_state_of_contract)
 				throw_error("state not common!");
 
-			const auto& asset1 = get_string_current_contract_storage("asset_1_symbol");
-			const auto& asset2 = get_string_current_contract_storage("asset_2_symbol");
-			int64_t asset_1_pool_amount = get_int_current_contract_storage("asset_1_pool_amount");
-			int64_t asset_2_pool_amount = get_int_current_contract_storage("asset_2_pool_amount");
-			int64_t supply = get_int_current_contract_storage("supply");
+			const auto& asset1 = pool.asset1;
+			const auto& asset2 = pool.asset2;
+			int64_t asset_1_pool_amount = pool.asset_1_pool_amount;
+			int64_t asset_2_pool_amount = pool.asset_2_pool_amount;
+			int64_t supply = pool.supply;
 
 			if (!is_integral(api_arg)) {
 				throw_error("input arg must be integer");
@@ -630,12 +613,8 @@ namespace uvm {
 				throw_error("input tokenAmount must <= supply");
 			}
 			else {
-				const auto& a = safe_number_create(asset_1_pool_amount);
-				const auto& b = safe_number_create(asset_2_pool_amount);
-				const auto& quota = safe_number_div(safe_number_create(tokenAmount), safe_number_create(supply));
-
-				result[asset1] = safe_number_to_int64(safe_number_multiply(quota, a));
-				result[asset2] = safe_number_to_int64(safe_number_multiply(quota, b));
+				result[asset1] = uniswap_math::pool_share(tokenAmount, supply, asset_1_pool_amount);
+				result[asset2] = uniswap_math::pool_share(tokenAmount, supply, asset_2_pool_amount);
 			}
 
 			const auto& r = uvm::util::json_ordered_dumps(result);
@@ -655,11 +634,8 @@ namespace uvm {
 			const auto& addr = parsed_args[0];
 			const auto& symbol = parsed_args[1];
 
-			auto balance = current_fast_map_get(addr, symbol);
 			int64_t bal = 0;
-			if (balance->is_integer()) {
-				bal = balance->force_as_int();
-			}
+			current_fast_map_get_int(addr, symbol, bal);
 			set_api_result(std::to_string(bal));
 		}
 
@@ -688,74 +664,59 @@ namespace uvm {
 			}
 			const auto& from_address = caller_address_string();
 
-			auto balance = current_fast_map_get(from_address, symbol);
 			int64_t bal = 0;
-			if (!balance->is_integer()) {
+			if (!current_fast_map_get_int(from_address, symbol, bal)) {
 				throw_error("no balance to withdraw");
 			}
-			else {
-				bal = balance->force_as_int();
-			}
 			if (amount > bal) {
 				throw_error("not enough balance to withdraw");
 			}
 			int64_t newBalance = bal - amount;
 			if (newBalance == 0) {
-				current_fast_map_set(from_address, parsed_args[1], CborObject::create_null());
+				current_fast_map_set_null(from_address, parsed_args[1]);
 			}
 			else {
-				current_fast_map_set(from_address, parsed_args[1], CborObject::from_int(newBalance));
+				current_fast_map_set_int(from_address, parsed_args[1], newBalance);
 			}
 
 			current_transfer_to_address(from_address, symbol, amount);
 			//{"amount":35000,"realAmount":34996,"fee":4,"symbol":"BTC","to_address":"test11"}
-			jsondiff::JsonObject event_arg;
-			event_arg["symbol"] = symbol;
-			event_arg["to_address"] = from_address;
-			event_arg["amount"] = amount;
-			emit_event("Withdrawed", uvm::util::json_ordered_dumps(event_arg));
+			native_event_builder event_arg;
+			event_arg.add("symbol", symbol).add("to_address", from_address).add("amount", amount);
+			emit_event("Withdrawed", event_arg.str());
 		}
 
 		//args: want_sell_asset_symbol,want_sell_asset_amount,want_buy_asset_symbol
 		//return : get_amount
 		void uniswap_native_contract::caculateExchangeAmount_api(const std::string& api_name, const std::string& api_arg) {
-			if (get_storage_state() != common_state_of_contract)
+			const auto& pool = get_pool_snapshot();
+			if (pool.state != common_state_of_contract)
 				throw_error("state not common!");
-			std::vector<std::string> parsed_args;
-			boost::split(parsed_args, api_arg, [](char c) {return c == ','; });
-			if (parsed_args.size() != 3)
+			native_args args(api_arg, binary_args_enabled());
+			if (args.size() != 3)
 				throw_error("argument format error, need format: want_sell_asset_symbol,want_sell_asset_amount,want_buy_asset_symbol");
 
-			std::string want_sell_asset_symbol = parsed_args[0];
-			std::string want_sell_asset_amount_str = parsed_args[1];
-			std::string want_buy_asset_symbol = parsed_args[2];
+			const auto& want_sell_asset_symbol = args.string_at(0);
+			const auto& want_buy_asset_symbol = args.string_at(2);
 
-			if (!is_integral(want_sell_asset_amount_str))
+			if (!args.is_int_at(1))
 				throw_error("argument format error, need format: want_sell_asset_symbol,want_sell_asset_amount");
 
-			int64_t want_sell_asset_amount = std::stoll(want_sell_asset_amount_str);
+			int64_t want_sell_asset_amount = args.int_at(1);
 			if (want_sell_asset_amount <= 0) {
 				throw_error("want_sell_asset_amount must > 0");
 			}
 			
-			const auto& asset1 = get_string_current_contract_storage("asset_1_symbol");
-			const auto& asset2 = get_string_current_contract_storage("asset_2_symbol");
-			int64_t asset_1_pool_amount = get_int_current_contract_storage("asset_1_pool_amount");
-			int64_t asset_2_pool_amount = get_int_current_contract_storage("asset_2_pool_amount");
+			const auto& asset1 = pool.asset1;
+			const auto& asset2 = pool.asset2;
+			int64_t asset_1_pool_amount = pool.asset_1_pool_amount;
+			int64_t asset_2_pool_amount = pool.asset_2_pool_amount;
 			if (asset_1_pool_amount <= 0 || asset_2_pool_amount <= 0) {
 				throw_error("pool is empty");
 			}
 
 			///
-			const auto& feeRate = get_string_current_contract_storage("fee_rate");
-			const auto& nFeeRate = safe_number_create(feeRate);
-			const auto& temp = safe_number_multiply(safe_number_create(want_sell_asset_amount), nFeeRate);
-			int64_t fee = safe_number_to_int64(temp);
-			if (safe_number_ne(safe_number_create(fee), temp))
-				fee++;
-			if (fee <= 0) {
-				fee = 1;
-			}
+			int64_t fee = uniswap_math::swap_fee(want_sell_asset_amount, pool.fee_rate);
 			if (want_sell_asset_amount <= fee) {
 				set_api_result(std::to_string(0));
 				return;
@@ -0,0 +1,143 @@
+#include <native_contract/native_uniswap_math.h>
+#include <boost/multiprecision/cpp_int.hpp>
+
+namespace uvm {
+	namespace contract {
+		namespace uniswap_math {
+			using boost::multiprecision::uint128_t;
+
+			static const uint64_t pow10[17] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+				100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+				100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL };
+			// SafeNumber stops generating decimals and drops digits when x exceeds 10^32
+			static const uint128_t largest_x = uint128_t(pow10[16]) * pow10[16];
+			static const uint128_t uint64_mask = uint128_t(UINT64_MAX);
+
+			// positive decimal x * 10^-e, same as a compressed SafeNumber whose e <= 16
+			struct decimal {
+				uint128_t x;
+				uint32_t e;
+			};
+
+			// same steps as compress_number when e <= 16
+			static decimal compress(uint128_t x, uint32_t e) {
+				while (x > largest_x && e > 0) {
+					x /= 10;
+					--e;
+				}
+				while (x != 0 && e > 0 && x % 10 == 0) {
+					x /= 10;
+					--e;
+				}
+				return decimal{ x, e };
+			}
+
+			// same as safe_number_div of two integers, d > 0
+			static decimal divide(const uint128_t& n, uint64_t d) {
+				if (n == 0)
+					return decimal{ 0, 0 };
+				uint128_t rx = 0;
+				uint128_t rest = n;
+				int32_t re = -1;
+				do {
+					rx = rx * 10 + rest / d;
+					rest = (rest % d) * 10;
+					++re;
+				} while (re < 16 && rx < largest_x && rest != 0);
+				return compress(rx, static_cast<uint32_t>(re));
+			}
+
+			// same as safe_number_multiply of a decimal and an integer when a.x < 2^64, so the product isn't shortened
+			static decimal multiply(const decimal& a, uint64_t m) {
+				if (a.x == 0 || m == 0)
+					return decimal{ 0, 0 };
+				return compress(a.x * m, a.e);
+			}
+
+			// safe_number_to_int64 keeps the low 63 bits of the integer part
+			static int64_t low_int64(const uint128_t& value) {
+				const auto low = static_cast<uint64_t>(value & uint64_mask);
+				return (static_cast<int64_t>(low) << 1) >> 1;
+			}
+
+			static int64_t to_int64(const decimal& value) {
+				if (value.x == 0)
+					return 0;
+				return low_int64(value.e > 0 ? value.x / pow10[value.e] : value.x);
+			}
+
+			// v = safe_number_to_int64(t); if (safe_number_ne(safe_number_create(v), t)) v++;
+			static int64_t round_up(const decimal& value) {
+				int64_t v = to_int64(value);
+				if (!(value.e == 0 && v >= 0 && uint128_t(static_cast<uint64_t>(v)) == value.x))
+					v++;
+				return v;
+			}
+
+			int64_t get_input_price(int64_t input_amount, int64_t input_reserve, int64_t output_reserve) {
+				if (input_amount < 0 || input_reserve < 0 || output_reserve < 0) {
+					const auto& a = safe_number_create(input_reserve);
+					const auto& b = safe_number_create(output_reserve);
+					const auto& x = safe_number_create(input_amount);
+					const auto& n = safe_number_multiply(x, b);
+					return safe_number_to_int64(safe_number_div(n, safe_number_add(a, x)));
+				}
+				if (input_amount == 0 || output_reserve == 0)
+					return 0;
+				const uint128_t n = uint128_t(static_cast<uint64_t>(input_amount)) * static_cast<uint64_t>(output_reserve);
+				return low_int64(n / (uint128_t(static_cast<uint64_t>(input_reserve)) + static_cast<uint64_t>(input_amount)));
+			}
+
+			int64_t mul_div_floor(int64_t x, int64_t y, int64_t z) {
+				if (x < 0 || y < 0 || z <= 0) {
+					const auto& temp = safe_number_div(safe_number_multiply(safe_number_create(x), safe_number_create(y)), safe_number_create(z));
+					return safe_number_to_int64(temp);
+				}
+				const uint128_t n = uint128_t(static_cast<uint64_t>(x)) * static_cast<uint64_t>(y);
+				if (n == 0)
+					return 0;
+				return low_int64(n / static_cast<uint64_t>(z));
+			}
+
+			int64_t mul_div_ceil(int64_t x, int64_t y, int64_t z) {
+				if (x < 0 || y < 0 || z <= 0) {
+					const auto& temp = safe_number_div(safe_number_multiply(safe_number_create(x), safe_number_create(y)), safe_number_create(z));
+					int64_t v = safe_number_to_int64(temp);
+					if (safe_number_ne(safe_number_create(v), temp))
+						v++;
+					return v;
+				}
+				const uint128_t n = uint128_t(static_cast<uint64_t>(x)) * static_cast<uint64_t>(y);
+				return round_up(divide(n, static_cast<uint64_t>(z)));
+			}
+
+			int64_t pool_share(int64_t token_amount, int64_t supply, int64_t pool_amount) {
+				if (token_amount >= 0 && supply > 0 && pool_amount >= 0) {
+					const auto& quota = divide(uint128_t(static_cast<uint64_t>(token_amount)), static_cast<uint64_t>(supply));
+					if (quota.x <= uint64_mask)
+						return to_int64(multiply(quota, static_cast<uint64_t>(pool_amount)));
+				}
+				const auto& quota = safe_number_div(safe_number_create(token_amount), safe_number_create(supply));
+				return safe_number_to_int64(safe_number_multiply(quota, safe_number_create(pool_amount)));
+			}
+
+			int64_t swap_fee(int64_t amount, const SafeNumber& fee_rate) {
+				int64_t fee = 0;
+				if (amount >= 0 && safe_number_is_valid(fee_rate) && fee_rate.sign && fee_rate.x.big == 0 && fee_rate.e <= 16) {
+					fee = round_up(multiply(decimal{ fee_rate.x.low, fee_rate.e }, static_cast<uint64_t>(amount)));
+				}
+				else {
+					const auto& temp = safe_number_multiply(safe_number_create(amount), fee_rate);
+					fee = safe_number_to_int64(temp);
+					if (safe_number_ne(safe_number_create(fee), temp))
+						fee++;
+				}
+				if (fee <= 0) {
+					fee = 1;
+				}
+				return fee;
+			}
+
+		}
+	}
+}
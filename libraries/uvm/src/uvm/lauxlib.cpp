@@ -46,6 +46,7 @@
 #include <fc/crypto/hex.hpp>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 /*
@@ -212,7 +213,7 @@ static int typeerror(lua_State *L, int arg, const char *tname) {
     else
         typearg = luaL_typename(L, arg);  /* standard name */
     msg = lua_pushfstring(L, "%s expected, got %s", tname, typearg);
-    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
+    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
     return luaL_argerror(L, arg, msg);
 }
 
@@ -671,7 +672,7 @@ static int errfile(lua_State *L, const char *what, int fnameindex) {
     const char *serr = strerror(errno);
     const char *filename = lua_tostring(L, fnameindex) + 1;
     lua_pushfstring(L, "cannot %s %s: %s", what, filename, serr);
-    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, luaL_checkstring(L, -1));
+    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, luaL_checkstring(L, -1));
     lua_remove(L, fnameindex);
     return LUA_ERRFILE;
 }
@@ -1020,7 +1021,7 @@ LUA_API int lua_docompiledfile(lua_State *L, const char *filename)
 	}
 	catch(const std::exception &e)
 	{
-      global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "error in load bytecode file, %s", e.what());
+      get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "error in load bytecode file, %s", e.what());
 		return LUA_ERRRUN;
 	}
 }
@@ -1060,7 +1061,7 @@ static bool findloader_for_import_stream(lua_State *L, const char *name) {
         else if (lua_isstring(L, -2)) {  /* searcher returned error message? */
             lua_pop(L, 1);  /* remove extra return */
             luaL_addvalue(&msg);  /* concatenate error message */
-            if (global_uvm_chain_api->has_exception(L))
+            if (get_uvm_chain_api(L)->has_exception(L))
             {
                 return false;
             }
@@ -1083,7 +1084,7 @@ int luaL_require_module(lua_State *L)
 {
     if (lua_gettop(L) < 1)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "require need 1 argument of contract name");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "require need 1 argument of contract name");
         return 0;
     }
     const char *name = luaL_checkstring(L, 1);
@@ -1277,7 +1278,7 @@ static bool lua_get_contract_apis_direct(lua_State *L, UvmModuleByteStream *stre
                 lua_pop(L, 1);
                 // store module info into uvm, limit not too many apis
                 if (strlen(key) > UVM_CONTRACT_API_NAME_MAX_LENGTH) {
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than 1024 characters\n");
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than 1024 characters\n");
                     return false;
                 }
 
@@ -1287,7 +1288,7 @@ static bool lua_get_contract_apis_direct(lua_State *L, UvmModuleByteStream *stre
 			{
 				auto api_str = (char*)lua_malloc(L, (item.length() + 1) * sizeof(char));
 				if (!api_str) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_MEMORY_ERROR, "uvm out of memory");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_MEMORY_ERROR, "uvm out of memory");
 					return false;
 				}
 				contract_apis[apis_count] = api_str;
@@ -1315,7 +1316,7 @@ static bool lua_get_contract_apis_direct(lua_State *L, UvmModuleByteStream *stre
         else {
 			const char *msg = "this uvm contract not return a table";
 			lua_set_compile_error(L, msg);
-            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
             return false;
         }
 
@@ -1326,7 +1327,7 @@ static bool lua_get_contract_apis_direct(lua_State *L, UvmModuleByteStream *stre
         lua_setfield(L, -2, "name");
 		char contract_id[CONTRACT_ID_MAX_LENGTH] = "\0";
 		size_t contract_id_size = 0;
-        global_uvm_chain_api->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(name.c_str()).c_str(), contract_id, &contract_id_size);
+        get_uvm_chain_api(L)->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(name.c_str()).c_str(), contract_id, &contract_id_size);
 		contract_id[CONTRACT_ID_MAX_LENGTH - 1] = '\0';
         // lua_pushstring(L, CURRENT_CONTRACT_NAME);
 		lua_pushstring(L, contract_id);
@@ -1339,7 +1340,7 @@ static bool lua_get_contract_apis_direct(lua_State *L, UvmModuleByteStream *stre
     {
 		const char *msg = "this uvm contract not return a table";
 		lua_set_compile_error(L, msg);
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
         return false;
     }
     if (lua_getfield(L, 2, filename) == LUA_TNIL) {   /* module set no value? */
@@ -1443,7 +1444,7 @@ static std::string get_contract_id_using_in_lua(lua_State *L, std::string namest
         char address[CONTRACT_ID_MAX_LENGTH];
         memset(address, 0x0, sizeof(char) * CONTRACT_ID_MAX_LENGTH);
         size_t address_len = 0;
-        global_uvm_chain_api->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(namestr.c_str()).c_str(), address, &address_len);
+        get_uvm_chain_api(L)->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(namestr.c_str()).c_str(), address, &address_len);
         address[CONTRACT_ID_MAX_LENGTH-1] = '\0';
         return address;
     }
@@ -1453,7 +1454,7 @@ static std::string get_contract_id_using_in_lua(lua_State *L, std::string namest
 		char address[CONTRACT_ID_MAX_LENGTH];
 		memset(address, 0x0, sizeof(char) * CONTRACT_ID_MAX_LENGTH);
 		size_t address_len = 0;
-        global_uvm_chain_api->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(name.c_str()).c_str(), address, &address_len);
+        get_uvm_chain_api(L)->get_contract_address_by_name(L, uvm::lua::lib::unwrap_any_contract_name(name.c_str()).c_str(), address, &address_len);
 		address[CONTRACT_ID_MAX_LENGTH - 1] = '\0';
 		return address;
         // return CURRENT_CONTRACT_NAME;
@@ -1467,7 +1468,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
 {
     if (lua_gettop(L) < 1)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "import_contract_from_address need 1 argument of contract name");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "import_contract_from_address need 1 argument of contract name");
         return 0;
     }
     const char *contract_id = luaL_checkstring(L, 1);
@@ -1496,10 +1497,10 @@ int luaL_import_contract_module_from_address(lua_State *L)
     // check whether the contract existed
     bool exists;
     std::string namestr(name);
-    exists = global_uvm_chain_api->check_contract_exist_by_address(L, contract_id);
+    exists = get_uvm_chain_api(L)->check_contract_exist_by_address(L, contract_id);
     if (!exists)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "this contract not found");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "this contract not found");
         return 0;
     }
     findloader_for_import_contract(L, name);
@@ -1555,7 +1556,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                 lua_pop(L, 1);
                 // store module info into uvm, limit not too many apis
                 if (strlen(key) > UVM_CONTRACT_API_NAME_MAX_LENGTH) {
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than %d characters", UVM_CONTRACT_API_NAME_MAX_LENGTH);
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than %d characters", UVM_CONTRACT_API_NAME_MAX_LENGTH);
                     uvm::lua::lib::notify_lua_state_stop(L);
                     return 0;
                 }
@@ -1563,7 +1564,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                     continue;
 				auto api_str = (char*)lua_malloc(L, (strlen(key) + 1) * sizeof(char));
 				if (!api_str) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_MEMORY_ERROR, "vm out of memory");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_MEMORY_ERROR, "vm out of memory");
 					uvm::lua::lib::notify_lua_state_stop(L);
 					return 0;
 				}
@@ -1581,11 +1582,11 @@ int luaL_import_contract_module_from_address(lua_State *L)
             }
             // if the contract info stored in uvm before, fetch and check whether the apis are the same. if not the same, error
             auto clear_stored_contract_info = [&]() {
-                // global_uvm_chain_api->free_contract_info(L, unwrap_name.c_str(), stored_contract_apis, &stored_contract_apis_count);
+                // get_uvm_chain_api(L)->free_contract_info(L, unwrap_name.c_str(), stored_contract_apis, &stored_contract_apis_count);
             };
             std::string address = contract_id;
 			auto stored_contract_info = std::make_shared<UvmContractInfo>();
-            if (global_uvm_chain_api->get_stored_contract_info_by_address(L, address.c_str(), stored_contract_info))
+            if (get_uvm_chain_api(L)->get_stored_contract_info_by_address(L, address.c_str(), stored_contract_info))
             {
                 struct exit_scope_of_stored_contract_info
                 {
@@ -1603,7 +1604,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                     snprintf(error_msg, LUA_COMPILE_ERROR_MAX_LENGTH - 1, "this contract byte stream not matched with the info stored in uvm api, need %d apis but only found %d", stored_contract_info->contract_apis.size(), apis_count);
                     if (strlen(L->compile_error) < 1)
                         memcpy(L->compile_error, error_msg, LUA_COMPILE_ERROR_MAX_LENGTH);
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
                     uvm::lua::lib::notify_lua_state_stop(L);
                     return 0;
                 }
@@ -1620,7 +1621,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                             snprintf(error_msg, LUA_COMPILE_ERROR_MAX_LENGTH - 1, "empty contract api name");
                             if (strlen(L->compile_error) < 1)
                                 memcpy(L->compile_error, error_msg, LUA_COMPILE_ERROR_MAX_LENGTH);
-                            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
+                            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
                             return 0;
                         }
                         if (strcmp(a, b) == 0)
@@ -1635,7 +1636,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                         snprintf(error_msg, LUA_COMPILE_ERROR_MAX_LENGTH - 1, "the contract api not match info stored in uvm");
                         if (strlen(L->compile_error) < 1)
                             memcpy(L->compile_error, error_msg, LUA_COMPILE_ERROR_MAX_LENGTH);
-                        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
+                        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
                         uvm::lua::lib::notify_lua_state_stop(L);
                         return 0;
                     }
@@ -1653,7 +1654,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
                     snprintf(error_msg, LUA_COMPILE_ERROR_MAX_LENGTH - 1, "contract can't use global variables");
                     if (strlen(L->compile_error) < 1)
                     memcpy(L->compile_error, error_msg, LUA_COMPILE_ERROR_MAX_LENGTH);
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error_msg);
                     */
                     lcompile_error_set(L, error_msg, "contract can't use global variables");
                     uvm::lua::lib::notify_lua_state_stop(L);
@@ -1723,7 +1724,7 @@ int luaL_import_contract_module_from_address(lua_State *L)
     }
     else
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
         return 0;
     }
     /*
@@ -1745,7 +1746,7 @@ int luaL_import_contract_module(lua_State *L)
 {
     if (lua_gettop(L) < 1 || !lua_isstring(L, 1))
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "import_contract need 1 string argument of contract name");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "import_contract need 1 string argument of contract name");
         return 0;
     }
     const char *origin_contract_name = luaL_checkstring(L, -1);
@@ -1780,7 +1781,7 @@ int luaL_import_contract_module(lua_State *L)
     if (is_pointer)
     {
         std::string address = unwrap_get_contract_address(namestr);
-        exists = global_uvm_chain_api->check_contract_exist_by_address(L, address.c_str());
+        exists = get_uvm_chain_api(L)->check_contract_exist_by_address(L, address.c_str());
     }
     else if (is_stream)
     {
@@ -1789,11 +1790,11 @@ int luaL_import_contract_module(lua_State *L)
     }
     else
     {
-        exists = global_uvm_chain_api->check_contract_exist(L, origin_contract_name);
+        exists = get_uvm_chain_api(L)->check_contract_exist(L, origin_contract_name);
     }
     if (!exists)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract %s not found", namestr.c_str());
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract %s not found", namestr.c_str());
         return 0;
     }
     if (!is_stream)
@@ -1857,7 +1858,7 @@ int luaL_import_contract_module(lua_State *L)
                 lua_pop(L, 1);
                 // store module info into uvm, limit not too many apis
                 if (strlen(key) > UVM_CONTRACT_API_NAME_MAX_LENGTH) {
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than 1024 characters\n");
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract module api name must be less than 1024 characters\n");
                     uvm::lua::lib::notify_lua_state_stop(L);
                     return 0;
                 }
@@ -1879,16 +1880,16 @@ int luaL_import_contract_module(lua_State *L)
             {
                 char address_chars[50];
                 size_t address_len = 0;
-                global_uvm_chain_api->get_contract_address_by_name(L, unwrap_name.c_str(), address_chars, &address_len);
+                get_uvm_chain_api(L)->get_contract_address_by_name(L, unwrap_name.c_str(), address_chars, &address_len);
                 if (address_len > 0)
                     address = std::string(address_chars);
             }
-            if (global_uvm_chain_api->get_stored_contract_info_by_address(L, address.c_str(), stored_contract_info))
+            if (get_uvm_chain_api(L)->get_stored_contract_info_by_address(L, address.c_str(), stored_contract_info))
             {
                 // found this contract stored in the uvm api before
                 if (stored_contract_info->contract_apis.size() != apis_count)
                 {
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "this contract byte stream not matched with the info stored in uvm api");
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "this contract byte stream not matched with the info stored in uvm api");
                     uvm::lua::lib::notify_lua_state_stop(L);
                     return 0;
                 }
@@ -1901,7 +1902,7 @@ int luaL_import_contract_module(lua_State *L)
                         char *b = contract_apis[j];
                         if (nullptr == a || nullptr == b)
                         {
-                            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "empty contract api name");
+                            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "empty contract api name");
                             return 0;
                         }
                         if (strcmp(a, b) == 0)
@@ -1912,7 +1913,7 @@ int luaL_import_contract_module(lua_State *L)
                     }
                     if (!matched)
                     {
-                        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "the contract api not match info stored in uvm");
+                        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "the contract api not match info stored in uvm");
                         uvm::lua::lib::notify_lua_state_stop(L);
                         return 0;
                     }
@@ -1925,7 +1926,7 @@ int luaL_import_contract_module(lua_State *L)
                 if (global_size_before != global_size_after || !uvm::util::compare_string_list(global_vars_before, global_vars_after))
                 {
                     // check all global variables not changed, don't call code eg. ```_G['abc'] = nil; abc = 1;```
-                    global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can't use global variables");
+                    get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can't use global variables");
                     uvm::lua::lib::notify_lua_state_stop(L);
                     return 0;
                 }
@@ -1933,13 +1934,13 @@ int luaL_import_contract_module(lua_State *L)
             }
             else
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract info not stored before");
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract info not stored before");
                 uvm::lua::lib::notify_lua_state_stop(L);
                 return 0;
             }
         }
         else {
-            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
             return 0;
         }
 
@@ -1988,7 +1989,7 @@ int luaL_import_contract_module(lua_State *L)
     }
     else
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "this uvm contract not return a table");
         return 0;
     }
     /*
@@ -2036,9 +2037,9 @@ static int lua_real_execute_contract_api(lua_State *L
     // FIXME
     if (!(uvm::util::starts_with(contract_name, STREAM_CONTRACT_PREFIX)
         || uvm::util::starts_with(contract_name, ADDRESS_CONTRACT_PREFIX))
-        && !global_uvm_chain_api->check_contract_exist(L, contract_name))
+        && !get_uvm_chain_api(L)->check_contract_exist(L, contract_name))
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find this contract");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find this contract");
         lua_pushinteger(L, LUA_ERRRUN);
         return 0;
     }
@@ -2048,7 +2049,7 @@ static int lua_real_execute_contract_api(lua_State *L
     std::string wrapper_contract_name_str = uvm::lua::lib::wrap_contract_name(contract_name);
     std::string unwrapper_name = uvm::lua::lib::unwrap_any_contract_name(contract_name);
     if (!is_address)
-        global_uvm_chain_api->get_contract_address_by_name(L, unwrapper_name.c_str(), address, &address_size);
+        get_uvm_chain_api(L)->get_contract_address_by_name(L, unwrapper_name.c_str(), address, &address_size);
     else
     {
         strncpy(address, unwrapper_name.c_str(), CONTRACT_ID_MAX_LENGTH);
@@ -2079,7 +2080,7 @@ static int lua_real_execute_contract_api(lua_State *L
 
     if (!lua_toboolean(L, -1))  /* is it there? */
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "need load contract before execute contract api");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "need load contract before execute contract api");
         lua_pushinteger(L, LUA_ERRRUN);
         return 0;
     }
@@ -2135,16 +2136,16 @@ static int lua_real_execute_contract_api(lua_State *L
 		//else
 		{ //push args ; check args  
 			auto stored_contract_info = std::make_shared<UvmContractInfo>();
-			if (!global_uvm_chain_api->get_stored_contract_info_by_address(L, address, stored_contract_info))
+			if (!get_uvm_chain_api(L)->get_stored_contract_info_by_address(L, address, stored_contract_info))
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", address);
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", address);
 				return 0;
 			}
 			std::vector<UvmTypeInfoEnum> arg_types;
 			bool check_arg_type = false;  //old gpc vesion, no arg_types info
 			if (stored_contract_info->contract_api_arg_types.size() > 0) {
 				if (stored_contract_info->contract_api_arg_types.find(api_name_str) == stored_contract_info->contract_api_arg_types.end()) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name_str.c_str());
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name_str.c_str());
 					return 0;
 				}
 				check_arg_type = true; //new gpc version has arg_types, support muti args, try check
@@ -2154,13 +2155,13 @@ static int lua_real_execute_contract_api(lua_State *L
 			int input_args_num = args.size();
 			if (check_arg_type) { //new version
 				if (arg_types.size() != input_args_num) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "args num not match %d error", arg_types.size());
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "args num not match %d error", arg_types.size());
 					return 0;
 				}
 			}
 			else {  //old gpc version,  conctract api accept only one arg
 				if (input_args_num != 1 && api_name_str!="init") {
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "old vesion gpc only accept 1 arg , but input %d args", input_args_num);
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "old vesion gpc only accept 1 arg , but input %d args", input_args_num);
 					return 0;
 				}
 			}
@@ -2169,7 +2170,7 @@ static int lua_real_execute_contract_api(lua_State *L
 				luaL_push_cbor_as_json(L, arg);
 				if (check_arg_type) {
 					if (!isArgTypeMatched(arg_types[i],lua_type(L,-1))) {
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "arg type not match ,api:%s args", api_name_str.c_str());
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "arg type not match ,api:%s args", api_name_str.c_str());
 						return 0;
 					}
 				}
@@ -2181,7 +2182,7 @@ static int lua_real_execute_contract_api(lua_State *L
 		int status = lua_pcall(L, (1 + args.size()), 1, 0);  //contract_table, arg1, arg2, ...
 		if (status != LUA_OK)
 		{
-			global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "execute api %s contract error", api_name_str.c_str());
+			get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "execute api %s contract error", api_name_str.c_str());
 			return 0;
 		}
 		if (status == LUA_OK && (L->state & (lua_VMState::LVM_STATE_BREAK | lua_VMState::LVM_STATE_SUSPEND))) {
@@ -2192,7 +2193,7 @@ static int lua_real_execute_contract_api(lua_State *L
         lua_pop(L, 1); // pop self
     } else
     {
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find api %s in this contract", api_name_str.c_str());
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find api %s in this contract", api_name_str.c_str());
 		lua_pop(L, 1);
 		return 0;
     }
@@ -2211,7 +2212,7 @@ LUA_API int lua_execute_contract_api(lua_State *L, const char *contract_name,
 		    return LUA_ERRRUN;
 		memset(contract_address, 0x0, CONTRACT_ID_MAX_LENGTH + 1);
 		size_t address_size = 0;
-		global_uvm_chain_api->get_contract_address_by_name(L, contract_name, contract_address, &address_size);
+		get_uvm_chain_api(L)->get_contract_address_by_name(L, contract_name, contract_address, &address_size);
 		if (address_size > 0)
 		{
 			UvmStateValue value;
@@ -2243,7 +2244,7 @@ LUA_API int lua_execute_contract_api(lua_State *L, const char *contract_name,
 		return result > 0 ? LUA_OK : LUA_ERRRUN;
 	}
 	catch (const std::exception& e) {
-		uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_LVM_ERROR, e.what());
+		uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_ERROR, e.what());
 		return LUA_ERRRUN;
 	}
 }
@@ -2270,7 +2271,7 @@ std::shared_ptr<UvmModuleByteStream> lua_common_open_contract(lua_State *L, cons
     {
         const std::string& pointer_str = namestr.substr(strlen(ADDRESS_CONTRACT_PREFIX), namestr.length() - strlen(ADDRESS_CONTRACT_PREFIX));
 		const std::string& address = pointer_str;
-        auto stream = global_uvm_chain_api->open_contract_by_address(L, address.c_str());
+        auto stream = get_uvm_chain_api(L)->open_contract_by_address(L, address.c_str());
         if (stream && stream->contract_level != CONTRACT_LEVEL_FOREVER && (stream->contract_name.length() < 1 || stream->contract_state == CONTRACT_STATE_DELETED))
         {
             auto start_contract_address = uvm::lua::lib::get_starting_contract_address(L);
@@ -2299,7 +2300,7 @@ std::shared_ptr<UvmModuleByteStream> lua_common_open_contract(lua_State *L, cons
     }
     else
     {
-        return global_uvm_chain_api->open_contract(L, name);
+        return get_uvm_chain_api(L)->open_contract(L, name);
     }
 }
 
@@ -2514,7 +2515,7 @@ UvmTableMapP luaL_create_lua_table_map_in_memory_pool(lua_State *L)
     auto p = new UvmTableMap();
     if (nullptr == p)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "out of memory");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "out of memory");
         uvm::lua::lib::notify_lua_state_stop(L);
         return nullptr;
     }
@@ -2615,7 +2616,7 @@ struct UvmStorageValue lua_type_to_storage_value_type_with_nested(lua_State *L,
     case LUA_TUSERDATA:
 	{
 		auto addr = lua_touserdata(L, index);
-		if (global_uvm_chain_api->is_object_in_pool(L, (intptr_t)addr, UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE))
+		if (get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)addr, UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE))
 		{
 			storage_value.type = uvm::blockchain::StorageValueTypes::storage_value_stream;
 			storage_value.value.userdata_value = addr;
@@ -23,6 +23,7 @@
 #include "uvm/uvm_lib.h"
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 static int luaB_print(lua_State *L) {
@@ -197,20 +198,20 @@ static int luaB_error(lua_State *L) {
         lua_pushvalue(L, 1);
         lua_concat(L, 2);
     }
-	global_uvm_chain_api->throw_exception(L, UVM_API_THROW_ERROR, luaL_checkstring(L, 1));
+	get_uvm_chain_api(L)->throw_exception(L, UVM_API_THROW_ERROR, luaL_checkstring(L, 1));
     return lua_error(L);
 }
 
 static int luaB_exit(lua_State *L) {
 	if (lua_gettop(L) < 1 || !lua_isstring(L, -1))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_THROW_ERROR, "empty error");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_THROW_ERROR, "empty error");
 		// uvm::lua::lib::notify_lua_state_stop(L);
 		return 0;
 	}
 	const char *msg = luaL_checkstring(L, -1);
 	lua_set_run_error(L, msg);
-	global_uvm_chain_api->throw_exception(L, UVM_API_THROW_ERROR, msg);
+	get_uvm_chain_api(L)->throw_exception(L, UVM_API_THROW_ERROR, msg);
 	L->force_stopping = true;
 	// uvm::lua::lib::notify_lua_state_stop(L);
 	return 0;
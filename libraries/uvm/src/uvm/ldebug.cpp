@@ -31,6 +31,7 @@
 #include <uvm/uvm_api.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 
@@ -92,7 +93,7 @@ LUA_API void lua_set_run_error(lua_State *L, const char *msg)
 			size = LUA_VM_EXCEPTION_STRNG_MAX_LENGTH - 1;
 		strncpy(L->runerror, msg, LUA_VM_EXCEPTION_STRNG_MAX_LENGTH);
 		L->runerror[size] = '\0';
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
 	}
 }
 
@@ -671,7 +672,7 @@ void luaG_runerror(lua_State *L, const char *fmt, ...) {
     va_end(argp);
     if (isLua(ci))  /* if Lua function, add source:line information */
         luaG_addinfo(L, msg, ci_func(ci)->p->source, currentline(ci));
-	global_uvm_chain_api->throw_exception(L, UVM_API_LVM_ERROR, msg);
+	get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_ERROR, msg);
     luaG_errormsg(L, msg);
 }
 
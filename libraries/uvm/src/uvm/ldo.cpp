@@ -35,6 +35,7 @@
 #include "uvm/uvm_lib.h"
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 #define errorstatus(s)	((s) > LUA_YIELD)
@@ -146,7 +147,7 @@ void luaD_throw(lua_State *L, int errcode) {
 			errmsg = "not found global function";
 		}
 		// abort();
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, errmsg.c_str());
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, errmsg.c_str());
 		uvm::lua::lib::notify_lua_state_stop(L);
 		L->force_stopping = true;
     }
@@ -335,7 +336,7 @@ static void tryfuncTM(lua_State *L, StkId func) {
     StkId p;
     if (!ttisfunction(tm))
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_LVM_ERROR, "Can't find __call method");
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_ERROR, "Can't find __call method");
         luaG_typeerror(L, func, "call");
     }
     if (L->force_stopping)
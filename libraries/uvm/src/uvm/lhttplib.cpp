@@ -29,6 +29,7 @@
 #include <boost/bind/bind.hpp>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 #undef LUA_HTTP_SERVERNAME
 #define LUA_HTTP_SERVERNAME "uvm_http_server";
@@ -164,7 +165,7 @@ static int lualib_http_request(lua_State *L)
 	auto headers_table_value = lua_type_to_storage_value_type(L, 4);
 	if(headers_table_value.type != UvmStorageValueType::LVALUE_TABLE)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "headers must be table");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "headers must be table");
 		return 0;
 	}
 	*/
@@ -337,7 +338,7 @@ static int lualib_http_on_request_data(lua_State *L)
 	// TODO
 	if (lua_gettop(L) < 2 || !lua_isuserdata(L, 1) && !lua_islightuserdata(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "http.on_request_data need arguments (socket: TcpSocket, handler: Function)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "http.on_request_data need arguments (socket: TcpSocket, handler: Function)");
 		return 0;
 	}
 	auto *socket = (TcpSocket*) lua_touserdata(L, 1);
@@ -447,7 +448,7 @@ static int lualib_http_accept_async(lua_State *L)
 {
 	if (lua_gettop(L) < 2 || !lua_islightuserdata(L, 1) || !lua_isfunction(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 			"http.accept_async need arguments (server: HttpServer, handler: Function)");
 		return 0;
 	}
@@ -461,7 +462,7 @@ static int lualib_http_start_io_loop(lua_State *L)
 {
 	if (lua_gettop(L) < 1 || !lua_islightuserdata(L, 1))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 			"http.start_io_loop need arguments (server: HttpServer)");
 		return 0;
 	}
@@ -20,6 +20,7 @@
 #include <uvm/uvm_lutil.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 using namespace uvm::parser;
 
@@ -110,7 +111,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             }
             else
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown symbol name %s)", token_str.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown symbol name %s)", token_str.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -132,7 +133,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             return value;
         } break;
         default:
-            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
             if (nullptr != result)
                 *result = false;
             return nil_storage_value();
@@ -146,7 +147,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
     {
         if (token_parser->eof())
         {
-            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
             if (nullptr != result)
                 *result = false;
             return nil_storage_value();
@@ -170,7 +171,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
         {
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -179,7 +180,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             token_parser->next();
             if (token.type != TOKEN_RESERVED::LTK_STRING)
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -187,7 +188,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             auto prop_key = token.token;
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -196,14 +197,14 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             token_parser->next();
             if (token.type != ':')
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
             }
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -220,7 +221,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             (*table_value.value.table_value)[prop_key] = sub_value;
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -238,7 +239,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             }
             else
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -252,7 +253,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
     {
         if (token_parser->eof())
         {
-            global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
             if (nullptr != result)
                 *result = false;
             return nil_storage_value();
@@ -277,7 +278,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
         {
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -295,7 +296,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             (*table_value.value.table_value)[prop_key] = sub_value;
             if (token_parser->eof())
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -313,7 +314,7 @@ static UvmStorageValue tokens_to_lua_value(lua_State *L, UvmTokenParser *token_p
             }
             else
             {
-                global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
+                get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(unknown token %s)", token.token.c_str());
                 if (nullptr != result)
                     *result = false;
                 return nil_storage_value();
@@ -346,8 +347,8 @@ static int json_to_lua(lua_State *L)
 	size_t little_large_size = 10000;
 	size_t very_large_size = 100000;
 	if (json_str_size > little_large_size) {
-		auto json_gas_punishment_fork_height = global_uvm_chain_api->get_fork_height(L, "JSON_GAS_PUNISHMENT");
-		if (json_gas_punishment_fork_height >= 0 && global_uvm_chain_api->get_header_block_num(L) >= json_gas_punishment_fork_height) {
+		auto json_gas_punishment_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "JSON_GAS_PUNISHMENT");
+		if (json_gas_punishment_fork_height >= 0 && get_uvm_chain_api(L)->get_header_block_num(L) >= json_gas_punishment_fork_height) {
 			auto common_extra_gas = 10 * json_str_size;
 			if (json_str_size > little_large_size) {
 				uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_extra_gas - 1);
@@ -380,8 +381,8 @@ static int lua_to_json(lua_State *L)
 	size_t little_large_size = 10000;
 	size_t very_large_size = 100000;
 	if (json_str_size > little_large_size) {
-		auto json_gas_punishment_fork_height = global_uvm_chain_api->get_fork_height(L, "JSON_GAS_PUNISHMENT");
-		if (json_gas_punishment_fork_height >= 0 && global_uvm_chain_api->get_header_block_num(L) >= json_gas_punishment_fork_height) {
+		auto json_gas_punishment_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "JSON_GAS_PUNISHMENT");
+		if (json_gas_punishment_fork_height >= 0 && get_uvm_chain_api(L)->get_header_block_num(L) >= json_gas_punishment_fork_height) {
 			auto common_extra_gas = 10 * json_str_size;
 			if (json_str_size > little_large_size) {
 				uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_extra_gas - 1);
@@ -22,6 +22,7 @@
 #include <uvm/json_reader.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 using namespace uvm::parser;
 
@@ -45,8 +46,8 @@ static int json_to_lua(lua_State *L)
 	size_t little_large_size = 10000;
 	size_t very_large_size = 100000;
 	if (json_str_size > little_large_size) {
-		auto json_gas_punishment_fork_height = global_uvm_chain_api->get_fork_height(L, "JSON_GAS_PUNISHMENT");
-		if (json_gas_punishment_fork_height >= 0 && global_uvm_chain_api->get_header_block_num(L) >= json_gas_punishment_fork_height) {
+		auto json_gas_punishment_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "JSON_GAS_PUNISHMENT");
+		if (json_gas_punishment_fork_height >= 0 && get_uvm_chain_api(L)->get_header_block_num(L) >= json_gas_punishment_fork_height) {
 			auto common_extra_gas = 10 * json_str_size;
 			if (json_str_size > little_large_size) {
 				uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_extra_gas - 1);
@@ -63,7 +64,7 @@ static int json_to_lua(lua_State *L)
 		return 1;
 	}
 	else {
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(%s)", json_parser->error.message_.c_str());
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "parse json error(%s)", json_parser->error.message_.c_str());
 		return 0;
 	}
 
@@ -78,8 +79,8 @@ static int lua_to_json(lua_State *L)
 	size_t little_large_size = 10000;
 	size_t very_large_size = 100000;
 	if (json_str_size > little_large_size) {
-		auto json_gas_punishment_fork_height = global_uvm_chain_api->get_fork_height(L, "JSON_GAS_PUNISHMENT");
-		if (json_gas_punishment_fork_height >= 0 && global_uvm_chain_api->get_header_block_num(L) >= json_gas_punishment_fork_height) {
+		auto json_gas_punishment_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "JSON_GAS_PUNISHMENT");
+		if (json_gas_punishment_fork_height >= 0 && get_uvm_chain_api(L)->get_header_block_num(L) >= json_gas_punishment_fork_height) {
 			auto common_extra_gas = 10 * json_str_size;
 			if (json_str_size > little_large_size) {
 				uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_extra_gas - 1);
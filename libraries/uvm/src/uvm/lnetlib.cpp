@@ -21,6 +21,7 @@
 #include <uvm/lnetlib.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 namespace uvm
@@ -113,7 +114,7 @@ int lualib_net_listen(lua_State *L)
 {
 	if(lua_gettop(L)<2 || !lua_isstring(L, 1) || !lua_isnumber(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.listen need arguments (host: string, port: integer)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.listen need arguments (host: string, port: integer)");
 		return 0;
 	}
 	auto host = luaL_checkstring(L, 1);
@@ -158,7 +159,7 @@ int lualib_net_connect(lua_State *L)
 {
 	if (lua_gettop(L)<2 || !lua_isstring(L, 1) || !lua_isnumber(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.connect need arguments (host: string, port: integer)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.connect need arguments (host: string, port: integer)");
 		return 0;
 	}
 	auto host = luaL_checkstring(L, 1);
@@ -170,7 +171,7 @@ int lualib_net_accept(lua_State *L)
 {
 	if(lua_gettop(L) < 1 || !lua_islightuserdata(L, 1))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.accept need arguments (server: TcpSocketServer)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.accept need arguments (server: TcpSocketServer)");
 		return 0;
 	}
 	NetServerInfo *server = (NetServerInfo*) lua_touserdata(L, 1);
@@ -225,7 +226,7 @@ int lualib_net_accept_async(lua_State *L)
 {
 	if (lua_gettop(L) < 2 || !lua_islightuserdata(L, 1) || !lua_isfunction(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 			"net.accept_async need arguments (server: TcpSocketServer, handler: Function)");
 		return 0;
 	}
@@ -239,7 +240,7 @@ int lualib_net_start_io_loop(lua_State *L)
 {
 	if (lua_gettop(L) < 1 || !lua_islightuserdata(L, 1))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 			"net.start_io_loop need arguments (server: TcpSocketServer)");
 		return 0;
 	}
@@ -281,7 +282,7 @@ int lualib_net_write(lua_State *L)
 {
 	if (lua_gettop(L)<2)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.write need arguments (socket: TcpSocket, data: string)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.write need arguments (socket: TcpSocket, data: string)");
 		return 0;
 	}
 	TcpSocket *socket = (TcpSocket*)lua_touserdata(L, 1);
@@ -309,7 +310,7 @@ int lualib_net_read(lua_State *L)
 {
 	if (lua_gettop(L)<2)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read need arguments (socket: TcpSocket, count: integer)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read need arguments (socket: TcpSocket, count: integer)");
 		return 0;
 	}
 	TcpSocket *socket = (TcpSocket*)lua_touserdata(L, 1);
@@ -329,7 +330,7 @@ int lualib_net_read_until_impl(lua_State *L, TcpSocket *socket, std::vector<char
 {
 	if (end.size() < 1)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read_until second argument can't be empty string");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read_until second argument can't be empty string");
 		return 0;
 	}
 	boost::system::error_code ignored_error;
@@ -374,7 +375,7 @@ int lualib_net_read_until(lua_State *L)
 {
 	if (lua_gettop(L) < 2 || !lua_isstring(L, 2))
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read_until need arguments (socket: TcpSocket, end: string)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.read_until need arguments (socket: TcpSocket, end: string)");
 		return 0;
 	}
 	TCP::socket *socket = (TCP::socket*)lua_touserdata(L, 1);
@@ -386,7 +387,7 @@ int lualib_net_close_server(lua_State *L)
 {
 	if (lua_gettop(L)<1)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.close_server need arguments (server: TcpSocketServer)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.close_server need arguments (server: TcpSocketServer)");
 		return 0;
 	}
 	NetServerInfo *server = (NetServerInfo*)lua_touserdata(L, 1);
@@ -405,7 +406,7 @@ int lualib_net_close_socket(lua_State *L)
 {
 	if(lua_gettop(L)<1)
 	{
-		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.close_socket need arguments (socket: TcpSocket)");
+		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "net.close_socket need arguments (socket: TcpSocket)");
 		return 0;
 	}
 	TcpSocket *socket = (TcpSocket*)lua_touserdata(L, 1);
@@ -25,8 +25,10 @@
 #include <uvm/uvm_api.h>
 #include <uvm/uvm_lib.h>
 #include <uvm/uvm_lutil.h>
+#include <uvm/uvm_code_cache.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 /*
@@ -450,7 +452,7 @@ static int searcher_uvm(lua_State *L) {
     }
     if (!stream)
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "load contract %s error", origin_contract_name);
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "load contract %s error", origin_contract_name);
         return 1;
     }
     struct StreamScope {
@@ -467,19 +469,31 @@ static int searcher_uvm(lua_State *L) {
             }
         }
     } stream_scope(L, name, stream.get());
+    // the bytecode is undumped even when it passed the check before: the gc heap a contract call
+    // uses counts against its limit, and must not depend on what this process ran earlier.
+    // only the check, which allocates nothing in the lua_State, is skipped
     uvm_types::GcLClosure *closure = uvm::lua::lib::luaU_undump_from_stream(L, stream.get(), uvm::lua::lib::unwrap_any_contract_name(origin_contract_name).c_str());
-	if (!closure)
-	{
-		return 1;
-	}
-    if (!uvm::lua::lib::check_contract_proto(L, closure->p, error))
+    if (!closure)
     {
-        if (strlen(L->compile_error) < 1)
+        return 1;
+    }
+    fc::sha256 code_digest;
+    if (stream->is_bytes)
+        code_digest = uvm::lua::lib::contract_code_digest(stream.get());
+    if (!stream->is_bytes || !uvm::lua::lib::is_verified_contract_code(L, code_digest))
+    {
+        uvm::lua::lib::UvmVerifiedContractCode verified;
+        if (!uvm::lua::lib::check_contract_proto(L, closure->p, error, nullptr, &verified))
         {
-            memcpy(L->compile_error, error, sizeof(char)*(strlen(error) + 1));
+            if (strlen(L->compile_error) < 1)
+            {
+                memcpy(L->compile_error, error, sizeof(char)*(strlen(error) + 1));
+            }
+            get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, error ? error : "contract bytecode stream error");
+            return 1;
         }
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, error ? error : "contract bytecode stream error");
-        return 1;
+        if (stream->is_bytes)
+            uvm::lua::lib::add_verified_contract_code(code_digest, std::move(verified));
     }
 
     return checkload(L, (luaL_loadbufferx(L, stream->buff.data(), stream->buff.size(), stream->is_bytes ? "binary" : "text", nullptr) == LUA_OK), name);
@@ -11,7 +11,6 @@
 #include <uvm/lauxlib.h>
 #include <uvm/lualib.h>
 #include <uvm/lobject.h>
-#include <boost/algorithm/hex.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <uvm/uvm_lutil.h>
 #include <safenumber/safenumber.h>
@@ -27,9 +26,74 @@ typedef boost::multiprecision::int512_t sm_bigint;
 //typedef boost::multiprecision::mpf_float sm_bigdecimal;
 
 
-static void push_bigint(lua_State *L, sm_bigint value) {
-	auto hex_str = uvm::util::hex(value.str());
-	lua_newtable(L);
+static const sm_bigint int512_max("13407807929942597099574024998205846127479365820592393377723561443721764030073546976801874298166903427690031858186486050853753882811946569946433649006084095");
+static const sm_bigint int512_min("-6703903964971298549787012499102923063739682910296196688861780721860882015036773488400937149083451713845015929093243025426876941405973284973216824503042048");
+
+// the hex field is the integer in base 16, with '-' when negative(same as uvm::util::hex of its base10 string).
+// bigint_from_hex and bigint_to_hex convert between it and the binary value directly,
+// input not written by bigint_to_hex(too long, invalid digits...) still goes through the base10 string
+static sm_bigint bigint_from_hex(const std::string& hex_str) {
+	size_t start = (hex_str.size() > 0 && hex_str[0] == '-') ? 1 : 0;
+	size_t digits_count = hex_str.size() - start;
+	if (digits_count < 1 || digits_count > 128) {
+		return sm_bigint(uvm::util::unhex(hex_str));
+	}
+	sm_bigint magnitude = 0;
+	uint64_t chunk = 0;
+	int chunk_digits = 0;
+	for (size_t i = start; i < hex_str.size(); i++) {
+		char c = hex_str[i];
+		uint64_t digit;
+		if (c >= '0' && c <= '9')
+			digit = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			digit = c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			digit = c - 'A' + 10;
+		else
+			return sm_bigint(uvm::util::unhex(hex_str));
+		chunk = (chunk << 4) | digit;
+		if (++chunk_digits == 16) {
+			magnitude <<= 64;
+			magnitude += chunk;
+			chunk = 0;
+			chunk_digits = 0;
+		}
+	}
+	if (chunk_digits > 0) {
+		magnitude <<= 4 * chunk_digits;
+		magnitude += chunk;
+	}
+	return start > 0 ? sm_bigint(-magnitude) : magnitude;
+}
+
+static std::string bigint_to_hex(const sm_bigint& value) {
+	static const char hex_chars[] = "0123456789abcdef";
+	const int limb_bits = sizeof(boost::multiprecision::limb_type) * 8;
+	const auto& backend = value.backend();
+	std::string result;
+	result.reserve(backend.size() * limb_bits / 4 + 1);
+	if (value.sign() < 0)
+		result.push_back('-');
+	bool leading_zero = true;
+	for (auto i = backend.size(); i-- > 0;) {
+		auto limb = backend.limbs()[i];
+		for (int shift = limb_bits - 4; shift >= 0; shift -= 4) {
+			auto digit = (limb >> shift) & 15;
+			if (leading_zero && digit == 0)
+				continue;
+			leading_zero = false;
+			result.push_back(hex_chars[digit]);
+		}
+	}
+	if (leading_zero)
+		result.push_back('0');
+	return result;
+}
+
+static void push_bigint(lua_State *L, const sm_bigint& value) {
+	auto hex_str = bigint_to_hex(value);
+	lua_createtable(L, 0, 2);
 	lua_pushstring(L, hex_str.c_str());
 	lua_setfield(L, -2, "hex");
 	lua_pushstring(L, "bigint");
@@ -52,19 +116,7 @@ static int safemath_bigint(lua_State *L) {
 	}
 	if (lua_isinteger(L, 1)) {
 		lua_Integer n = lua_tointeger(L, 1);
-		std::string value_hex;
-		try {
-			value_hex = uvm::util::hex(std::to_string(n));
-		}
-		catch (...) {
-			lua_pushnil(L);
-			return 1;
-		}
-		lua_newtable(L);
-		lua_pushstring(L, value_hex.c_str());
-		lua_setfield(L, -2, "hex");
-		lua_pushstring(L, "bigint");
-		lua_setfield(L, -2, "type");
+		push_bigint(L, sm_bigint(n));
 		return 1;
 	}
 	else if (lua_isstring(L, 1)) {
@@ -146,16 +198,9 @@ static bool is_valid_bigint_obj(lua_State *L, int index, std::string& out)
 		lua_pop(L, 1);
 		return false;
 	}
-	std::string hex_str = luaL_checkstring(L, -1);
+	out = luaL_checkstring(L, -1);
 	lua_pop(L, 1);
-	try {
-		boost::algorithm::hex(hex_str);
-		out = hex_str;
-		return true;
-	}
-	catch (...) {
-		return false;
-	}
+	return true;
 }
 
 //static bool is_valid_bignumber_obj(lua_State *L, int index, std::string& out)
@@ -211,10 +256,8 @@ static int safemath_add(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	auto result_int = first_int + second_int;
 	// overflow check
 	if (is_same_direction_safe_int(first_int, second_int)) {
@@ -257,14 +300,10 @@ static int safemath_mul(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	auto result_int = boost::multiprecision::int512_t(first_int) * boost::multiprecision::int512_t(second_int);
 	// overflow check
-	sm_bigint int512_max("13407807929942597099574024998205846127479365820592393377723561443721764030073546976801874298166903427690031858186486050853753882811946569946433649006084095");
-	sm_bigint int512_min("-6703903964971298549787012499102923063739682910296196688861780721860882015036773488400937149083451713845015929093243025426876941405973284973216824503042048");
 	if (is_same_direction_safe_int(first_int, second_int) && result_int > int512_max) {
 		luaL_error(L, "int512 overflow");
 	}
@@ -299,8 +338,6 @@ static sm_bigint int512_pow(lua_State *L, sm_bigint value, sm_bigint n) {
 		luaL_error(L, "too large value in bigint pow");
 	}
 	boost::multiprecision::int1024_t result(value);
-	sm_bigint int512_max("13407807929942597099574024998205846127479365820592393377723561443721764030073546976801874298166903427690031858186486050853753882811946569946433649006084095");
-	sm_bigint int512_min("-6703903964971298549787012499102923063739682910296196688861780721860882015036773488400937149083451713845015929093243025426876941405973284973216824503042048");
 	for (int i = 1; i < n; i++) {
 		auto mid_value = result * value;
 		// overflow check
@@ -339,10 +376,8 @@ static int safemath_pow(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	auto result_int = int512_pow(L, first_int, second_int);
 	// overflow check
 	if (result_int <= 0) {
@@ -373,10 +408,8 @@ static int _safemath_compare(lua_State* L, compare_type type) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	bool result = false;
 	if ( (type==compare_type::GT && first_int > second_int)
 		|| (type == compare_type::GE && first_int >= second_int)
@@ -444,10 +477,8 @@ static int safemath_div(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	if (second_int.is_zero()) {
 		luaL_error(L, "div by 0 error");
 	}
@@ -503,8 +534,6 @@ static int safemath_rem(lua_State *L) {
 	}
 	std::string first_hex_str;
 	std::string second_hex_str;
-	std::string first_int_str;
-	std::string second_int_str;
 	sm_bigint first_int;
 	sm_bigint second_int;
 	try {
@@ -516,10 +545,8 @@ static int safemath_rem(lua_State *L) {
 			luaL_argcheck(L, false, 2, "invalid bigint obj");
 			return 0;
 		}
-		first_int_str = uvm::util::unhex(first_hex_str);
-		first_int = sm_bigint(first_int_str);
-		second_int_str = uvm::util::unhex(second_hex_str);
-		second_int = sm_bigint(second_int_str);
+		first_int = bigint_from_hex(first_hex_str);
+		second_int = bigint_from_hex(second_hex_str);
 		if (second_int == 0) {
 			luaL_error(L, "rem by 0 error");
 		}
@@ -573,10 +600,8 @@ static int safemath_sub(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 2, second_hex_str)) {
 		luaL_argcheck(L, false, 2, "invalid bigint obj");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint first_int(first_int_str);
-	auto second_int_str = uvm::util::unhex(second_hex_str);
-	sm_bigint second_int(second_int_str);
+	auto first_int = bigint_from_hex(first_hex_str);
+	auto second_int = bigint_from_hex(second_hex_str);
 	auto result_int = first_int - second_int;
 	// overflow check
 	if (!is_same_direction_safe_int(first_int, second_int)) {
@@ -614,8 +639,7 @@ static int safemath_toint(lua_State* L) {
 		return 0;
 	}
 	try {
-		auto value_str = uvm::util::unhex(hex_str);
-		sm_bigint bigint_value(value_str);
+		auto bigint_value = bigint_from_hex(hex_str);
 		auto value = bigint_value.convert_to<lua_Integer>();
 		lua_pushinteger(L, value);
 		return 1;
@@ -658,8 +682,7 @@ static int safemath_tohex(lua_State* L) {
 static int safemath_tostring(lua_State* L) {
 	std::string hex_str;
 	if (is_valid_bigint_obj(L, 1, hex_str)) {
-		auto value_str = uvm::util::unhex(hex_str);
-		sm_bigint bigint_value(value_str);
+		auto bigint_value = bigint_from_hex(hex_str);
 		auto bigint_value_str = bigint_value.str();
 		lua_pushstring(L, bigint_value_str.c_str());
 		return 1;
@@ -682,16 +705,14 @@ static int safemath_min(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 1, first_hex_str)) {
 		luaL_argcheck(L, false, 1, "bigint value expected");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint min_value(first_int_str);
+	auto min_value = bigint_from_hex(first_hex_str);
 	luaL_argcheck(L, n >= 1, 1, "value expected");
 	for (int i = 2; i <= n; i++) {
 		std::string hex_value;
 		if (!is_valid_bigint_obj(L, i, hex_value)) {
 			luaL_argcheck(L, false, i, "bigint value expected");
 		}
-		auto int_str = uvm::util::unhex(hex_value);
-		sm_bigint int_value(int_str);
+		auto int_value = bigint_from_hex(hex_value);
 		if (int_value < min_value) {
 			imin = i;
 			min_value = int_value;
@@ -733,16 +754,14 @@ static int safemath_max(lua_State *L) {
 	if (!is_valid_bigint_obj(L, 1, first_hex_str)) {
 		luaL_argcheck(L, false, 1, "bigint value expected");
 	}
-	auto first_int_str = uvm::util::unhex(first_hex_str);
-	sm_bigint max_value(first_int_str);
+	auto max_value = bigint_from_hex(first_hex_str);
 	luaL_argcheck(L, n >= 1, 1, "value expected");
 	for (int i = 2; i <= n; i++) {
 		std::string hex_value;
 		if (!is_valid_bigint_obj(L, i, hex_value)) {
 			luaL_argcheck(L, false, i, "bigint value expected");
 		}
-		auto int_str = uvm::util::unhex(hex_value);
-		sm_bigint int_value(int_str);
+		auto int_value = bigint_from_hex(hex_value);
 		if (int_value > max_value) {
 			imax = i;
 			max_value = int_value;
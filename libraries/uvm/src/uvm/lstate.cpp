@@ -291,6 +291,9 @@ LUA_API lua_State *lua_newstate(lua_Alloc f, void *ud) {
 	L->breakpoints = new std::map<std::string, std::list<uint32_t> >();
     
 	L->cbor_diff_state = 0;
+	L->chain_api = nullptr;
+	L->chain_api_has_error = false;
+	L->profile = nullptr;
 
 	L->allow_contract_modify = 0;
 	L->contract_table_addresses = new std::list<intptr_t>();
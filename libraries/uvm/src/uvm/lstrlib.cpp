@@ -24,6 +24,7 @@
 #include <uvm/lobject.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 /*
@@ -621,7 +622,7 @@ static void reprepstate(MatchState *ms) {
     lua_assert(ms->matchdepth == MAXCCALLS);
 }
 
-#define ARGS_ERROR()   { global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "arguments wrong"); return 0; }
+#define ARGS_ERROR()   { get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "arguments wrong"); return 0; }
 
 static int str_split(lua_State *L)
 {
@@ -339,7 +339,27 @@ const TValue *luaH_getint(uvm_types::GcTable *t, lua_Integer key) {
 /*
 ** search function for short strings
 */
+/*
+** lookup of an interned string key by pointer. a found value is remembered,
+** the slow lookup only runs again while the key is missing
+*/
+static const TValue *getinterned(uvm_types::GcTable *t, uvm_types::GcString *key) {
+	auto it = t->interned_keys.find(key);
+	return it != t->interned_keys.end() ? it->second : nullptr;
+}
+
+static const TValue *cacheinterned(uvm_types::GcTable *t, uvm_types::GcString *key, const TValue *val) {
+	if (key->interned && val != luaO_nilobject)
+		t->interned_keys[key] = val;
+	return val;
+}
+
 const TValue *luaH_getshortstr(uvm_types::GcTable *t, uvm_types::GcString *key) {
+	if (key->interned) {
+		auto cached = getinterned(t, key);
+		if (cached)
+			return cached;
+	}
 	std::string key_str = key->value;
 	auto key_obj_it = t->keys.find(key_str);
 	if (key_obj_it == t->keys.end())
@@ -348,7 +368,7 @@ const TValue *luaH_getshortstr(uvm_types::GcTable *t, uvm_types::GcString *key)
 	auto val_it = t->entries.find(key_obj);
 	if (val_it == t->entries.end())
 		return luaO_nilobject;
-	return &val_it->second;
+	return cacheinterned(t, key, &val_it->second);
 }
 
 
@@ -376,9 +396,14 @@ const TValue *luaH_getstr(uvm_types::GcTable *t, uvm_types::GcString *key) {
 	if (key->tt == LUA_TSHRSTR)
 		return luaH_getshortstr(t, key);
     else {  /* for long strings, use generic case */
+        if (key->interned) {
+            auto cached = getinterned(t, key);
+            if (cached)
+                return cached;
+        }
         TValue ko;
         setsvalue(lua_cast(lua_State *, nullptr), &ko, key);
-        return getgeneric(t, &ko);
+        return cacheinterned(t, key, getgeneric(t, &ko));
     }
 }
 
@@ -15,9 +15,10 @@
 #include "uvm/lualib.h"
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
-#define ARGS_ERROR()   { global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "arguments wrong"); return 0; }
+#define ARGS_ERROR()   { get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "arguments wrong"); return 0; }
 
 static int time_difftime(lua_State *L) {
     if (lua_gettop(L) < 2 || !lua_isinteger(L, 1) || !lua_isinteger(L, 2)) {
@@ -62,7 +63,7 @@ static int time_add(lua_State *L) {
         cdt.tm_sec += offset;
     else
     {
-        global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+        get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
             "time.add second argument need be 'year'/'month'/'day'/'hour'/'minute'/'second'");
         return 0;
     }
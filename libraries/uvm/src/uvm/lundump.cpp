@@ -25,6 +25,7 @@
 #include <uvm/uvm_lib.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 #if !defined(luai_verifycode)
@@ -41,7 +42,7 @@ typedef struct {
 
 static l_noret error(LoadState *S, const char *why) {
     luaO_pushfstring(S->L, "%s: %s precompiled chunk", S->name, why);
-	global_uvm_chain_api->throw_exception(S->L, UVM_API_SIMPLE_ERROR, "%s: %s precompiled chunk", S->name, why);
+	get_uvm_chain_api(S->L)->throw_exception(S->L, UVM_API_SIMPLE_ERROR, "%s: %s precompiled chunk", S->name, why);
     luaD_throw(S->L, LUA_ERRSYNTAX);
 }
 
@@ -39,9 +39,11 @@
 #include <uvm/uvm_api.h>
 #include <uvm/uvm_lib.h>
 #include <uvm/uvm_storage.h>
+#include <uvm/uvm_profiler.h>
 #include <uvm/exceptions.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 
 
@@ -77,7 +79,9 @@ using uvm::lua::api::global_uvm_chain_api;
 
 #endif
 
-static std::shared_ptr<uvm::core::ExecuteContext> last_execute_context;
+// VMs in different threads have their own execute contexts
+static thread_local std::shared_ptr<uvm::core::ExecuteContext> last_execute_context;
+
 /*
 ** Try to convert a value to a float. The float case is already handled
 ** by the macro 'tonumber'.
@@ -262,6 +266,8 @@ void luaV_finishset(lua_State *L, const TValue *t, TValue *key,
 ** of the strings.
 */
 static int l_strcmp(const uvm_types::GcString *ls, const uvm_types::GcString *rs) {
+	if (ls == rs)
+		return 0;
 	const char *l = getstr(ls);
 	size_t ll = ls->value.size();
 	const char *r = getstr(rs);
@@ -813,9 +819,14 @@ void luaV_finishOp(lua_State *L) {
 	{  }
 
 
+/*
+** dispatch macros; redefined by 'ljumptab.h' when the interpreter is
+** built with UVM_USE_JUMPTABLE (computed gotos instead of a 'switch')
+*/
 #define vmdispatch(o)	switch(o)
 #define vmcase(l)	case l:
 #define vmbreak		break
+#define vmdispatchend	(void)0
 
 
 /*
@@ -1073,12 +1084,12 @@ namespace uvm {
 				L->state = lua_VMState::LVM_STATE_NONE;
 			}
 
-			bool use_step_log = global_uvm_chain_api != nullptr && global_uvm_chain_api->use_step_log(L);
-                        bool use_gas_log = global_uvm_chain_api != nullptr && global_uvm_chain_api->use_gas_log(L);
+			bool use_step_log = global_uvm_chain_api != nullptr && get_uvm_chain_api(L)->use_step_log(L);
+                        bool use_gas_log = global_uvm_chain_api != nullptr && get_uvm_chain_api(L)->use_gas_log(L);
 
 			
 				if (!ci || ci->u.l.savedpc == nullptr) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "wrong bytecode instruction, can't find savedpc");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "wrong bytecode instruction, can't find savedpc");
 					//vmbreak;
 					return false;
 				}
@@ -1089,6 +1100,8 @@ namespace uvm {
 					printf("%s\tline:%d, now gas %d\n", luaP_opnames[GET_OPCODE(i)], cur_line, *insts_executed_count);
 					ci->u.l.savedpc++;
 				}
+				if (profile)
+					profile->on_instruction(L, ci, *insts_executed_count);
 
 				StkId ra;
 
@@ -1097,7 +1110,7 @@ namespace uvm {
 											// limit instructions count, and executed instructions
 				if (has_insts_limit && *insts_executed_count > insts_limit)
 				{
-					global_uvm_chain_api->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
 					//vmbreak;
 					return false;
 				}
@@ -1111,9 +1124,9 @@ namespace uvm {
 
 				// when over contract api limit, also vmbreak
 				if ((GET_OPCODE(i) == UOP_CALL || GET_OPCODE(i) == UOP_TAILCALL)
-					&& global_uvm_chain_api->check_contract_api_instructions_over_limit(L))
+					&& get_uvm_chain_api(L)->check_contract_api_instructions_over_limit(L))
 				{
-					global_uvm_chain_api->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
 					//vmbreak;
 					return false;
 				}
@@ -1125,6 +1138,10 @@ namespace uvm {
 				lua_assert(base == ci->u.l.base);
 				lua_assert(base <= L->top && L->top < L->stack + L->stacksize);
 
+#if defined(UVM_USE_JUMPTABLE)
+#include <uvm/ljumptab.h>
+#endif
+
 				vmdispatch(GET_OPCODE(i)) {
 					vmcase(UOP_MOVE) {
 						setobjs2s(L, ra, RB(i));
@@ -1935,6 +1952,7 @@ namespace uvm {
 							vmbreak;
 					}
 				}
+				vmdispatchend;
 
 				if (!enum_has_flag(L->state, lua_VMState::LVM_STATE_FAULT) && L->allow_debug && L->using_contract_id_stack && !L->using_contract_id_stack->empty())
 				{
@@ -2036,6 +2054,7 @@ namespace uvm {
 			this->ci = ci;
 			this->base = base;
 			this->cl = cl;
+			this->profile = L->profile;
 		}
 
 		std::map<std::string, TValue> ExecuteContext::view_localvars(lua_State* L) const {
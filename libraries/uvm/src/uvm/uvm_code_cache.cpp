@@ -0,0 +1,62 @@
+#include <uvm/uvm_code_cache.h>
+#include <uvm/uvm_lib.h>
+#include <map>
+#include <mutex>
+
+namespace uvm
+{
+	namespace lua
+	{
+		namespace lib
+		{
+			// bytecode of a contract is registered once and loaded by every call of it,
+			// the same few contracts are checked again and again
+			static const size_t verified_contract_code_cache_max_size = 1024;
+
+			static std::mutex verified_contract_code_mutex;
+			static std::map<fc::sha256, UvmVerifiedContractCode> verified_contract_codes;
+
+			fc::sha256 contract_code_digest(const UvmModuleByteStream *stream)
+			{
+				return fc::sha256::hash(stream->buff.data(), static_cast<uint32_t>(stream->buff.size()));
+			}
+
+			bool is_verified_contract_code(lua_State *L, const fc::sha256& digest)
+			{
+				UvmVerifiedContractCode code;
+				{
+					std::lock_guard<std::mutex> lock(verified_contract_code_mutex);
+					auto it = verified_contract_codes.find(digest);
+					if (it == verified_contract_codes.end())
+						return false;
+					code = it->second;
+				}
+				for (const auto& name : code.imported_contracts)
+				{
+					if (!uvm::lua::api::get_uvm_chain_api(L)->check_contract_exist(L, name.c_str()))
+						return false;
+				}
+				for (const auto& address : code.imported_contract_addresses)
+				{
+					if (!uvm::lua::api::get_uvm_chain_api(L)->check_contract_exist_by_address(L, address.c_str()))
+						return false;
+				}
+				return true;
+			}
+
+			void add_verified_contract_code(const fc::sha256& digest, UvmVerifiedContractCode&& code)
+			{
+				std::lock_guard<std::mutex> lock(verified_contract_code_mutex);
+				if (verified_contract_codes.size() >= verified_contract_code_cache_max_size)
+					verified_contract_codes.clear();
+				verified_contract_codes[digest] = std::move(code);
+			}
+
+			void clear_verified_contract_codes()
+			{
+				std::lock_guard<std::mutex> lock(verified_contract_code_mutex);
+				verified_contract_codes.clear();
+			}
+		}
+	}
+}
@@ -36,6 +36,8 @@
 #include <uvm/lfunc.h>
 #include <uvm/ltable.h>
 #include <uvm/uvm_storage.h>
+#include <uvm/uvm_profiler.h>
+#include <uvm/uvm_code_cache.h>
 #include <uvm/exceptions.h>
 #include <cborcpp/cbor.h>
 #include <uvm/lvm.h>
@@ -48,9 +50,22 @@ namespace uvm
       namespace api
       {
         IUvmChainApi *global_uvm_chain_api = nullptr;
+
+        IUvmChainApi *get_uvm_chain_api(lua_State *L)
+        {
+            if (L && L->chain_api)
+                return L->chain_api;
+            return global_uvm_chain_api;
+        }
+
+        void set_uvm_chain_api(lua_State *L, IUvmChainApi *chain_api)
+        {
+            L->chain_api = chain_api;
+        }
       }
 
       using uvm::lua::api::global_uvm_chain_api;
+      using uvm::lua::api::get_uvm_chain_api;
 
 		namespace lib
 		{
@@ -100,16 +115,16 @@ namespace uvm
 
             static std::mutex states_map_mutex;
 
+            // lua_States in different threads share states_map, each state's own values map is only used by its thread
             static L_V1 create_value_map_for_lua_state(lua_State *L)
             {
                 LStatesMap *states_map = get_lua_states_value_hashmap();
+                std::lock_guard<std::mutex> lock(states_map_mutex);
                 auto it = states_map->find(L);
                 if (it == states_map->end())
                 {
-                    states_map_mutex.lock();
                     L_V1 map = std::make_shared<L_VM1>();
                     states_map->insert(std::make_pair(L, map));
-                    states_map_mutex.unlock();
                     return map;
                 }
                 else
@@ -121,13 +136,13 @@ namespace uvm
             {
 				if (lua_gettop(L) < 3)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "transfer_from_contract_to_public_account need 3 arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "transfer_from_contract_to_public_account need 3 arguments");
 					return 0;
 				}
 				const char *contract_id = get_storage_contract_id_in_api(L);
 				if (nullptr == contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract transfer must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract transfer must be called in contract api");
 					return 0;
 				}
 				const char *to_account_name = luaL_checkstring(L, 1);
@@ -135,10 +150,10 @@ namespace uvm
 				auto amount_str = luaL_checkinteger(L, 3);
 				if (amount_str <= 0)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "amount must be positive");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "amount must be positive");
 					return 0;
 				}
-				lua_Integer transfer_result = uvm::lua::api::global_uvm_chain_api->transfer_from_contract_to_public_account(L, contract_id, to_account_name, asset_type, amount_str);
+				lua_Integer transfer_result = uvm::lua::api::get_uvm_chain_api(L)->transfer_from_contract_to_public_account(L, contract_id, to_account_name, asset_type, amount_str);
 				lua_pushinteger(L, transfer_result);
 				return 1;
             }
@@ -150,13 +165,13 @@ namespace uvm
             {
                 if (lua_gettop(L) < 3)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "transfer_from_contract_to_address need 3 arguments");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "transfer_from_contract_to_address need 3 arguments");
                     return 0;
                 }
                 const char *contract_id = get_storage_contract_id_in_api(L);
                 if (!contract_id)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract transfer must be called in contract api");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract transfer must be called in contract api");
                     return 0;
                 }
                 const char *to_address = luaL_checkstring(L, 1);
@@ -164,10 +179,10 @@ namespace uvm
                 auto amount_str = luaL_checkinteger(L, 3);
                 if (amount_str <= 0)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "amount must be positive");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "amount must be positive");
                     return 0;
                 }
-                lua_Integer transfer_result = uvm::lua::api::global_uvm_chain_api->transfer_from_contract_to_address(L, contract_id, to_address, asset_type, amount_str);
+                lua_Integer transfer_result = uvm::lua::api::get_uvm_chain_api(L)->transfer_from_contract_to_address(L, contract_id, to_address, asset_type, amount_str);
                 lua_pushinteger(L, transfer_result);
                 return 1;
             }
@@ -175,14 +190,14 @@ namespace uvm
 			static int ecrecover(lua_State *L)
 			{
 				if (lua_gettop(L) < 4) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "ecrecover need 4 arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "ecrecover need 4 arguments");
 					return 0;
 				}
 				const char * hash = luaL_checkstring(L, 1);
 				const char * v = luaL_checkstring(L, 2);
 				const char * r = luaL_checkstring(L, 3);
 				const char * s = luaL_checkstring(L, 4);
-				auto verify_address = uvm::lua::api::global_uvm_chain_api->get_signature_address(L,hash, v, r, s);
+				auto verify_address = uvm::lua::api::get_uvm_chain_api(L)->get_signature_address(L,hash, v, r, s);
 				lua_pushstring(L, verify_address.c_str());
 				return 1;
 			}
@@ -192,7 +207,7 @@ namespace uvm
                 const char *cur_contract_id = get_storage_contract_id_in_api(L);
                 if (!cur_contract_id)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't get current contract address");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't get current contract address");
                     return 0;
                 }
                 lua_pushstring(L, cur_contract_id);
@@ -290,14 +305,14 @@ namespace uvm
 
 			static int get_system_asset_symbol(lua_State *L)
 			{
-				const char *system_asset_symbol = uvm::lua::api::global_uvm_chain_api->get_system_asset_symbol(L);
+				const char *system_asset_symbol = uvm::lua::api::get_uvm_chain_api(L)->get_system_asset_symbol(L);
 				lua_pushstring(L, system_asset_symbol);
 				return 1;
 			}
 
 			static int get_system_asset_precision(lua_State *L)
 			{
-				auto precision = uvm::lua::api::global_uvm_chain_api->get_system_asset_precision(L);
+				auto precision = uvm::lua::api::get_uvm_chain_api(L)->get_system_asset_precision(L);
 				lua_pushinteger(L, precision);
 				return 1;
 			}
@@ -306,7 +321,7 @@ namespace uvm
             {
                 if (lua_gettop(L) > 0 && !lua_isstring(L, 1))
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
                         "get_contract_balance_amount need 1 string argument of contract address");
                     return 0;
                 }
@@ -314,20 +329,20 @@ namespace uvm
 				auto contract_address = luaL_checkstring(L, 1);
                 if (strlen(contract_address) < 1)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
                         "contract address can't be empty");
                     return 0;
                 }
 
                 if (lua_gettop(L) < 2 || !lua_isstring(L, 2))
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get balance amount need asset symbol");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get balance amount need asset symbol");
                     return 0;
                 }
 
                 auto assert_symbol = luaL_checkstring(L, 2);
                 
-                auto result = uvm::lua::api::global_uvm_chain_api->get_contract_balance_amount(L, contract_address, assert_symbol);
+                auto result = uvm::lua::api::get_uvm_chain_api(L)->get_contract_balance_amount(L, contract_address, assert_symbol);
                 lua_pushinteger(L, result);
                 return 1;
             }
@@ -335,7 +350,7 @@ namespace uvm
 			static int signature_recover(lua_State* L) {
 				// signature_recover(sig_hex, raw_hex): public_key_hex_string
 				if (lua_gettop(L) < 2 || !lua_isstring(L, 1) || !lua_isstring(L, 2)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "signature_recover need accept 2 hex string arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "signature_recover need accept 2 hex string arguments");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -344,8 +359,8 @@ namespace uvm
 				std::string raw_hex(luaL_checkstring(L, 2));
 				
 				try {
-					const auto& sig_bytes = uvm::lua::api::global_uvm_chain_api->hex_to_bytes(sig_hex);
-					const auto& raw_bytes = uvm::lua::api::global_uvm_chain_api->hex_to_bytes(raw_hex);
+					const auto& sig_bytes = uvm::lua::api::get_uvm_chain_api(L)->hex_to_bytes(sig_hex);
+					const auto& raw_bytes = uvm::lua::api::get_uvm_chain_api(L)->hex_to_bytes(raw_hex);
 					fc::ecc::compact_signature compact_sig;
 					if (sig_bytes.size() > compact_sig.size())
 						throw uvm::core::UvmException("invalid sig bytes size");
@@ -359,17 +374,17 @@ namespace uvm
 					}
 					const auto& public_key_chars = recoved_public_key.serialize();
 					std::vector<unsigned char> public_key_bytes(public_key_chars.begin(), public_key_chars.end());
-					const auto& public_key_hex = uvm::lua::api::global_uvm_chain_api->bytes_to_hex(public_key_bytes);
+					const auto& public_key_hex = uvm::lua::api::get_uvm_chain_api(L)->bytes_to_hex(public_key_bytes);
 					lua_pushstring(L, public_key_hex.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when signature_recover");
 					return 0;
 				}
@@ -377,30 +392,30 @@ namespace uvm
 
 			static int get_address_role(lua_State *L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"get_address_role need 1 address string argument");
 					return 0;
 				}
 				auto addr = luaL_checkstring(L, 1);
-				if (!uvm::lua::api::global_uvm_chain_api->is_valid_address(L, addr)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+				if (!uvm::lua::api::get_uvm_chain_api(L)->is_valid_address(L, addr)) {
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"get_address_role's first argument must be valid address format");
 					return 0;
 				}
-				std::string address_role = uvm::lua::api::global_uvm_chain_api->get_address_role(L, addr);
+				std::string address_role = uvm::lua::api::get_uvm_chain_api(L)->get_address_role(L, addr);
 				lua_pushstring(L, address_role.c_str());
 				return 1;
 			}
 
 			static int hex_to_bytes(lua_State *L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"hex_to_bytes need 1 hex string argument");
 					return 0;
 				}
 				auto hex_str = luaL_checkstring(L, 1);
 				try {
-					const auto& result = uvm::lua::api::global_uvm_chain_api->hex_to_bytes(hex_str);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->hex_to_bytes(hex_str);
 					lua_newtable(L);
 					for (size_t i = 0; i < result.size(); i++) {
 						lua_pushinteger(L, (lua_Integer)result[i]);
@@ -409,12 +424,12 @@ namespace uvm
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when hex_to_bytes");
 					return 0;
 				}
@@ -422,7 +437,7 @@ namespace uvm
 
 			static int bytes_to_hex(lua_State *L) {
 				if (lua_gettop(L) < 1 || !lua_istable(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"bytes_to_hex need 1 int array argument");
 					return 0;
 				}
@@ -444,7 +459,7 @@ namespace uvm
 								byte_value = (unsigned char)value.value.number_value;
 							}
 							else {
-								uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+								uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 									"invalid byte int bytes_to_hex's argument");
 								return 0;
 							}
@@ -455,17 +470,17 @@ namespace uvm
 						}
 						i++;
 					}
-					const auto& result = uvm::lua::api::global_uvm_chain_api->bytes_to_hex(bytes);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->bytes_to_hex(bytes);
 					lua_pushstring(L, result.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when bytes_to_hex");
 					return 0;
 				}
@@ -474,7 +489,7 @@ namespace uvm
 			static int cbor_encode(lua_State* L) {
 				// cbor_encode(json object): hex string
 				if (lua_gettop(L) < 1) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"cbor_encode need 1 argument");
 					return 0;
 				}
@@ -491,12 +506,12 @@ namespace uvm
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when ebor_encode");
 					return 0;
 				}
@@ -505,7 +520,7 @@ namespace uvm
 			static int cbor_decode(lua_State* L) {
 				// cbor_decode(hex_str): json object
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"cbor_decode need 1 string argument");
 					return 0;
 				}
@@ -522,12 +537,12 @@ namespace uvm
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when cbor_decode");
 					return 0;
 				}
@@ -535,92 +550,92 @@ namespace uvm
 
 			static int sha256_hex(lua_State* L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"sha256_hex need 1 string argument");
 					return 0;
 				}
 				try {
 					auto hex_str = luaL_checkstring(L, 1);
-					const auto& result = uvm::lua::api::global_uvm_chain_api->sha256_hex(hex_str);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->sha256_hex(hex_str);
 					lua_pushstring(L, result.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when sha256_hex");
 					return 0;
 				}
 			}
 			static int sha1_hex(lua_State* L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"sha1_hex need 1 string argument");
 					return 0;
 				}
 				try {
 					auto hex_str = luaL_checkstring(L, 1);
-					const auto& result = uvm::lua::api::global_uvm_chain_api->sha1_hex(hex_str);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->sha1_hex(hex_str);
 					lua_pushstring(L, result.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when sha1_hex");
 					return 0;
 				}
 			}
 			static int sha3_hex(lua_State* L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"sha3_hex need 1 string argument");
 					return 0;
 				}
 				try {
 					auto hex_str = luaL_checkstring(L, 1);
-					const auto& result = uvm::lua::api::global_uvm_chain_api->sha3_hex(hex_str);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->sha3_hex(hex_str);
 					lua_pushstring(L, result.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when sha3_hex");
 					return 0;
 				}
 			}
 			static int ripemd160_hex(lua_State* L) {
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"ripemd160_hex need 1 string argument");
 					return 0;
 				}
 				try {
 					auto hex_str = luaL_checkstring(L, 1);
-					const auto& result = uvm::lua::api::global_uvm_chain_api->ripemd160_hex(hex_str);
+					const auto& result = uvm::lua::api::get_uvm_chain_api(L)->ripemd160_hex(hex_str);
 					lua_pushstring(L, result.c_str());
 					return 1;
 				}
 				catch (const std::exception& e) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						e.what());
 					return 0;
 				}
 				catch (...) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"error when ripemd160_hex");
 					return 0;
 				}
@@ -630,7 +645,7 @@ namespace uvm
 				// delegate_call(contractAddr: string, apiName: string, params args: object[]): object
 				auto top = lua_gettop(L);
 				if (top < 2 || !lua_isstring(L, 1) || !lua_isstring(L, 2)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"delegate_call arguments invalid");
 					return 0;
 				}
@@ -638,12 +653,12 @@ namespace uvm
 				auto contract_addr = luaL_checkstring(L, 1);
 				std::string api_name(luaL_checkstring(L, 2));
 				if (api_name.empty()) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"delegate_call argument api_name can't be empty");
 					return 0;
 				}
 				if (std::find(contract_special_api_names.begin(), contract_special_api_names.end(), api_name) != contract_special_api_names.end()) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 						"delegate_call can't call special api name");
 					return 0;
 				}
@@ -660,7 +675,7 @@ namespace uvm
 				//import
 				lua_getglobal(L, "import_contract_from_address");
 				if (!lua_iscfunction(L, 4)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "no import_contract_from_address");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "no import_contract_from_address");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -668,7 +683,7 @@ namespace uvm
 				lua_call(L, 1, 1);
 				//con_id,apiname,args,con_table
 				if (lua_gettop(L) < 4 || !lua_istable(L, 4)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract not found when delegate_call");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract not found when delegate_call");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -678,7 +693,7 @@ namespace uvm
 				lua_gettable(L, 4); //con_id,apiname,args,con_table,api_func
 
 				if (!lua_isfunction(L, 5)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "no api funcion");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "no api funcion");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -797,20 +812,20 @@ namespace uvm
             {
                 auto msg = luaL_checkstring(L, -1);
                 if (nullptr != msg)
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, msg);
                 return 0;
             }
 
             static int get_chain_now(lua_State *L)
             {
-                auto time = uvm::lua::api::global_uvm_chain_api->get_chain_now(L);
+                auto time = uvm::lua::api::get_uvm_chain_api(L)->get_chain_now(L);
                 lua_pushinteger(L, time);
                 return 1;
             }
 
             static int get_chain_random(lua_State *L)
             {
-                auto rand = uvm::lua::api::global_uvm_chain_api->get_chain_random(L);
+                auto rand = uvm::lua::api::get_uvm_chain_api(L)->get_chain_random(L);
                 lua_pushinteger(L, rand);
                 return 1;
             }
@@ -821,26 +836,26 @@ namespace uvm
 				if (lua_gettop(L) >= 1 && lua_isboolean(L, 1) && lua_toboolean(L, 1)) {
 					diff_in_diff_txs = true;
 				}
-				auto rand = uvm::lua::api::global_uvm_chain_api->get_chain_safe_random(L, diff_in_diff_txs);
+				auto rand = uvm::lua::api::get_uvm_chain_api(L)->get_chain_safe_random(L, diff_in_diff_txs);
 				lua_pushinteger(L, rand);
 				return 1;
 			}
 
             static int get_transaction_id(lua_State *L)
             {
-                std::string tid = uvm::lua::api::global_uvm_chain_api->get_transaction_id(L);
+                std::string tid = uvm::lua::api::get_uvm_chain_api(L)->get_transaction_id(L);
                 lua_pushstring(L, tid.c_str());
                 return 1;
             }
             static int get_transaction_fee(lua_State *L)
             {
-                int64_t res = uvm::lua::api::global_uvm_chain_api->get_transaction_fee(L);
+                int64_t res = uvm::lua::api::get_uvm_chain_api(L)->get_transaction_fee(L);
                 lua_pushinteger(L, res);
                 return 1;
             }
             static int get_header_block_num(lua_State *L)
             {
-                auto result = uvm::lua::api::global_uvm_chain_api->get_header_block_num(L);
+                auto result = uvm::lua::api::get_uvm_chain_api(L)->get_header_block_num(L);
                 lua_pushinteger(L, result);
                 return 1;
             }
@@ -849,16 +864,16 @@ namespace uvm
             {
                 if (lua_gettop(L) < 1 || !lua_isinteger(L, 1))
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "wait_for_future_random need a integer param");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "wait_for_future_random need a integer param");
                     return 0;
                 }
                 auto next = luaL_checkinteger(L, 1);
                 if (next <= 0)
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "wait_for_future_random first param must be positive number");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "wait_for_future_random first param must be positive number");
                     return 0;
                 }
-                auto result = uvm::lua::api::global_uvm_chain_api->wait_for_future_random(L, (int)next);
+                auto result = uvm::lua::api::get_uvm_chain_api(L)->wait_for_future_random(L, (int)next);
                 lua_pushinteger(L, result);
                 return 1;
             }
@@ -868,19 +883,19 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 3)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "lock_contract_balance_to_miner need 4 arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "lock_contract_balance_to_miner need 4 arguments");
 					return 0;
 				}
 				const char *contract_id = get_storage_contract_id_in_api(L);
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "lock_contract_balance_to_miner must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "lock_contract_balance_to_miner must be called in contract api");
 					return 0;
 				}
 				const char *asset_sym = luaL_checkstring(L, 1);
 				const char *asset_amount = luaL_checkstring(L, 2);
 				auto mid = luaL_checkstring(L, 3);
-				int transfer_result = uvm::lua::api::global_uvm_chain_api->lock_contract_balance_to_miner(L, contract_id, asset_sym, asset_amount, mid);
+				int transfer_result = uvm::lua::api::get_uvm_chain_api(L)->lock_contract_balance_to_miner(L, contract_id, asset_sym, asset_amount, mid);
 				lua_pushboolean(L, transfer_result);
 				return 1;
 			}
@@ -889,20 +904,20 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 3)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "obtain_pay_back_balance need 4 arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "obtain_pay_back_balance need 4 arguments");
 					return 0;
 				}
 				const char *contract_id = get_storage_contract_id_in_api(L);
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "obtain_pay_back_balance must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "obtain_pay_back_balance must be called in contract api");
 					return 0;
 				}
 
 				auto mid = luaL_checkstring(L, 1);
 				const char *asset_sym = luaL_checkstring(L, 2);
 				const char *asset_amount = luaL_checkstring(L, 3);
-				int transfer_result = uvm::lua::api::global_uvm_chain_api->obtain_pay_back_balance(L, contract_id, mid, asset_sym, asset_amount);
+				int transfer_result = uvm::lua::api::get_uvm_chain_api(L)->obtain_pay_back_balance(L, contract_id, mid, asset_sym, asset_amount);
 				lua_pushboolean(L, transfer_result);
 				return 1;
 			}
@@ -911,20 +926,20 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 3)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "foreclose_balance_from_miners need 4 arguments");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "foreclose_balance_from_miners need 4 arguments");
 					return 0;
 				}
 				const char *contract_id = get_storage_contract_id_in_api(L);
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "foreclose_balance_from_miners must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "foreclose_balance_from_miners must be called in contract api");
 					return 0;
 				}
 
 				auto mid = luaL_checkstring(L, 1);
 				const char *asset_sym = luaL_checkstring(L, 2);
 				const char *asset_amount = luaL_checkstring(L, 3);
-				int transfer_result = uvm::lua::api::global_uvm_chain_api->foreclose_balance_from_miners(L, contract_id, mid, asset_sym, asset_amount);
+				int transfer_result = uvm::lua::api::get_uvm_chain_api(L)->foreclose_balance_from_miners(L, contract_id, mid, asset_sym, asset_amount);
 				lua_pushboolean(L, transfer_result);
 				return 1;
 			}
@@ -934,10 +949,10 @@ namespace uvm
 				const char *contract_id = get_storage_contract_id_in_api(L);
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info must be called in contract api");
 					return 0;
 				}
-				std::string res = uvm::lua::api::global_uvm_chain_api->get_contract_lock_balance_info(L, contract_id);
+				std::string res = uvm::lua::api::get_uvm_chain_api(L)->get_contract_lock_balance_info(L, contract_id);
 				lua_pushstring(L, res.c_str());
 				return 1;
 			}
@@ -946,7 +961,7 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 1)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info_by_asset must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info_by_asset must be called in contract api");
 					return 0;
 				}
 				const char *asset_sym = luaL_checkstring(L, 1);
@@ -954,10 +969,10 @@ namespace uvm
 
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_contract_lock_balance_info must be called in contract api");
 					return 0;
 				}
-				std::string res = uvm::lua::api::global_uvm_chain_api->get_contract_lock_balance_info(L, contract_id, asset_sym);
+				std::string res = uvm::lua::api::get_uvm_chain_api(L)->get_contract_lock_balance_info(L, contract_id, asset_sym);
 				lua_pushstring(L, res.c_str());
 				return 1;
 			}
@@ -966,7 +981,7 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 1)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_pay_back_balance must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_pay_back_balance must be called in contract api");
 					return 0;
 				}
 				const char *asset_sym = luaL_checkstring(L, 1);
@@ -974,10 +989,10 @@ namespace uvm
 
 				if (!contract_id)
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_pay_back_balance must be called in contract api");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_pay_back_balance must be called in contract api");
 					return 0;
 				}
-				std::string res = uvm::lua::api::global_uvm_chain_api->get_pay_back_balance(L, contract_id, asset_sym);
+				std::string res = uvm::lua::api::get_uvm_chain_api(L)->get_pay_back_balance(L, contract_id, asset_sym);
 				lua_pushstring(L, res.c_str());
 				return 1;
 			}
@@ -989,11 +1004,11 @@ namespace uvm
             {
                 if (lua_gettop(L) < 1 || !lua_isinteger(L, 1))
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_waited need a integer param");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_waited need a integer param");
                     return 0;
                 }
                 auto num = luaL_checkinteger(L, 1);
-                auto result = uvm::lua::api::global_uvm_chain_api->get_waited(L, (uint32_t)num);
+                auto result = uvm::lua::api::get_uvm_chain_api(L)->get_waited(L, (uint32_t)num);
                 lua_pushinteger(L, result);
                 return 1;
             }
@@ -1002,7 +1017,7 @@ namespace uvm
             {
                 if (lua_gettop(L) < 2 && (!lua_isstring(L, 1) || !lua_isstring(L, 2)))
                 {
-                    uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "emit need 2 string params");
+                    uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "emit need 2 string params");
                     return 0;
                 }
                 const char *contract_id = get_storage_contract_id_in_api(L);
@@ -1010,7 +1025,7 @@ namespace uvm
                 const char *event_param = luaL_checkstring(L, 2);
 				if (!contract_id || strlen(contract_id) < 1)
 					return 0;
-                uvm::lua::api::global_uvm_chain_api->emit(L, contract_id, event_name, event_param);
+                uvm::lua::api::get_uvm_chain_api(L)->emit(L, contract_id, event_name, event_param);
                 return 0;
             }
 
@@ -1018,11 +1033,11 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1))
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "is_valid_address need a param of address string");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "is_valid_address need a param of address string");
 					return 0;
 				}
 				auto address = luaL_checkstring(L, 1);
-				auto result = uvm::lua::api::global_uvm_chain_api->is_valid_address(L, address);
+				auto result = uvm::lua::api::get_uvm_chain_api(L)->is_valid_address(L, address);
 				lua_pushboolean(L, result ? 1 : 0);
 				return 1;
 			}
@@ -1031,11 +1046,11 @@ namespace uvm
 			{
 				if (lua_gettop(L) < 1 || !lua_isstring(L, 1))
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "is_valid_contract_address need a param of address string");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "is_valid_contract_address need a param of address string");
 					return 0;
 				}
 				auto address = luaL_checkstring(L, 1);
-				auto result = uvm::lua::api::global_uvm_chain_api->is_valid_contract_address(L, address);
+				auto result = uvm::lua::api::get_uvm_chain_api(L)->is_valid_contract_address(L, address);
 				lua_pushboolean(L, result ? 1 : 0);
 				return 1;
 			}
@@ -1043,7 +1058,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_size(lua_State *L)
             {
 				auto stream = (UvmByteStream*) luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if(uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t) stream,
+				if(uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t) stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					auto stream_size = stream->size();
@@ -1060,7 +1075,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_eof(lua_State *L)
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					lua_pushboolean(L, stream->eof());
@@ -1076,7 +1091,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_current(lua_State *L)
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					lua_pushinteger(L, stream->current());
@@ -1092,7 +1107,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_next(lua_State *L)
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					lua_pushboolean(L, stream->next());
@@ -1108,7 +1123,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_pos(lua_State *L)
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					lua_pushinteger(L, stream->pos());
@@ -1124,7 +1139,7 @@ namespace uvm
 			static int uvm_core_lib_Stream_reset_pos(lua_State *L)
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					stream->reset_pos();
@@ -1141,7 +1156,7 @@ namespace uvm
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
 				auto c = luaL_checkinteger(L, 2);
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					stream->push((char)c);
@@ -1158,7 +1173,7 @@ namespace uvm
 			{
 				auto stream = (UvmByteStream*)luaL_checkudata(L, 1, "UvmByteStream_metatable");
 				auto argstr = luaL_checkstring(L, 2);
-				if (uvm::lua::api::global_uvm_chain_api->is_object_in_pool(L, (intptr_t)stream,
+				if (uvm::lua::api::get_uvm_chain_api(L)->is_object_in_pool(L, (intptr_t)stream,
 					UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE)>0)
 				{
 					for(size_t i=0;i<strlen(argstr);++i)
@@ -1180,7 +1195,7 @@ namespace uvm
 			static int uvm_core_lib_Stream(lua_State *L)
             {
 				auto stream = new UvmByteStream();
-				uvm::lua::api::global_uvm_chain_api->register_object_in_pool(L, (intptr_t) stream, UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE);
+				uvm::lua::api::get_uvm_chain_api(L)->register_object_in_pool(L, (intptr_t) stream, UvmOutsideObjectTypes::OUTSIDE_STREAM_STORAGE_TYPE);
 				lua_pushlightuserdata(L, (void*) stream);
 				luaL_getmetatable(L, "UvmByteStream_metatable");
 				lua_setmetatable(L, -2);
@@ -1288,7 +1303,7 @@ namespace uvm
 						lua_pop(L, 1);
 						return 0;
 					}
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "attempt to update a read-only table!");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "attempt to update a read-only table!");
 					lua_pop(L, 2); // stack: t, k, v
 					return 0;
 				}
@@ -1313,7 +1328,7 @@ namespace uvm
             {
 				if(!lua_isstring(L, 2))
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "only string can be storage key");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "only string can be storage key");
 					L->force_stopping = true;
 					lua_pushnil(L);
 					return 1;
@@ -1353,7 +1368,7 @@ namespace uvm
             {
 				if (!lua_isstring(L, 2))
 				{
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "only string can be storage key");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "only string can be storage key");
 					L->force_stopping = true;
 					lua_pushnil(L);
 					return 1;
@@ -1380,7 +1395,7 @@ namespace uvm
 					uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_gas - 1);
 				}
 				if (lua_gettop(L) < 2 || !lua_isstring(L, 1) || !lua_isstring(L, 2)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of fast_map_get");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of fast_map_get");
 					L->force_stopping = true;
 					lua_pushnil(L);
 					return 1;
@@ -1402,7 +1417,7 @@ namespace uvm
 					uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_gas - 1);
 				}
 				if (lua_gettop(L) < 3 || !lua_isstring(L, 1) || !lua_isstring(L, 2)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of fast_map_set");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of fast_map_set");
 					L->force_stopping = true;
 					lua_pushnil(L);
 					return 1;
@@ -1519,7 +1534,7 @@ end
 					uvm::lua::lib::increment_lvm_instructions_executed_count(L, common_gas - 1);
 				}
 				if (lua_gettop(L) < 3 || !lua_isstring(L, 1) || !lua_isstring(L, 2) || !lua_istable(L, 3)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of send_message");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "invalid arguments of send_message");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -1533,7 +1548,7 @@ end
 				//import
 				lua_getglobal(L, "import_contract_from_address");
 				if (!lua_iscfunction(L, 4)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "no import_contract_from_address");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "no import_contract_from_address");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -1548,7 +1563,7 @@ end
 				//con_id,apiname,args,con_table,api_func
 
 				if (!lua_isfunction(L, 5)) {
-					uvm::lua::api::global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "no api funcion");
+					uvm::lua::api::get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "no api funcion");
 					L->force_stopping = true;
 					return 0;
 				}
@@ -1587,9 +1602,9 @@ end
 				
 				//get to call contract api args types
 				auto stored_contract_info = std::make_shared<UvmContractInfo>();
-				if (!global_uvm_chain_api->get_stored_contract_info_by_address(L, to_call_contract_id, stored_contract_info))
+				if (!get_uvm_chain_api(L)->get_stored_contract_info_by_address(L, to_call_contract_id, stored_contract_info))
 				{
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", to_call_contract_id);
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", to_call_contract_id);
 					L->force_stopping = true;
 					return 0;
 				}
@@ -1597,7 +1612,7 @@ end
 				bool check_arg_type = false;  //old gpc vesion, no arg_types info
 				if (stored_contract_info->contract_api_arg_types.size() > 0) {
 					if (stored_contract_info->contract_api_arg_types.find(api_name_str) == stored_contract_info->contract_api_arg_types.end()) {
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name_str.c_str());
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name_str.c_str());
 						L->force_stopping = true;
 						return 0;
 					}
@@ -1608,14 +1623,14 @@ end
 				//int input_args_num = args.size();
 				if (check_arg_type) { //new version
 					if (arg_types.size() != input_args_num) {
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "send_message to contract args num not match %d error", arg_types.size());
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "send_message to contract args num not match %d error", arg_types.size());
 						L->force_stopping = true;
 						return 0;
 					}
 				}
 				else {  //old gpc version,  conctract api accept only one arg
 					if (input_args_num != 1 && api_name_str != "init") {
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "send_message to contract old vesion gpc only accept 1 arg , but input %d args", input_args_num);
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "send_message to contract old vesion gpc only accept 1 arg , but input %d args", input_args_num);
 						L->force_stopping = true;
 						return 0;
 					}
@@ -1632,7 +1647,7 @@ end
 					//check arg type
 					if (check_arg_type) {
 						if (!isArgTypeMatched(arg_types[i], lua_type(L,-1))) {
-							global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "send message arg type not match ,api:%s args", api_name_str.c_str());
+							get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "send message arg type not match ,api:%s args", api_name_str.c_str());
 							L->force_stopping = true;
 							return 0;
 						}
@@ -1679,9 +1694,9 @@ end
 						uvm::lua::lib::set_lua_state_value(L, "exception_msg", val_msg, UvmStateValueType::LUA_STATE_VALUE_STRING);
 					}
 
-					if (global_uvm_chain_api->has_exception(L))
+					if (get_uvm_chain_api(L)->has_exception(L))
 					{
-						global_uvm_chain_api->clear_exceptions(L);
+						get_uvm_chain_api(L)->clear_exceptions(L);
 					}
 
 					L->allowhook = Lbak->allowhook;
@@ -1856,13 +1871,13 @@ end
 					lua_pop(L, 1);
                 }
 
-				
+				attach_state_profile(L);
                 return L;
             }
 
             bool commit_storage_changes(lua_State *L)
             {
-                if (!uvm::lua::api::global_uvm_chain_api->has_exception(L))
+                if (!uvm::lua::api::get_uvm_chain_api(L)->has_exception(L))
                 {
                     return luaL_commit_storage_changes(L);
                 }
@@ -1872,7 +1887,9 @@ end
             void close_lua_state(lua_State *L)
             {
                 //luaL_commit_storage_changes(L);
-				uvm::lua::api::global_uvm_chain_api->release_objects_in_pool(L);
+				const auto *executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+				close_state_profile(L, executed_count ? *executed_count : 0);
+				uvm::lua::api::get_uvm_chain_api(L)->release_objects_in_pool(L);
                 LStatesMap *states_map = get_lua_states_value_hashmap();
                 if (nullptr != states_map)
                 {
@@ -1929,6 +1946,14 @@ end
                         lua_free(L, list);
                     }
 
+                    UvmStateValueNode storage_read_cache_node = get_lua_state_value_node(L, LUA_STORAGE_READ_CACHE_KEY);
+                    if (storage_read_cache_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_read_cache_node.value.pointer_value)
+                    {
+                        UvmStorageReadCache *cache = (UvmStorageReadCache*)storage_read_cache_node.value.pointer_value;
+                        cache->~UvmStorageReadCache();
+                        lua_free(L, cache);
+                    }
+
 					int64_t *insts_executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
                     if (nullptr != insts_executed_count)
                     {
@@ -1940,6 +1965,7 @@ end
                         lua_free(L, stopped_pointer);
                     }
                     
+                    std::lock_guard<std::mutex> lock(states_map_mutex);
                     states_map->erase(L);
                 }
 
@@ -1952,14 +1978,17 @@ end
             void close_all_lua_state_values()
             {
                 LStatesMap *states_map = get_lua_states_value_hashmap();
+                std::lock_guard<std::mutex> lock(states_map_mutex);
                 states_map->clear();
             }
             void close_lua_state_values(lua_State *L)
             {
                 LStatesMap *states_map = get_lua_states_value_hashmap();
+                std::lock_guard<std::mutex> lock(states_map_mutex);
                 states_map->erase(L);
             }
 
+
             UvmStateValueNode get_lua_state_value_node(lua_State *L, const char *key)
             {
                 UvmStateValue nil_value = { 0 };
@@ -2200,7 +2229,8 @@ end
 				}
 			}
 
-            bool check_contract_proto(lua_State *L, uvm_types::GcProto *proto, char *error, std::list<uvm_types::GcProto*> *parents)
+            bool check_contract_proto(lua_State *L, uvm_types::GcProto *proto, char *error, std::list<uvm_types::GcProto*> *parents,
+                UvmVerifiedContractCode *verified)
             {
                 // for all sub function in proto, check whether the contract bytecode meet our provision
                 int i, proto_size = proto->ps.size();
@@ -2262,11 +2292,13 @@ end
 							if (idx_in_kst >= 0 && idx_in_kst < proto->ks.size())
 							{
 								const char *contract_name = getstr(tsvalue(&proto->ks[idx_in_kst]));
-								if (contract_name && !uvm::lua::api::global_uvm_chain_api->check_contract_exist(L, contract_name))
+								if (contract_name && !uvm::lua::api::get_uvm_chain_api(L)->check_contract_exist(L, contract_name))
 								{
 									lcompile_error_set(L, error, "Can't find contract %s", contract_name);
 									return false;
 								}
+								if (contract_name && verified)
+									verified->imported_contracts.push_back(contract_name);
 							}
 						}
 					}
@@ -2281,11 +2313,13 @@ end
 							if (idx_in_kst >= 0 && idx_in_kst < proto->ks.size())
 							{
 								const char *contract_address = getstr(tsvalue(&proto->ks[idx_in_kst]));
-								if (contract_address && !uvm::lua::api::global_uvm_chain_api->check_contract_exist_by_address(L, contract_address))
+								if (contract_address && !uvm::lua::api::get_uvm_chain_api(L)->check_contract_exist_by_address(L, contract_address))
 								{
 									lcompile_error_set(L, error, "Can't find contract address %s", contract_address);
 									return false;
 								}
+								if (contract_address && verified)
+									verified->imported_contract_addresses.push_back(contract_address);
 							}
 						}
 					}
@@ -2452,7 +2486,7 @@ end
                         }
                     }
                     sub_parents.push_back(proto);
-                    if (!check_contract_proto(L, proto->ps.at(i), error, &sub_parents)) {
+                    if (!check_contract_proto(L, proto->ps.at(i), error, &sub_parents, verified)) {
                         return false;
                     }
                 }
@@ -2624,7 +2658,7 @@ end
 					return LUA_ERRRUN;
                 memset(contract_address, 0x0, CONTRACT_ID_MAX_LENGTH + 1);
                 size_t address_size = 0;
-                uvm::lua::api::global_uvm_chain_api->get_contract_address_by_name(L, contract_name, contract_address, &address_size);
+                uvm::lua::api::get_uvm_chain_api(L)->get_contract_address_by_name(L, contract_name, contract_address, &address_size);
                 if (address_size > 0)
                 {
                     UvmStateValue value;
@@ -2703,6 +2737,7 @@ end
 
 			bool call_last_contract_api(lua_State* L, const std::string& contract_id, const std::string& api_name, cbor::CborArrayValue& args, const std::string& caller_address, const std::string& caller_pubkey, std::string* result_json_string) {
 				using uvm::lua::api::global_uvm_chain_api;
+				using uvm::lua::api::get_uvm_chain_api;
 				try {
 					lua_fill_contract_info_for_use(L);
 
@@ -2731,16 +2766,16 @@ end
 						
 						{ //push args ; check args  
 							auto stored_contract_info = std::make_shared<UvmContractInfo>();
-							if (!global_uvm_chain_api->get_stored_contract_info_by_address(L, contract_id.c_str(), stored_contract_info))
+							if (!get_uvm_chain_api(L)->get_stored_contract_info_by_address(L, contract_id.c_str(), stored_contract_info))
 							{
-								global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", contract_id.c_str());
+								get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "get_stored_contract_info_by_address %s error", contract_id.c_str());
 								return 0;
 							}
 							std::vector<UvmTypeInfoEnum> arg_types;
 							bool check_arg_type = false;  //old gpc vesion, no arg_types info
 							if (stored_contract_info->contract_api_arg_types.size() > 0) {
 								if (stored_contract_info->contract_api_arg_types.find(api_name) == stored_contract_info->contract_api_arg_types.end()) {
-									global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name.c_str());
+									get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "can't find api_arg_types %s error", api_name.c_str());
 									return 0;
 								}
 								check_arg_type = true; //new gpc version has arg_types, support muti args, try check
@@ -2749,13 +2784,13 @@ end
 							int input_args_num = args.size();
 							if (check_arg_type) { //new version
 								if (arg_types.size() != input_args_num) {
-									global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "args num not match %d error", arg_types.size());
+									get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "args num not match %d error", arg_types.size());
 									return 0;
 								}
 							}
 							else {  //old gpc version,  conctract api accept only one arg
 								if (input_args_num != 1) {
-									global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "old vesion gpc only accept 1 arg , but input %d args", input_args_num);
+									get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "old vesion gpc only accept 1 arg , but input %d args", input_args_num);
 									return 0;
 								}
 							}
@@ -2763,7 +2798,7 @@ end
 								const auto& arg = args[i];
 								//if (check_arg_type) {
 								//	if (!isArgTypeMatched(arg_types[i], arg->type)) {
-								//		global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "arg type not match ,api:%s args", api_name_str.c_str());
+								//		get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "arg type not match ,api:%s args", api_name_str.c_str());
 								//		return 0;
 								//	}
 								//}
@@ -2784,7 +2819,7 @@ end
 						int status = lua_pcall(L, 2, 1, 0);
 						if (status != LUA_OK)
 						{
-							global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "execute api %s contract error", api_name.c_str());
+							get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "execute api %s contract error", api_name.c_str());
 							return false;
 						}
 						lua_pop(L, 1);
@@ -2792,7 +2827,7 @@ end
 					}
 					else
 					{
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find api %s in this contract", api_name.c_str());
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find api %s in this contract", api_name.c_str());
 						lua_pop(L, 1);
 						return false;
 					}
@@ -2814,7 +2849,7 @@ end
 					return true;
 				}
 				catch (const std::exception& e) {
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, e.what());
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, e.what());
 					return false;
 				}
 			}
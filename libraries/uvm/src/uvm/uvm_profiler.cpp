@@ -0,0 +1,238 @@
+#include <uvm/uvm_profiler.h>
+#include <uvm/uvm_lib.h>
+#include <uvm/lobject.h>
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+namespace uvm
+{
+	namespace lua
+	{
+		namespace lib
+		{
+			bool parse_profile_metric(const std::string& name, UvmProfileMetric& metric)
+			{
+				static const std::map<std::string, UvmProfileMetric> metrics = {
+					{ "instructions", UvmProfileMetric::instructions },
+					{ "gas", UvmProfileMetric::gas },
+					{ "wall_time", UvmProfileMetric::wall_time },
+					{ "storage_reads", UvmProfileMetric::storage_reads },
+					{ "storage_writes", UvmProfileMetric::storage_writes }
+				};
+				auto it = metrics.find(name);
+				if (it == metrics.end())
+					return false;
+				metric = it->second;
+				return true;
+			}
+
+			int64_t UvmProfileCounters::get(UvmProfileMetric metric) const
+			{
+				switch (metric)
+				{
+				case UvmProfileMetric::instructions: return instructions;
+				case UvmProfileMetric::gas: return gas;
+				case UvmProfileMetric::wall_time: return wall_time;
+				case UvmProfileMetric::storage_reads: return storage_reads;
+				case UvmProfileMetric::storage_writes: return storage_writes;
+				default: return 0;
+				}
+			}
+
+			void UvmProfileCounters::add(const UvmProfileCounters& other)
+			{
+				instructions += other.instructions;
+				gas += other.gas;
+				wall_time += other.wall_time;
+				storage_reads += other.storage_reads;
+				storage_writes += other.storage_writes;
+			}
+
+			void UvmProfiler::merge(const std::map<std::string, UvmProfileCounters>& stacks)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				for (const auto& p : stacks)
+					_stacks[p.first].add(p.second);
+			}
+
+			void UvmProfiler::reset()
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stacks.clear();
+			}
+
+			std::string UvmProfiler::collapsed(UvmProfileMetric metric) const
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				std::stringstream ss;
+				for (const auto& p : _stacks)
+				{
+					auto count = p.second.get(metric);
+					if (count != 0)
+						ss << p.first << " " << count << "\n";
+				}
+				return ss.str();
+			}
+
+			static std::atomic<bool> node_profiling_enabled(false);
+			static thread_local std::shared_ptr<UvmProfiler> scoped_profiler;
+
+			std::shared_ptr<UvmProfiler> node_profiler()
+			{
+				static std::shared_ptr<UvmProfiler> profiler = std::make_shared<UvmProfiler>();
+				return profiler;
+			}
+
+			void set_node_profiling_enabled(bool enabled)
+			{
+				node_profiling_enabled = enabled;
+			}
+
+			bool is_node_profiling_enabled()
+			{
+				return node_profiling_enabled;
+			}
+
+			UvmProfilerScope::UvmProfilerScope(std::shared_ptr<UvmProfiler> profiler)
+				: _previous(scoped_profiler)
+			{
+				scoped_profiler = profiler;
+			}
+
+			UvmProfilerScope::~UvmProfilerScope()
+			{
+				scoped_profiler = _previous;
+			}
+
+			UvmStateProfile::UvmStateProfile(std::shared_ptr<UvmProfiler> profiler)
+				: _profiler(profiler), _last_time(std::chrono::steady_clock::now())
+			{
+			}
+
+			void UvmStateProfile::charge(std::chrono::steady_clock::time_point now, int64_t executed_count)
+			{
+				if (_current)
+				{
+					_current->gas += executed_count - _last_count;
+					_current->wall_time += std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last_time).count();
+				}
+				_last_count = executed_count;
+				_last_time = now;
+			}
+
+			uint32_t UvmStateProfile::frame_id(const std::string& name)
+			{
+				auto it = _frame_ids.find(name);
+				if (it != _frame_ids.end())
+					return it->second;
+				auto id = static_cast<uint32_t>(_frame_names.size());
+				_frame_names.push_back(name);
+				_frame_ids[name] = id;
+				return id;
+			}
+
+			uint32_t UvmStateProfile::proto_frame_id(const uvm_types::GcProto *proto)
+			{
+				auto it = _proto_frame_ids.find(proto);
+				if (it != _proto_frame_ids.end())
+					return it->second;
+				std::string name = proto->source ? proto->source->value : std::string("?");
+				name += ":" + std::to_string(proto->linedefined);
+				auto id = frame_id(name);
+				_proto_frame_ids[proto] = id;
+				return id;
+			}
+
+			void UvmStateProfile::enter_stack(lua_State *L, CallInfo *ci)
+			{
+				_stack.clear();
+				for (auto frame = ci; frame; frame = frame->previous)
+				{
+					if (ttisLclosure(frame->func))
+						_stack.push_back(proto_frame_id(clLvalue(frame->func)->p));
+				}
+				auto contract_id = get_current_using_contract_id(L);
+				_stack.push_back(frame_id(contract_id.empty() ? std::string("uvm") : contract_id));
+				std::reverse(_stack.begin(), _stack.end());
+			}
+
+			void UvmStateProfile::on_instruction(lua_State *L, CallInfo *ci, int64_t executed_count)
+			{
+				charge(std::chrono::steady_clock::now(), executed_count);
+				auto proto = clLvalue(ci->func)->p;
+				auto pc = ci->u.l.savedpc - 1 - proto->codes.data();
+				int line = (pc >= 0 && static_cast<size_t>(pc) < proto->lineinfos.size()) ? proto->lineinfos[pc] : 0;
+				bool stack_changed = ci != _last_ci || proto != _last_proto;
+				if (stack_changed)
+				{
+					enter_stack(L, ci);
+					_last_ci = ci;
+					_last_proto = proto;
+				}
+				if (stack_changed || line != _last_line || !_current)
+				{
+					std::vector<uint32_t> key(_stack);
+					key.push_back(static_cast<uint32_t>(line));
+					_current = &_counters[key];
+					_last_line = line;
+				}
+				_current->instructions += 1;
+			}
+
+			void UvmStateProfile::on_storage_read()
+			{
+				if (_current)
+					_current->storage_reads += 1;
+			}
+
+			void UvmStateProfile::on_storage_write()
+			{
+				if (_current)
+					_current->storage_writes += 1;
+			}
+
+			void UvmStateProfile::flush(int64_t executed_count)
+			{
+				charge(std::chrono::steady_clock::now(), executed_count);
+				std::map<std::string, UvmProfileCounters> stacks;
+				for (const auto& p : _counters)
+				{
+					std::string stack;
+					for (size_t i = 0; i + 1 < p.first.size(); ++i)
+					{
+						auto name = _frame_names[p.first[i]];
+						// ';' separates the frames of a collapsed stack
+						std::replace(name.begin(), name.end(), ';', '_');
+						stack += name + ";";
+					}
+					stack += "line:" + std::to_string(p.first.back());
+					stacks[stack].add(p.second);
+				}
+				_profiler->merge(stacks);
+				_counters.clear();
+				_current = nullptr;
+				_last_ci = nullptr;
+				_last_proto = nullptr;
+			}
+
+			void attach_state_profile(lua_State *L)
+			{
+				auto profiler = scoped_profiler;
+				if (!profiler && is_node_profiling_enabled())
+					profiler = node_profiler();
+				if (profiler)
+					L->profile = new UvmStateProfile(profiler);
+			}
+
+			void close_state_profile(lua_State *L, int64_t executed_count)
+			{
+				if (!L->profile)
+					return;
+				L->profile->flush(executed_count);
+				delete L->profile;
+				L->profile = nullptr;
+			}
+		}
+	}
+}
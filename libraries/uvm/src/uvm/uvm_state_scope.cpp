@@ -30,6 +30,7 @@
 #include <uvm/lualib.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 namespace uvm
 {
@@ -152,7 +153,7 @@ namespace uvm
             }
             int UvmStateScope::check_uvm_contract_api_instructions_over_limit()
             {
-                return global_uvm_chain_api->check_contract_api_instructions_over_limit(_L);
+                return get_uvm_chain_api(_L)->check_contract_api_instructions_over_limit(_L);
             }
 
             void UvmStateScope::notify_stop()
@@ -7,13 +7,16 @@
 #include <unordered_map>
 #include <memory>
 #include <set>
+#include <algorithm>
 
 #include <uvm/uvm_storage.h>
 #include <jsondiff/jsondiff.h>
 #include <jsondiff/exceptions.h>
 #include <uvm/uvm_lib.h>
+#include <uvm/uvm_profiler.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 static UvmStorageTableReadList *get_or_init_storage_table_read_list(lua_State *L)
 {
@@ -36,6 +39,120 @@ static UvmStorageTableReadList *get_or_init_storage_table_read_list(lua_State *L
 	return list;
 }
 
+static UvmStorageReadCache *get_or_init_storage_read_cache(lua_State *L)
+{
+	UvmStateValueNode state_value_node = uvm::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_READ_CACHE_KEY);
+	UvmStorageReadCache *cache = nullptr;
+	if (state_value_node.type != LUA_STATE_VALUE_POINTER || nullptr == state_value_node.value.pointer_value)
+	{
+		cache = (UvmStorageReadCache*)lua_malloc(L, sizeof(UvmStorageReadCache));
+		if (!cache)
+			return nullptr;
+		new (cache)UvmStorageReadCache();
+		UvmStateValue value_to_store;
+		value_to_store.pointer_value = cache;
+		uvm::lua::lib::set_lua_state_value(L, LUA_STORAGE_READ_CACHE_KEY, value_to_store, LUA_STATE_VALUE_POINTER);
+	}
+	else
+	{
+		cache = (UvmStorageReadCache*)state_value_node.value.pointer_value;
+	}
+	return cache;
+}
+
+static std::string global_key_for_storage_prop(const std::string& contract_id, const std::string& key, const std::string& fast_map_key, bool is_fast_map);
+
+std::string UvmStorageChangeList::property_key(const std::string& contract_id, const std::string& key,
+	const std::string& fast_map_key, bool is_fast_map)
+{
+	// lengths keep the parts apart, whatever characters they have
+	return std::to_string(contract_id.size()) + ":" + contract_id + std::to_string(key.size()) + ":" + key
+		+ std::to_string(fast_map_key.size()) + ":" + fast_map_key + (is_fast_map ? "1" : "0");
+}
+
+void UvmStorageChangeList::push_back(const UvmStorageChangeItem& item)
+{
+	base_type::push_back(item);
+	_changes_by_property[property_key(item.contract_id, item.key, item.fast_map_key, item.is_fast_map)].push_back(&base_type::back());
+}
+
+void UvmStorageChangeList::forget(const UvmStorageChangeItem& item, bool last)
+{
+	auto found = _changes_by_property.find(property_key(item.contract_id, item.key, item.fast_map_key, item.is_fast_map));
+	if (found == _changes_by_property.end())
+		return;
+	if (last)
+		found->second.pop_back();
+	else
+		found->second.pop_front();
+	if (found->second.empty())
+		_changes_by_property.erase(found);
+}
+
+void UvmStorageChangeList::pop_back()
+{
+	forget(base_type::back(), true);
+	base_type::pop_back();
+}
+
+void UvmStorageChangeList::pop_front()
+{
+	forget(base_type::front(), false);
+	base_type::pop_front();
+}
+
+void UvmStorageChangeList::clear()
+{
+	_changes_by_property.clear();
+	base_type::clear();
+}
+
+const UvmStorageChangeList::property_changes* UvmStorageChangeList::find_all(const std::string& contract_id, const std::string& key,
+	const std::string& fast_map_key, bool is_fast_map) const
+{
+	auto found = _changes_by_property.find(property_key(contract_id, key, fast_map_key, is_fast_map));
+	return found != _changes_by_property.end() ? &found->second : nullptr;
+}
+
+const UvmStorageChangeItem* UvmStorageChangeList::find_last(const std::string& contract_id, const std::string& key,
+	const std::string& fast_map_key, bool is_fast_map) const
+{
+	auto changes = find_all(contract_id, key, fast_map_key, is_fast_map);
+	return changes ? changes->back() : nullptr;
+}
+
+// callers may change the table of a read value, so the cache hands out copies of its tables
+static struct UvmStorageValue copy_storage_value(lua_State *L, const UvmStorageValue &value)
+{
+	if (!lua_storage_is_table(value.type) || nullptr == value.value.table_value)
+		return value;
+	UvmStorageValue result = value;
+	result.value.table_value = uvm::lua::lib::create_managed_lua_table_map(L);
+	for (const auto &p : *value.value.table_value)
+	{
+		result.value.table_value->insert(std::make_pair(p.first, copy_storage_value(L, p.second)));
+	}
+	return result;
+}
+
+// chain storage doesn't change while a lua_State is executing(changes are only committed after execution,
+// and luaL_commit_storage_changes clears the cache), so the decoded value of each storage property
+// only need to be read from chain once
+static struct UvmStorageValue read_storage_value_from_chain(lua_State *L, const char *contract_id,
+	const std::string &key, const std::string& fast_map_key, bool is_fast_map)
+{
+	UvmStorageReadCache *cache = get_or_init_storage_read_cache(L);
+	if (!cache)
+		return get_uvm_chain_api(L)->get_storage_value_from_uvm_by_address(L, contract_id, key, fast_map_key, is_fast_map);
+	const auto &cache_key = global_key_for_storage_prop(contract_id, key, is_fast_map ? fast_map_key : "", is_fast_map);
+	auto found = cache->find(cache_key);
+	if (found != cache->end())
+		return copy_storage_value(L, found->second);
+	auto value = get_uvm_chain_api(L)->get_storage_value_from_uvm_by_address(L, contract_id, key, fast_map_key, is_fast_map);
+	cache->insert(std::make_pair(cache_key, value));
+	return copy_storage_value(L, value);
+}
+
 static struct UvmStorageValue get_last_storage_changed_value(lua_State *L, const char *contract_id,
 	UvmStorageChangeList *list, const std::string &key, const std::string& fast_map_key, bool is_fast_map)
 {
@@ -49,13 +166,8 @@ static struct UvmStorageValue get_last_storage_changed_value(lua_State *L, const
 			UvmStorageTableReadList *table_read_list = get_or_init_storage_table_read_list(L);
 			if (table_read_list)
 			{
-				for (auto it = table_read_list->begin(); it != table_read_list->end(); ++it)
-				{
-					if (it->contract_id == contract_id_str && it->key == key && it->fast_map_key==fast_map_key && it->is_fast_map == is_fast_map)
-					{
-						return;
-					}
-				}
+				if (table_read_list->find_last(contract_id_str, key, fast_map_key, is_fast_map))
+					return;
 				UvmStorageChangeItem change_item;
 				change_item.contract_id = contract_id_str;
 				change_item.key = key;
@@ -68,7 +180,7 @@ static struct UvmStorageValue get_last_storage_changed_value(lua_State *L, const
 	};
 	if (!list || list->size() < 1)
 	{
-		auto value = global_uvm_chain_api->get_storage_value_from_uvm_by_address(L, contract_id, key, fast_map_key, is_fast_map);
+		auto value = read_storage_value_from_chain(L, contract_id, key, fast_map_key, is_fast_map);
 		post_when_read_table(value);
 		// cache the value if it's the first time to read
 		if (!list) {
@@ -92,12 +204,10 @@ static struct UvmStorageValue get_last_storage_changed_value(lua_State *L, const
 
 		return value;
 	}
-	for (auto it = list->rbegin(); it != list->rend(); ++it)
-	{
-		if (it->contract_id == contract_id_str && it->key == key && it->fast_map_key==fast_map_key && it->is_fast_map == is_fast_map)
-			return it->after;
-	}
-	auto value = global_uvm_chain_api->get_storage_value_from_uvm_by_address(L, contract_id, key, fast_map_key, is_fast_map);
+	auto last_change = list->find_last(contract_id_str, key, fast_map_key, is_fast_map);
+	if (last_change)
+		return last_change->after;
+	auto value = read_storage_value_from_chain(L, contract_id, key, fast_map_key, is_fast_map);
 	post_when_read_table(value);
 	return value;
 }
@@ -342,6 +452,73 @@ cbor::CborObjectP uvm_storage_value_to_cbor(UvmStorageValue value) {
 	}
 }
 
+void uvm_storage_value_write_cbor(cbor::encoder &encoder, const UvmStorageValue &value) {
+	switch (value.type)
+	{
+	case uvm::blockchain::StorageValueTypes::storage_value_null:
+		encoder.write_null();
+		return;
+	case uvm::blockchain::StorageValueTypes::storage_value_bool:
+		encoder.write_bool(value.value.bool_value);
+		return;
+	case uvm::blockchain::StorageValueTypes::storage_value_int:
+		encoder.write_int((int64_t)value.value.int_value);
+		return;
+	case uvm::blockchain::StorageValueTypes::storage_value_number:
+		encoder.write_float64(value.value.number_value);
+		return;
+	case uvm::blockchain::StorageValueTypes::storage_value_string:
+		encoder.write_string(value.value.string_value, (unsigned int)strlen(value.value.string_value));
+		return;
+	case uvm::blockchain::StorageValueTypes::storage_value_bool_array:
+	case uvm::blockchain::StorageValueTypes::storage_value_int_array:
+	case uvm::blockchain::StorageValueTypes::storage_value_number_array:
+	case uvm::blockchain::StorageValueTypes::storage_value_string_array:
+	case uvm::blockchain::StorageValueTypes::storage_value_unknown_array:
+	{
+		encoder.write_array((int)value.value.table_value->size());
+		for (const auto &p : *value.value.table_value)
+		{
+			uvm_storage_value_write_cbor(encoder, p.second);
+		}
+		return;
+	}
+	case uvm::blockchain::StorageValueTypes::storage_value_bool_table:
+	case uvm::blockchain::StorageValueTypes::storage_value_int_table:
+	case uvm::blockchain::StorageValueTypes::storage_value_number_table:
+	case uvm::blockchain::StorageValueTypes::storage_value_string_table:
+	case uvm::blockchain::StorageValueTypes::storage_value_unknown_table:
+	{
+		// a table is ordered by key length first, a cbor map by key
+		std::vector<const UvmTableMap::value_type*> items;
+		items.reserve(value.value.table_value->size());
+		for (const auto &p : *value.value.table_value)
+		{
+			items.push_back(&p);
+		}
+		std::sort(items.begin(), items.end(), [](const UvmTableMap::value_type *a, const UvmTableMap::value_type *b) {
+			return a->first < b->first;
+		});
+		encoder.write_map((int)items.size());
+		for (const auto *p : items)
+		{
+			encoder.write_string(p->first);
+			uvm_storage_value_write_cbor(encoder, p->second);
+		}
+		return;
+	}
+	default:
+		throw cbor::CborException("not supported cbor value type");
+	}
+}
+
+std::vector<char> uvm_storage_value_to_cbor_bytes(const UvmStorageValue &value) {
+	cbor::output_dynamic output;
+	cbor::encoder encoder(output);
+	uvm_storage_value_write_cbor(encoder, value);
+	return output.chars();
+}
+
 jsondiff::JsonValue uvm_storage_value_to_json(UvmStorageValue value)
 {
 	switch (value.type)
@@ -507,41 +684,6 @@ UvmStorageValue json_to_uvm_storage_value(lua_State *L, jsondiff::JsonValue json
 	}
 }
 
-static UvmStorageChangeItem diff_storage_change_if_is_table(lua_State *L, UvmStorageChangeItem change_item, bool use_cbor_diff)
-{
-	if (!lua_storage_is_table(change_item.after.type))
-		return change_item;
-	if (!lua_storage_is_table(change_item.before.type) || !lua_storage_is_table(change_item.after.type))
-		return change_item;
-	try
-	{
-		if (use_cbor_diff) {
-			const auto &before_cbor = uvm_storage_value_to_cbor(change_item.before);
-			const auto &after_cbor = uvm_storage_value_to_cbor(change_item.after);
-			cbor_diff::CborDiff differ;
-			const auto &diff = differ.diff(before_cbor, after_cbor);
-			change_item.cbor_diff = *diff;
-		}
-		else {
-			const auto &before_json = uvm_storage_value_to_json(change_item.before);
-			const auto &after_json = uvm_storage_value_to_json(change_item.after);
-			jsondiff::JsonDiff json_diff;
-			const auto &diff_json = json_diff.diff(before_json, after_json);
-			change_item.diff = *diff_json;
-		}
-	}
-	catch (jsondiff::JsonDiffException& e)
-	{
-		return change_item; // FIXME: throw error
-	}
-	catch (cbor_diff::CborDiffException& e) {
-		return change_item;
-	}
-	catch (...) {
-		return change_item;
-	}
-	return change_item;
-}
 static bool has_property_changed_in_changelist(UvmStorageChangeList *list, std::string contract_id, std::string name)
 {
 	if (nullptr == list)
@@ -558,8 +700,15 @@ static bool has_property_changed_in_changelist(UvmStorageChangeList *list, std::
 
 bool luaL_commit_storage_changes(lua_State *L)
 {
+	// committed changes are visible to later reads from chain
+	UvmStateValueNode storage_read_cache_node = uvm::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_READ_CACHE_KEY);
+	if (storage_read_cache_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_read_cache_node.value.pointer_value)
+	{
+		UvmStorageReadCache *cache = (UvmStorageReadCache*)storage_read_cache_node.value.pointer_value;
+		cache->clear();
+	}
 	UvmStateValueNode storage_changelist_node = uvm::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_CHANGELIST_KEY);
-	if (global_uvm_chain_api->has_exception(L))
+	if (get_uvm_chain_api(L)->has_exception(L))
 	{
 		if (storage_changelist_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_changelist_node.value.pointer_value)
 		{
@@ -568,7 +717,6 @@ bool luaL_commit_storage_changes(lua_State *L)
 		}
 		return false;
 	}
-	auto use_cbor_diff = global_uvm_chain_api->use_cbor_diff(L);
 	// merge changes
 	std::unordered_map<std::string, std::shared_ptr<std::unordered_map<std::string, UvmStorageChangeItem>>> changes; // contract_id => (storage_unique_key => change_item)
 	UvmStorageTableReadList *table_read_list = get_or_init_storage_table_read_list(L);
@@ -594,8 +742,8 @@ bool luaL_commit_storage_changes(lua_State *L)
 		bool mod_change_list = false;
 		int64_t mod_change_list_fork_height = -1;
 		if (global_uvm_chain_api) { //list->size()>0 ???
-			mod_change_list_fork_height = global_uvm_chain_api->get_fork_height(L, "MOD_CHANGE_LIST");
-			if (global_uvm_chain_api->get_header_block_num_without_gas(L) >= mod_change_list_fork_height) {
+			mod_change_list_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "MOD_CHANGE_LIST");
+			if (get_uvm_chain_api(L)->get_header_block_num_without_gas(L) >= mod_change_list_fork_height) {
 				mod_change_list = true;
 				//fix bug, remove first null val
 				if (list->size() > 0) {
@@ -641,7 +789,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 			UvmStorageChangeItem change_item = *it;
 			const auto& change_item_full_key = change_item.full_key();
 			if (!mod_change_list) {
-				if (global_uvm_chain_api->use_fast_map_set_nil(L)) {
+				if (get_uvm_chain_api(L)->use_fast_map_set_nil(L)) {
 					if (change_item.is_fast_map && null_keys_changed.find(change_item_full_key) != null_keys_changed.end())
 						continue;
 				}
@@ -682,19 +830,19 @@ bool luaL_commit_storage_changes(lua_State *L)
 		&& changes.size() == 0)
 	{
 		auto starting_contract_address = uvm::lua::lib::get_starting_contract_address(L);
-		auto stream = global_uvm_chain_api->open_contract_by_address(L, starting_contract_address.c_str());
+		auto stream = get_uvm_chain_api(L)->open_contract_by_address(L, starting_contract_address.c_str());
 		if (stream && stream->contract_storage_properties.size() > 0)
 		{
-			global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "some storage of this contract not init");
+			get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "some storage of this contract not init");
 			return false;
 		}
 	}
 	for (auto it = changes.begin(); it != changes.end(); ++it)
 	{
-		auto stream = global_uvm_chain_api->open_contract_by_address(L, it->first.c_str());
+		auto stream = get_uvm_chain_api(L)->open_contract_by_address(L, it->first.c_str());
 		if (!stream)
 		{
-			global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't get contract info by contract address %s", it->first.c_str());
+			get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't get contract info by contract address %s", it->first.c_str());
 			return false;
 		}
 		bool is_in_starting_contract_init = false;
@@ -707,7 +855,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 				const auto &storage_properties_in_chain = stream->contract_storage_properties;
 				/*if (it->second->size() != storage_properties_in_chain.size())
 				{
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "some storage of this contract not init");
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "some storage of this contract not init");
 					return false;
 				}*/
 				for (auto &p1 : *(it->second))
@@ -718,7 +866,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 					}
 					if (storage_properties_in_chain.find(p1.second.key) == storage_properties_in_chain.end())
 					{
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find storage %s", p1.second.key.c_str());
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "Can't find storage %s", p1.second.key.c_str());
 						return false;
 					}
 					auto storage_info_in_chain = storage_properties_in_chain.at(p1.second.key);
@@ -729,7 +877,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 						if (!uvm::blockchain::is_any_table_storage_value_type(storage_info_in_chain)
 							&& !uvm::blockchain::is_any_array_storage_value_type(storage_info_in_chain))
 						{
-							global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", p1.second.key.c_str());
+							get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", p1.second.key.c_str());
 							return false;
 						}
 						if (p1.second.after.value.table_value->size()>0)
@@ -741,7 +889,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 							auto item_after = p1.second.after.value.table_value->begin()->second;
 							if (item_after.type != uvm::blockchain::get_item_type_in_table_or_array(storage_info_in_chain))
 							{
-								global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", p1.second.key.c_str());
+								get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", p1.second.key.c_str());
 								return false;
 							}
 						}
@@ -777,8 +925,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 					it2->second.after.type = it2->second.before.type;
 				else if (lua_storage_is_table(it2->second.before.type) && it2->second.before.value.table_value->size()>0)
 					it2->second.after.type = it2->second.before.type;
-				// just save table diff
-				it2->second = diff_storage_change_if_is_table(L, it2->second, use_cbor_diff);
+				// the chain api diffs the tables it commits, from before and after
 			}
 			// check storage changes and the corresponding types of compile-time contracts, and modify the type of commit
 			if (!is_in_starting_contract_init)
@@ -795,7 +942,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 						if (!uvm::blockchain::is_any_table_storage_value_type(storage_info_in_chain)
 							&& !uvm::blockchain::is_any_array_storage_value_type(storage_info_in_chain))
 						{
-							global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", it2->first.c_str());
+							get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", it2->first.c_str());
 							return false;
 						}
 						if (it2->second.after.value.table_value->size() > 0)
@@ -807,7 +954,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 							auto item_after = it2->second.after.value.table_value->begin()->second;
 							if (item_after.type != uvm::blockchain::get_item_type_in_table_or_array(storage_info_in_chain))
 							{
-								global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", it2->first.c_str());
+								get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage %s type not matched in chain", it2->first.c_str());
 								return false;
 							}
 						}
@@ -847,7 +994,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 					is_first = true;
 					if (!UvmStorageValue::is_same_base_type_with_type_parse(p.second.type, item_value_type))
 					{
-						global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR,
+						get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR,
 							"array/map's value type must be same in contract storage");
 						return false;
 					}
@@ -912,7 +1059,7 @@ bool luaL_commit_storage_changes(lua_State *L)
 		printf("commit storage changes in sandbox\n");
 		return false;
 	}
-	auto result = global_uvm_chain_api->commit_storage_changes_to_uvm(L, changes);
+	auto result = get_uvm_chain_api(L)->commit_storage_changes_to_uvm(L, changes);
 	if (storage_changelist_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_changelist_node.value.pointer_value)
 	{
 		UvmStorageChangeList *list = (UvmStorageChangeList*)storage_changelist_node.value.pointer_value;
@@ -929,11 +1076,13 @@ namespace uvm {
 			const char *contract_id, const char *name, const char* fast_map_key, bool is_fast_map)
 		{
 			uvm::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
+			if (L->profile)
+				L->profile->on_storage_read();
 
 			const auto &code_storage_contract_id = get_contract_id_string_in_storage_operation(L);
 			/*if (code_storage_contract_id != contract_id)
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can only access its own storage directly");
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can only access its own storage directly");
 				uvm::lua::lib::notify_lua_state_stop(L);
 				L->force_stopping = true;
 				return 0;
@@ -986,10 +1135,12 @@ namespace uvm {
 		int uvmlib_set_storage_impl(lua_State *L,
 			const char *contract_id, const char *name, const char* fast_map_key, bool is_fast_map, int value_index)
 		{
+			if (L->profile)
+				L->profile->on_storage_write();
 			const auto &code_storage_contract_id = get_contract_id_string_in_storage_operation(L);
 			/*if (code_storage_contract_id != contract_id)
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can only access its own storage directly");
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "contract can only access its own storage directly");
 				uvm::lua::lib::notify_lua_state_stop(L);
 				L->force_stopping = true;
 				return 0;
@@ -997,14 +1148,14 @@ namespace uvm {
 			contract_id = code_storage_contract_id.c_str(); // storageĳֻõǰںԼ
 			auto contract_id_stack = uvm::lua::lib::get_using_contract_id_stack(L, true);
 			if (contract_id_stack && contract_id_stack->size()>0 && contract_id_stack->top().call_type == "STATIC_CALL") {
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "static call can not modify contract storage");
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "static call can not modify contract storage");
 				uvm::lua::lib::notify_lua_state_stop(L);
 				L->force_stopping = true;
 				return 0;
 			}
 			if (!name || strlen(name) < 1)
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "second argument of set_storage must be name");
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "second argument of set_storage must be name");
 				return 0;
 			}
 			std::string fast_map_key_str = fast_map_key ? fast_map_key : "";
@@ -1022,16 +1173,7 @@ namespace uvm {
 				auto *table_read_list = get_or_init_storage_table_read_list(L);
 				if (table_read_list)
 				{
-					bool found = false;
-					for (auto it = table_read_list->begin(); it != table_read_list->end(); ++it)
-					{
-						if (it->contract_id == std::string(contract_id) && it->key == name && it->fast_map_key== fast_map_key_str && it->is_fast_map==is_fast_map)
-						{
-							found = true;
-							break;
-						}
-					}
-					if (!found)
+					if (!table_read_list->find_last(contract_id, name, fast_map_key_str, is_fast_map))
 					{
 						UvmStorageChangeItem change_item;
 						change_item.contract_id = contract_id;
@@ -1048,7 +1190,7 @@ namespace uvm {
 			/*
 			if (arg2.type >= LVALUE_NOT_SUPPORT)
 			{
-			global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "third argument of set_storage must be value");
+			get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "third argument of set_storage must be value");
 			return 0;
 			}
 			*/
@@ -1082,14 +1224,14 @@ namespace uvm {
 			auto after = arg2;
 			if (!is_fast_map && after.type == uvm::blockchain::StorageValueTypes::storage_value_null)
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, (name_str + " storage can't change to nil").c_str());
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, (name_str + " storage can't change to nil").c_str());
 				uvm::lua::lib::notify_lua_state_stop(L);
 				return 0;
 			}
 			if (!is_fast_map && (before.type != uvm::blockchain::StorageValueTypes::storage_value_null
 				&& (before.type != after.type && !lua_storage_is_table(before.type))))
 			{
-				global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, (std::string(name) + " storage can't change type").c_str());
+				get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, (std::string(name) + " storage can't change type").c_str());
 				uvm::lua::lib::notify_lua_state_stop(L);
 				return 0;
 			}
@@ -1097,8 +1239,8 @@ namespace uvm {
 			if (is_fast_map && (after.type == uvm::blockchain::StorageValueTypes::storage_value_null)
 				&& (lua_storage_is_table(before.type))) {
 				if (global_uvm_chain_api) { 
-					int64_t mod_change_list_fork_height = global_uvm_chain_api->get_fork_height(L, "MOD_CHANGE_LIST");
-					if (global_uvm_chain_api->get_header_block_num_without_gas(L) >= mod_change_list_fork_height) {
+					int64_t mod_change_list_fork_height = get_uvm_chain_api(L)->get_fork_height(L, "MOD_CHANGE_LIST");
+					if (get_uvm_chain_api(L)->get_header_block_num_without_gas(L) >= mod_change_list_fork_height) {
 						// has been added to table_read_list when get_last_storage_changed_value
 						//set val
 						lua_pushvalue(L, value_index);
@@ -1114,7 +1256,7 @@ namespace uvm {
 			{
 				if (!is_fast_map) {
 					// when not in init api
-					global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, (std::string(name) + "storage can't register storage after inited").c_str());
+					get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, (std::string(name) + "storage can't register storage after inited").c_str());
 					uvm::lua::lib::notify_lua_state_stop(L);
 					return 0;
 				}
@@ -1130,7 +1272,7 @@ namespace uvm {
 					{
 						if (lua_storage_is_table(it->second.type))
 						{
-							global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage not support nested map");
+							get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage not support nested map");
 							uvm::lua::lib::notify_lua_state_stop(L);
 							return 0;
 						}
@@ -1158,7 +1300,7 @@ namespace uvm {
 							{
 								if (table_value_type != it->second.type)
 								{
-									global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
+									get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
 									uvm::lua::lib::notify_lua_state_stop(L);
 									return 0;
 								}
@@ -1178,7 +1320,7 @@ namespace uvm {
 						{
 							if (table_value_type != it->second.type)
 							{
-								global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
+								get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
 								uvm::lua::lib::notify_lua_state_stop(L);
 								return 0;
 							}
@@ -1188,22 +1330,21 @@ namespace uvm {
 				if ((!lua_storage_is_table(before.type) || before.value.table_value->size() < 1) && after.value.table_value->size() > 0)
 				{
 					// if before table is empty and after table not empty, search type before
-					for (auto it = list->begin(); it != list->end(); ++it)
+					auto property_changes = list->find_all(contract_id, name, fast_map_key_str, is_fast_map);
+					for (size_t i = 0; property_changes && i < property_changes->size(); ++i)
 					{
-						if (it->contract_id == std::string(contract_id) && it->key == std::string(name) && it->fast_map_key==fast_map_key_str && it->is_fast_map==is_fast_map)
+						const UvmStorageChangeItem *it = (*property_changes)[i];
+						if (lua_storage_is_table(it->after.type) && it->after.value.table_value->size() > 0)
 						{
-							if (lua_storage_is_table(it->after.type) && it->after.value.table_value->size() > 0)
+							for (auto it2 = it->after.value.table_value->begin(); it2 != it->after.value.table_value->end(); ++it2)
 							{
-								for (auto it2 = it->after.value.table_value->begin(); it2 != it->after.value.table_value->end(); ++it2)
+								if (it2->second.type != uvm::blockchain::StorageValueTypes::storage_value_null)
 								{
-									if (it2->second.type != uvm::blockchain::StorageValueTypes::storage_value_null)
+									if (it2->second.type != table_value_type)
 									{
-										if (it2->second.type != table_value_type)
-										{
-											global_uvm_chain_api->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
-											uvm::lua::lib::notify_lua_state_stop(L);
-											return 0;
-										}
+										get_uvm_chain_api(L)->throw_exception(L, UVM_API_SIMPLE_ERROR, "storage table type must be same");
+										uvm::lua::lib::notify_lua_state_stop(L);
+										return 0;
 									}
 								}
 							}
@@ -5,6 +5,7 @@
 #include <uvm/exceptions.h>
 
 using uvm::lua::api::global_uvm_chain_api;
+using uvm::lua::api::get_uvm_chain_api;
 
 namespace uvm
 {
@@ -462,14 +463,14 @@ namespace uvm
 					}
 					else 
 					{
-                        global_uvm_chain_api->throw_exception(_L, UVM_API_COMPILE_ERROR, std::string("too long token").c_str());
+                        get_uvm_chain_api(_L)->throw_exception(_L, UVM_API_COMPILE_ERROR, std::string("too long token").c_str());
 						return;
 					}
                 }
                 switch (_current_char(code))
                 {
                 case EOF_TOKEN_CHAR:
-                    global_uvm_chain_api->throw_exception(_L, UVM_API_COMPILE_ERROR, "undefined long %s (starting at line %d)", what, line);
+                    get_uvm_chain_api(_L)->throw_exception(_L, UVM_API_COMPILE_ERROR, "undefined long %s (starting at line %d)", what, line);
                     return;
                 case ']':
                 {
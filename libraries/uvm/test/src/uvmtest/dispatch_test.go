@@ -0,0 +1,73 @@
+package main
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+)
+
+// uvm_single built against the jump table dispatch uvm, see UVM_BUILD_DISPATCH_TEST in CMakeLists.txt
+func findUvmSingleJumptablePath() string {
+	return uvmSinglePath + "_jumptable"
+}
+
+// scripts whose output depends on wall time, so can't be compared between two runs
+var dispatchDiffSkipScripts = map[string]bool{
+	"test_time.lua":     true,
+	"test_stop_vm.lua":  true,
+	"test_debugger.lua": true,
+}
+
+func dispatchDiffScripts(t *testing.T) []string {
+	scripts := []string{
+		"../../load_simple_contract.lua",
+		"../../change_other_contract_property.lua",
+		"../../test_many_string_operations.lua",
+		"../../test_safemath.lua",
+	}
+	matches, err := filepath.Glob("../../tests_lua/*.lua")
+	assert.True(t, err == nil)
+	for _, path := range matches {
+		if dispatchDiffSkipScripts[filepath.Base(path)] {
+			continue
+		}
+		scripts = append(scripts, path)
+	}
+	return scripts
+}
+
+// run the same bytecode under switch dispatch and jump table dispatch,
+// the stdout, stderr and executed instructions count(gas) must be the same
+func TestDispatchModesSameResult(t *testing.T) {
+	jumptablePath := findUvmSingleJumptablePath()
+	if _, err := os.Stat(jumptablePath); err != nil {
+		t.Fatalf("%s not found, configure uvm with -DUVM_BUILD_DISPATCH_TEST=ON to build it", jumptablePath)
+	}
+	for _, script := range dispatchDiffScripts(t) {
+		_, compileErr := execCommand(uvmCompilerPath, script)
+		if compileErr != "" {
+			continue // scripts testing compile errors have no bytecode
+		}
+		bytecodePath := script + ".out"
+		switchOut, switchErr := execCommand(uvmSinglePath, "-g", bytecodePath)
+		jumptableOut, jumptableErr := execCommand(jumptablePath, "-g", bytecodePath)
+		fmt.Printf("%s: %s\n", script, strings.TrimSpace(lastLine(switchOut)))
+		assert.Equal(t, switchOut, jumptableOut, "stdout of "+script+" differs between dispatch modes")
+		assert.Equal(t, switchErr, jumptableErr, "stderr of "+script+" differs between dispatch modes")
+		assert.True(t, strings.Contains(switchOut, "gas used: "), "uvm_single -g should print gas used")
+	}
+
+	// contract api calls go through the same interpreter loop with contract state
+	switchOut, _ := execCommand(uvmSinglePath, "-g", "-k", "../../result.out", "sayHi", "China")
+	jumptableOut, _ := execCommand(jumptablePath, "-g", "-k", "../../result.out", "sayHi", "China")
+	assert.Equal(t, switchOut, jumptableOut)
+}
+
+func lastLine(out string) string {
+	lines := strings.Split(strings.TrimSpace(out), "\n")
+	return lines[len(lines)-1]
+}
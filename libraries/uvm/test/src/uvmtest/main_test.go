@@ -289,6 +289,10 @@ func TestSafeMath(t *testing.T) {
 	assert.True(t, strings.Contains(out, `h	3333333333333333333333333333333333332`))
 	assert.True(t, strings.Contains(out, `j	0`))
 	assert.True(t, strings.Contains(out, `try parse a1 is:	nil`))
+	assert.True(t, strings.Contains(out, `k	11111111111111111111111111111111111102222222222222222222222222222222222224`))
+	assert.True(t, strings.Contains(out, `hex(-k)=	-649e6044945b687b02ed981ae31413f2265be6350a177ff26ebe38e38e390`))
+	assert.True(t, strings.Contains(out, `l	256	100`))
+
 	assert.True(t, strings.Contains(out, `123 > 456=false`))
 	assert.True(t, strings.Contains(out, `123 >= 456=false`))
 	assert.True(t, strings.Contains(out, `123 < 456=true`))
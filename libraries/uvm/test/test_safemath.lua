@@ -22,6 +22,12 @@ pprint('h', safemath.tostring(h))
 pprint('j', safemath.tostring(j))
 pprint("try parse a1 is:", safemath.bigint('a1'))
 
+k = safemath.mul(h, h)
+pprint('k', safemath.tostring(k))
+pprint('hex(-k)=', safemath.tohex(safemath.sub(safemath.bigint(0), k)))
+l = safemath.add({hex='00FF', type='bigint'}, safemath.bigint(1))
+pprint('l', safemath.tostring(l), safemath.tohex(l))
+
 c1 = safemath.gt(a, b)
 c2 = safemath.ge(a, b)
 c3 = safemath.lt(a, b)
@@ -44,6 +44,7 @@ static lua_State *globalL = NULL;
 
 static const char *progname = LUA_PROGNAME;
 
+static bool print_gas = false;
 
 /*
 ** Hook set by signal function to stop the interpreter.
@@ -88,6 +89,7 @@ static void print_usage(const char *badoption) {
 		"  -k       call contract api, -k script_path contract_api api_argument [caller_address caller_pubkey]\n"
 		"  -x       run with debugger\n"
 		"  -c       compile source to bytecode\n"
+		"  -g       print executed instructions count(gas) when done\n"
 		"  -h       show help info\n"
 		"  --       stop handling options\n"
 		"  -        stop handling options and execute stdin\n"
@@ -313,6 +315,7 @@ static int handle_script(lua_State *L, char **argv, bool is_contract = false) {
 #define has_call    128 /* -k */
 #define has_debug   256 /* -x */
 #define has_help    512 /* -h */
+#define has_gas     1024 /* -g */
 
 /*
 ** Traverses all arguments from 'argv', returning a mask with those
@@ -370,6 +373,11 @@ static int collectargs(char **argv, int *first) {
 				return has_error;  /* invalid option */
 			args |= has_help;
 			break;
+		case 'g':
+			if (argv[i][2] != '\0')  /* extra characters after 1st? */
+				return has_error;  /* invalid option */
+			args |= has_gas;
+			break;
 		case 'e':
 			args |= has_e;  /* FALLTHROUGH */
 		case 'l':  /* both options need an argument */
@@ -420,6 +428,7 @@ static int pmain(lua_State *L) {
 		print_usage("help");
 		return LUA_OK;
 	}
+	print_gas = (args & has_gas) != 0;
 	if (args & has_v)  /* option '-v'? */
 		print_version();
 	if (args & has_E) {  /* option '-E'? */
@@ -535,5 +544,7 @@ int main(int argc, char **argv) {
 	status = lua_pcall(L, 2, 1, 0);  /* do the call */
 	result = lua_toboolean(L, -1);  /* get result */
 	report(L, status);
+	if (print_gas)
+		printf("gas used: %d\n", uvm::lua::lib::get_lua_state_instructions_executed_count(L));
 	return (result && status == LUA_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -44,7 +44,12 @@ namespace vmgc {
 		std::shared_ptr<std::list<std::pair<intptr_t, ptrdiff_t>>> _empty_small_buffers[DEFAULT_MAX_SMALL_BUFFER_SIZE]; //empty_size => [ [start_ptr, size], ... ]
 		std::shared_ptr<std::list<std::pair<intptr_t, ptrdiff_t>>> _empty_big_buffers; //order list, from small to big
 		std::shared_ptr<std::list<std::pair<intptr_t, intptr_t> > > _malloced_str_blocks; // [ [start_ptr, size], ... ]
-		std::shared_ptr<std::map<unsigned int,std::pair<intptr_t, ptrdiff_t>>> _gc_strpool;
+		// interned short strings, open addressing with linear probing on the hash cached in each string
+		std::vector<GcObject*> _strpool_slots;
+		size_t _strpool_count;
+		// bytes of the interned strings. no string is interned once it reaches DEFAULT_MAX_GC_STRPOOL_SIZE
+		size_t _strpool_size;
+		void grow_strpool();
 		std::pair<intptr_t, ptrdiff_t>  _empty_str_buffer; // [start_ptr, size]
 		void insert_empty_buffer(std::pair<intptr_t, ptrdiff_t> &buf);
 
@@ -61,7 +66,9 @@ namespace vmgc {
 		void* gc_grow_vector(void *p, size_t nelements, size_t* size, size_t element_size, size_t limit);
 		ptrdiff_t usedsize() const;
 		void gc_free_all();
-		void* gc_intern_strpool(size_t sz, size_t strsize, const char* str, bool* isNewStr);
+		// @return the pooled string, or nullptr when out of memory or the pool is full and str isn't in it
+		void* gc_intern_strpool(size_t sz, size_t strsize, const char* str, bool* isNewStr, unsigned int* hash);
+		bool gc_strpool_full() const;
 
 		template <typename T>
 		T* gc_new_object()
@@ -138,6 +145,7 @@ namespace vmgc {
 		}
 
 		void fill_gc_string(GcObject* p, const char* str, size_t size);
+		void fill_interned_gc_string(GcObject* p, const char* str, size_t size, unsigned int hash);
 
 		// short string into str pool, reused
 		template <typename T>
@@ -147,14 +155,21 @@ namespace vmgc {
 			bool isNewStr = true;
 			if (size < DEFAULT_MAX_GC_SHORT_STRING_SIZE) { 
 				size_t sz = sizeof(T);
-				auto p = gc_intern_strpool(sz, size, str, &isNewStr);
+				unsigned int hash = 0;
+				auto p = gc_intern_strpool(sz, size, str, &isNewStr, &hash);
 				if (!p) {
-					return nullptr;
+					if (!gc_strpool_full())
+						return nullptr;
+					// the pool is full, the string gets an object of its own like a long string
+					ts = gc_new_object<T>();
+					if (ts)
+						fill_gc_string(ts, str, size);
+					return ts;
 				}
 				GcObject* obj_p = static_cast<GcObject*>(p);
 				if (isNewStr) {
 					new (obj_p)T();
-					fill_gc_string(obj_p, str, size);
+					fill_interned_gc_string(obj_p, str, size, hash);
 					obj_p->tt = T::type;
 				}
 				ts = static_cast<T*>(obj_p);
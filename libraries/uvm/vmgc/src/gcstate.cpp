@@ -24,7 +24,8 @@ namespace vmgc {
 
 		//////////////////
 		this->_malloced_str_blocks = std::make_shared<std::list<std::pair<intptr_t, intptr_t>>>();
-		this->_gc_strpool = std::make_shared<std::map<unsigned int, std::pair<intptr_t, ptrdiff_t>>>();
+		_strpool_count = 0;
+		_strpool_size = 0;
 
 		_empty_str_buffer.first = 0;
 		_empty_str_buffer.second = 0;
@@ -47,11 +48,13 @@ namespace vmgc {
 		_empty_big_buffers->clear();
 
 		////////////////////////////////////
-		for (const auto& item : *_gc_strpool) {
-			auto gc_obj = (GcObject*)item.second.first;
-			gc_obj->~GcObject();
+		for (auto gc_obj : _strpool_slots) {
+			if (gc_obj)
+				gc_obj->~GcObject();
 		}
-		_gc_strpool->clear();
+		_strpool_slots.clear();
+		_strpool_count = 0;
+		_strpool_size = 0;
 
 		_empty_str_buffer.first = 0;
 		_empty_str_buffer.second = 0;
@@ -310,6 +313,13 @@ namespace vmgc {
 		sp->tt = sp->tt_;
 	}
 
+	void GcState::fill_interned_gc_string(GcObject* p, const char* str, size_t size, unsigned int hash) {
+		fill_gc_string(p, str, size);
+		auto sp = static_cast<uvm_types::GcString*>(p);
+		sp->interned = true;
+		sp->interned_hash = hash;
+	}
+
 	//ֳ֧С2^5hashڵڴֻϴʷײ
 	static unsigned int gc_str_hash(const char *str, size_t l, unsigned int seed) {
 		unsigned int h = seed ^ lua_cast(unsigned int, l);
@@ -319,31 +329,52 @@ namespace vmgc {
 		return h;
 	}
 
-	void* GcState::gc_intern_strpool(size_t sz, size_t strsize, const char* str, bool* isNewStr) {
+	void GcState::grow_strpool() {
+		std::vector<GcObject*> slots(_strpool_slots.empty() ? 256 : _strpool_slots.size() * 2, nullptr);
+		size_t mask = slots.size() - 1;
+		for (auto gc_obj : _strpool_slots) {
+			if (!gc_obj)
+				continue;
+			size_t i = static_cast<uvm_types::GcString*>(gc_obj)->interned_hash & mask;
+			while (slots[i])
+				i = (i + 1) & mask;
+			slots[i] = gc_obj;
+		}
+		_strpool_slots.swap(slots);
+	}
+
+	bool GcState::gc_strpool_full() const {
+		return _strpool_size >= DEFAULT_MAX_GC_STRPOOL_SIZE;
+	}
+
+	void* GcState::gc_intern_strpool(size_t sz, size_t strsize, const char* str, bool* isNewStr, unsigned int* hash) {
 		void* p = nullptr;
 		unsigned int seed = 1;
 		unsigned int h = gc_str_hash(str, strsize, seed);
-
-		auto it = _gc_strpool->find(h);
-		if (it == _gc_strpool->end()) {
-			*isNewStr = true;
-		}
-		else {
-			*isNewStr = false;
-			p = (void *)((*_gc_strpool)[h].first);
-			uvm_types::GcString* gcstr = static_cast<uvm_types::GcString*>(p);
-			if (strncmp(gcstr->value.c_str(), str, strsize) != 0) { //ײ
-				//new it 
-				*isNewStr = true;
+		*hash = h;
+
+		// keep the load factor under 3/4
+		if ((_strpool_count + 1) * 4 > _strpool_slots.size() * 3)
+			grow_strpool();
+		size_t mask = _strpool_slots.size() - 1;
+		size_t slot = h & mask;
+		while (_strpool_slots[slot]) {
+			auto gcstr = static_cast<uvm_types::GcString*>(_strpool_slots[slot]);
+			if (gcstr->interned_hash == h && gcstr->value.size() == strsize && memcmp(gcstr->value.data(), str, strsize) == 0) {
+				*isNewStr = false;
+				return gcstr;
 			}
+			slot = (slot + 1) & mask;
 		}
+		*isNewStr = true;
+		if (gc_strpool_full())
+			return nullptr;
 
-		if (*isNewStr) {
+		{
 			//add 
 			size_t align8sz = align8(sz);
 
 			if (align8sz <= _empty_str_buffer.second) {
-				(*_gc_strpool)[h] = std::pair<intptr_t, ptrdiff_t>(_empty_str_buffer.first, align8sz);
 				p = (void*) _empty_str_buffer.first;
 
 				_empty_str_buffer.first = _empty_str_buffer.first + align8sz;
@@ -366,15 +397,16 @@ namespace vmgc {
 				block.second = DEFAULT_GC_BLOCK_SIZE;
 				_malloced_str_blocks->push_back(block);
 
-				(*_gc_strpool)[h] = std::pair<intptr_t, ptrdiff_t>((intptr_t)p, align8sz);
-
 				if (align8sz < DEFAULT_GC_BLOCK_SIZE) {
 					_empty_str_buffer.first = (intptr_t)p + align8sz;
 					_empty_str_buffer.second = DEFAULT_GC_BLOCK_SIZE - align8sz;
 				}
 			}
 			_used_size += align8sz;
+			_strpool_size += align8sz + strsize;
 		}
+		_strpool_slots[slot] = static_cast<GcObject*>(p);
+		_strpool_count++;
 		
 		return p;
 	}
@@ -1977,6 +1977,8 @@ class wallet_api
       std::pair<asset, share_type> register_native_contract_testing(const string& caller_account_name,  const string& native_contract_key);
 
 	  full_transaction invoke_contract(const string& caller_account_name, const string& gas_price, const string& gas_limit, const string& contract_address_or_name, const string& contract_api, const string& contract_arg);
+      // calls contract_apis[i] with contract_args[i] in one operation. gas_limit is the limit of all the calls
+      full_transaction invoke_contract_batch(const string& caller_account_name, const string& gas_price, const string& gas_limit, const string& contract_address_or_name, const vector<string>& contract_apis, const vector<string>& contract_args);
       std::pair<asset, share_type> invoke_contract_testing(const string& caller_account_name,const string& contract_address_or_name, const string& contract_api, const string& contract_arg);
 
       string invoke_contract_offline(const string& caller_account_name, const string& contract_address_or_name, const string& contract_api, const string& contract_arg);
@@ -3298,6 +3300,7 @@ FC_API( graphene::wallet::wallet_api,
 		(register_native_contract)
         (register_contract_like)
 		(invoke_contract)
+		(invoke_contract_batch)
 		(invoke_contract_offline)
 		(upgrade_contract)
         (get_contract_info)
@@ -2077,6 +2077,58 @@ public:
 	   }FC_CAPTURE_AND_RETHROW((caller_account_name)(gas_price)(gas_limit)(contract_address_or_name)(contract_api)(contract_arg))
    }
 
+   full_transaction invoke_contract_batch(const string& caller_account_name, const string& gas_price, const string& gas_limit, const string& contract_address, const vector<string>& contract_apis, const vector<string>& contract_args)
+   {
+	   try {
+		   FC_ASSERT(!self.is_locked());
+		   FC_ASSERT(is_valid_account_name(caller_account_name));
+		   FC_ASSERT(contract_apis.size() == contract_args.size(), "each contract api needs one argument");
+
+		   contract_batch_invoke_operation contract_batch_invoke_op;
+
+		   auto acc_caller = get_account(caller_account_name);
+		   FC_ASSERT(acc_caller.addr != address(), "contract owner can't be empty.");
+		   FC_ASSERT(_keys.count(acc_caller.addr), "this name has not existed in the wallet.");
+		   auto privkey = *wif_to_key(_keys[acc_caller.addr]);
+		   auto caller_pubkey = privkey.get_public_key();
+
+		   auto cont = _remote_db->get_contract_object(contract_address);
+		   FC_ASSERT(cont.type_of_contract != contract_type::native_contract, "native contract can't be invoked in a batch");
+		   auto& abi = cont.code.abi;
+		   for (size_t i = 0; i < contract_apis.size(); ++i)
+		   {
+			   if (abi.find(contract_apis[i]) == abi.end())
+				   FC_CAPTURE_AND_THROW(blockchain::contract_engine::contract_api_not_found);
+			   contract_batch_invoke_operation::contract_call call;
+			   call.contract_api = contract_apis[i];
+			   call.contract_arg = contract_args[i];
+			   contract_batch_invoke_op.calls.push_back(call);
+		   }
+		   fc::optional<asset_object> default_asset = get_asset(GRAPHENE_SYMBOL);
+		   contract_batch_invoke_op.gas_price = default_asset->amount_from_string(gas_price).amount.value;
+		   contract_batch_invoke_op.invoke_cost = std::stoll(gas_limit);
+		   contract_batch_invoke_op.caller_addr = acc_caller.addr;
+		   contract_batch_invoke_op.caller_pubkey = caller_pubkey;
+		   contract_batch_invoke_op.contract_id = address(cont.contract_address);
+		   contract_batch_invoke_op.fee.amount = 0;
+		   contract_batch_invoke_op.fee.asset_id = asset_id_type(0);
+		   contract_batch_invoke_op.guarantee_id = get_guarantee_id();
+		   signed_transaction tx;
+		   tx.operations.push_back(contract_batch_invoke_op);
+		   auto current_fees = _remote_db->get_global_properties().parameters.current_fees;
+		   set_operation_fees(tx, current_fees);
+
+		   auto dyn_props = get_dynamic_global_properties();
+		   tx.set_reference_block(dyn_props.head_block_id);
+		   tx.set_expiration(dyn_props.time + fc::seconds(30));
+		   tx.validate();
+
+		   bool broadcast = true;
+		   auto signed_tx = sign_transaction(tx, broadcast);
+		   return signed_tx;
+	   }FC_CAPTURE_AND_RETHROW((caller_account_name)(gas_price)(gas_limit)(contract_address)(contract_apis)(contract_args))
+   }
+
    string invoke_contract_offline(const string& caller_account_name, const string& contract_address_or_name, const string& contract_api, const string& contract_arg)
    {
 	   try {
@@ -9164,6 +9216,24 @@ full_transaction wallet_api::invoke_contract(const string& caller_account_name,
 	return my->invoke_contract(caller_account_name, gas_price, gas_limit, contract_address, contract_api, contract_arg);
 }
 
+full_transaction wallet_api::invoke_contract_batch(const string& caller_account_name, const string& gas_price, const string& gas_limit, const string& contract_address_or_name, const vector<string>& contract_apis, const vector<string>& contract_args)
+{
+	std::string contract_address;
+	bool is_valid_address = true;
+	try {
+		contract_address = graphene::chain::address(contract_address_or_name).address_to_string();
+		auto temp = address(contract_address);
+		FC_ASSERT(temp.version == addressVersion::CONTRACT);
+	}
+	catch (fc::exception& e)
+	{
+		is_valid_address = false;
+	}
+	if (!is_valid_address)
+		contract_address = string(my->_remote_db->get_contract_object_by_name(contract_address_or_name).contract_address);
+	return my->invoke_contract_batch(caller_account_name, gas_price, gas_limit, contract_address, contract_apis, contract_args);
+}
+
 std::pair<asset, share_type> wallet_api::invoke_contract_testing(const string & caller_account_name, const string & contract_address_or_name, const string & contract_api, const string & contract_arg)
 {
 	std::string contract_address;
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <native_contract/native_uniswap_math.h>
+#include <safenumber/safenumber.h>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include <random>
+
+using namespace uvm::contract;
+
+// the SafeNumber expressions uniswap_native_contract used before uniswap_math
+static int64_t safe_number_swap( int64_t amount, const SafeNumber& fee_rate, int64_t input_reserve, int64_t output_reserve )
+{
+   const auto& temp = safe_number_multiply(safe_number_create(amount), fee_rate);
+   int64_t fee = safe_number_to_int64(temp);
+   if (safe_number_ne(safe_number_create(fee), temp))
+      fee++;
+   if (fee <= 0)
+      fee = 1;
+   const auto& a = safe_number_create(input_reserve);
+   const auto& b = safe_number_create(output_reserve);
+   const auto& x = safe_number_create(amount - fee);
+   return safe_number_to_int64(safe_number_div(safe_number_multiply(x, b), safe_number_add(a, x)));
+}
+
+static int64_t uniswap_math_swap( int64_t amount, const SafeNumber& fee_rate, int64_t input_reserve, int64_t output_reserve )
+{
+   int64_t fee = uniswap_math::swap_fee(amount, fee_rate);
+   return uniswap_math::get_input_price(amount - fee, input_reserve, output_reserve);
+}
+
+// the other SafeNumber expressions replaced by uniswap_math
+static int64_t safe_number_mul_div_floor( int64_t x, int64_t y, int64_t z )
+{
+   return safe_number_to_int64(safe_number_div(safe_number_multiply(safe_number_create(x), safe_number_create(y)), safe_number_create(z)));
+}
+
+static int64_t safe_number_mul_div_ceil( int64_t x, int64_t y, int64_t z )
+{
+   const auto& temp = safe_number_div(safe_number_multiply(safe_number_create(x), safe_number_create(y)), safe_number_create(z));
+   int64_t v = safe_number_to_int64(temp);
+   if (safe_number_ne(safe_number_create(v), temp))
+      v++;
+   return v;
+}
+
+static int64_t safe_number_pool_share( int64_t token_amount, int64_t supply, int64_t pool_amount )
+{
+   const auto& quota = safe_number_div(safe_number_create(token_amount), safe_number_create(supply));
+   return safe_number_to_int64(safe_number_multiply(quota, safe_number_create(pool_amount)));
+}
+
+struct swap_input
+{
+   int64_t amount;
+   int64_t input_reserve;
+   int64_t output_reserve;
+};
+
+BOOST_AUTO_TEST_CASE( uniswap_math_swap_bench )
+{
+   try {
+#ifdef NDEBUG
+      const int swap_count = 200000;
+#else
+      const int swap_count = 20000;
+#endif
+      const int64_t max_asset_amount = 4000000000000000;
+      const auto& fee_rate = safe_number_create(std::string("0.003"));
+
+      std::mt19937_64 gen(1);
+      std::vector<swap_input> inputs;
+      for( int i = 0; i < swap_count; ++i )
+         inputs.push_back({ int64_t(gen() % max_asset_amount) + 1, int64_t(gen() % max_asset_amount) + 1, int64_t(gen() % max_asset_amount) + 1 });
+
+      std::vector<int64_t> expected(inputs.size());
+      fc::time_point start_time = fc::time_point::now();
+      for( size_t i = 0; i < inputs.size(); ++i )
+         expected[i] = safe_number_swap(inputs[i].amount, fee_rate, inputs[i].input_reserve, inputs[i].output_reserve);
+      auto safe_number_us = std::max<int64_t>((fc::time_point::now() - start_time).count(), 1);
+
+      std::vector<int64_t> results(inputs.size());
+      start_time = fc::time_point::now();
+      for( size_t i = 0; i < inputs.size(); ++i )
+         results[i] = uniswap_math_swap(inputs[i].amount, fee_rate, inputs[i].input_reserve, inputs[i].output_reserve);
+      auto uniswap_math_us = std::max<int64_t>((fc::time_point::now() - start_time).count(), 1);
+
+      for( size_t i = 0; i < inputs.size(); ++i )
+         BOOST_REQUIRE_EQUAL(results[i], expected[i]);
+
+      ilog("SafeNumber: ${n} swaps/sec, uniswap_math: ${m} swaps/sec",
+           ("n", int64_t(swap_count) * 1000000 / safe_number_us)("m", int64_t(swap_count) * 1000000 / uniswap_math_us));
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+// SafeNumber drops digits once a product exceeds 10^32, the integer kernel must truncate the same way there
+BOOST_AUTO_TEST_CASE( uniswap_math_large_products )
+{
+   try {
+      const int64_t e16 = 10000000000000000;
+      const auto& fee_rate = safe_number_create(std::string("0.003"));
+      std::mt19937_64 gen(2);
+      // at least 10^16, up to INT64_MAX
+      auto large = [&gen, e16]() { return e16 + int64_t(gen() % uint64_t(INT64_MAX - e16)); };
+      // any size, so quotients range from 0 to far beyond int64
+      auto any = [&gen]() { return std::max<int64_t>(int64_t(gen() >> 1) >> (gen() % 63), 1); };
+      for( int i = 0; i < 20000; ++i )
+      {
+         int64_t x = large();
+         int64_t y = large();
+         // products just below and above 10^32
+         int64_t near_y = int64_t(1e32 / double(x) * (0.9 + double(gen() % 200) / 1000.0));
+         int64_t z = any();
+         BOOST_REQUIRE_EQUAL(uniswap_math::mul_div_floor(x, y, z), safe_number_mul_div_floor(x, y, z));
+         BOOST_REQUIRE_EQUAL(uniswap_math::mul_div_ceil(x, y, z), safe_number_mul_div_ceil(x, y, z));
+         BOOST_REQUIRE_EQUAL(uniswap_math::mul_div_floor(x, near_y, z), safe_number_mul_div_floor(x, near_y, z));
+         BOOST_REQUIRE_EQUAL(uniswap_math::mul_div_ceil(x, near_y, z), safe_number_mul_div_ceil(x, near_y, z));
+         BOOST_REQUIRE_EQUAL(uniswap_math::pool_share(x, z, y), safe_number_pool_share(x, z, y));
+         BOOST_REQUIRE_EQUAL(uniswap_math::pool_share(z, x, y), safe_number_pool_share(z, x, y));
+         BOOST_REQUIRE_EQUAL(uniswap_math_swap(x, fee_rate, z, y), safe_number_swap(x, fee_rate, z, y));
+         BOOST_REQUIRE_EQUAL(uniswap_math_swap(z, fee_rate, x, y), safe_number_swap(z, fee_rate, x, y));
+      }
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,103 @@
+#include <boost/test/unit_test.hpp>
+
+#include "contract_fixture.hpp"
+
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/filesystem.hpp>
+
+namespace graphene { namespace chain {
+
+const uint32_t contract_fixture::contract_skip_flags = database::skip_transaction_signatures
+                                                     | database::skip_authority_check
+                                                     | database::skip_transaction_dupe_check;
+
+contract_fixture::contract_fixture()
+{
+   caller_public_key = caller_private_key.get_public_key();
+   caller_addr = address( caller_public_key );
+   db.adjust_balance( caller_addr, asset( 1000000 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+}
+
+uvm::blockchain::Code contract_fixture::load_test_contract( const string& filename )
+{
+   fc::path contract_path = fc::path( __FILE__ ).parent_path() / ".." / ".." / "libraries" / "uvm" / "test" / "test_contracts" / filename;
+   return ContractHelper::load_contract_from_file( contract_path );
+}
+
+address contract_fixture::register_contract( const uvm::blockchain::Code& code )
+{
+   contract_register_operation op;
+   op.init_cost = 1000000;
+   op.gas_price = gas_price;
+   op.owner_addr = caller_addr;
+   op.owner_pubkey = caller_public_key;
+   // contracts of the same code get different ids
+   op.register_time = db.head_block_time() + ++registered_contracts;
+   op.contract_code = code;
+   op.contract_id = op.calculate_contract_id();
+   push_contract_operation( op );
+   BOOST_REQUIRE( db.has_contract( op.contract_id ) );
+   return op.contract_id;
+}
+
+address contract_fixture::register_native_contract( const string& native_contract_key )
+{
+   native_contract_register_operation op;
+   op.init_cost = 1000000;
+   op.gas_price = gas_price;
+   op.owner_addr = caller_addr;
+   op.owner_pubkey = caller_public_key;
+   op.register_time = db.head_block_time() + ++registered_contracts;
+   op.native_contract_key = native_contract_key;
+   op.contract_id = op.calculate_contract_id();
+   push_contract_operation( op );
+   BOOST_REQUIRE( db.has_contract( op.contract_id ) );
+   return op.contract_id;
+}
+
+contract_invoke_operation contract_fixture::make_invoke_operation( const address& contract_id, const string& api, const string& arg,
+                                                                   gas_count_type invoke_cost ) const
+{
+   contract_invoke_operation op;
+   op.invoke_cost = invoke_cost;
+   op.gas_price = gas_price;
+   op.caller_addr = caller_addr;
+   op.caller_pubkey = caller_public_key;
+   op.contract_id = contract_id;
+   op.contract_api = api;
+   op.contract_arg = arg;
+   return op;
+}
+
+contract_batch_invoke_operation contract_fixture::make_batch_invoke_operation( const address& contract_id,
+                                                                               const vector<contract_batch_invoke_operation::contract_call>& calls,
+                                                                               gas_count_type invoke_cost ) const
+{
+   contract_batch_invoke_operation op;
+   op.invoke_cost = invoke_cost;
+   op.gas_price = gas_price;
+   op.caller_addr = caller_addr;
+   op.caller_pubkey = caller_public_key;
+   op.contract_id = contract_id;
+   op.calls = calls;
+   return op;
+}
+
+processed_transaction contract_fixture::push_contract_operation( operation op )
+{
+   db.current_fee_schedule().set_fee( op );
+   signed_transaction tx;
+   tx.operations.push_back( op );
+   test::set_expiration( db, tx );
+   return db.push_transaction( tx, contract_skip_flags );
+}
+
+contract_invoke_result_object contract_fixture::invoke_result_of( const processed_transaction& trx )
+{
+   auto results = db.get_contract_invoke_result( trx.id() );
+   BOOST_REQUIRE_EQUAL( results.size(), 1u );
+   return results.front();
+}
+
+} }
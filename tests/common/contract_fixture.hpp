@@ -0,0 +1,48 @@
+#pragma once
+
+#include "database_fixture.hpp"
+
+#include <graphene/chain/contract.hpp>
+#include <graphene/chain/contract_object.hpp>
+#include <graphene/chain/native_contract.hpp>
+
+namespace graphene { namespace chain {
+
+/**
+ *  Registers and calls contracts through transactions, with their vms run as a miner runs them.
+ *  The caller address is funded with enough core asset to pay the gas.
+ */
+struct contract_fixture : database_fixture
+{
+   contract_fixture();
+
+   fc::ecc::private_key caller_private_key = generate_private_key( "contract_caller" );
+   fc::ecc::public_key  caller_public_key;
+   address              caller_addr;
+   /** gas price of the operations, above 0 so the gas shows up in the fees */
+   gas_price_type       gas_price = 10;
+
+   /** a compiled contract of libraries/uvm/test/test_contracts */
+   static uvm::blockchain::Code load_test_contract( const string& filename );
+
+   address register_contract( const uvm::blockchain::Code& code );
+   address register_native_contract( const string& native_contract_key );
+
+   contract_invoke_operation make_invoke_operation( const address& contract_id, const string& api, const string& arg,
+                                                    gas_count_type invoke_cost = 1000000 ) const;
+   contract_batch_invoke_operation make_batch_invoke_operation( const address& contract_id,
+                                                                const vector<contract_batch_invoke_operation::contract_call>& calls,
+                                                                gas_count_type invoke_cost = 1000000 ) const;
+
+   /** pushes op in a transaction of its own, with the fee set from the fee schedule */
+   processed_transaction push_contract_operation( operation op );
+   /** the result stored for the contract operation of trx */
+   contract_invoke_result_object invoke_result_of( const processed_transaction& trx );
+
+   /** flags contract transactions are pushed with: signatures aren't checked, the vms run */
+   static const uint32_t contract_skip_flags;
+
+   uint32_t registered_contracts = 0;
+};
+
+} }
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <fc/crypto/aes.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/time.hpp>
+#include <fc/log/logger.hpp>
+
+#include <vector>
+
+namespace
+{
+   const uint32_t cipher_benchmark_buffer_size = 1024 * 1024;
+   const uint32_t cipher_benchmark_iterations = 256;
+
+   // MB/s of one core encrypting with the encoder
+   double encrypt_mb_per_second( fc::aes_encoder& encoder )
+   {
+      std::vector<char> plaintext( cipher_benchmark_buffer_size, 'x' );
+      std::vector<char> ciphertext( cipher_benchmark_buffer_size );
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < cipher_benchmark_iterations; ++i )
+         encoder.encode( plaintext.data(), plaintext.size(), ciphertext.data() );
+      auto elapsed = fc::time_point::now() - start;
+      return double(cipher_benchmark_iterations) * 1000000.0 / elapsed.count();
+   }
+}
+
+BOOST_AUTO_TEST_CASE( stcp_cipher_benchmark )
+{
+   auto key = fc::sha256::hash( "stcp_cipher_benchmark" );
+   auto init_value = fc::city_hash_crc_128( (char*)&key, sizeof(key) );
+
+   fc::aes_encoder cbc_encoder;
+   cbc_encoder.init( key, init_value );
+   double cbc_mb_per_second = encrypt_mb_per_second( cbc_encoder );
+
+   fc::aes_encoder ctr_encoder;
+   ctr_encoder.init_ctr( key, init_value );
+   double ctr_mb_per_second = encrypt_mb_per_second( ctr_encoder );
+
+   wdump( (cbc_mb_per_second)(ctr_mb_per_second) );
+
+   // a message split over several encode calls decrypts like one encrypted at once
+   std::vector<char> message( 4096 + 48 );
+   for( size_t i = 0; i < message.size(); ++i )
+      message[i] = char(i * 7);
+   std::vector<char> ciphertext( message.size() );
+   fc::aes_encoder encoder;
+   encoder.init_ctr( key, init_value );
+   encoder.encode( message.data(), 16, ciphertext.data() );
+   encoder.encode( message.data() + 16, message.size() - 32, ciphertext.data() + 16 );
+   encoder.encode( message.data() + message.size() - 16, 16, ciphertext.data() + message.size() - 16 );
+   std::vector<char> decrypted( message.size() );
+   fc::aes_decoder decoder;
+   decoder.init_ctr( key, init_value );
+   decoder.decode( ciphertext.data(), ciphertext.size(), decrypted.data() );
+   BOOST_CHECK( decrypted == message );
+}
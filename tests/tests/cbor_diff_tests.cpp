@@ -0,0 +1,127 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cbor_diff/cbor_diff_tests.h>
+#include <cbor_diff/cbor_diff_exceptions.h>
+#include <uvm/uvm_api.h>
+
+#include <deque>
+#include <random>
+
+namespace {
+
+using uvm::blockchain::StorageValueTypes;
+
+// random storage values, the tables and strings they point to live as long as the generator
+struct storage_value_generator
+{
+   std::mt19937 random{ 20181019 };
+   std::deque<std::string> strings;
+   std::deque<UvmTableMap> tables;
+
+   std::string random_key()
+   {
+      static const char chars[] = "abcXYZ019_";
+      std::string key( random() % 6, 'a' );
+      for( auto& c : key )
+         c = chars[random() % ( sizeof( chars ) - 1 )];
+      return key;
+   }
+
+   UvmStorageValue scalar( StorageValueTypes type )
+   {
+      UvmStorageValue value;
+      value.type = type;
+      switch( type )
+      {
+      case StorageValueTypes::storage_value_bool:
+         value.value.bool_value = random() % 2 == 0;
+         break;
+      case StorageValueTypes::storage_value_int:
+         value.value.int_value = (lua_Integer)( ( (uint64_t)random() << 32 ) | random() ) >> ( random() % 64 );
+         break;
+      case StorageValueTypes::storage_value_number:
+         value.value.number_value = ( (int64_t)random() - (int64_t)random() ) / 1000.0;
+         break;
+      case StorageValueTypes::storage_value_string:
+         strings.push_back( random_key() );
+         value.value.string_value = const_cast<char*>( strings.back().c_str() );
+         break;
+      default:
+         break;
+      }
+      return value;
+   }
+
+   UvmStorageValue table( StorageValueTypes type, StorageValueTypes item_type, bool is_array )
+   {
+      UvmStorageValue value;
+      value.type = type;
+      tables.emplace_back();
+      UvmTableMap& map = tables.back();
+      size_t size = random() % 15;
+      for( size_t i = 0; i < size; ++i )
+         map[is_array ? std::to_string( i + 1 ) : random_key()] = scalar( item_type );
+      value.value.table_value = &map;
+      return value;
+   }
+
+   UvmStorageValue next()
+   {
+      static const StorageValueTypes scalar_types[] = { StorageValueTypes::storage_value_null, StorageValueTypes::storage_value_bool,
+                                                        StorageValueTypes::storage_value_int, StorageValueTypes::storage_value_number,
+                                                        StorageValueTypes::storage_value_string };
+      static const StorageValueTypes table_types[][3] = {
+         { StorageValueTypes::storage_value_int_table, StorageValueTypes::storage_value_int, StorageValueTypes::storage_value_int_array },
+         { StorageValueTypes::storage_value_string_table, StorageValueTypes::storage_value_string, StorageValueTypes::storage_value_string_array },
+         { StorageValueTypes::storage_value_bool_table, StorageValueTypes::storage_value_bool, StorageValueTypes::storage_value_bool_array },
+         { StorageValueTypes::storage_value_number_table, StorageValueTypes::storage_value_number, StorageValueTypes::storage_value_number_array } };
+      if( random() % 3 == 0 )
+         return scalar( scalar_types[random() % 5] );
+      const auto& types = table_types[random() % 4];
+      bool is_array = random() % 2 == 0;
+      return table( is_array ? types[2] : types[0], types[1], is_array );
+   }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE( cbor_diff_tests )
+
+// contract storage diffs are computed by diff_encoded without decoding unchanged items,
+// they must be the same as diffs of the decoded values
+BOOST_AUTO_TEST_CASE( cbor_diff_encoded_test )
+{
+   try {
+      cbor_diff::test_cbor_diff_encoded();
+   } catch( const cbor_diff::CborDiffException& e ) {
+      BOOST_FAIL( e.what() );
+   }
+}
+
+// storage values are written to chain by the streaming writer, its bytes are consensus data and must be
+// the ones the cbor objects encode to
+BOOST_AUTO_TEST_CASE( storage_value_cbor_writer_test )
+{
+   storage_value_generator generator;
+   for( int i = 0; i < 2000; ++i )
+   {
+      UvmStorageValue value = generator.next();
+      std::vector<char> expected = cbor_diff::cbor_encode( uvm_storage_value_to_cbor( value ) );
+      BOOST_REQUIRE( uvm_storage_value_to_cbor_bytes( value ) == expected );
+   }
+
+   // keys of different lengths are ordered differently in a table and in a cbor map
+   UvmTableMap map;
+   for( const char* key : { "bb", "a", "ccc", "b" } )
+      map[key] = generator.scalar( StorageValueTypes::storage_value_int );
+   UvmStorageValue table;
+   table.type = StorageValueTypes::storage_value_int_table;
+   table.value.table_value = &map;
+   BOOST_CHECK( uvm_storage_value_to_cbor_bytes( table ) == cbor_diff::cbor_encode( uvm_storage_value_to_cbor( table ) ) );
+
+   UvmStorageValue stream;
+   stream.type = StorageValueTypes::storage_value_stream;
+   BOOST_CHECK_THROW( uvm_storage_value_to_cbor_bytes( stream ), cbor::CborException );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
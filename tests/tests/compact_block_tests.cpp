@@ -0,0 +1,174 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/message_cache.hpp>
+#include <graphene/net/core_messages.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+using namespace graphene::net;
+using graphene::chain::asset;
+using graphene::chain::void_result;
+
+namespace {
+
+processed_transaction make_transaction( uint32_t i )
+{
+   processed_transaction trx;
+   trx.ref_block_num = 1;
+   trx.expiration = fc::time_point_sec( 1500000000 + i );
+   trx.operation_results.push_back( asset( i ) );
+   trx.operation_results.push_back( void_result() );
+   return trx;
+}
+
+signed_block make_block( uint32_t transaction_count )
+{
+   signed_block block;
+   block.timestamp = fc::time_point_sec( 1500000000 );
+   for( uint32_t i = 0; i < transaction_count; ++i )
+      block.transactions.push_back( make_transaction( i ) );
+   block.transaction_merkle_root = block.calculate_merkle_root();
+   return block;
+}
+
+void cache_transaction( blockchain_tied_message_cache& cache, const signed_transaction& trx,
+                        const fc::uint160_t& contents_hash )
+{
+   message trx_msg = trx_message( trx );
+   cache.cache_message( std::make_shared<const message>( trx_msg ), trx_msg.id(), message_propagation_data(), contents_hash );
+}
+
+void cache_transaction( blockchain_tied_message_cache& cache, const signed_transaction& trx )
+{
+   cache_transaction( cache, trx, trx.id() );
+}
+
+/** id with the first 8 bytes of id, the others changed */
+fc::uint160_t same_short_id( const transaction_id_type& id )
+{
+   fc::uint160_t other = id;
+   for( size_t i = sizeof( uint64_t ); i < other.data_size(); ++i )
+      other.data()[i] = ~other.data()[i];
+   return other;
+}
+
+std::function<fc::optional<signed_transaction>( uint64_t )> lookup_in( const blockchain_tied_message_cache& cache )
+{
+   return [&cache]( uint64_t short_id ) { return cache.get_transaction( short_id ); };
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( compact_block_tests )
+
+// a transaction is found by the first 8 bytes of its id, among messages that sort around it
+BOOST_AUTO_TEST_CASE( message_cache_get_transaction_test )
+{
+   blockchain_tied_message_cache cache;
+   processed_transaction trx = make_transaction( 0 );
+   transaction_id_type id = trx.id();
+   BOOST_CHECK( !cache.get_transaction( compact_block_short_id( id ) ) );
+
+   cache_transaction( cache, trx );
+   // neighbours of the id in the contents hash index, differing in the first or the last byte of the short id
+   fc::uint160_t before = id;
+   before.data()[0] = char( before.data()[0] - 1 );
+   fc::uint160_t after = id;
+   after.data()[sizeof( uint64_t ) - 1] = char( after.data()[sizeof( uint64_t ) - 1] + 1 );
+   cache_transaction( cache, make_transaction( 1 ), before );
+   cache_transaction( cache, make_transaction( 2 ), after );
+
+   auto found = cache.get_transaction( compact_block_short_id( id ) );
+   BOOST_REQUIRE( found );
+   BOOST_CHECK( found->id() == id );
+   BOOST_CHECK( cache.get_transaction( compact_block_short_id( before ) )->id() == make_transaction( 1 ).id() );
+   BOOST_CHECK( cache.get_transaction( compact_block_short_id( after ) )->id() == make_transaction( 2 ).id() );
+
+   // a block whose id starts the same way isn't a transaction
+   message block_msg = block_message( make_block( 1 ) );
+   cache.cache_message( std::make_shared<const message>( block_msg ), block_msg.id(), message_propagation_data(), same_short_id( id ) );
+   BOOST_CHECK( cache.get_transaction( compact_block_short_id( id ) )->id() == id );
+
+   // two transactions with the short id, we can't tell which one the block has
+   cache_transaction( cache, make_transaction( 3 ), same_short_id( id ) );
+   BOOST_CHECK( !cache.get_transaction( compact_block_short_id( id ) ) );
+}
+
+// the block is rebuilt from the prefilled transactions and our own, the rest is asked for
+BOOST_AUTO_TEST_CASE( reconstruct_compact_block_test )
+{
+   signed_block block = make_block( 6 );
+   block_id_type block_id = block.id();
+
+   // the peer has transactions 0 to 3, we only have 0 to 2 of them
+   std::set<transaction_id_type> peer_has;
+   blockchain_tied_message_cache cache;
+   for( uint32_t i = 0; i < 4; ++i )
+      peer_has.insert( block.transactions[i].id() );
+   for( uint32_t i = 0; i < 3; ++i )
+      cache_transaction( cache, block.transactions[i] );
+
+   compact_block_message compact_block = make_compact_block( block, block_id, [&]( const transaction_id_type& id ) {
+      return peer_has.count( id ) > 0;
+   });
+   BOOST_CHECK( compact_block.block_id == block_id );
+   BOOST_CHECK( compact_block.header.transaction_merkle_root == block.transaction_merkle_root );
+   BOOST_REQUIRE_EQUAL( compact_block.transactions.size(), block.transactions.size() );
+   for( uint32_t i = 0; i < block.transactions.size(); ++i )
+      BOOST_CHECK_EQUAL( compact_block.transactions[i].short_id, compact_block_short_id( block.transactions[i].id() ) );
+   BOOST_CHECK_EQUAL( compact_block.prefilled_transactions.size(), 2u );
+   BOOST_CHECK( compact_block.prefilled_transactions.count( 4 ) && compact_block.prefilled_transactions.count( 5 ) );
+
+   // the message keeps its contents through the wire format
+   message compact_msg = compact_block;
+   BOOST_CHECK_EQUAL( compact_msg.msg_type, core_message_type_enum::compact_block_message_type );
+   compact_block = compact_msg.as<compact_block_message>();
+
+   block_message reconstructed;
+   std::vector<uint32_t> missing;
+   BOOST_CHECK( reconstruct_compact_block( compact_block, lookup_in( cache ), reconstructed, missing ) );
+   BOOST_CHECK( missing == std::vector<uint32_t>( { 3 } ) );
+   BOOST_CHECK( reconstructed.block_id == block_id );
+
+   reconstructed.block.transactions[3] = block.transactions[3];
+   BOOST_CHECK( reconstructed.block.calculate_merkle_root() == block.transaction_merkle_root );
+   BOOST_CHECK( reconstructed.block.id() == block_id );
+   BOOST_CHECK( fc::raw::pack( reconstructed.block ) == fc::raw::pack( block ) );
+
+   // a peer that has none of them gets them all prefilled
+   compact_block = make_compact_block( block, block_id, []( const transaction_id_type& ) { return false; } );
+   BOOST_CHECK( !reconstruct_compact_block( compact_block, lookup_in( cache ), reconstructed, missing ) );
+   BOOST_CHECK( missing.empty() );
+   BOOST_CHECK( fc::raw::pack( reconstructed.block ) == fc::raw::pack( block ) );
+}
+
+// a transaction of ours with the short id of the block's gives a bad merkle root, not a bad block
+BOOST_AUTO_TEST_CASE( compact_block_short_id_collision_test )
+{
+   signed_block block = make_block( 3 );
+   blockchain_tied_message_cache cache;
+   cache_transaction( cache, block.transactions[0] );
+   cache_transaction( cache, block.transactions[1] );
+   cache_transaction( cache, make_transaction( 10 ), same_short_id( block.transactions[2].id() ) );
+
+   compact_block_message compact_block = make_compact_block( block, block.id(), []( const transaction_id_type& ) { return true; } );
+   BOOST_CHECK( compact_block.prefilled_transactions.empty() );
+   block_message reconstructed;
+   std::vector<uint32_t> missing;
+   BOOST_CHECK( reconstruct_compact_block( compact_block, lookup_in( cache ), reconstructed, missing ) );
+   BOOST_CHECK( missing.empty() );
+   BOOST_CHECK( reconstructed.block.transactions[2].id() == make_transaction( 10 ).id() );
+   BOOST_CHECK( reconstructed.block.calculate_merkle_root() != block.transaction_merkle_root );
+
+   // the operation results of the compact block are part of the merkle root too
+   compact_block.transactions[1].operation_results.front() = asset( 7 );
+   cache = blockchain_tied_message_cache();
+   for( const auto& trx : block.transactions )
+      cache_transaction( cache, trx );
+   reconstruct_compact_block( compact_block, lookup_in( cache ), reconstructed, missing );
+   BOOST_CHECK( missing.empty() );
+   BOOST_CHECK( reconstructed.block.calculate_merkle_root() != block.transaction_merkle_root );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
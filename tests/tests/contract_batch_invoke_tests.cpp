@@ -0,0 +1,172 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/contract_evaluate.hpp>
+#include <graphene/chain/transaction_object.hpp>
+
+#include "../common/contract_fixture.hpp"
+
+using namespace graphene::chain;
+
+namespace {
+
+typedef contract_batch_invoke_operation::contract_call contract_call;
+
+string receiver_address( const string& seed )
+{
+   return string( address( fc::ecc::private_key::regenerate( fc::sha256::hash( seed ) ).get_public_key() ) );
+}
+
+// the calls of a batch that initializes a token contract and transfers some of it
+vector<contract_call> token_calls()
+{
+   vector<contract_call> calls;
+   calls.push_back( { "init_token", "test,TEST,100000000,100" } );
+   for( int i = 0; i < 5; ++i )
+      calls.push_back( { "transfer", receiver_address( "receiver" + std::to_string( i % 3 ) ) + "," + std::to_string( 100 + i ) } );
+   return calls;
+}
+
+// the storage diffs the database keeps for contract_id, in the order they were applied
+vector<std::pair<string, vector<char>>> storage_diffs_of( database& db, const address& contract_id )
+{
+   vector<std::pair<string, vector<char>>> diffs;
+   for( const auto& obj : db.get_index_type<transaction_contract_storage_diff_index>().indices().get<by_id>() )
+   {
+      if( obj.contract_address == contract_id )
+         diffs.emplace_back( obj.storage_name, obj.diff );
+   }
+   return diffs;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( contract_batch_invoke_tests, contract_fixture )
+
+// a batch changes the storages as its calls pushed one by one do, and stores the same diffs
+BOOST_AUTO_TEST_CASE( batch_invoke_same_as_single_calls_test )
+{ try {
+   auto code = load_test_contract( "token.gpc" );
+   address batch_contract = register_contract( code );
+   address single_contract = register_contract( code );
+   generate_block();
+
+   vector<contract_call> calls = token_calls();
+   auto batch_trx = push_contract_operation( make_batch_invoke_operation( batch_contract, calls ) );
+   auto batch_result = invoke_result_of( batch_trx );
+   BOOST_CHECK( batch_result.exec_succeed );
+
+   int64_t single_gas = 0;
+   fc::variants single_api_results;
+   for( const auto& call : calls )
+   {
+      auto trx = push_contract_operation( make_invoke_operation( single_contract, call.contract_api, call.contract_arg ) );
+      BOOST_REQUIRE( invoke_result_of( trx ).exec_succeed );
+      single_gas += trx.operation_results.front().get<contract_operation_result_info>().gas_count.value;
+      single_api_results.push_back( invoke_result_of( trx ).api_result );
+   }
+   BOOST_CHECK_EQUAL( batch_trx.operation_results.front().get<contract_operation_result_info>().gas_count.value, single_gas );
+   BOOST_CHECK_EQUAL( batch_result.api_result, fc::json::to_string( single_api_results ) );
+
+   auto batch_diffs = storage_diffs_of( db, batch_contract );
+   auto single_diffs = storage_diffs_of( db, single_contract );
+   BOOST_REQUIRE_GT( batch_diffs.size(), calls.size() );
+   BOOST_CHECK( batch_diffs == single_diffs );
+   for( const auto& diff : batch_diffs )
+   {
+      BOOST_CHECK( db.get_contract_storage( batch_contract, diff.first ).storage_data
+                   == db.get_contract_storage( single_contract, diff.first ).storage_data );
+   }
+} FC_LOG_AND_RETHROW() }
+
+// a call that fails fails the whole batch, the calls before it change nothing
+BOOST_AUTO_TEST_CASE( batch_invoke_failed_call_test )
+{ try {
+   address contract = register_contract( load_test_contract( "token.gpc" ) );
+   generate_block();
+   push_contract_operation( make_invoke_operation( contract, "init_token", "test,TEST,100000000,100" ) );
+   generate_block();
+
+   auto diffs = storage_diffs_of( db, contract );
+   std::map<string, vector<char>> storages;
+   for( const auto& diff : diffs )
+      storages[diff.first] = db.get_contract_storage( contract, diff.first ).storage_data;
+   asset balance = db.get_balance( caller_addr, asset_id_type() );
+   vector<contract_call> calls;
+   calls.push_back( { "transfer", receiver_address( "receiver0" ) + ",100" } );
+   calls.push_back( { "transfer", receiver_address( "receiver1" ) + ",1000000000" } );
+   BOOST_CHECK_THROW( push_contract_operation( make_batch_invoke_operation( contract, calls ) ), fc::exception );
+
+   // the first call changed the users storage before the second one failed
+   BOOST_CHECK( storage_diffs_of( db, contract ) == diffs );
+   for( const auto& storage : storages )
+      BOOST_CHECK( db.get_contract_storage( contract, storage.first ).storage_data == storage.second );
+   BOOST_CHECK_EQUAL( db.get_balance( caller_addr, asset_id_type() ).amount.value, balance.amount.value );
+
+   calls.pop_back();
+   BOOST_CHECK( invoke_result_of( push_contract_operation( make_batch_invoke_operation( contract, calls ) ) ).exec_succeed );
+   BOOST_CHECK_GT( storage_diffs_of( db, contract ).size(), diffs.size() );
+} FC_LOG_AND_RETHROW() }
+
+// a batch has 1 to XWC_MAX_BATCH_INVOKE_CALLS calls
+BOOST_AUTO_TEST_CASE( batch_invoke_call_limit_test )
+{ try {
+   address contract = register_contract( load_test_contract( "token.gpc" ) );
+   generate_block();
+
+   vector<contract_call> calls( XWC_MAX_BATCH_INVOKE_CALLS, contract_call{ "balanceOf", string( caller_addr ) } );
+   make_batch_invoke_operation( contract, calls ).validate();
+   calls.push_back( calls.front() );
+   BOOST_CHECK_THROW( make_batch_invoke_operation( contract, calls ).validate(), fc::exception );
+   BOOST_CHECK_THROW( push_contract_operation( make_batch_invoke_operation( contract, calls ) ), fc::exception );
+   BOOST_CHECK_THROW( make_batch_invoke_operation( contract, {} ).validate(), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+// the calls of a native contract can't share the state of a batch
+BOOST_AUTO_TEST_CASE( batch_invoke_native_contract_test )
+{ try {
+   address contract = register_native_contract( "token" );
+   generate_block();
+
+   vector<contract_call> calls;
+   calls.push_back( { "init_token", "test,TEST,100000000,100" } );
+   BOOST_CHECK_THROW( push_contract_operation( make_batch_invoke_operation( contract, calls ) ), fc::exception );
+   BOOST_CHECK( invoke_result_of( push_contract_operation( make_invoke_operation( contract, "init_token", "test,TEST,100000000,100" ) ) ).exec_succeed );
+} FC_LOG_AND_RETHROW() }
+
+// the caller pays the gas all the calls used, the rest of invoke_cost is refunded
+BOOST_AUTO_TEST_CASE( batch_invoke_fee_test )
+{ try {
+   address contract = register_contract( load_test_contract( "token.gpc" ) );
+   generate_block();
+
+   operation op = make_batch_invoke_operation( contract, token_calls() );
+   db.current_fee_schedule().set_fee( op );
+   const auto& batch_op = op.get<contract_batch_invoke_operation>();
+   share_type base_fee = batch_op.fee.amount - count_gas_fee( batch_op.gas_price, batch_op.invoke_cost );
+
+   asset balance = db.get_balance( caller_addr, asset_id_type() );
+   auto trx = push_contract_operation( op );
+   auto result = invoke_result_of( trx );
+   int64_t gas_used = trx.operation_results.front().get<contract_operation_result_info>().gas_count.value;
+   BOOST_CHECK_GT( gas_used, 0 );
+   BOOST_CHECK_LT( gas_used, batch_op.invoke_cost );
+   BOOST_CHECK_EQUAL( result.acctual_fee.value, ( count_gas_fee( gas_price, gas_used ) + base_fee ).value );
+   BOOST_CHECK_EQUAL( db.get_balance( caller_addr, asset_id_type() ).amount.value, ( balance.amount - result.acctual_fee ).value );
+
+   // a batch that runs out of gas pays all of invoke_cost and changes nothing
+   vector<contract_call> calls( 1, contract_call{ "transfer", receiver_address( "receiver0" ) + ",1" } );
+   auto transfer_trx = push_contract_operation( make_batch_invoke_operation( contract, calls ) );
+   int64_t transfer_gas = transfer_trx.operation_results.front().get<contract_operation_result_info>().gas_count.value;
+   auto diffs = storage_diffs_of( db, contract );
+   calls.resize( 3, calls.front() );
+   balance = db.get_balance( caller_addr, asset_id_type() );
+   auto out_of_gas_trx = push_contract_operation( make_batch_invoke_operation( contract, calls, transfer_gas ) );
+   auto out_of_gas_result = invoke_result_of( out_of_gas_trx );
+   BOOST_CHECK( !out_of_gas_result.exec_succeed );
+   BOOST_CHECK( storage_diffs_of( db, contract ) == diffs );
+   BOOST_CHECK_EQUAL( db.get_balance( caller_addr, asset_id_type() ).amount.value, ( balance.amount - out_of_gas_result.acctual_fee ).value );
+   BOOST_CHECK_EQUAL( out_of_gas_result.acctual_fee.value,
+                      out_of_gas_trx.operations.front().get<contract_batch_invoke_operation>().fee.amount.value );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/contract_offline_executor.hpp>
+#include <graphene/chain/db_with.hpp>
+
+#include "../common/contract_fixture.hpp"
+
+#include <future>
+
+using namespace graphene::chain;
+
+BOOST_FIXTURE_TEST_SUITE( contract_offline_executor_tests, contract_fixture )
+
+// invoke_cost of offline calls is lowered to the executor's gas cap
+BOOST_AUTO_TEST_CASE( offline_gas_cap_test )
+{ try {
+   address contract = register_contract( load_test_contract( "test_many_objects.lua.gpc" ) );
+   contract_offline_executor& executor = db.offline_executor();
+   BOOST_CHECK_EQUAL( executor.gas_cap(), GRAPHENE_CONTRACT_TESTING_GAS );
+
+   offline_invoke_result result = executor.invoke( make_invoke_operation( contract, "hello", "", GRAPHENE_CONTRACT_TESTING_GAS ), fc::seconds( 10 ) );
+   BOOST_CHECK_GT( result.gas_count.value, 1000 );
+   BOOST_CHECK_EQUAL( result.block_num, db.head_block_num() );
+
+   executor.set_gas_cap( 1000 );
+   BOOST_CHECK_THROW( executor.invoke( make_invoke_operation( contract, "hello", "", GRAPHENE_CONTRACT_TESTING_GAS ), fc::seconds( 10 ) ), fc::exception );
+
+   executor.set_gas_cap( result.gas_count.value );
+   BOOST_CHECK_EQUAL( executor.invoke( make_invoke_operation( contract, "hello", "", GRAPHENE_CONTRACT_TESTING_GAS ), fc::seconds( 10 ) ).gas_count.value,
+                      result.gas_count.value );
+
+   BOOST_CHECK_THROW( executor.set_gas_cap( 0 ), fc::exception );
+   BOOST_CHECK_THROW( executor.set_gas_cap( XWC_MAX_GAS_LIMIT + 1 ), fc::exception );
+   executor.set_gas_cap( GRAPHENE_CONTRACT_TESTING_GAS );
+} FC_LOG_AND_RETHROW() }
+
+// a call still running when the timeout is over is stopped, the worker is free for the next call
+BOOST_AUTO_TEST_CASE( offline_timeout_test )
+{ try {
+   address contract = register_contract( load_test_contract( "test_many_objects.lua.gpc" ) );
+   contract_offline_executor executor( db, 1 );
+
+   BOOST_CHECK_THROW( executor.invoke( make_invoke_operation( contract, "hello", "" ), fc::microseconds( 1 ) ), fc::timeout_exception );
+
+   offline_invoke_result result = executor.invoke( make_invoke_operation( contract, "hello", "" ), fc::seconds( 10 ) );
+   BOOST_CHECK_GT( result.gas_count.value, 0 );
+} FC_LOG_AND_RETHROW() }
+
+// writers don't wait for running offline calls, the calls start over on the state the writers left
+BOOST_AUTO_TEST_CASE( offline_call_preempted_by_writer_test )
+{ try {
+   address contract = register_contract( load_test_contract( "test_many_objects.lua.gpc" ) );
+   contract_offline_executor executor( db, 1 );
+   offline_invoke_result expected = executor.invoke( make_invoke_operation( contract, "hello", "" ), fc::seconds( 10 ) );
+
+   auto call = std::async( std::launch::async, [&]() {
+      return executor.invoke( make_invoke_operation( contract, "hello", "" ), fc::seconds( 10 ) );
+   } );
+   for( int i = 0; i < 20 && call.wait_for( std::chrono::milliseconds( 0 ) ) != std::future_status::ready; ++i )
+   {
+      graphene::chain::detail::chain_state_write_lock write_lock( db );
+      BOOST_CHECK_EQUAL( db.chain_state_writers_waiting(), 0u );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+   }
+   offline_invoke_result result = call.get();
+   BOOST_CHECK_EQUAL( result.api_result, expected.api_result );
+   BOOST_CHECK_EQUAL( result.gas_count.value, expected.gas_count.value );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
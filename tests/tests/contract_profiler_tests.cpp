@@ -0,0 +1,162 @@
+#include <boost/test/unit_test.hpp>
+
+#include "../common/contract_fixture.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <uvm/uvm_profiler.h>
+
+using namespace graphene::chain;
+using namespace uvm::lua::lib;
+
+namespace {
+
+// the "stack count" lines of a collapsed profile, by stack
+std::map<string, int64_t> parse_collapsed( const string& collapsed )
+{
+   std::map<string, int64_t> counts;
+   std::vector<string> lines;
+   boost::split( lines, collapsed, []( char c ) { return c == '\n'; } );
+   for( const auto& line : lines )
+   {
+      if( line.empty() )
+         continue;
+      auto space = line.rfind( ' ' );
+      BOOST_REQUIRE( space != string::npos );
+      counts[line.substr( 0, space )] += std::stoll( line.substr( space + 1 ) );
+   }
+   return counts;
+}
+
+int64_t total( const std::map<string, int64_t>& counts )
+{
+   int64_t sum = 0;
+   for( const auto& p : counts )
+      sum += p.second;
+   return sum;
+}
+
+/** turns node profiling on for the life of a test, into an empty profile */
+struct node_profiling_fixture : contract_fixture
+{
+   node_profiling_fixture()
+   {
+      node_profiler()->reset();
+      set_node_profiling_enabled( true );
+   }
+   ~node_profiling_fixture()
+   {
+      set_node_profiling_enabled( false );
+      node_profiler()->reset();
+   }
+
+   std::map<string, int64_t> profile( UvmProfileMetric metric )
+   {
+      return parse_collapsed( node_profiler()->collapsed( metric ) );
+   }
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE( contract_profiler_tests )
+
+// counters of the same stack add up, and a metric prints only the stacks it counted
+BOOST_AUTO_TEST_CASE( profiler_merge_test )
+{
+   UvmProfiler profiler;
+   BOOST_CHECK( profiler.collapsed( UvmProfileMetric::instructions ).empty() );
+
+   UvmProfileCounters transfer;
+   transfer.instructions = 10;
+   transfer.gas = 12;
+   transfer.storage_writes = 2;
+   UvmProfileCounters balance;
+   balance.instructions = 3;
+   balance.gas = 3;
+   std::map<string, UvmProfileCounters> stacks;
+   stacks["c1;@self:10;line:12"] = transfer;
+   stacks["c1;@self:20;line:21"] = balance;
+   profiler.merge( stacks );
+   profiler.merge( stacks );
+
+   BOOST_CHECK_EQUAL( profiler.collapsed( UvmProfileMetric::instructions ), "c1;@self:10;line:12 20\nc1;@self:20;line:21 6\n" );
+   BOOST_CHECK_EQUAL( profiler.collapsed( UvmProfileMetric::gas ), "c1;@self:10;line:12 24\nc1;@self:20;line:21 6\n" );
+   BOOST_CHECK_EQUAL( profiler.collapsed( UvmProfileMetric::storage_writes ), "c1;@self:10;line:12 4\n" );
+   BOOST_CHECK( profiler.collapsed( UvmProfileMetric::storage_reads ).empty() );
+
+   profiler.reset();
+   BOOST_CHECK( profiler.collapsed( UvmProfileMetric::instructions ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( parse_profile_metric_test )
+{
+   UvmProfileMetric metric;
+   BOOST_CHECK( parse_profile_metric( "gas", metric ) && metric == UvmProfileMetric::gas );
+   BOOST_CHECK( parse_profile_metric( "wall_time", metric ) && metric == UvmProfileMetric::wall_time );
+   BOOST_CHECK( parse_profile_metric( "storage_writes", metric ) && metric == UvmProfileMetric::storage_writes );
+   BOOST_CHECK( !parse_profile_metric( "Gas", metric ) );
+   BOOST_CHECK( !parse_profile_metric( "", metric ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE( contract_profiler_vm_tests, node_profiling_fixture )
+
+// a contract call is profiled by the lines of the contract it ran
+BOOST_AUTO_TEST_CASE( profile_contract_invoke_test )
+{ try {
+   address contract = register_contract( load_test_contract( "token.gpc" ) );
+   generate_block();
+   push_contract_operation( make_invoke_operation( contract, "init_token", "test,TEST,100000000,100" ) );
+   node_profiler()->reset();
+
+   string receiver( address( generate_private_key( "receiver" ).get_public_key() ) );
+   auto trx = push_contract_operation( make_invoke_operation( contract, "transfer", receiver + ",100" ) );
+   BOOST_REQUIRE( invoke_result_of( trx ).exec_succeed );
+
+   auto instructions = profile( UvmProfileMetric::instructions );
+   BOOST_REQUIRE( !instructions.empty() );
+   bool contract_stack = false;
+   for( const auto& p : instructions )
+   {
+      BOOST_CHECK_GT( p.second, 0 );
+      BOOST_CHECK( p.first.find( ";line:" ) != string::npos );
+      contract_stack = contract_stack || boost::starts_with( p.first, string( contract ) + ";" );
+   }
+   BOOST_CHECK( contract_stack );
+
+   // every instruction costs gas, and the storage apis are charged to the lines calling them
+   int64_t gas = total( profile( UvmProfileMetric::gas ) );
+   BOOST_CHECK_GT( gas, 0 );
+   BOOST_CHECK_LE( gas, trx.operation_results.front().get<contract_operation_result_info>().gas_count.value );
+   BOOST_CHECK_GT( total( profile( UvmProfileMetric::storage_reads ) ), 0 );
+   BOOST_CHECK_GT( total( profile( UvmProfileMetric::storage_writes ) ), 0 );
+   for( const auto& p : profile( UvmProfileMetric::storage_writes ) )
+      BOOST_CHECK( instructions.count( p.first ) );
+
+   // nothing is profiled once profiling is off
+   set_node_profiling_enabled( false );
+   node_profiler()->reset();
+   push_contract_operation( make_invoke_operation( contract, "transfer", receiver + ",100" ) );
+   BOOST_CHECK( profile( UvmProfileMetric::instructions ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+// a scope profiles the calls of its thread into its own profiler, not the node profiler
+BOOST_AUTO_TEST_CASE( profiler_scope_test )
+{ try {
+   address contract = register_contract( load_test_contract( "token.gpc" ) );
+   generate_block();
+   node_profiler()->reset();
+
+   auto scoped = std::make_shared<UvmProfiler>();
+   {
+      UvmProfilerScope scope( scoped );
+      push_contract_operation( make_invoke_operation( contract, "init_token", "test,TEST,100000000,100" ) );
+   }
+   BOOST_CHECK( !scoped->collapsed( UvmProfileMetric::instructions ).empty() );
+   BOOST_CHECK( profile( UvmProfileMetric::instructions ).empty() );
+
+   push_contract_operation( make_invoke_operation( contract, "balanceOf", string( caller_addr ) ) );
+   BOOST_CHECK( !profile( UvmProfileMetric::instructions ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
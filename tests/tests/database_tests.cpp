@@ -27,9 +27,12 @@
 #include <graphene/chain/database.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/db_with.hpp>
 
 #include <fc/crypto/digest.hpp>
 
+#include <future>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -59,3 +62,28 @@ BOOST_AUTO_TEST_CASE( undo_test )
       throw;
    }
 }
+
+// the write lock is reentrant per database, holding one database's lock doesn't skip locking another
+BOOST_AUTO_TEST_CASE( chain_state_write_lock_per_database_test )
+{
+   database db1;
+   database db2;
+   {
+      graphene::chain::detail::chain_state_write_lock lock1( db1 );
+      graphene::chain::detail::chain_state_write_lock lock1_again( db1 );
+      {
+         graphene::chain::detail::chain_state_write_lock lock2( db2 );
+         BOOST_CHECK( !std::async( std::launch::async, [&]() { return db2.chain_state_mutex().try_lock_shared(); } ).get() );
+      }
+      BOOST_CHECK( !std::async( std::launch::async, [&]() { return db1.chain_state_mutex().try_lock_shared(); } ).get() );
+      bool db2_locked = std::async( std::launch::async, [&]() {
+         bool locked = db2.chain_state_mutex().try_lock_shared();
+         if( locked )
+            db2.chain_state_mutex().unlock_shared();
+         return locked;
+      } ).get();
+      BOOST_CHECK( db2_locked );
+   }
+   BOOST_CHECK( db1.chain_state_mutex().try_lock() );
+   db1.chain_state_mutex().unlock();
+}
@@ -0,0 +1,151 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/exchange_order_book/exchange_order_book_plugin.hpp>
+
+#include "../common/contract_fixture.hpp"
+
+#include <fc/io/json.hpp>
+
+using namespace graphene::chain;
+using namespace graphene::exchange_order_book;
+
+namespace {
+
+/**
+ *  The book is derived from contract events, which these tests add to the index directly:
+ *  an exchange contract only emits them for orders signed off chain.
+ */
+struct exchange_order_book_fixture : contract_fixture
+{
+   exchange_order_book_fixture()
+   {
+      plugin = app.register_plugin<exchange_order_book_plugin>();
+      boost::program_options::variables_map options;
+      options.emplace( "exchange-order-book", boost::program_options::variable_value( true, false ) );
+      plugin->plugin_initialize( options );
+      plugin->plugin_startup();
+      exchange = register_native_contract( "exchange" );
+      generate_block();
+   }
+
+   /** an event of the exchange contract in the next block */
+   const contract_event_notify_object& add_event( const string& name, const string& arg )
+   {
+      return db.create<contract_event_notify_object>( [&]( contract_event_notify_object& e ) {
+         e.contract_address = exchange;
+         e.event_name = name;
+         e.event_arg = arg;
+         e.block_num = db.head_block_num() + 1;
+         e.op_num = 0;
+      });
+   }
+
+   /** orders are "baseRemain,quoteRemain,owner,orderId,baseFilled,quoteFilled" */
+   const contract_event_notify_object& add_fill_event( const vector<string>& buys, const vector<string>& sells )
+   {
+      fc::mutable_variant_object arg;
+      arg( "exchangPair", "HC/COIN" )( "transactionBuys", buys )( "transactionSells", sells );
+      return add_event( "BuyOrderPutedOn", fc::json::to_string( arg ) );
+   }
+
+   exchange_order_book_depth depth()const
+   {
+      return plugin->get_depth( exchange, "HC/COIN", 10 );
+   }
+
+   std::shared_ptr<exchange_order_book_plugin> plugin;
+   address exchange;
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( exchange_order_book_tests, exchange_order_book_fixture )
+
+// the plugin is registered by witness_node, it only keeps a book when asked to
+BOOST_AUTO_TEST_CASE( exchange_order_book_disabled_by_default_test )
+{ try {
+   exchange_order_book_plugin disabled;
+   disabled.plugin_set_app( &app );
+   disabled.plugin_initialize( boost::program_options::variables_map() );
+   disabled.plugin_startup();
+   BOOST_CHECK( !disabled.is_enabled() );
+   BOOST_CHECK( plugin->is_enabled() );
+
+   add_fill_event( { "90,45,owner1,a,10,5" }, {} );
+   generate_block();
+   BOOST_CHECK( disabled.get_depth( exchange, "HC/COIN", 10 ).bids.empty() );
+   BOOST_CHECK_EQUAL( depth().bids.size(), 1u );
+} FC_LOG_AND_RETHROW() }
+
+// an order stays at the price it entered the book with, the contract rounds its remaining amounts
+BOOST_AUTO_TEST_CASE( exchange_order_book_original_price_test )
+{ try {
+   add_fill_event( { "90,45,owner1,a,10,5", "50,26,owner2,b,50,25", "80,40,owner3,c,20,10" }, { "30,33,owner4,d,70,77" } );
+   generate_block();
+
+   // a's remaining price is 21/40 now, above b's price
+   add_fill_event( { "40,21,owner1,a,60,29" }, {} );
+   generate_block();
+
+   auto book = depth();
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 2u );
+   BOOST_CHECK_EQUAL( book.bids[0].price, 51.0 / 100.0 );
+   BOOST_CHECK_EQUAL( book.bids[0].total_base, 50 );
+   BOOST_CHECK_EQUAL( book.bids[0].order_count, 1u );
+   BOOST_CHECK_EQUAL( book.bids[1].price, 0.5 );
+   BOOST_CHECK_EQUAL( book.bids[1].total_base, 40 + 80 );
+   BOOST_CHECK_EQUAL( book.bids[1].total_quote, 21 + 40 );
+   BOOST_CHECK_EQUAL( book.bids[1].order_count, 2u );
+   BOOST_REQUIRE_EQUAL( book.asks.size(), 1u );
+   BOOST_CHECK_EQUAL( book.asks[0].price, 110.0 / 100.0 );
+
+   auto orders = plugin->get_open_orders( exchange, "owner1" );
+   BOOST_REQUIRE_EQUAL( orders.size(), 1u );
+   BOOST_CHECK_EQUAL( orders[0].base_remain, 40 );
+   BOOST_CHECK_EQUAL( orders[0].base_amount, 100 );
+   BOOST_CHECK_EQUAL( orders[0].quote_amount, 50 );
+} FC_LOG_AND_RETHROW() }
+
+// completed and canceled orders leave the book
+BOOST_AUTO_TEST_CASE( exchange_order_book_remove_test )
+{ try {
+   add_fill_event( { "90,45,owner1,a,10,5", "50,26,owner2,b,50,25" }, {} );
+   generate_block();
+
+   add_fill_event( { "0,0,owner1,a,100,50" }, {} );
+   add_event( "CancelOrders", fc::json::to_string( vector<string>{ "b" } ) );
+   generate_block();
+
+   BOOST_CHECK( depth().bids.empty() );
+   BOOST_CHECK( plugin->get_open_orders( exchange, "owner1" ).empty() );
+   BOOST_CHECK( plugin->get_open_orders( exchange, "owner2" ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+// blocks popped by a fork switch are undone, the orders are as before them
+BOOST_AUTO_TEST_CASE( exchange_order_book_pop_block_test )
+{ try {
+   add_fill_event( { "90,45,owner1,a,10,5" }, {} );
+   generate_block();
+
+   const auto& fill = add_fill_event( { "40,20,owner1,a,60,30", "50,26,owner2,b,50,25" }, {} );
+   const auto& cancel = add_event( "CancelOrders", fc::json::to_string( vector<string>{ "a" } ) );
+   generate_block();
+   BOOST_CHECK( plugin->get_open_orders( exchange, "owner1" ).empty() );
+   BOOST_CHECK_EQUAL( plugin->get_open_orders( exchange, "owner2" ).size(), 1u );
+
+   // the block of the other fork at the same height has none of the events
+   db.pop_block();
+   db.remove( fill );
+   db.remove( cancel );
+   generate_block();
+
+   auto orders = plugin->get_open_orders( exchange, "owner1" );
+   BOOST_REQUIRE_EQUAL( orders.size(), 1u );
+   BOOST_CHECK_EQUAL( orders[0].base_remain, 90 );
+   BOOST_CHECK( plugin->get_open_orders( exchange, "owner2" ).empty() );
+   auto book = depth();
+   BOOST_REQUIRE_EQUAL( book.bids.size(), 1u );
+   BOOST_CHECK_EQUAL( book.bids[0].total_base, 90 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
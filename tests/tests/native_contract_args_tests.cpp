@@ -0,0 +1,94 @@
+#include <boost/test/unit_test.hpp>
+
+#include <native_contract/native_contract_args.h>
+#include <jsondiff/jsondiff.h>
+#include <uvm/uvm_lutil.h>
+
+using uvm::contract::native_args;
+using uvm::contract::native_event_builder;
+
+BOOST_AUTO_TEST_SUITE( native_contract_args_tests )
+
+BOOST_AUTO_TEST_CASE( native_args_text_test )
+{
+   native_args args("XWCNa1,  100 ,1.5", true);
+   BOOST_CHECK( !args.is_binary() );
+   BOOST_REQUIRE_EQUAL( args.size(), 3u );
+   BOOST_CHECK_EQUAL( args.string_at(1), "  100 " );
+   BOOST_CHECK( !args.is_int_at(0) );
+   BOOST_CHECK( !args.is_int_at(2) );
+
+   native_args trimmed("XWCNa1,  100 ,1.5", true, true);
+   BOOST_CHECK_EQUAL( trimmed.string_at(0), "XWCNa1" );
+   BOOST_CHECK_EQUAL( trimmed.string_at(1), "100" );
+   BOOST_CHECK( trimmed.is_int_at(1) );
+   BOOST_CHECK_EQUAL( trimmed.int_at(1), 100 );
+   BOOST_CHECK_THROW( native_args("99999999999999999999", true).int_at(0), std::out_of_range );
+}
+
+BOOST_AUTO_TEST_CASE( native_args_binary_test )
+{
+   const auto& arg = native_args::encode_binary({
+      cbor::CborObject::from_string("XWCNa1"),
+      cbor::CborObject::from_int(100),
+      cbor::CborObject::from_int(-5),
+      cbor::CborObject::from_extra_integer(5000000000, true),
+      cbor::CborObject::from_extra_integer(INT64_MAX, true),
+      cbor::CborObject::from_string("1,2") });
+
+   native_args args(arg, true);
+   BOOST_CHECK( args.is_binary() );
+   BOOST_REQUIRE_EQUAL( args.size(), 6u );
+   BOOST_CHECK( !args.is_int_at(0) );
+   BOOST_CHECK_EQUAL( args.string_at(0), "XWCNa1" );
+   BOOST_CHECK( args.is_int_at(1) );
+   BOOST_CHECK_EQUAL( args.int_at(1), 100 );
+   BOOST_CHECK_EQUAL( args.string_at(1), "100" );
+   BOOST_CHECK_EQUAL( args.int_at(2), -5 );
+   BOOST_CHECK( args.is_int_at(3) );
+   BOOST_CHECK_EQUAL( args.int_at(3), 5000000000 );
+   BOOST_CHECK_EQUAL( args.string_at(3), "5000000000" );
+   BOOST_CHECK_EQUAL( args.int_at(4), INT64_MAX );
+   // commas in binary arguments don't split them
+   BOOST_CHECK( !args.is_int_at(5) );
+   BOOST_CHECK_EQUAL( args.string_at(5), "1,2" );
+
+   // before activation the argument is taken as text
+   BOOST_CHECK( !native_args(arg, false).is_binary() );
+}
+
+BOOST_AUTO_TEST_CASE( native_args_malformed_binary_test )
+{
+   // integers beyond int64, items of other types and truncated cbor leave no arguments
+   BOOST_CHECK_EQUAL( native_args(native_args::encode_binary({ cbor::CborObject::from_extra_integer(uint64_t(INT64_MAX) + 1, true) }), true).size(), 0u );
+   BOOST_CHECK_EQUAL( native_args(native_args::encode_binary({ cbor::CborObject::from_bool(true) }), true).size(), 0u );
+   const auto& arg = native_args::encode_binary({ cbor::CborObject::from_string("XWCNa1"), cbor::CborObject::from_int(100) });
+   native_args truncated(arg.substr(0, arg.size() - 1), true);
+   BOOST_CHECK( truncated.is_binary() );
+   BOOST_CHECK_EQUAL( truncated.size(), 0u );
+
+   // text arguments starting with a byte of a cbor array header are still text
+   native_args text(std::string("\x83,1"), true);
+   BOOST_CHECK( !text.is_binary() );
+   BOOST_CHECK_EQUAL( text.size(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE( native_event_builder_test )
+{
+   native_event_builder builder;
+   builder.add("to", "XWCNb2").add("from", "XWCNa1\"\\").add("amount", int64_t(-100)).add("fee", int64_t(3));
+   // a key set again replaces its value
+   builder.add("fee", int64_t(4));
+
+   jsondiff::JsonObject event_arg;
+   event_arg["to"] = "XWCNb2";
+   event_arg["from"] = "XWCNa1\"\\";
+   event_arg["amount"] = int64_t(-100);
+   event_arg["fee"] = int64_t(4);
+   BOOST_CHECK_EQUAL( builder.str(), uvm::util::json_ordered_dumps(event_arg) );
+   BOOST_CHECK_EQUAL( builder.str(), "{\"amount\":-100,\"fee\":4,\"from\":\"XWCNa1\\\"\\\\\",\"to\":\"XWCNb2\"}" );
+
+   BOOST_CHECK_EQUAL( native_event_builder().str(), uvm::util::json_ordered_dumps(jsondiff::JsonObject()) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cbor_diff/cbor_diff.h>
+
+#include "../common/contract_fixture.hpp"
+
+using namespace graphene::chain;
+
+namespace {
+
+string receiver_address( const string& seed )
+{
+   return string( address( fc::ecc::private_key::regenerate( fc::sha256::hash( seed ) ).get_public_key() ) );
+}
+
+const int64_t token_supply = 100000000;
+
+struct native_token_fixture : contract_fixture
+{
+   native_token_fixture()
+   {
+      token = register_native_contract( "token" );
+      generate_block();
+   }
+
+   /** the storage changes of contract_id stored for the operation of trx */
+   contract_storage_changes_type storage_changes_of( const processed_transaction& trx )
+   {
+      auto result = invoke_result_of( trx );
+      BOOST_REQUIRE( result.exec_succeed );
+      auto changes = result.storage_changes.find( string( token ) );
+      BOOST_REQUIRE( changes != result.storage_changes.end() );
+      return changes->second;
+   }
+
+   /** checks each change is stored once, with the diff of its value before the invocation */
+   void check_storage_changes( const contract_storage_changes_type& changes )
+   {
+      for( const auto& change : changes )
+      {
+         auto diff = cbor_diff::CborDiff().diff_encoded( change.second.before.storage_data, change.second.after.storage_data );
+         BOOST_CHECK( change.second.storage_diff.storage_data == cbor_diff::cbor_encode( diff->value() ) );
+         BOOST_CHECK( db.get_contract_storage( token, change.first ).storage_data == change.second.after.storage_data );
+      }
+   }
+
+   int64_t balance_of( const string& owner )
+   {
+      auto trx = push_contract_operation( make_invoke_operation( token, "balanceOf", owner ) );
+      return std::stoll( invoke_result_of( trx ).api_result );
+   }
+
+   address token;
+};
+
+cbor::CborObjectP decoded( const StorageDataType& data )
+{
+   return cbor_diff::cbor_decode( data.storage_data );
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( native_contract_storage_tests, native_token_fixture )
+
+// the storages an invocation sets are diffed against the database once, whatever they were set to in between
+BOOST_AUTO_TEST_CASE( native_storage_changes_test )
+{ try {
+   auto init_trx = push_contract_operation( make_invoke_operation( token, "init_token",
+                                                                   "test,TEST," + std::to_string( token_supply ) + ",100" ) );
+   auto changes = storage_changes_of( init_trx );
+   check_storage_changes( changes );
+   BOOST_REQUIRE( changes.count( "state" ) );
+   BOOST_CHECK_EQUAL( decoded( changes["state"].before )->as_string(), "NOT_INITED" );
+   BOOST_CHECK_EQUAL( decoded( changes["state"].after )->as_string(), "COMMON" );
+   BOOST_REQUIRE( changes.count( "supply" ) );
+   BOOST_CHECK_EQUAL( decoded( changes["supply"].after )->force_as_int(), token_supply );
+   BOOST_REQUIRE( changes.count( "users." + string( caller_addr ) ) );
+   BOOST_CHECK_EQUAL( decoded( changes["users." + string( caller_addr )].after )->force_as_int(), token_supply );
+   generate_block();
+
+   string receiver = receiver_address( "receiver" );
+   auto transfer_trx = push_contract_operation( make_invoke_operation( token, "transfer", receiver + ",100" ) );
+   changes = storage_changes_of( transfer_trx );
+   check_storage_changes( changes );
+   BOOST_CHECK_EQUAL( changes.size(), 2u );
+   BOOST_CHECK_EQUAL( decoded( changes["users." + string( caller_addr )].before )->force_as_int(), token_supply );
+   BOOST_CHECK_EQUAL( decoded( changes["users." + string( caller_addr )].after )->force_as_int(), token_supply - 100 );
+   BOOST_CHECK( decoded( changes["users." + receiver].before )->is_null() );
+   BOOST_CHECK_EQUAL( decoded( changes["users." + receiver].after )->force_as_int(), 100 );
+   BOOST_CHECK_EQUAL( balance_of( string( caller_addr ) ), token_supply - 100 );
+   BOOST_CHECK_EQUAL( balance_of( receiver ), 100 );
+} FC_LOG_AND_RETHROW() }
+
+// a read in an invocation sees what the invocation set before it, not the value in the database
+BOOST_AUTO_TEST_CASE( native_storage_reads_pending_test )
+{ try {
+   push_contract_operation( make_invoke_operation( token, "init_token", "test,TEST," + std::to_string( token_supply ) + ",100" ) );
+   generate_block();
+
+   // the balance taken off the sender is read back as the receiver's balance
+   auto self_trx = push_contract_operation( make_invoke_operation( token, "transfer", string( caller_addr ) + ",100" ) );
+   auto changes = storage_changes_of( self_trx );
+   check_storage_changes( changes );
+   BOOST_CHECK_EQUAL( changes.size(), 1u );
+   BOOST_CHECK_EQUAL( decoded( changes["users." + string( caller_addr )].after )->force_as_int(), token_supply );
+   BOOST_CHECK_EQUAL( balance_of( string( caller_addr ) ), token_supply );
+
+   // the sender's storage is set to null, then the typed read of it finds no balance
+   string receiver = receiver_address( "receiver" );
+   auto all_trx = push_contract_operation( make_invoke_operation( token, "transfer", receiver + "," + std::to_string( token_supply ) ) );
+   changes = storage_changes_of( all_trx );
+   check_storage_changes( changes );
+   BOOST_CHECK( decoded( changes["users." + string( caller_addr )].after )->is_null() );
+   BOOST_CHECK_EQUAL( balance_of( string( caller_addr ) ), 0 );
+   BOOST_CHECK_EQUAL( balance_of( receiver ), token_supply );
+   BOOST_CHECK_THROW( push_contract_operation( make_invoke_operation( token, "transfer", receiver + ",1" ) ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/application.hpp>
+#include <graphene/net/peer_connection.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using graphene::app::precheck_network_transaction;
+using graphene::net::token_bucket;
+
+BOOST_AUTO_TEST_SUITE( token_bucket_tests )
+
+// a new bucket holds burst tokens, then earns tokens_per_second up to burst
+BOOST_AUTO_TEST_CASE( token_bucket_refill_test )
+{
+   const fc::time_point start( fc::seconds( 1500000000 ) );
+   token_bucket bucket;
+   BOOST_CHECK_EQUAL( bucket.take(), 0u );
+
+   bucket.refill( 10, 5, start );
+   BOOST_CHECK_EQUAL( bucket.tokens(), 5 );
+   BOOST_CHECK_EQUAL( bucket.take( 3 ), 3u );
+   BOOST_CHECK_EQUAL( bucket.take( 3 ), 2u );
+   BOOST_CHECK_EQUAL( bucket.take(), 0u );
+   BOOST_CHECK( bucket.next_token_time( 10 ) > start + fc::milliseconds( 100 ) - fc::microseconds( 10 ) );
+   BOOST_CHECK( bucket.next_token_time( 10 ) <= start + fc::milliseconds( 100 ) + fc::microseconds( 10 ) );
+
+   // a partial token can't be taken, it counts towards the next one
+   bucket.refill( 10, 5, start + fc::milliseconds( 250 ) );
+   BOOST_CHECK_CLOSE( bucket.tokens(), 2.5, 0.0001 );
+   BOOST_CHECK_EQUAL( bucket.take( 3 ), 2u );
+   BOOST_CHECK( bucket.next_token_time( 10 ) > start + fc::milliseconds( 300 ) - fc::microseconds( 10 ) );
+   BOOST_CHECK( bucket.next_token_time( 10 ) <= start + fc::milliseconds( 300 ) + fc::microseconds( 10 ) );
+
+   bucket.refill( 10, 5, start + fc::seconds( 60 ) );
+   BOOST_CHECK_EQUAL( bucket.tokens(), 5 );
+   BOOST_CHECK( bucket.next_token_time( 10 ) == start + fc::seconds( 60 ) );
+
+   // a clock that goes back earns nothing
+   BOOST_CHECK_EQUAL( bucket.take( 5 ), 5u );
+   bucket.refill( 10, 5, start );
+   BOOST_CHECK_EQUAL( bucket.tokens(), 0 );
+   bucket.refill( 10, 5, start + fc::seconds( 60 ) );
+   BOOST_CHECK_EQUAL( bucket.tokens(), 0 );
+}
+
+// a peer asking for transactions at the limit gets one per token, a burst of them is cut to the bucket size
+BOOST_AUTO_TEST_CASE( token_bucket_admission_rate_test )
+{
+   const fc::time_point start( fc::seconds( 1500000000 ) );
+   const uint32_t transactions_per_second = 20;
+   const uint32_t burst = 10;
+   token_bucket bucket;
+   uint32_t admitted = 0;
+   for( uint32_t request = 0; request < 1000; ++request )
+   {
+      // 1000 requests over 10 seconds
+      bucket.refill( transactions_per_second, burst, start + fc::milliseconds( request * 10 ) );
+      admitted += bucket.take();
+   }
+   BOOST_CHECK_GE( admitted, burst + 10 * transactions_per_second - 1 );
+   BOOST_CHECK_LE( admitted, burst + 10 * transactions_per_second );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE( network_transaction_precheck_tests, database_fixture )
+
+// a transaction from the network is refused on what it can be checked for without verifying its signatures
+BOOST_AUTO_TEST_CASE( precheck_network_transaction_test )
+{ try {
+   generate_block();
+   const chain_parameters& parameters = db.get_global_properties().parameters;
+
+   signed_transaction trx;
+   set_expiration( db, trx );
+   trx.signatures.resize( 3 );
+   precheck_network_transaction( db, trx, 3 );
+   BOOST_CHECK_THROW( precheck_network_transaction( db, trx, 2 ), fc::exception );
+
+   signed_transaction large_trx = trx;
+   large_trx.signatures.resize( parameters.maximum_transaction_size / sizeof( signature_type ) + 1 );
+   BOOST_CHECK_THROW( precheck_network_transaction( db, large_trx, large_trx.signatures.size() ), fc::exception );
+
+   signed_transaction expired_trx = trx;
+   expired_trx.expiration = db.head_block_time() - 1;
+   BOOST_CHECK_THROW( precheck_network_transaction( db, expired_trx, 3 ), fc::exception );
+
+   signed_transaction late_trx = trx;
+   late_trx.expiration = db.head_block_time() + parameters.maximum_time_until_expiration + 1;
+   BOOST_CHECK_THROW( precheck_network_transaction( db, late_trx, 3 ), fc::exception );
+
+   signed_transaction other_fork_trx = trx;
+   ++other_fork_trx.ref_block_prefix;
+   BOOST_CHECK_THROW( precheck_network_transaction( db, other_fork_trx, 3 ), fc::exception );
+
+   signed_transaction future_block_trx = trx;
+   future_block_trx.ref_block_num = db.head_block_num() + 10;
+   BOOST_CHECK_THROW( precheck_network_transaction( db, future_block_trx, 3 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/peer_connection.hpp>
+#include <graphene/net/core_messages.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+using namespace graphene::net;
+
+BOOST_AUTO_TEST_SUITE( p2p_metrics_tests )
+
+// the metrics name the item types and the core messages, anything else by its number
+BOOST_AUTO_TEST_CASE( message_type_name_test )
+{
+   BOOST_CHECK_EQUAL( message_type_name( 1000 ), "trx_message_type" );
+   BOOST_CHECK_EQUAL( message_type_name( 1001 ), "block_message_type" );
+   BOOST_CHECK_EQUAL( message_type_name( core_message_type_enum::hello_message_type ), "hello_message_type" );
+   BOOST_CHECK_EQUAL( message_type_name( core_message_type_enum::block_headers_message_type ), "block_headers_message_type" );
+   BOOST_CHECK_EQUAL( message_type_name( core_message_type_enum::core_message_type_first ), "5000" );
+   BOOST_CHECK_EQUAL( message_type_name( core_message_type_enum::core_message_type_last ), "5099" );
+   BOOST_CHECK_EQUAL( message_type_name( 1002 ), "1002" );
+   BOOST_CHECK_EQUAL( message_type_name( 5098 ), "5098" );
+}
+
+// messages are counted by type with their header, and a closed connection's counters add to the totals
+BOOST_AUTO_TEST_CASE( traffic_metrics_count_test )
+{
+   message trx = trx_message();
+   message hello = hello_message();
+
+   traffic_metrics peer;
+   peer.count_sent_message( trx );
+   peer.count_sent_message( trx );
+   peer.count_received_message( hello );
+   peer.item_latency.record( fc::milliseconds( 5 ) );
+   peer.item_latency.record( fc::milliseconds( 15 ) );
+   ++peer.duplicate_items_received;
+
+   BOOST_REQUIRE_EQUAL( peer.message_types.size(), 2u );
+   const message_type_counters& trx_counters = peer.message_types[trx_message_type];
+   BOOST_CHECK_EQUAL( trx_counters.messages_sent, 2u );
+   BOOST_CHECK_EQUAL( trx_counters.bytes_sent, 2 * ( sizeof( message_header ) + trx.size ) );
+   BOOST_CHECK_EQUAL( trx_counters.messages_received, 0u );
+   BOOST_CHECK_EQUAL( peer.message_types[hello_message_type].bytes_received, sizeof( message_header ) + hello.size );
+   BOOST_CHECK_EQUAL( peer.item_latency.count, 2u );
+   BOOST_CHECK( peer.item_latency.total == fc::milliseconds( 20 ) );
+   BOOST_CHECK( peer.item_latency.max == fc::milliseconds( 15 ) );
+
+   traffic_metrics totals;
+   totals.count_received_message( trx );
+   totals.item_latency.record( fc::milliseconds( 30 ) );
+   totals.add( peer );
+   BOOST_CHECK_EQUAL( totals.message_types[trx_message_type].messages_sent, 2u );
+   BOOST_CHECK_EQUAL( totals.message_types[trx_message_type].messages_received, 1u );
+   BOOST_CHECK_EQUAL( totals.message_types[hello_message_type].messages_received, 1u );
+   BOOST_CHECK_EQUAL( totals.item_latency.count, 3u );
+   BOOST_CHECK( totals.item_latency.total == fc::milliseconds( 50 ) );
+   BOOST_CHECK( totals.item_latency.max == fc::milliseconds( 30 ) );
+   BOOST_CHECK_EQUAL( totals.duplicate_items_received, 1u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
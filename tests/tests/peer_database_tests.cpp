@@ -0,0 +1,123 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/peer_database.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
+#include <fstream>
+
+using graphene::net::peer_database;
+using graphene::net::potential_peer_record;
+
+namespace {
+
+potential_peer_record make_peer_record( uint16_t port, uint32_t blocks_received )
+{
+   potential_peer_record record( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), port ),
+                                 fc::time_point_sec( 1500000000 + port ),
+                                 graphene::net::last_connection_succeeded );
+   record.number_of_blocks_received = blocks_received;
+   return record;
+}
+
+void check_peer_record( peer_database& peer_db, uint16_t port, uint32_t blocks_received )
+{
+   fc::optional<potential_peer_record> record = peer_db.lookup_entry_for_endpoint( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), port ) );
+   BOOST_REQUIRE( record.valid() );
+   BOOST_CHECK_EQUAL( record->number_of_blocks_received, blocks_received );
+   BOOST_CHECK( record->last_seen_time == fc::time_point_sec( 1500000000 + port ) );
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( peer_database_tests )
+
+// the database is a log of updates and erases, reopening it replays them
+BOOST_AUTO_TEST_CASE( peer_database_log_replay_test )
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   fc::path peer_db_filename = data_dir.path() / "peers.dat";
+   {
+      peer_database peer_db;
+      peer_db.open( peer_db_filename );
+      for( uint16_t port = 1000; port < 1010; ++port )
+         peer_db.update_entry( make_peer_record( port, 1 ) );
+      peer_db.update_entry( make_peer_record( 1003, 7 ) );
+      peer_db.erase( make_peer_record( 1005, 0 ).endpoint );
+      peer_db.close();
+   }
+
+   peer_database peer_db;
+   peer_db.open( peer_db_filename );
+   BOOST_CHECK_EQUAL( peer_db.size(), 9u );
+   check_peer_record( peer_db, 1000, 1 );
+   check_peer_record( peer_db, 1003, 7 );
+   BOOST_CHECK( !peer_db.lookup_entry_for_endpoint( make_peer_record( 1005, 0 ).endpoint ).valid() );
+   peer_db.close();
+}
+
+// a crash may leave a partly written entry at the end of the log, the entries before it are kept
+BOOST_AUTO_TEST_CASE( peer_database_damaged_tail_test )
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   fc::path peer_db_filename = data_dir.path() / "peers.dat";
+   {
+      peer_database peer_db;
+      peer_db.open( peer_db_filename );
+      peer_db.update_entry( make_peer_record( 1000, 1 ) );
+      peer_db.update_entry( make_peer_record( 1001, 2 ) );
+      peer_db.close();
+   }
+   {
+      std::ofstream log_file( peer_db_filename.generic_string().c_str(), std::ios::binary | std::ios::out | std::ios::app );
+      uint32_t entry_size = 100;
+      log_file.write( (const char*)&entry_size, sizeof(entry_size) );
+      log_file.write( "abc", 3 );
+   }
+   {
+      peer_database peer_db;
+      peer_db.open( peer_db_filename );
+      BOOST_CHECK_EQUAL( peer_db.size(), 2u );
+      check_peer_record( peer_db, 1000, 1 );
+      check_peer_record( peer_db, 1001, 2 );
+      // the damaged entry is dropped, so entries appended after it aren't lost
+      peer_db.update_entry( make_peer_record( 1002, 3 ) );
+      peer_db.close();
+   }
+
+   peer_database peer_db;
+   peer_db.open( peer_db_filename );
+   BOOST_CHECK_EQUAL( peer_db.size(), 3u );
+   check_peer_record( peer_db, 1002, 3 );
+   peer_db.close();
+}
+
+// peers.json of earlier versions is converted the first time the database is opened
+BOOST_AUTO_TEST_CASE( peer_database_legacy_json_test )
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   fc::path peer_db_filename = data_dir.path() / "peers.dat";
+   std::vector<potential_peer_record> legacy_records = { make_peer_record( 1000, 1 ), make_peer_record( 1001, 2 ) };
+   fc::json::save_to_file( legacy_records, data_dir.path() / "peers.json" );
+   {
+      peer_database peer_db;
+      peer_db.open( peer_db_filename );
+      BOOST_CHECK_EQUAL( peer_db.size(), 2u );
+      check_peer_record( peer_db, 1000, 1 );
+      check_peer_record( peer_db, 1001, 2 );
+      peer_db.close();
+   }
+   BOOST_CHECK( fc::exists( peer_db_filename ) );
+
+   // once converted, the log is used even when peers.json is still there
+   fc::json::save_to_file( std::vector<potential_peer_record>(), data_dir.path() / "peers.json" );
+   peer_database peer_db;
+   peer_db.open( peer_db_filename );
+   BOOST_CHECK_EQUAL( peer_db.size(), 2u );
+   check_peer_record( peer_db, 1001, 2 );
+   peer_db.close();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/node.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/bitutil.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+using namespace graphene::net;
+using graphene::chain::asset;
+
+namespace {
+
+/** a block message for a block at block_num, on the fork told apart by fork */
+block_message make_sync_block( uint32_t block_num, uint32_t fork = 0 )
+{
+   signed_block block;
+   block.previous._hash[0] = fc::endian_reverse_u32( block_num - 1 );
+   block.previous._hash[1] = fork;
+   block.timestamp = fc::time_point_sec( 1500000000 + block_num );
+   processed_transaction trx;
+   trx.ref_block_num = uint16_t( block_num );
+   trx.expiration = fc::time_point_sec( 1500000000 + block_num );
+   trx.operation_results.push_back( asset( block_num ) );
+   block.transactions.push_back( trx );
+   block.transaction_merkle_root = block.calculate_merkle_root();
+   return block_message( block );
+}
+
+void receive( received_sync_blocks& blocks, const block_message& block )
+{
+   blocks.insert( std::make_pair( block.block_id, block ) );
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( sync_block_backlog_tests )
+
+// the backlog is in block number order, whatever order the blocks come in and across the bytes of the number
+BOOST_AUTO_TEST_CASE( received_sync_blocks_order_test )
+{
+   std::vector<uint32_t> block_nums = { 65536, 2, 256, 1, 255, 16777216, 257, 65535 };
+   received_sync_blocks blocks;
+   for( uint32_t block_num : block_nums )
+      receive( blocks, make_sync_block( block_num ) );
+
+   std::sort( block_nums.begin(), block_nums.end() );
+   std::vector<uint32_t> received_nums;
+   for( const auto& p : blocks )
+   {
+      BOOST_CHECK( p.first == p.second.block.id() );
+      received_nums.push_back( p.second.block.block_num() );
+   }
+   BOOST_CHECK( received_nums == block_nums );
+}
+
+// the lowest block a peer is waiting for is pushed first, blocks no peer is waiting for stay in the backlog
+BOOST_AUTO_TEST_CASE( find_next_sync_block_test )
+{
+   received_sync_blocks blocks;
+   BOOST_CHECK( find_next_sync_block( blocks, {} ) == blocks.end() );
+
+   block_message block_10 = make_sync_block( 10 );
+   block_message block_11 = make_sync_block( 11 );
+   block_message fork_block_11 = make_sync_block( 11, 1 );
+   block_message block_300 = make_sync_block( 300 );
+   receive( blocks, block_300 );
+   receive( blocks, block_11 );
+   receive( blocks, fork_block_11 );
+   BOOST_CHECK( find_next_sync_block( blocks, {} ) == blocks.end() );
+
+   // block 10 isn't here yet, block 11 waits for it
+   BOOST_CHECK( find_next_sync_block( blocks, { block_10.block_id } ) == blocks.end() );
+
+   // peers on the fork and on the chain after block 300, the fork block is the lower one
+   auto next = find_next_sync_block( blocks, { block_300.block_id, fork_block_11.block_id } );
+   BOOST_REQUIRE( next != blocks.end() );
+   BOOST_CHECK( next->first == fork_block_11.block_id );
+
+   receive( blocks, block_10 );
+   next = find_next_sync_block( blocks, { block_300.block_id, block_10.block_id, fork_block_11.block_id } );
+   BOOST_REQUIRE( next != blocks.end() );
+   BOOST_CHECK( next->first == block_10.block_id );
+   BOOST_CHECK( next->second.block.block_num() == 10u );
+   blocks.erase( next );
+
+   // the peer then waits for block 11, and the same id from two peers is the same block
+   next = find_next_sync_block( blocks, { block_300.block_id, block_11.block_id, block_11.block_id } );
+   BOOST_REQUIRE( next != blocks.end() );
+   BOOST_CHECK( next->first == block_11.block_id );
+   BOOST_CHECK_EQUAL( blocks.size(), 3u );
+}
+
+// a block whose header or transactions were changed is rejected before it goes into the backlog
+BOOST_AUTO_TEST_CASE( sync_block_matches_id_test )
+{
+   block_message block = make_sync_block( 20 );
+   BOOST_CHECK( sync_block_matches_id( block ) );
+
+   block_message other_id = block;
+   other_id.block_id = make_sync_block( 21 ).block_id;
+   BOOST_CHECK( !sync_block_matches_id( other_id ) );
+
+   block_message other_header = block;
+   other_header.block.timestamp += 1;
+   BOOST_CHECK( !sync_block_matches_id( other_header ) );
+
+   // the transactions aren't part of the id, only of the merkle root in the header
+   block_message other_transactions = block;
+   other_transactions.block.transactions.front().operation_results.front() = asset( 7 );
+   BOOST_CHECK( other_transactions.block.id() == block.block_id );
+   BOOST_CHECK( !sync_block_matches_id( other_transactions ) );
+
+   other_transactions.block.transactions.clear();
+   BOOST_CHECK( !sync_block_matches_id( other_transactions ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,214 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/node.hpp>
+#include <graphene/net/core_messages.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+using namespace graphene::net;
+using graphene::chain::signed_block_header;
+using graphene::chain::miner_id_type;
+
+namespace {
+
+fc::ecc::private_key miner_key( int miner )
+{
+   return fc::ecc::private_key::regenerate( fc::sha256::hash( "sync_header_miner" + std::to_string( miner ) ) );
+}
+
+signed_block_header make_header( const item_hash_t& previous, fc::time_point_sec timestamp, int miner )
+{
+   signed_block_header header;
+   header.previous = previous;
+   header.timestamp = timestamp;
+   header.miner = miner_id_type( miner );
+   header.sign( miner_key( miner ) );
+   return header;
+}
+
+/** headers as a peer sends them, with the ids and signers we get from checking their signatures */
+struct sync_headers
+{
+   explicit sync_headers( const item_hash_t& previous_block_id ) : last_block_id( previous_block_id ) {}
+
+   std::vector<signed_block_header> headers;
+   std::vector<item_hash_t> block_ids;
+   std::vector<fc::ecc::public_key_data> signers;
+   item_hash_t last_block_id;
+
+   void add( const signed_block_header& header )
+   {
+      headers.push_back( header );
+      last_block_id = header.id();
+      block_ids.push_back( last_block_id );
+      signers.push_back( header.signee().serialize() );
+   }
+   /** adds the header of the block after the last one */
+   void add( fc::time_point_sec timestamp, int miner )
+   {
+      add( make_header( last_block_id, timestamp, miner ) );
+   }
+};
+
+const fc::time_point_sec first_slot_time( 1500000000 );
+const uint32_t block_interval = 5;
+
+// miners 0, 1 and 2 take turns, starting at first_slot_time.  miner 3 is active but not scheduled
+block_signing_schedule make_schedule( const item_hash_t& head_block_id, uint32_t last_scheduled_block_num )
+{
+   block_signing_schedule schedule;
+   schedule.head_block_id = head_block_id;
+   schedule.last_scheduled_block_num = last_scheduled_block_num;
+   schedule.first_slot_time = first_slot_time;
+   schedule.block_interval = block_interval;
+   schedule.next_maintenance_time = first_slot_time + 3600;
+   for( int miner = 0; miner < 3; ++miner )
+      schedule.slot_signing_keys.push_back( miner_key( miner ).get_public_key().serialize() );
+   for( int miner = 0; miner < 4; ++miner )
+      schedule.signing_keys.insert( miner_key( miner ).get_public_key().serialize() );
+   return schedule;
+}
+
+fc::time_point_sec slot_time( uint32_t slot )
+{
+   return first_slot_time + slot * block_interval;
+}
+
+const fc::time_point_sec latest_acceptable_timestamp = first_slot_time + 3600 * 24;
+
+}
+
+BOOST_AUTO_TEST_SUITE( sync_block_header_tests )
+
+// headers built on our head block are checked against the miner of their slot
+BOOST_AUTO_TEST_CASE( headers_on_scheduled_slots_test )
+{
+   signed_block_header head = make_header( item_hash_t(), first_slot_time - block_interval, 0 );
+   block_signing_schedule schedule = make_schedule( head.id(), 100 );
+   std::vector<char> trusted_signers;
+
+   sync_headers scheduled( head.id() );
+   scheduled.add( slot_time( 0 ), 0 );
+   scheduled.add( slot_time( 2 ), 2 ); // a missed slot
+   scheduled.add( slot_time( 3 ), 0 );
+   scheduled.add( slot_time( 4 ), 3 ); // an active miner, but not the one of the slot
+   BOOST_CHECK_EQUAL( check_sync_block_headers( scheduled.headers, scheduled.block_ids, scheduled.signers, head.id(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 4u );
+   BOOST_CHECK( trusted_signers == std::vector<char>( { 1, 1, 1, 0 } ) );
+
+   // the chain would reject a block between two slots, whoever signed it
+   sync_headers off_slot( head.id() );
+   off_slot.add( slot_time( 0 ), 0 );
+   off_slot.add( slot_time( 1 ) + 2, 1 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( off_slot.headers, off_slot.block_ids, off_slot.signers, head.id(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 1u );
+
+   sync_headers before_first_slot( head.id() );
+   before_first_slot.add( first_slot_time - 1, 0 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( before_first_slot.headers, before_first_slot.block_ids, before_first_slot.signers,
+                                                head.id(), schedule, latest_acceptable_timestamp, trusted_signers ), 0u );
+}
+
+// the slots are only known up to the end of the round and the next maintenance block, later headers
+// need an active miner's signature at a multiple of the block interval to be trusted
+BOOST_AUTO_TEST_CASE( headers_past_scheduled_slots_test )
+{
+   signed_block_header head = make_header( item_hash_t(), first_slot_time - block_interval, 0 );
+   std::vector<char> trusted_signers;
+
+   sync_headers headers( head.id() );
+   headers.add( slot_time( 0 ), 0 );                 // block 2, the last one on the schedule
+   headers.add( slot_time( 1 ), 0 );                 // not miner 1's slot, but a new round
+   headers.add( slot_time( 2 ) + 1, 1 );             // not at a multiple of the block interval
+   headers.add( slot_time( 4 ), 4 );                 // not an active miner
+   headers.add( slot_time( 5 ), 2 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( headers.headers, headers.block_ids, headers.signers, head.id(),
+                                                make_schedule( head.id(), 2 ), latest_acceptable_timestamp, trusted_signers ), 5u );
+   BOOST_CHECK( trusted_signers == std::vector<char>( { 1, 1, 0, 0, 1 } ) );
+
+   // a maintenance block is the last one the slots are known for
+   block_signing_schedule schedule = make_schedule( head.id(), 100 );
+   schedule.next_maintenance_time = slot_time( 1 );
+   sync_headers maintenance( head.id() );
+   maintenance.add( slot_time( 1 ), 1 );
+   maintenance.add( slot_time( 2 ) + 1, 1 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( maintenance.headers, maintenance.block_ids, maintenance.signers, head.id(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 2u );
+   BOOST_CHECK( trusted_signers == std::vector<char>( { 1, 0 } ) );
+
+   // headers that aren't built on our head block, e.g. of another fork, have no known slots
+   signed_block_header fork_block = make_header( item_hash_t(), first_slot_time - block_interval, 1 );
+   sync_headers other_fork( fork_block.id() );
+   other_fork.add( slot_time( 0 ) + 1, 0 );
+   other_fork.add( slot_time( 1 ), 2 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( other_fork.headers, other_fork.block_ids, other_fork.signers,
+                                                fc::optional<item_hash_t>(), make_schedule( head.id(), 100 ),
+                                                latest_acceptable_timestamp, trusted_signers ), 2u );
+   BOOST_CHECK( trusted_signers == std::vector<char>( { 0, 1 } ) );
+
+   // a client that doesn't know the miners trusts every signer
+   BOOST_CHECK_EQUAL( check_sync_block_headers( other_fork.headers, other_fork.block_ids, other_fork.signers,
+                                                fc::optional<item_hash_t>(), block_signing_schedule(),
+                                                latest_acceptable_timestamp, trusted_signers ), 2u );
+   BOOST_CHECK( trusted_signers == std::vector<char>( { 1, 1 } ) );
+}
+
+// the headers must form a chain, in time, starting at the block we asked after
+BOOST_AUTO_TEST_CASE( headers_chain_test )
+{
+   signed_block_header head = make_header( item_hash_t(), first_slot_time - block_interval, 0 );
+   block_signing_schedule schedule = make_schedule( head.id(), 100 );
+   std::vector<char> trusted_signers;
+
+   sync_headers headers( head.id() );
+   headers.add( slot_time( 0 ), 0 );
+   headers.add( slot_time( 1 ), 1 );
+
+   BOOST_CHECK_EQUAL( check_sync_block_headers( headers.headers, headers.block_ids, headers.signers, item_hash_t(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 0u );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( headers.headers, headers.block_ids, headers.signers, head.id(),
+                                                schedule, slot_time( 0 ), trusted_signers ), 1u );
+
+   sync_headers unlinked = headers;
+   unlinked.add( make_header( head.id(), slot_time( 2 ), 2 ) );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( unlinked.headers, unlinked.block_ids, unlinked.signers, head.id(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 2u );
+
+   sync_headers back_in_time = headers;
+   back_in_time.add( slot_time( 1 ), 2 );
+   BOOST_CHECK_EQUAL( check_sync_block_headers( back_in_time.headers, back_in_time.block_ids, back_in_time.signers, head.id(),
+                                                schedule, latest_acceptable_timestamp, trusted_signers ), 2u );
+}
+
+// the request and the reply of the header check keep their contents through the wire format
+BOOST_AUTO_TEST_CASE( block_headers_messages_test )
+{
+   std::vector<item_hash_t> block_ids;
+   std::vector<signed_block_header> headers;
+   item_hash_t previous;
+   for( uint32_t i = 0; i < 3; ++i )
+   {
+      headers.push_back( make_header( previous, slot_time( i ), i ) );
+      previous = headers.back().id();
+      block_ids.push_back( previous );
+   }
+
+   message request = get_block_headers_message( block_ids );
+   BOOST_CHECK_EQUAL( request.msg_type, core_message_type_enum::get_block_headers_message_type );
+   BOOST_CHECK( request.as<get_block_headers_message>().block_ids == block_ids );
+
+   block_headers_message reply;
+   reply.headers = headers;
+   message reply_message = reply;
+   BOOST_CHECK_EQUAL( reply_message.msg_type, core_message_type_enum::block_headers_message_type );
+   std::vector<signed_block_header> received = reply_message.as<block_headers_message>().headers;
+   BOOST_REQUIRE_EQUAL( received.size(), headers.size() );
+   for( size_t i = 0; i < headers.size(); ++i )
+   {
+      BOOST_CHECK( received[i].id() == block_ids[i] );
+      BOOST_CHECK( received[i].signee() == miner_key( i ).get_public_key() );
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/contract.hpp>
+#include <graphene/chain/uvm_chain_api.hpp>
+#include <uvm/uvm_lib.h>
+#include <uvm/uvm_code_cache.h>
+#include <uvm/lstate.h>
+
+#include <fc/filesystem.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+struct contract_call_result
+{
+   bool succeed = false;
+   std::string result;
+   int64_t gas_used = 0;
+   ptrdiff_t gc_used = 0;
+};
+
+// runs one api of a contract in a new lua_State, as each contract call does
+contract_call_result call_contract_api( const uvm::blockchain::Code& code, const char* api_name )
+{
+   uvm::lua::lib::UvmStateScope scope;
+   lua_State* L = scope.L();
+   uvm::lua::api::set_uvm_chain_api( L, uvm::lua::api::global_uvm_chain_api );
+   auto stream = uvm::lua::api::global_uvm_chain_api->get_bytestream_from_code( L, code );
+   BOOST_REQUIRE( stream );
+   scope.set_instructions_limit( 10000000 );
+   cbor::CborArrayValue args;
+   args.push_back( cbor::CborObject::from_string( "test" ) );
+   contract_call_result result;
+   result.succeed = uvm::lua::lib::execute_contract_api_by_stream( L, stream.get(), api_name, args, &result.result ) == LUA_OK;
+   result.gas_used = scope.get_instructions_executed_count();
+   result.gc_used = L->gc_state->usedsize();
+   return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( uvm_code_cache_tests )
+
+// the gc heap of a contract call counts against its limit, so a call must use the same
+// heap whether or not this process checked the contract's bytecode before
+BOOST_AUTO_TEST_CASE( verified_code_cache_same_gc_usage )
+{
+   if( !uvm::lua::api::global_uvm_chain_api )
+      uvm::lua::api::global_uvm_chain_api = new UvmChainApi();
+   fc::path contract_path = fc::path( __FILE__ ).parent_path() / ".." / ".." / "libraries" / "uvm" / "test" / "test_contracts" / "test_many_objects.lua.gpc";
+   uvm::blockchain::Code code = ContractHelper::load_contract_from_file( contract_path );
+
+   uvm::lua::lib::clear_verified_contract_codes();
+   contract_call_result cold = call_contract_api( code, "hello" );
+   contract_call_result warm = call_contract_api( code, "hello" );
+
+   BOOST_CHECK( cold.succeed );
+   BOOST_CHECK( warm.succeed );
+   BOOST_CHECK_EQUAL( cold.result, warm.result );
+   BOOST_CHECK_EQUAL( cold.gas_used, warm.gas_used );
+   BOOST_CHECK_EQUAL( cold.gc_used, warm.gc_used );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
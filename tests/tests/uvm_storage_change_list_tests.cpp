@@ -0,0 +1,98 @@
+#include <boost/test/unit_test.hpp>
+
+#include <uvm/uvm_api.h>
+
+namespace {
+
+UvmStorageChangeItem int_change( const std::string& contract_id, const std::string& key, lua_Integer after,
+                                 const std::string& fast_map_key = "" )
+{
+   UvmStorageChangeItem item;
+   item.contract_id = contract_id;
+   item.key = key;
+   item.fast_map_key = fast_map_key;
+   item.is_fast_map = !fast_map_key.empty();
+   item.after.type = uvm::blockchain::StorageValueTypes::storage_value_int;
+   item.after.value.int_value = after;
+   return item;
+}
+
+lua_Integer last_value( const UvmStorageChangeList& list, const std::string& contract_id, const std::string& key,
+                        const std::string& fast_map_key = "" )
+{
+   const UvmStorageChangeItem* item = list.find_last( contract_id, key, fast_map_key, !fast_map_key.empty() );
+   BOOST_REQUIRE( item );
+   return item->after.value.int_value;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( uvm_storage_change_list_tests )
+
+// the last change of a property is the one a read sees, whatever was changed after it
+BOOST_AUTO_TEST_CASE( storage_change_list_find_last_test )
+{
+   UvmStorageChangeList list;
+   BOOST_CHECK( !list.find_last( "c1", "a", "", false ) );
+
+   list.push_back( int_change( "c1", "a", 1 ) );
+   list.push_back( int_change( "c1", "b", 2 ) );
+   list.push_back( int_change( "c2", "a", 3 ) );
+   list.push_back( int_change( "c1", "a", 4 ) );
+   list.push_back( int_change( "c1", "a", 5, "k" ) );
+   BOOST_CHECK_EQUAL( list.size(), 5u );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a" ), 4 );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "b" ), 2 );
+   BOOST_CHECK_EQUAL( last_value( list, "c2", "a" ), 3 );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a", "k" ), 5 );
+   BOOST_CHECK( !list.find_last( "c1", "a", "k", false ) );
+   BOOST_CHECK( !list.find_last( "c1", "ak", "", false ) );
+
+   // the parts of a property can't run into each other
+   list.push_back( int_change( "c1a", "", 6 ) );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a" ), 4 );
+   BOOST_CHECK_EQUAL( last_value( list, "c1a", "" ), 6 );
+
+   const UvmStorageChangeList::property_changes* changes = list.find_all( "c1", "a", "", false );
+   BOOST_REQUIRE( changes );
+   BOOST_REQUIRE_EQUAL( changes->size(), 2u );
+   BOOST_CHECK_EQUAL( changes->front()->after.value.int_value, 1 );
+   BOOST_CHECK_EQUAL( changes->back()->after.value.int_value, 4 );
+
+   // the list keeps the order of the changes
+   std::vector<lua_Integer> values;
+   for( const auto& item : list )
+      values.push_back( item.after.value.int_value );
+   BOOST_CHECK( values == std::vector<lua_Integer>( { 1, 2, 3, 4, 5, 6 } ) );
+}
+
+// the changes of a failed contract call are popped off the back, the first null read off the front
+BOOST_AUTO_TEST_CASE( storage_change_list_pop_test )
+{
+   UvmStorageChangeList list;
+   list.push_back( int_change( "c1", "a", 1 ) );
+   list.push_back( int_change( "c1", "b", 2 ) );
+   size_t changes_before_call = list.size();
+   list.push_back( int_change( "c1", "a", 3 ) );
+   list.push_back( int_change( "c1", "c", 4 ) );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a" ), 3 );
+
+   while( list.size() > changes_before_call )
+      list.pop_back();
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a" ), 1 );
+   BOOST_CHECK( !list.find_last( "c1", "c", "", false ) );
+
+   list.push_back( int_change( "c1", "a", 5 ) );
+   list.pop_front();
+   BOOST_CHECK_EQUAL( list.size(), 2u );
+   BOOST_CHECK_EQUAL( list.find_all( "c1", "a", "", false )->size(), 1u );
+   BOOST_CHECK_EQUAL( last_value( list, "c1", "a" ), 5 );
+   BOOST_CHECK_EQUAL( list.begin()->after.value.int_value, 2 );
+
+   list.clear();
+   BOOST_CHECK( list.empty() );
+   BOOST_CHECK( !list.find_last( "c1", "a", "", false ) );
+   BOOST_CHECK( !list.find_last( "c1", "b", "", false ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
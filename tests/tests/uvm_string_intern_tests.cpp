@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/uvm_chain_api.hpp>
+#include <uvm/uvm_lib.h>
+#include <uvm/lstate.h>
+#include <uvm/lstring.h>
+#include <vmgc/gcstate.h>
+
+using namespace graphene::chain;
+using uvm_types::GcString;
+
+namespace {
+
+GcString* intern( vmgc::GcState& gc, const std::string& str )
+{
+   GcString* s = gc.gc_intern_string<GcString>( str.data(), str.size() );
+   BOOST_REQUIRE( s );
+   BOOST_REQUIRE_EQUAL( s->value, str );
+   return s;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( uvm_string_intern_tests )
+
+// a short string is pooled once by its content, strings of the same hash stay apart
+BOOST_AUTO_TEST_CASE( intern_short_strings_test )
+{
+   vmgc::GcState gc;
+   GcString* balance = intern( gc, "balance" );
+   BOOST_CHECK( balance->interned );
+   BOOST_CHECK_EQUAL( intern( gc, "balance" ), balance );
+   BOOST_CHECK_EQUAL( balance->hash(), luaS_hash( "balance", 7, 1 ) );
+   BOOST_CHECK( intern( gc, "balancf" ) != balance );
+   BOOST_CHECK( intern( gc, "balanc" ) != balance );
+   BOOST_CHECK( intern( gc, std::string( "balance\0", 8 ) ) != balance );
+
+   // enough strings to grow the pool several times, each found again after the growth
+   std::vector<GcString*> strings;
+   for( int i = 0; i < 10000; ++i )
+      strings.push_back( intern( gc, "key" + std::to_string( i ) ) );
+   for( int i = 0; i < 10000; ++i )
+      BOOST_CHECK_EQUAL( intern( gc, "key" + std::to_string( i ) ), strings[i] );
+   BOOST_CHECK_EQUAL( intern( gc, "balance" ), balance );
+
+   // long strings aren't pooled
+   std::string long_str( DEFAULT_MAX_GC_SHORT_STRING_SIZE, 'a' );
+   GcString* long1 = intern( gc, long_str );
+   GcString* long2 = intern( gc, long_str );
+   BOOST_CHECK( !long1->interned );
+   BOOST_CHECK( long1 != long2 );
+   BOOST_CHECK( luaS_eqlngstr( long1, long2 ) );
+}
+
+// once the pool is full, new strings get objects of their own and still compare equal by content
+BOOST_AUTO_TEST_CASE( full_strpool_test )
+{
+   vmgc::GcState gc;
+   GcString* first = intern( gc, "first" );
+   size_t pooled = 1;
+   while( !gc.gc_strpool_full() )
+   {
+      BOOST_REQUIRE( intern( gc, "s" + std::to_string( pooled ) )->interned );
+      ++pooled;
+   }
+   BOOST_CHECK_GT( pooled, 1000u );
+
+   GcString* new1 = intern( gc, "not pooled" );
+   GcString* new2 = intern( gc, "not pooled" );
+   BOOST_CHECK( !new1->interned );
+   BOOST_CHECK( new1 != new2 );
+   BOOST_CHECK( luaS_eqlngstr( new1, new2 ) );
+   BOOST_CHECK_EQUAL( new1->hash(), luaS_hash( "not pooled", 10, 1 ) );
+
+   // strings pooled before still come from the pool
+   BOOST_CHECK_EQUAL( intern( gc, "first" ), first );
+   BOOST_CHECK_EQUAL( intern( gc, "s1" ), intern( gc, "s1" ) );
+   BOOST_CHECK( luaS_eqlngstr( first, first ) );
+
+   GcString copy;
+   copy.value = "first";
+   BOOST_CHECK( luaS_eqlngstr( first, &copy ) );
+   BOOST_CHECK( !luaS_eqlngstr( first, new1 ) );
+
+   // gc_free_all empties the pool
+   gc.gc_free_all();
+   BOOST_CHECK( !gc.gc_strpool_full() );
+   BOOST_CHECK( intern( gc, "not pooled" )->interned );
+}
+
+// a field read by an interned key sees every later write of the field
+BOOST_AUTO_TEST_CASE( table_interned_key_lookup_test )
+{
+   if( !uvm::lua::api::global_uvm_chain_api )
+      uvm::lua::api::global_uvm_chain_api = new UvmChainApi();
+   uvm::lua::lib::UvmStateScope scope;
+   lua_State* L = scope.L();
+
+   lua_newtable( L );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK( lua_isnil( L, -1 ) );
+   lua_pop( L, 1 );
+
+   // a missing key isn't remembered
+   lua_pushinteger( L, 100 );
+   lua_setfield( L, -2, "balance" );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK_EQUAL( lua_tointeger( L, -1 ), 100 );
+   lua_pop( L, 1 );
+
+   lua_pushinteger( L, 200 );
+   lua_setfield( L, -2, "balance" );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK_EQUAL( lua_tointeger( L, -1 ), 200 );
+   lua_pop( L, 1 );
+
+   // the same key in another table
+   lua_newtable( L );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK( lua_isnil( L, -1 ) );
+   lua_pop( L, 1 );
+   lua_pushstring( L, "other" );
+   lua_setfield( L, -2, "balance" );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK_EQUAL( std::string( lua_tostring( L, -1 ) ), "other" );
+   lua_pop( L, 2 );
+
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK_EQUAL( lua_tointeger( L, -1 ), 200 );
+   lua_pop( L, 1 );
+
+   lua_pushnil( L );
+   lua_setfield( L, -2, "balance" );
+   lua_getfield( L, -1, "balance" );
+   BOOST_CHECK( lua_isnil( L, -1 ) );
+   lua_pop( L, 2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()